@@ -0,0 +1,161 @@
+#include "Bench.h"
+#include "BasicServices/FileWriter.h"
+#include "BasicServices/Profiler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fmt/format.h>
+
+using services::Profiler;
+
+namespace bench {
+
+namespace {
+    // Runs the body iterations times, returns the elapsed nanoseconds and accumulates the items
+    u64 timeRuns(const Body& body, u64 iterations, u64& items) {
+        const u64 start = Profiler::now();
+        for (u64 i = 0; i < iterations; i++) {
+            items += body();
+        }
+        return Profiler::now() - start;
+    }
+}
+
+Options Options::fromArguments(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--list") == 0) {
+            options.list = true;
+            continue;
+        }
+        if (!value) {
+            fmt::print(stderr, "meadows_bench: missing value for {}\n", arg);
+            continue;
+        }
+
+        if (std::strcmp(arg, "--filter") == 0) options.filter = value;
+        else if (std::strcmp(arg, "--samples") == 0) options.samples = std::max(1, std::atoi(value));
+        else if (std::strcmp(arg, "--min-time") == 0) options.minTimeMs = std::max(0.1, std::atof(value));
+        else if (std::strcmp(arg, "--json") == 0) options.jsonOutput = value;
+        else {
+            fmt::print(stderr, "meadows_bench: unknown argument {}\n", arg);
+            continue;
+        }
+        i++;
+    }
+    return options;
+}
+
+void Suite::add(const str& name, Setup setup) {
+    entries.push_back({ name, std::move(setup) });
+}
+
+Result Suite::measure(const Entry& entry, const Options& options) const {
+    const Body body = entry.setup();
+
+    // Warm caches and lazy allocations once, then grow the run count until a sample is long enough
+    u64 items = 0;
+    timeRuns(body, 1, items);
+
+    const f64 minTimeNs = options.minTimeMs * 1'000'000.0;
+    u64 iterations = 1;
+    while (true) {
+        items = 0;
+        const u64 elapsed = timeRuns(body, iterations, items);
+        if (static_cast<f64>(elapsed) >= minTimeNs || iterations >= (1ull << 40)) break;
+
+        // Aim slightly past the target from the last measurement, at most x10 per step
+        const f64 scale = elapsed > 0 ? minTimeNs * 1.2 / static_cast<f64>(elapsed) : 10.0;
+        iterations = std::max(iterations + 1, static_cast<u64>(static_cast<f64>(iterations) * std::min(scale, 10.0)));
+    }
+
+    vector<f64> samples;
+    samples.reserve(options.samples);
+    u64 sampleItems = 0;
+    for (u32 s = 0; s < options.samples; s++) {
+        sampleItems = 0;
+        const u64 elapsed = timeRuns(body, iterations, sampleItems);
+        samples.push_back(static_cast<f64>(elapsed) / static_cast<f64>(iterations));
+    }
+    std::sort(samples.begin(), samples.end());
+
+    f64 sum = 0.0;
+    for (const f64 sample : samples) {
+        sum += sample;
+    }
+
+    Result result;
+    result.name = entry.name;
+    result.iterations = iterations;
+    result.minNs = samples.front();
+    result.medianNs = samples[samples.size() / 2];
+    result.meanNs = sum / static_cast<f64>(samples.size());
+    const f64 itemsPerRun = static_cast<f64>(sampleItems) / static_cast<f64>(iterations);
+    result.itemsPerSecond = result.medianNs > 0.0 ? itemsPerRun * 1'000'000'000.0 / result.medianNs : 0.0;
+    return result;
+}
+
+int Suite::run(const Options& options) {
+    vector<const Entry*> selected;
+    for (const Entry& entry : entries) {
+        if (options.filter.empty() || entry.name.find(options.filter) != str::npos) {
+            selected.push_back(&entry);
+        }
+    }
+
+    if (options.list) {
+        for (const Entry* entry : selected) {
+            fmt::print("{}\n", entry->name);
+        }
+        return 0;
+    }
+    if (selected.empty()) {
+        fmt::print(stderr, "meadows_bench: no benchmark matches '{}'\n", options.filter);
+        return 1;
+    }
+
+    vector<Result> results;
+    results.reserve(selected.size());
+    for (const Entry* entry : selected) {
+        fmt::print(stderr, "Running {}...\n", entry->name);
+        results.push_back(measure(*entry, options));
+    }
+
+    // Printed once everything ran, so benchmarks that log do not interleave with the table
+    fmt::print("\n{:<40} {:>12} {:>12} {:>12} {:>14} {:>10}\n", "Benchmark", "Median", "Min", "Mean", "Items/s", "Runs");
+    for (const Result& r : results) {
+        fmt::print("{:<40} {:>9.3f} us {:>9.3f} us {:>9.3f} us {:>14.4g} {:>10}\n",
+            r.name, r.medianNs / 1000.0, r.minNs / 1000.0, r.meanNs / 1000.0, r.itemsPerSecond, r.iterations);
+    }
+
+    if (!options.jsonOutput.empty() && !writeJson(options.jsonOutput, results)) {
+        return 1;
+    }
+    return 0;
+}
+
+bool Suite::writeJson(const str& path, const vector<Result>& results) const {
+    services::FileWriter writer;
+    if (!writer.open(path)) {
+        fmt::print(stderr, "meadows_bench: cannot open {}\n", path);
+        return false;
+    }
+
+    writer.writeLine("{");
+    writer.writeLine("  \"benchmarks\": [");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        writer.writeLine(fmt::format("    {{\"name\":\"{}\",\"iterations\":{},\"median_ns\":{:.1f},\"min_ns\":{:.1f},"
+                                     "\"mean_ns\":{:.1f},\"items_per_second\":{:.1f}}}{}",
+            r.name, r.iterations, r.medianNs, r.minNs, r.meanNs, r.itemsPerSecond, i + 1 < results.size() ? "," : ""));
+    }
+    writer.writeLine("  ]");
+    writer.writeLine("}");
+    writer.close();
+    return true;
+}
+
+} // namespace bench
@@ -0,0 +1,85 @@
+#pragma once
+#include "Defines.h"
+#include <functional>
+
+/**
+ * Minimal microbenchmark harness for meadows_bench.
+ *
+ * A benchmark is a setup function returning its body. Setup runs once and is
+ * not timed; the body runs the measured operation once and returns how many
+ * items it processed (objects culled, sets allocated, bytes parsed...).
+ *
+ *     suite.add("culling/cullVisible", [] {
+ *         auto objects = std::make_shared<vector<RenderObject>>(makeObjects(10000));
+ *         return bench::Body { [objects] {
+ *             ...
+ *             return u64 { objects->size() };
+ *         } };
+ *     });
+ *
+ * The body is repeated until one sample lasts minTimeMs, then samples are
+ * taken and the median time per run is reported.
+ */
+
+namespace bench {
+
+using Body = std::function<u64()>;
+using Setup = std::function<Body()>;
+
+// Keeps the compiler from optimizing away a value only computed for the benchmark
+template<class T>
+inline void doNotOptimize(const T& value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    const volatile void* sink = &value;
+    (void)sink;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+struct Options {
+    str filter;              // Only run benchmarks whose name contains this
+    u32 samples { 10 };
+    f64 minTimeMs { 20.0 };  // Minimum duration of one sample
+    str jsonOutput;          // Empty: no JSON report
+    bool list { false };     // Print the benchmark names and exit
+
+    static Options fromArguments(int argc, char* argv[]);
+};
+
+struct Result {
+    str name;
+    u64 iterations { 0 };    // Body runs per sample
+    f64 minNs { 0.0 };       // Per body run
+    f64 medianNs { 0.0 };
+    f64 meanNs { 0.0 };
+    f64 itemsPerSecond { 0.0 };
+};
+
+class Suite {
+public:
+    void add(const str& name, Setup setup);
+
+    // Runs the selected benchmarks, prints a table and writes the JSON report. Returns the exit code
+    int run(const Options& options);
+
+private:
+    struct Entry {
+        str name;
+        Setup setup;
+    };
+
+    Result measure(const Entry& entry, const Options& options) const;
+    bool writeJson(const str& path, const vector<Result>& results) const;
+
+    vector<Entry> entries;
+};
+
+// Registration, one function per benchmark file
+void registerRenderBenchmarks(Suite& suite);
+void registerDescriptorBenchmarks(Suite& suite);
+void registerLoaderBenchmarks(Suite& suite);
+void registerLogBenchmarks(Suite& suite);
+
+} // namespace bench
@@ -0,0 +1,71 @@
+#include "Bench.h"
+#include "NullDevice.h"
+#include "Graphics/DescriptorAllocatorGrowable.h"
+#include "Graphics/DescriptorWriter.h"
+
+using namespace graphics;
+
+namespace bench {
+
+namespace {
+    constexpr u32 SET_COUNT = 1000;
+
+    // Same ratios as the per-frame allocators of the renderer
+    vector<DescriptorAllocatorGrowable::PoolSizeRatio> frameRatios() {
+        return {
+            { vk::DescriptorType::eStorageImage, 3 },
+            { vk::DescriptorType::eStorageBuffer, 3 },
+            { vk::DescriptorType::eUniformBuffer, 3 },
+            { vk::DescriptorType::eCombinedImageSampler, 4 }
+        };
+    }
+}
+
+void registerDescriptorBenchmarks(Suite& suite) {
+    // Steady state of a frame allocator: pools already grown, reset every frame
+    suite.add("descriptors/allocate 1k + clear", [] {
+        auto ratios = frameRatios();
+        auto allocator = std::make_shared<DescriptorAllocatorGrowable>(nullDevice(), SET_COUNT, ratios);
+        const auto layout = fakeHandle<vk::DescriptorSetLayout>(0x10);
+        return Body { [allocator, layout] {
+            for (u32 i = 0; i < SET_COUNT; i++) {
+                doNotOptimize(allocator->allocate(layout));
+            }
+            allocator->clear();
+            return u64 { SET_COUNT };
+        } };
+    });
+
+    // Cold allocator starting small: measures the pool growth path of getPool
+    suite.add("descriptors/allocate 4k growing", [] {
+        const auto layout = fakeHandle<vk::DescriptorSetLayout>(0x10);
+        return Body { [layout] {
+            auto ratios = frameRatios();
+            DescriptorAllocatorGrowable allocator { nullDevice(), 16, ratios };
+            for (u32 i = 0; i < 4 * SET_COUNT; i++) {
+                doNotOptimize(allocator.allocate(layout));
+            }
+            return u64 { 4 * SET_COUNT };
+        } };
+    });
+
+    // Material-like writes: one uniform buffer and four textures per set
+    suite.add("descriptors/DescriptorWriter 1k sets", [] {
+        auto writer = std::make_shared<DescriptorWriter>();
+        return Body { [writer] {
+            const vk::Device device = nullDevice();
+            for (u32 i = 0; i < SET_COUNT; i++) {
+                writer->clear();
+                writer->writeBuffer(0, fakeHandle<vk::Buffer>(0x20), 64, i * 256, vk::DescriptorType::eUniformBuffer);
+                for (int binding = 1; binding <= 4; binding++) {
+                    writer->writeImage(binding, fakeHandle<vk::ImageView>(0x30 + binding), fakeHandle<vk::Sampler>(0x40),
+                                       vk::ImageLayout::eShaderReadOnlyOptimal, vk::DescriptorType::eCombinedImageSampler);
+                }
+                writer->updateSet(device, fakeHandle<vk::DescriptorSet>(0x50 + i));
+            }
+            return u64 { SET_COUNT };
+        } };
+    });
+}
+
+} // namespace bench
@@ -0,0 +1,209 @@
+#include "Bench.h"
+#include "BasicServices/FileWriter.h"
+#include "Graphics/KTXLoader.h"
+#include "Graphics/VulkanLoader.h"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+
+using namespace graphics;
+
+namespace bench {
+
+namespace {
+    constexpr u32 GRID_SIZE = 256;          // Vertices per side of the benchmark mesh
+    constexpr u32 KTX_SIZE = 1024;          // RGBA8, full mip chain
+
+    str tempPath(const char* fileName) {
+        return (std::filesystem::temp_directory_path() / fileName).string();
+    }
+
+    str encodeBase64(const vector<u8>& bytes) {
+        constexpr char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        str encoded;
+        encoded.reserve((bytes.size() + 2) / 3 * 4);
+        for (size_t i = 0; i < bytes.size(); i += 3) {
+            const u32 b0 = bytes[i];
+            const u32 b1 = i + 1 < bytes.size() ? bytes[i + 1] : 0;
+            const u32 b2 = i + 2 < bytes.size() ? bytes[i + 2] : 0;
+            const u32 triple = (b0 << 16) | (b1 << 8) | b2;
+            encoded += table[(triple >> 18) & 63];
+            encoded += table[(triple >> 12) & 63];
+            encoded += i + 1 < bytes.size() ? table[(triple >> 6) & 63] : '=';
+            encoded += i + 2 < bytes.size() ? table[triple & 63] : '=';
+        }
+        return encoded;
+    }
+
+    template<class T>
+    void append(vector<u8>& bytes, const T& value) {
+        const auto* data = reinterpret_cast<const u8*>(&value);
+        bytes.insert(bytes.end(), data, data + sizeof(T));
+    }
+
+    /**
+     * Writes a glTF with one GRID_SIZE x GRID_SIZE grid primitive (positions, normals,
+     * UVs, u32 indices) embedded as a base64 buffer, so no asset is needed on disk.
+     */
+    str writeGridGltf() {
+        constexpr u32 vertexCount = GRID_SIZE * GRID_SIZE;
+        constexpr u32 indexCount = (GRID_SIZE - 1) * (GRID_SIZE - 1) * 6;
+
+        vector<u8> buffer;
+        buffer.reserve(vertexCount * 32 + indexCount * 4);
+        for (u32 y = 0; y < GRID_SIZE; y++) {
+            for (u32 x = 0; x < GRID_SIZE; x++) {
+                append(buffer, glm::vec3 { static_cast<f32>(x), std::sin(x * 0.1f) * std::cos(y * 0.1f), static_cast<f32>(y) });
+            }
+        }
+        for (u32 i = 0; i < vertexCount; i++) {
+            append(buffer, glm::vec3 { 0.f, 1.f, 0.f });
+        }
+        for (u32 y = 0; y < GRID_SIZE; y++) {
+            for (u32 x = 0; x < GRID_SIZE; x++) {
+                append(buffer, glm::vec2 { x / static_cast<f32>(GRID_SIZE - 1), y / static_cast<f32>(GRID_SIZE - 1) });
+            }
+        }
+        for (u32 y = 0; y + 1 < GRID_SIZE; y++) {
+            for (u32 x = 0; x + 1 < GRID_SIZE; x++) {
+                const u32 i = y * GRID_SIZE + x;
+                for (const u32 index : { i, i + GRID_SIZE, i + 1, i + 1, i + GRID_SIZE, i + GRID_SIZE + 1 }) {
+                    append(buffer, index);
+                }
+            }
+        }
+
+        const u32 positionsOffset = 0;
+        const u32 normalsOffset = vertexCount * 12;
+        const u32 uvsOffset = normalsOffset + vertexCount * 12;
+        const u32 indicesOffset = uvsOffset + vertexCount * 8;
+        const f32 maxHeight = 1.f;
+
+        const str json = fmt::format(R"({{
+  "asset": {{ "version": "2.0" }},
+  "buffers": [ {{ "byteLength": {0}, "uri": "data:application/octet-stream;base64,{1}" }} ],
+  "bufferViews": [
+    {{ "buffer": 0, "byteOffset": {2}, "byteLength": {3} }},
+    {{ "buffer": 0, "byteOffset": {4}, "byteLength": {3} }},
+    {{ "buffer": 0, "byteOffset": {5}, "byteLength": {6} }},
+    {{ "buffer": 0, "byteOffset": {7}, "byteLength": {8} }}
+  ],
+  "accessors": [
+    {{ "bufferView": 0, "componentType": 5126, "count": {9}, "type": "VEC3", "min": [0, {11}, 0], "max": [{10}, {12}, {10}] }},
+    {{ "bufferView": 1, "componentType": 5126, "count": {9}, "type": "VEC3" }},
+    {{ "bufferView": 2, "componentType": 5126, "count": {9}, "type": "VEC2" }},
+    {{ "bufferView": 3, "componentType": 5125, "count": {13}, "type": "SCALAR" }}
+  ],
+  "meshes": [ {{ "name": "grid", "primitives": [ {{ "attributes": {{ "POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2 }}, "indices": 3 }} ] }} ]
+}})",
+            buffer.size(), encodeBase64(buffer),
+            positionsOffset, vertexCount * 12, normalsOffset, uvsOffset, vertexCount * 8, indicesOffset, indexCount * 4,
+            vertexCount, GRID_SIZE - 1, -maxHeight, maxHeight, indexCount);
+
+        const str path = tempPath("meadows_bench_grid.gltf");
+        services::FileWriter writer;
+        writer.open(path);
+        writer.write(json);
+        writer.close();
+        return path;
+    }
+
+    sptr<fastgltf::Asset> parseGltf(const str& path) {
+        auto data = fastgltf::GltfDataBuffer::FromPath(path);
+        if (!data) return nullptr;
+
+        fastgltf::Parser parser {};
+        auto asset = parser.loadGltf(data.get(), std::filesystem::path(path).parent_path(), fastgltf::Options::None);
+        if (!asset) return nullptr;
+        return std::make_shared<fastgltf::Asset>(std::move(asset.get()));
+    }
+
+    // Uncompressed RGBA8 KTX1 with a full mip chain and a small key/value block
+    str writeKtx() {
+        KTX1Header header {};
+        const u8 identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+        std::memcpy(header.identifier, identifier, sizeof(identifier));
+        header.endianness = 0x04030201;
+        header.glType = 0x1401;             // GL_UNSIGNED_BYTE
+        header.glTypeSize = 1;
+        header.glFormat = 0x1908;           // GL_RGBA
+        header.glInternalFormat = 0x8058;   // GL_RGBA8
+        header.glBaseInternalFormat = 0x1908;
+        header.pixelWidth = KTX_SIZE;
+        header.pixelHeight = KTX_SIZE;
+        header.numberOfFaces = 1;
+        header.numberOfMipmapLevels = 0;
+        for (u32 size = KTX_SIZE; size > 0; size /= 2) {
+            header.numberOfMipmapLevels++;
+        }
+        header.bytesOfKeyValueData = 16;
+
+        const str path = tempPath("meadows_bench_texture.ktx");
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        const vector<char> keyValues(header.bytesOfKeyValueData, 0);
+        file.write(keyValues.data(), static_cast<std::streamsize>(keyValues.size()));
+
+        for (u32 size = KTX_SIZE; size > 0; size /= 2) {
+            const u32 imageSize = size * size * 4;
+            const vector<char> pixels(imageSize, static_cast<char>(size & 0xFF));
+            file.write(reinterpret_cast<const char*>(&imageSize), sizeof(imageSize));
+            file.write(pixels.data(), imageSize);
+        }
+        return path;
+    }
+}
+
+void registerLoaderBenchmarks(Suite& suite) {
+    // fastgltf parse + base64 decode of the embedded buffer
+    suite.add("gltf/parse 64k vertices", [] {
+        const str path = writeGridGltf();
+        return Body { [path] {
+            const sptr<fastgltf::Asset> asset = parseGltf(path);
+            doNotOptimize(asset.get());
+            return u64 { GRID_SIZE * GRID_SIZE };
+        } };
+    });
+
+    // What loadGltf does on the CPU for each primitive before the upload
+    suite.add("gltf/vertex conversion 64k vertices", [] {
+        const sptr<fastgltf::Asset> asset = parseGltf(writeGridGltf());
+        if (!asset) {
+            fmt::print(stderr, "gltf benchmark: cannot parse the generated mesh\n");
+            return Body { [] { return u64 { 0 }; } };
+        }
+
+        struct Buffers {
+            vector<u32> indices;
+            vector<Vertex> vertices;
+            vector<SkinVertex> skinVertices;
+        };
+        auto buffers = std::make_shared<Buffers>();
+        return Body { [asset, buffers] {
+            // Cleared but not freed, like the vectors loadGltf reuses across meshes
+            buffers->indices.clear();
+            buffers->vertices.clear();
+            buffers->skinVertices.clear();
+            for (const fastgltf::Primitive& primitive : asset->meshes[0].primitives) {
+                GeoSurface surface;
+                appendPrimitiveGeometry(*asset, primitive, buffers->indices, buffers->vertices, buffers->skinVertices, surface);
+                doNotOptimize(surface.bounds);
+            }
+            return u64 { buffers->vertices.size() };
+        } };
+    });
+
+    // Header parsing and mip reads, items are texel bytes
+    suite.add("ktx/loadKTXFile 1024 RGBA8", [] {
+        const str path = writeKtx();
+        return Body { [path] {
+            const auto result = loadKTXFile(path);
+            doNotOptimize(result);
+            return u64 { result ? result->data.size() : 0 };
+        } };
+    });
+}
+
+} // namespace bench
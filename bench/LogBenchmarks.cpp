@@ -0,0 +1,34 @@
+#include "Bench.h"
+#include "BasicServices/Log.h"
+
+using services::Log;
+
+namespace bench {
+
+namespace {
+    constexpr u32 MESSAGE_COUNT = 100;
+}
+
+void registerLogBenchmarks(Suite& suite) {
+    // Below the runtime level: a level check, the message is not formatted. Compiled out entirely below MEADOWS_LOG_LEVEL
+    suite.add("log/filtered Debug x100", [] {
+        return Body { [] {
+            for (u32 i = 0; i < MESSAGE_COUNT; i++) {
+                Log::Debug("Benchmark message %u with a float %.3f", i, 1.5f * static_cast<f32>(i));
+            }
+            return u64 { MESSAGE_COUNT };
+        } };
+    });
+
+    // Caller side only: formatting into the ring. The writer thread prints them later, filter it out when not needed
+    suite.add("log/emitted Warn x100", [] {
+        return Body { [] {
+            for (u32 i = 0; i < MESSAGE_COUNT; i++) {
+                Log::Warn("Benchmark message %u with a float %.3f", i, 1.5f * static_cast<f32>(i));
+            }
+            return u64 { MESSAGE_COUNT };
+        } };
+    });
+}
+
+} // namespace bench
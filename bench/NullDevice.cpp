@@ -0,0 +1,68 @@
+#include "NullDevice.h"
+#include "Bench.h"
+
+namespace bench {
+
+namespace {
+    struct NullPool {
+        u32 maxSets { 0 };
+        u32 allocatedSets { 0 };
+    };
+
+    u64 nextSetHandle { 1 };
+
+    NullPool* toPool(VkDescriptorPool handle) {
+        return (NullPool*)(uintptr_t)handle;
+    }
+}
+
+vk::Device nullDevice() {
+    return fakeHandle<vk::Device>(0x1);
+}
+
+} // namespace bench
+
+using bench::NullPool;
+
+extern "C" {
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateDescriptorPool(VkDevice, const VkDescriptorPoolCreateInfo* pCreateInfo,
+                                                      const VkAllocationCallbacks*, VkDescriptorPool* pDescriptorPool) {
+    auto* pool = new NullPool { pCreateInfo->maxSets, 0 };
+    *pDescriptorPool = (VkDescriptorPool)(uintptr_t)pool;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyDescriptorPool(VkDevice, VkDescriptorPool descriptorPool, const VkAllocationCallbacks*) {
+    if (descriptorPool == VK_NULL_HANDLE) return;
+    delete bench::toPool(descriptorPool);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkResetDescriptorPool(VkDevice, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags) {
+    bench::toPool(descriptorPool)->allocatedSets = 0;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateDescriptorSets(VkDevice, const VkDescriptorSetAllocateInfo* pAllocateInfo,
+                                                        VkDescriptorSet* pDescriptorSets) {
+    NullPool* pool = bench::toPool(pAllocateInfo->descriptorPool);
+    if (pool->allocatedSets + pAllocateInfo->descriptorSetCount > pool->maxSets) {
+        return VK_ERROR_OUT_OF_POOL_MEMORY;
+    }
+
+    pool->allocatedSets += pAllocateInfo->descriptorSetCount;
+    for (u32 i = 0; i < pAllocateInfo->descriptorSetCount; i++) {
+        pDescriptorSets[i] = (VkDescriptorSet)(uintptr_t)bench::nextSetHandle++;
+    }
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkUpdateDescriptorSets(VkDevice, uint32_t descriptorWriteCount, const VkWriteDescriptorSet* pDescriptorWrites,
+                                                  uint32_t, const VkCopyDescriptorSet*) {
+    // Read what a driver would read, so the writer's data is not dead
+    for (u32 i = 0; i < descriptorWriteCount; i++) {
+        bench::doNotOptimize(pDescriptorWrites[i].dstBinding);
+    }
+}
+
+} // extern "C"
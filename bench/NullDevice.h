@@ -0,0 +1,26 @@
+#pragma once
+#include "Graphics/Types.h"
+#include <cstdint>
+
+/**
+ * Stand-in for the descriptor entry points of the Vulkan driver.
+ *
+ * meadows_bench defines vkCreateDescriptorPool, vkAllocateDescriptorSets,
+ * vkUpdateDescriptorSets... itself. The executable's definitions take precedence
+ * over the loader library, so DescriptorAllocatorGrowable and DescriptorWriter
+ * run unchanged without a GPU. Pools honour maxSets so the allocator still
+ * sees eErrorOutOfPoolMemory and grows; everything else is bookkeeping only.
+ */
+
+namespace bench {
+
+// Non-null device handle accepted by the stubs
+vk::Device nullDevice();
+
+// Builds a Vulkan-Hpp handle from an arbitrary non-zero value (handles are pointers or u64 depending on the platform)
+template<class Handle>
+Handle fakeHandle(u64 value) {
+    return Handle { (typename Handle::CType)(uintptr_t)value };
+}
+
+} // namespace bench
@@ -0,0 +1,125 @@
+#include "Bench.h"
+#include "NullDevice.h"
+#include "Graphics/Culling.h"
+#include "Graphics/Node.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+using namespace graphics;
+
+namespace bench {
+
+namespace {
+    constexpr u32 OBJECT_COUNT = 10000;
+    constexpr u32 MATERIAL_COUNT = 32;
+    constexpr u32 MESH_COUNT = 256;
+
+    // Objects scattered in a 200m cube around a camera at the origin, roughly a third of them in view
+    struct CullingScene {
+        vector<RenderObject> objects;
+        vector<MaterialInstance> materials;
+        Mat4 viewProj { 1.f };
+    };
+
+    sptr<CullingScene> makeCullingScene() {
+        auto scene = std::make_shared<CullingScene>();
+        std::mt19937 random { 42 };
+        std::uniform_real_distribution<f32> position { -100.f, 100.f };
+        std::uniform_real_distribution<f32> size { 0.2f, 4.f };
+        std::uniform_int_distribution<u32> material { 0, MATERIAL_COUNT - 1 };
+        std::uniform_int_distribution<u32> mesh { 1, MESH_COUNT };
+
+        scene->materials.resize(MATERIAL_COUNT);
+        scene->objects.resize(OBJECT_COUNT);
+        for (RenderObject& object : scene->objects) {
+            object = {};
+            object.material = &scene->materials[material(random)];
+            object.indexBuffer = fakeHandle<vk::Buffer>(mesh(random));
+            object.bounds.origin = Vec3 { 0.f };
+            object.bounds.extents = Vec3 { size(random), size(random), size(random) };
+            object.bounds.sphereRadius = glm::length(object.bounds.extents);
+            object.transform = glm::translate(Mat4 { 1.f }, Vec3 { position(random), position(random), position(random) });
+        }
+
+        const Mat4 view = glm::lookAt(Vec3 { 0.f }, Vec3 { 0.f, 0.f, -1.f }, Vec3 { 0.f, 1.f, 0.f });
+        // Same projection as Renderer::updateScene
+        Mat4 projection = glm::perspective(glm::radians(70.f), 16.f / 9.f, 0.1f, 10000.f);
+        projection[1][1] *= -1;
+        scene->viewProj = projection * view;
+        return scene;
+    }
+
+    // Root with fanout[0] children, each with fanout[1] children...
+    void addChildren(const sptr<Node>& parent, std::span<const u32> fanout, std::mt19937& random, u32& nodeCount) {
+        if (fanout.empty()) return;
+
+        std::uniform_real_distribution<f32> offset { -5.f, 5.f };
+        for (u32 i = 0; i < fanout[0]; i++) {
+            auto child = std::make_shared<Node>();
+            child->parent = parent;
+            child->localTransform = glm::rotate(glm::translate(Mat4 { 1.f }, Vec3 { offset(random), offset(random), offset(random) }),
+                                                offset(random), Vec3 { 0.f, 1.f, 0.f });
+            parent->children.push_back(child);
+            nodeCount++;
+            addChildren(child, fanout.subspan(1), random, nodeCount);
+        }
+    }
+}
+
+void registerRenderBenchmarks(Suite& suite) {
+    suite.add("culling/isVisible 10k", [] {
+        auto scene = makeCullingScene();
+        return Body { [scene] {
+            u32 visible = 0;
+            for (const RenderObject& object : scene->objects) {
+                visible += isVisible(object, scene->viewProj) ? 1 : 0;
+            }
+            doNotOptimize(visible);
+            return u64 { OBJECT_COUNT };
+        } };
+    });
+
+    suite.add("culling/cullVisible 10k", [] {
+        auto scene = makeCullingScene();
+        auto visible = std::make_shared<vector<u32>>();
+        visible->reserve(OBJECT_COUNT);
+        return Body { [scene, visible] {
+            visible->clear();
+            cullVisible(scene->objects, scene->viewProj, *visible);
+            doNotOptimize(visible->data());
+            return u64 { OBJECT_COUNT };
+        } };
+    });
+
+    suite.add("sort/sortByMaterial visible", [] {
+        auto scene = makeCullingScene();
+        auto culled = std::make_shared<vector<u32>>();
+        cullVisible(scene->objects, scene->viewProj, *culled);
+        auto draws = std::make_shared<vector<u32>>();
+        draws->reserve(culled->size());
+        // Each run sorts the draws in culling order, as drawGeometry does every frame
+        return Body { [scene, culled, draws] {
+            *draws = *culled;
+            sortByMaterial(scene->objects, *draws);
+            doNotOptimize(draws->data());
+            return u64 { culled->size() };
+        } };
+    });
+
+    suite.add("scene/refreshTransform 5k nodes", [] {
+        auto root = std::make_shared<Node>();
+        root->localTransform = Mat4 { 1.f };
+        std::mt19937 random { 7 };
+        u32 nodeCount = 1;
+        constexpr std::array<u32, 3> fanout { 64, 16, 4 };
+        addChildren(root, fanout, random, nodeCount);
+
+        return Body { [root, nodeCount] {
+            root->refreshTransform(Mat4 { 1.f });
+            doNotOptimize(root->children.back()->worldTransform);
+            return u64 { nodeCount };
+        } };
+    });
+}
+
+} // namespace bench
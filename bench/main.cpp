@@ -0,0 +1,18 @@
+#include "Bench.h"
+#include "BasicServices/Log.h"
+
+// meadows_bench [--filter text] [--samples N] [--min-time ms] [--json report.json] [--list]
+int main(int argc, char* argv[]) {
+    // Release log level: Debug messages of the measured code (e.g. the KTX loader) are filtered out
+    services::Log::setLevel(services::LogLevel::Warn);
+
+    bench::Suite suite;
+    bench::registerRenderBenchmarks(suite);
+    bench::registerDescriptorBenchmarks(suite);
+    bench::registerLoaderBenchmarks(suite);
+    bench::registerLogBenchmarks(suite);
+
+    const int result = suite.run(bench::Options::fromArguments(argc, argv));
+    services::Log::flush();
+    return result;
+}
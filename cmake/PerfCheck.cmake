@@ -0,0 +1,145 @@
+# Performance regression gate for one scene, run by the perf-check CTest tests.
+#
+#   cmake -DMEADOWS=<Meadows executable> -DSCENE=basic|shadow|deferred -DBASELINE=<perf/baseline.json>
+#         -DREPORT=<report.json> [-DICD=<Vulkan ICD json>] [-DUPDATE=ON] -P PerfCheck.cmake
+#
+# Runs the headless benchmark (meadows --bench) and compares its report to the scene's
+# entry in the baseline. The checked metrics are the keys of "tolerances_percent": a
+# metric regresses when it is more than its tolerance above the baseline; lower values
+# always pass. With UPDATE=ON the results are written as the scene's new baseline.
+#
+# Timings (metrics ending in _ms) are only compared when the baseline was recorded on
+# the same device: they are skipped otherwise. Counters and memory do not depend on the
+# device's speed and are always compared. A scene without baseline is skipped (the test
+# prints PERF-SKIP, which CTest reports as skipped rather than passed) until one is
+# recorded with the perf-baseline target.
+
+cmake_minimum_required(VERSION 3.20)
+
+foreach(variable MEADOWS SCENE BASELINE REPORT)
+    if(NOT DEFINED ${variable})
+        message(FATAL_ERROR "PerfCheck: ${variable} is not set")
+    endif()
+endforeach()
+
+# Short deterministic orbit, small enough for a software rasterizer
+set(PERF_WIDTH 640)
+set(PERF_HEIGHT 360)
+set(PERF_WARMUP 30)
+set(PERF_FRAMES 300)
+
+# Reads "a.b" from a JSON document, empty when missing
+function(perf_get json metric out)
+    string(REPLACE "." ";" path "${metric}")
+    string(JSON value ERROR_VARIABLE error GET "${json}" ${path})
+    if(error)
+        set(value "")
+    endif()
+    set(${out} "${value}" PARENT_SCOPE)
+endfunction()
+
+# "12.3456" -> 12345: math(EXPR) only knows integers, compare in thousandths
+function(perf_to_milli value out)
+    if(value MATCHES "^([0-9]+)(\\.([0-9]*))?$")
+        string(SUBSTRING "${CMAKE_MATCH_3}000" 0 3 fraction)
+        # The leading 1 keeps a fraction like "012" from being read as octal
+        math(EXPR milli "${CMAKE_MATCH_1} * 1000 + 1${fraction} - 1000")
+    elseif(value MATCHES "^[0-9.]+e-")
+        set(milli 0)
+    else()
+        message(FATAL_ERROR "PerfCheck: cannot compare value '${value}'")
+    endif()
+    set(${out} ${milli} PARENT_SCOPE)
+endfunction()
+
+if(ICD)
+    set(ENV{VK_DRIVER_FILES} "${ICD}")
+    set(ENV{VK_ICD_FILENAMES} "${ICD}")
+endif()
+
+get_filename_component(reportDirectory "${REPORT}" DIRECTORY)
+file(MAKE_DIRECTORY "${reportDirectory}")
+file(REMOVE "${REPORT}")
+
+# Assets and shaders are found next to the executable
+get_filename_component(workingDirectory "${MEADOWS}" DIRECTORY)
+execute_process(
+    COMMAND "${MEADOWS}" --bench --scene ${SCENE} --width ${PERF_WIDTH} --height ${PERF_HEIGHT}
+            --warmup ${PERF_WARMUP} --frames ${PERF_FRAMES} --output "${REPORT}"
+    WORKING_DIRECTORY "${workingDirectory}"
+    RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0 OR NOT EXISTS "${REPORT}")
+    message(FATAL_ERROR "PerfCheck: benchmark of scene '${SCENE}' failed (${result})")
+endif()
+
+file(READ "${REPORT}" report)
+file(READ "${BASELINE}" baseline)
+string(JSON device GET "${report}" device)
+string(JSON metricCount LENGTH "${baseline}" tolerances_percent)
+math(EXPR lastMetric "${metricCount} - 1")
+
+if(UPDATE)
+    set(entry "{}")
+    string(JSON entry SET "${entry}" device "\"${device}\"")
+    foreach(i RANGE ${lastMetric})
+        string(JSON metric MEMBER "${baseline}" tolerances_percent ${i})
+        perf_get("${report}" "${metric}" current)
+        if(current STREQUAL "")
+            message(FATAL_ERROR "PerfCheck: '${metric}' is missing from the report")
+        endif()
+        string(JSON entry SET "${entry}" "${metric}" "${current}")
+    endforeach()
+
+    string(JSON baseline SET "${baseline}" scenes ${SCENE} "${entry}")
+    file(WRITE "${BASELINE}" "${baseline}\n")
+    message(STATUS "PerfCheck: baseline of '${SCENE}' updated (${device})")
+    return()
+endif()
+
+string(JSON baselineDevice ERROR_VARIABLE missingScene GET "${baseline}" scenes ${SCENE} device)
+if(missingScene)
+    message(STATUS "PERF-SKIP: no baseline for scene '${SCENE}', record one with the perf-baseline target")
+    return()
+endif()
+set(otherDevice OFF)
+if(NOT baselineDevice STREQUAL device)
+    set(otherDevice ON)
+    message(STATUS "PerfCheck: baseline of '${SCENE}' was recorded on '${baselineDevice}', this run is on '${device}': timings are not compared")
+endif()
+
+set(regressions "")
+foreach(i RANGE ${lastMetric})
+    string(JSON metric MEMBER "${baseline}" tolerances_percent ${i})
+    if(otherDevice AND metric MATCHES "_ms$")
+        message(STATUS "  ${metric}: skipped, other device")
+        continue()
+    endif()
+    string(JSON tolerance GET "${baseline}" tolerances_percent "${metric}")
+    perf_get("${report}" "${metric}" current)
+    string(JSON expected ERROR_VARIABLE missingMetric GET "${baseline}" scenes ${SCENE} "${metric}")
+    if(current STREQUAL "" OR missingMetric)
+        list(APPEND regressions "${metric}: missing from the report or the baseline")
+        continue()
+    endif()
+
+    perf_to_milli("${current}" currentMilli)
+    perf_to_milli("${expected}" expectedMilli)
+    math(EXPR limitMilli "${expectedMilli} * (100 + ${tolerance}) / 100")
+
+    if(currentMilli GREATER limitMilli)
+        set(status "REGRESSION")
+        list(APPEND regressions "${metric}: ${current} > ${expected} +${tolerance}%")
+    elseif(currentMilli LESS expectedMilli)
+        set(status "better")
+    else()
+        set(status "ok")
+    endif()
+    message(STATUS "  ${metric}: ${current} (baseline ${expected}, +${tolerance}% allowed) ${status}")
+endforeach()
+
+if(regressions)
+    list(JOIN regressions "\n  " details)
+    message(FATAL_ERROR "PerfCheck: scene '${SCENE}' regressed:\n  ${details}")
+endif()
+message(STATUS "PerfCheck: scene '${SCENE}' within tolerances")
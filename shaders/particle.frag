@@ -0,0 +1,16 @@
+#version 450
+
+layout (location = 0) in vec4 inColor;
+layout (location = 1) in vec2 inUV;
+
+layout (location = 0) out vec4 outFragColor;
+
+void main()
+{
+    // Soft round sprite
+    float falloff = 1.0 - smoothstep(0.0, 1.0, length(inUV));
+    if (falloff <= 0.0) {
+        discard;
+    }
+    outFragColor = vec4(inColor.rgb, inColor.a * falloff);
+}
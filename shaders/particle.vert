@@ -0,0 +1,38 @@
+#version 450
+
+#extension GL_GOOGLE_include_directive : require
+
+#include "particles.glsl"
+
+layout (location = 0) out vec4 outColor;
+layout (location = 1) out vec2 outUV;
+
+// Two triangles per billboard, expanded from gl_VertexIndex (no vertex buffer)
+const vec2 corners[6] = vec2[6](
+    vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+    vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0)
+);
+
+void main()
+{
+    EmitterParams params = PushConstants.params;
+    uint slot = params.drawList.indices[gl_InstanceIndex];
+    Particle particle = params.particles.particles[slot];
+
+    vec2 corner = corners[gl_VertexIndex];
+    vec3 position = particle.positionLife.xyz
+                  + (params.cameraRight.xyz * corner.x + params.cameraUp.xyz * corner.y) * params.positionSize.w;
+    gl_Position = params.viewProj * vec4(position, 1.0);
+
+    // Age goes 0 -> 1 over the particle lifetime
+    float age = 1.0 - particle.positionLife.w / max(particle.velocityMaxLife.w, 0.0001);
+    vec4 color = mix(params.colorStart, params.colorEnd, age);
+    color.a *= smoothstep(0.0, 0.1, age);
+
+    // Fireflies: each particle blinks with its own phase
+    float blink = 0.5 + 0.5 * sin(particle.positionLife.w * 6.0 + float(slot) * 1.7);
+    color.a *= mix(1.0, blink * blink, params.flicker);
+
+    outColor = color;
+    outUV = corner;
+}
@@ -0,0 +1,81 @@
+// Shared declarations of the GPU particle system (see ParticleSystem.h)
+
+#extension GL_EXT_buffer_reference : require
+
+struct Particle {
+    vec4 positionLife;      // xyz = position, w = remaining life
+    vec4 velocityMaxLife;   // xyz = velocity, w = total life
+};
+
+layout(buffer_reference, std430) buffer ParticleBuffer {
+    Particle particles[];
+};
+
+layout(buffer_reference, std430) buffer IndexBuffer {
+    uint indices[];
+};
+
+// Counters + VkDrawIndirectCommand. Must match GPUParticleState in ParticleSystem.cpp
+layout(buffer_reference, std430) buffer StateBuffer {
+    uint vertexCount;
+    uint instanceCount;     // Number of visible particles, written by the simulation
+    uint firstVertex;
+    uint firstInstance;
+    int deadCount;          // Signed: emission may briefly push it below zero
+    uint aliveCount[2];
+    uint padding;
+};
+
+// Must match GPUParticleEmitterParams in ParticleSystem.h
+layout(buffer_reference, std430) readonly buffer EmitterParams {
+    mat4 viewProj;
+    vec4 cameraRight;
+    vec4 cameraUp;
+    vec4 positionSize;      // xyz = spawn center, w = size
+    vec4 extentsJitter;     // xyz = spawn half extents, w = velocity jitter
+    vec4 velocityLifeMin;   // xyz = velocity, w = min life
+    vec4 gravityLifeMax;    // xyz = gravity, w = max life
+    vec4 colorStart;
+    vec4 colorEnd;
+    uint emitCount;
+    uint maxParticles;
+    uint randomSeed;
+    float deltaTime;
+    float turbulence;
+    float flicker;
+    uint padding0;
+    uint padding1;
+    ParticleBuffer particles;
+    IndexBuffer deadList;
+    IndexBuffer aliveList0;
+    IndexBuffer aliveList1;
+    IndexBuffer drawList;
+    StateBuffer state;
+};
+
+layout(push_constant) uniform constants {
+    EmitterParams params;
+    uint aliveIndex;        // Alive list holding last frame's survivors (the simulation input)
+    uint padding;
+} PushConstants;
+
+IndexBuffer aliveList(EmitterParams params, uint index) {
+    return index == 0 ? params.aliveList0 : params.aliveList1;
+}
+
+// PCG hash, good enough for spawn randomness and cheap on the GPU
+uint pcgHash(uint value) {
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+// Returns a float in [0, 1) and advances the seed
+float random01(inout uint seed) {
+    seed = pcgHash(seed);
+    return float(seed) / 4294967296.0;
+}
+
+vec3 randomSigned3(inout uint seed) {
+    return vec3(random01(seed), random01(seed), random01(seed)) * 2.0 - 1.0;
+}
@@ -5,27 +5,25 @@
 
 #include "inputStructures.glsl"
 
-struct Vertex {
-    vec3 position;
-    float uvX;
-    vec3 normal;
-    float uvY;
-    vec4 color;
-};
-
-layout(buffer_reference, std430) readonly buffer VertexBuffer {
-    Vertex vertices[];
+// Positions only: either the mesh's packed position stream (stride 3)
+// or its full Vertex buffer, where position is the first member (stride 12)
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer PositionBuffer {
+    float positions[];
 };
 
 layout(push_constant) uniform constants {
     mat4 renderMatrix;
-    VertexBuffer vertexBuffer;
+    PositionBuffer positionBuffer;
+    uint positionStride;
 } PushConstants;
 
 void main()
 {
-    Vertex v = PushConstants.vertexBuffer.vertices[gl_VertexIndex];
+    uint base = uint(gl_VertexIndex) * PushConstants.positionStride;
+    vec3 position = vec3(PushConstants.positionBuffer.positions[base],
+                         PushConstants.positionBuffer.positions[base + 1],
+                         PushConstants.positionBuffer.positions[base + 2]);
 
     // Transform vertex to light space
-    gl_Position = sceneData.lightSpaceMatrix * PushConstants.renderMatrix * vec4(v.position, 1.0);
+    gl_Position = sceneData.lightSpaceMatrix * PushConstants.renderMatrix * vec4(position, 1.0);
 }
@@ -0,0 +1,71 @@
+// Shadow map filtering through a comparison sampler (sampler2DShadow).
+// Each texture() call compares and bilinearly filters 2x2 texels in hardware,
+// so a kernel needs far fewer fetches than manual point-sampled PCF.
+// Include in any lighting shader that reads the shadow map.
+
+// Kernel selection, must match ShadowFilter in ShadowMap.h
+#define SHADOW_FILTER_HARDWARE  0   // 1 tap
+#define SHADOW_FILTER_OPTIMIZED 1   // 4 taps, 4x4 texel footprint
+#define SHADOW_FILTER_POISSON   2   // 8 taps, rotated Poisson disk
+
+layout (constant_id = 0) const uint SHADOW_FILTER = SHADOW_FILTER_OPTIMIZED;
+
+const vec2 poissonDisk[8] = vec2[8](
+    vec2(-0.7071,  0.7071), vec2(-0.0000, -0.8750),
+    vec2( 0.5303,  0.5303), vec2(-0.6250, -0.0000),
+    vec2( 0.3536, -0.3536), vec2(-0.0000,  0.3750),
+    vec2(-0.1768, -0.1768), vec2( 0.9500,  0.0000)
+);
+
+float shadowTap(sampler2DShadow shadowMap, vec3 coord, vec2 offset)
+{
+    return texture(shadowMap, vec3(coord.xy + offset, coord.z));
+}
+
+// Taps are 2 texels apart, so their 2x2 bilinear footprints tile a 4x4 block
+float shadowOptimized(sampler2DShadow shadowMap, vec3 coord, vec2 texel)
+{
+    float sum = shadowTap(shadowMap, coord, vec2(-1.0, -1.0) * texel)
+              + shadowTap(shadowMap, coord, vec2( 1.0, -1.0) * texel)
+              + shadowTap(shadowMap, coord, vec2(-1.0,  1.0) * texel)
+              + shadowTap(shadowMap, coord, vec2( 1.0,  1.0) * texel);
+    return sum * 0.25;
+}
+
+// Disk rotated per pixel (interleaved gradient noise) to trade banding for fine noise
+float shadowPoisson(sampler2DShadow shadowMap, vec3 coord, vec2 texel)
+{
+    float noise = fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+    float angle = noise * 6.2831853;
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+    vec2 radius = texel * 2.5;
+
+    float sum = 0.0;
+    for (int i = 0; i < 8; i++) {
+        sum += shadowTap(shadowMap, coord, rotation * poissonDisk[i] * radius);
+    }
+    return sum * 0.125;
+}
+
+/**
+ * Returns light visibility in [0, 1] for a projected shadow coordinate
+ * (xy in [0, 1] texture space, z = receiver depth). Coordinates outside
+ * the light depth range are treated as lit.
+ */
+float sampleShadow(sampler2DShadow shadowMap, vec4 shadowCoord, bool filtered)
+{
+    if (shadowCoord.w <= 0.0 || shadowCoord.z <= -1.0 || shadowCoord.z >= 1.0) {
+        return 1.0;
+    }
+
+    vec3 coord = shadowCoord.xyz;
+    if (!filtered || SHADOW_FILTER == SHADOW_FILTER_HARDWARE) {
+        return shadowTap(shadowMap, coord, vec2(0.0));
+    }
+
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0));
+    if (SHADOW_FILTER == SHADOW_FILTER_POISSON) {
+        return shadowPoisson(shadowMap, coord, texel);
+    }
+    return shadowOptimized(shadowMap, coord, texel);
+}
@@ -28,6 +28,12 @@ void FileWriter::writeLine(const str& text) {
     }
 }
 
+void FileWriter::flush() {
+    if (stream.is_open()) {
+        stream.flush();
+    }
+}
+
 bool FileWriter::isOpen() const {
     return stream.is_open();
 }
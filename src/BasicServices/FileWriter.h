@@ -20,6 +20,7 @@ public:
     bool open(const str& filepath);
     void write(const str& text);
     void writeLine(const str& text);
+    void flush();
     bool isOpen() const;
     void close();
     
@@ -0,0 +1,174 @@
+#include "FrameHistory.h"
+#include "Log.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <imgui.h>
+
+namespace services {
+
+namespace {
+    // Needs a sorted, non-empty range
+    f32 percentile(const vector<f32>& sorted, f32 fraction) {
+        const size_t index = static_cast<size_t>(fraction * static_cast<f32>(sorted.size() - 1) + 0.5f);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    str describe(const FrameHistory::Event& event) {
+        str text = toString(event.type);
+        if (event.ms > 0.f) {
+            char duration[32];
+            std::snprintf(duration, sizeof(duration), " %.2f ms", event.ms);
+            text += duration;
+        }
+        if (!event.detail.empty()) {
+            text += " (" + event.detail + ")";
+        }
+        return text;
+    }
+}
+
+const char* toString(FrameEvent event) {
+    switch (event) {
+        case FrameEvent::AssetUpload:           return "Asset upload";
+        case FrameEvent::PipelineCompile:       return "Pipeline compile";
+        case FrameEvent::DescriptorPoolGrowth:  return "Descriptor pool growth";
+        case FrameEvent::SwapchainRecreation:   return "Swapchain recreation";
+        case FrameEvent::Count:                 break;
+    }
+    return "Unknown";
+}
+
+FrameHistory::FrameHistory() {
+    sorted.reserve(HISTORY_SIZE);
+    pendingEvents.reserve(MAX_EVENTS_PER_FRAME);
+}
+
+void FrameHistory::recordEvent(FrameEvent type, f32 ms, str detail) {
+    std::lock_guard lock(eventMutex);
+    if (pendingEvents.size() >= MAX_EVENTS_PER_FRAME) {
+        droppedEvents++;
+        return;
+    }
+    pendingEvents.push_back({ type, ms, std::move(detail) });
+}
+
+f32 FrameHistory::getHitchThreshold() const {
+    return std::max(minimumHitchMs, hitchFactor * stats.p50Ms);
+}
+
+void FrameHistory::endFrame(f32 frameMs) {
+    // Judge the frame against the history before it, so a hitch does not raise its own bar
+    const bool canDetect = stats.sampleCount > 0;
+    const f32 thresholdMs = getHitchThreshold();
+
+    history[cursor] = frameMs;
+    cursor = (cursor + 1) % HISTORY_SIZE;
+    count = std::min(count + 1, HISTORY_SIZE);
+    frameIndex++;
+
+    vector<Event> events;
+    u32 dropped = 0;
+    {
+        std::lock_guard lock(eventMutex);
+        if (!pendingEvents.empty() || droppedEvents > 0) {
+            events.swap(pendingEvents);
+            pendingEvents.reserve(MAX_EVENTS_PER_FRAME);
+            dropped = droppedEvents;
+            droppedEvents = 0;
+        }
+    }
+
+    if (canDetect && frameMs > thresholdMs) {
+        reportHitch(frameMs, thresholdMs, std::move(events), dropped);
+    }
+
+    if (++framesSinceStats >= STATS_INTERVAL) {
+        updateStats();
+    }
+}
+
+void FrameHistory::updateStats() {
+    framesSinceStats = 0;
+    sorted.assign(history.begin(), history.begin() + count);
+    std::sort(sorted.begin(), sorted.end());
+
+    stats.sampleCount = count;
+    stats.p50Ms = percentile(sorted, 0.50f);
+    stats.p95Ms = percentile(sorted, 0.95f);
+    stats.p99Ms = percentile(sorted, 0.99f);
+    stats.maxMs = sorted.back();
+}
+
+void FrameHistory::reportHitch(f32 frameMs, f32 thresholdMs, vector<Event>&& events, u32 dropped) {
+    hitchCount++;
+    Log::Warn("Hitch: frame %llu took %.2f ms (threshold %.2f ms, p50 %.2f ms), %u events",
+        static_cast<unsigned long long>(frameIndex), frameMs, thresholdMs, stats.p50Ms,
+        static_cast<u32>(events.size()) + dropped);
+    for (const Event& event : events) {
+        Log::Warn("  %s", describe(event).c_str());
+    }
+    if (dropped > 0) {
+        Log::Warn("  ... and %u more", dropped);
+    }
+
+    if (hitches.size() >= MAX_HITCH_REPORTS) {
+        hitches.erase(hitches.begin());
+    }
+    hitches.push_back({ frameIndex, frameMs, thresholdMs, std::move(events), dropped });
+}
+
+void FrameHistory::drawImGui() {
+    if (ImGui::Begin("Frame Times")) {
+        const f32 last = count > 0 ? history[(cursor + HISTORY_SIZE - 1) % HISTORY_SIZE] : 0.f;
+        ImGui::Text("Last %.2f ms   p50 %.2f   p95 %.2f   p99 %.2f   max %.2f (last %u frames)",
+            last, stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs, stats.sampleCount);
+
+        // The ring is drawn oldest first: PlotLines wraps around from the offset
+        const f32 scaleMax = std::max(stats.maxMs, getHitchThreshold()) * 1.1f;
+        char overlay[48];
+        std::snprintf(overlay, sizeof(overlay), "hitch > %.1f ms", getHitchThreshold());
+        ImGui::PlotLines("##FrameTimes", history.data(), static_cast<int>(count),
+            count < HISTORY_SIZE ? 0 : static_cast<int>(cursor), overlay, 0.f, scaleMax, ImVec2(0.f, 80.f));
+
+        ImGui::SliderFloat("Hitch factor (x p50)", &hitchFactor, 1.2f, 5.f, "%.1f");
+        ImGui::SliderFloat("Minimum hitch (ms)", &minimumHitchMs, 1.f, 100.f, "%.1f");
+
+        ImGui::SeparatorText("Hitches");
+        ImGui::Text("%llu hitches", static_cast<unsigned long long>(hitchCount));
+        ImGui::SameLine();
+        if (ImGui::Button("Clear")) {
+            hitches.clear();
+            hitchCount = 0;
+        }
+        for (size_t i = hitches.size(); i-- > 0;) {
+            const HitchReport& hitch = hitches[i];
+            ImGui::PushID(static_cast<int>(i));
+            if (ImGui::TreeNode("hitch", "Frame %llu: %.2f ms (> %.2f), %zu events",
+                    static_cast<unsigned long long>(hitch.frame), hitch.frameMs, hitch.thresholdMs,
+                    hitch.events.size() + hitch.droppedEvents)) {
+                if (hitch.events.empty()) {
+                    ImGui::TextDisabled("Nothing recorded: CPU or GPU work of the frame itself");
+                }
+                for (const Event& event : hitch.events) {
+                    ImGui::BulletText("%s", describe(event).c_str());
+                }
+                if (hitch.droppedEvents > 0) {
+                    ImGui::BulletText("... and %u more", hitch.droppedEvents);
+                }
+                ImGui::TreePop();
+            }
+            ImGui::PopID();
+        }
+    }
+    ImGui::End();
+}
+
+ScopedFrameEvent::ScopedFrameEvent(FrameEvent type, str detail)
+    : type(type), detail(std::move(detail)), start(Profiler::now()) {}
+
+ScopedFrameEvent::~ScopedFrameEvent() {
+    FrameHistory::Instance().recordEvent(type, Profiler::toMilliseconds(Profiler::now() - start), std::move(detail));
+}
+
+} // namespace services
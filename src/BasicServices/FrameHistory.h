@@ -0,0 +1,130 @@
+#pragma once
+
+#include "../Defines.h"
+#include <array>
+#include <mutex>
+
+/**
+ * Rolling frame-time history with percentiles and hitch detection.
+ *
+ * The main loop reports each frame time with endFrame(). Code paths known to stall
+ * a frame (blocking uploads, pipeline compiles, descriptor pool growth, swapchain
+ * recreation) report what they did with recordEvent() or a ScopedFrameEvent, from
+ * any thread. When a frame goes over the hitch threshold, the events of that frame
+ * are logged as a warning and kept for the "Frame Times" window:
+ *
+ *     void PipelineBuilder::buildPipeline(...) {
+ *         services::ScopedFrameEvent event(services::FrameEvent::PipelineCompile);
+ *         ...
+ *     }
+ *
+ * Events of frames that do not hitch are discarded.
+ */
+
+namespace services {
+
+enum class FrameEvent : u8 {
+    AssetUpload,
+    PipelineCompile,
+    DescriptorPoolGrowth,
+    SwapchainRecreation,
+    Count
+};
+
+const char* toString(FrameEvent event);
+
+class FrameHistory {
+public:
+    static constexpr u32 HISTORY_SIZE = 512;            // Frames kept for the graph and percentiles
+    static constexpr u32 STATS_INTERVAL = 30;           // Percentiles are refreshed every N frames
+    static constexpr u32 MAX_EVENTS_PER_FRAME = 64;     // Further events are only counted
+    static constexpr u32 MAX_HITCH_REPORTS = 32;
+
+    struct Stats {
+        u32 sampleCount { 0 };
+        f32 p50Ms { 0.f };
+        f32 p95Ms { 0.f };
+        f32 p99Ms { 0.f };
+        f32 maxMs { 0.f };
+    };
+
+    struct Event {
+        FrameEvent type;
+        f32 ms;                     // Time spent, 0 when not measured
+        str detail;
+    };
+
+    struct HitchReport {
+        u64 frame { 0 };
+        f32 frameMs { 0.f };
+        f32 thresholdMs { 0.f };
+        vector<Event> events;
+        u32 droppedEvents { 0 };
+    };
+
+    static FrameHistory& Instance() {
+        static FrameHistory instance;
+        return instance;
+    }
+
+    // Thread safe, attributed to the frame in progress
+    void recordEvent(FrameEvent type, f32 ms = 0.f, str detail = {});
+
+    // Closes the frame: stores its time, and reports it when it is a hitch (main thread)
+    void endFrame(f32 frameMs);
+
+    const Stats& getStats() const { return stats; }
+    f32 getHitchThreshold() const;
+    u64 getHitchCount() const { return hitchCount; }
+
+    void drawImGui();
+
+    // A frame is a hitch above max(minimumHitchMs, hitchFactor * p50)
+    f32 hitchFactor { 2.f };
+    f32 minimumHitchMs { 8.f };
+
+private:
+    FrameHistory();
+    ~FrameHistory() = default;
+
+    FrameHistory(const FrameHistory&) = delete;
+    FrameHistory& operator=(const FrameHistory&) = delete;
+
+    void updateStats();
+    void reportHitch(f32 frameMs, f32 thresholdMs, vector<Event>&& events, u32 dropped);
+
+    // Ring of frame times, in milliseconds
+    std::array<f32, HISTORY_SIZE> history {};
+    u32 cursor { 0 };
+    u32 count { 0 };
+    u64 frameIndex { 0 };
+
+    Stats stats;
+    vector<f32> sorted;             // Scratch for the percentiles
+    u32 framesSinceStats { 0 };
+
+    // Events of the frame in progress
+    std::mutex eventMutex;
+    vector<Event> pendingEvents;
+    u32 droppedEvents { 0 };
+
+    vector<HitchReport> hitches;    // Most recent last
+    u64 hitchCount { 0 };
+};
+
+// Records the time spent in a scope as a frame event
+class ScopedFrameEvent {
+public:
+    explicit ScopedFrameEvent(FrameEvent type, str detail = {});
+    ~ScopedFrameEvent();
+
+    ScopedFrameEvent(const ScopedFrameEvent&) = delete;
+    ScopedFrameEvent& operator=(const ScopedFrameEvent&) = delete;
+
+private:
+    FrameEvent type;
+    str detail;
+    u64 start;
+};
+
+} // namespace services
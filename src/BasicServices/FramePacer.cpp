@@ -0,0 +1,54 @@
+#include "FramePacer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace services {
+
+void FramePacer::wait() {
+    const f32 fps = targetFps.load(std::memory_order_relaxed);
+    if (fps <= 0.f) {
+        nextDeadline = 0;
+        return;
+    }
+
+    const u64 period = static_cast<u64>(1'000'000'000.0 / static_cast<f64>(fps));
+    u64 now = Profiler::now();
+    // First capped frame, or more than a period late: start a new cadence from now
+    if (nextDeadline == 0 || now > nextDeadline + period) {
+        nextDeadline = now;
+    }
+
+    if (nextDeadline > now + SPIN_MARGIN_NS) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(nextDeadline - now - SPIN_MARGIN_NS));
+    }
+    while (now < nextDeadline) {
+        std::this_thread::yield();
+        now = Profiler::now();
+    }
+
+    nextDeadline += period;
+}
+
+void FramePacer::recordLatency(f32 milliseconds) {
+    lastLatency = milliseconds;
+    latencies[latencyCursor] = milliseconds;
+    latencyCursor = (latencyCursor + 1) % LATENCY_HISTORY_SIZE;
+    latencyCount = std::min(latencyCount + 1, LATENCY_HISTORY_SIZE);
+}
+
+f32 FramePacer::getAverageLatency() const {
+    if (latencyCount == 0) return 0.f;
+    f32 sum = 0.f;
+    for (u32 i = 0; i < latencyCount; i++) {
+        sum += latencies[i];
+    }
+    return sum / static_cast<f32>(latencyCount);
+}
+
+f32 FramePacer::getMaxLatency() const {
+    return latencyCount == 0 ? 0.f : *std::max_element(latencies.begin(), latencies.begin() + latencyCount);
+}
+
+} // namespace services
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../Defines.h"
+#include <array>
+#include <atomic>
+
+/**
+ * CPU frame limiter and input latency tracking.
+ *
+ * The limiter runs where input is sampled (the simulation thread), so a capped
+ * frame rate delays input sampling rather than queuing up finished frames. It
+ * sleeps until shortly before the deadline, the OS scheduler being too coarse
+ * for the last stretch, then spins on the clock. Deadlines advance by whole
+ * periods to keep a steady cadence; a late frame restarts the cadence instead
+ * of rushing the following ones.
+ *
+ * Latency is measured from the input sample of a frame to the return of its
+ * present call. Scan-out comes later, by up to the swapchain's queued images.
+ */
+
+namespace services {
+
+class FramePacer {
+public:
+    static constexpr u64 SPIN_MARGIN_NS = 1'000'000;   // Spun instead of slept before a deadline
+    static constexpr u32 LATENCY_HISTORY_SIZE = 120;
+
+    static FramePacer& Instance() {
+        static FramePacer instance;
+        return instance;
+    }
+
+    // 0 for uncapped. Any thread
+    void setTargetFps(f32 fps) { targetFps.store(fps, std::memory_order_relaxed); }
+    f32 getTargetFps() const { return targetFps.load(std::memory_order_relaxed); }
+
+    // Blocks until the next frame is due. Called once per frame by the thread sampling input
+    void wait();
+
+    // Input sample to present, in milliseconds (render thread)
+    void recordLatency(f32 milliseconds);
+    f32 getLastLatency() const { return lastLatency; }
+    f32 getAverageLatency() const;
+    f32 getMaxLatency() const;
+
+private:
+    FramePacer() = default;
+    ~FramePacer() = default;
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    std::atomic<f32> targetFps { 0.f };
+    u64 nextDeadline { 0 };
+
+    std::array<f32, LATENCY_HISTORY_SIZE> latencies {};
+    u32 latencyCursor { 0 };
+    u32 latencyCount { 0 };
+    f32 lastLatency { 0.f };
+};
+
+} // namespace services
@@ -1,163 +1,327 @@
 #include "Log.h"
 #include "Platform.h"
 #include "FileWriter.h"
+#include "MpscRing.h"
+#include <atomic>
 #include <cstdarg>
+#include <cstdio>
 #include <chrono>
 #include <ctime>
-#include <sstream>
-#include <iomanip>
+#include <memory>
+#include <thread>
 #include <SDL3/SDL_log.h>
 
 using services::FileWriter;
 using services::Platform;
 using services::ConsoleColor;
+using services::LogLevel;
+using services::MpscRing;
 
-// Global log file
-static FileWriter logFile;
-
-// Custom SDL log output function with colored output
-static void CustomLogOutput(void* userdata, int category, SDL_LogPriority priority, const char* message) {
-    // Get current time
-    auto now = std::chrono::system_clock::now();
-    auto now_time_t = std::chrono::system_clock::to_time_t(now);
-    auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
-    
-    std::tm now_tm;
-#ifdef _WIN32
-    localtime_s(&now_tm, &now_time_t);
+namespace {
+
+constexpr u32 RING_CAPACITY = 4096;
+constexpr auto IDLE_SLEEP = std::chrono::milliseconds(2);
+
+struct LogRecord {
+    i64 timestampMs { 0 };      // Milliseconds since epoch, taken by the caller
+    LogLevel level { LogLevel::Info };
+    char text[services::Log::MAX_MESSAGE_LENGTH + 1] {};
+};
+
+#if defined(NDEBUG)
+constexpr LogLevel DEFAULT_LEVEL = LogLevel::Warn;
 #else
-    localtime_r(&now_time_t, &now_tm);
+constexpr LogLevel DEFAULT_LEVEL = LogLevel::Debug;
 #endif
-    
-    // Map SDL priority to console color and severity string
-    ConsoleColor color = ConsoleColor::Reset;
-    const char* severityStr = "INFO";
-    switch(priority) {
-        case SDL_LOG_PRIORITY_VERBOSE:  
-            color = ConsoleColor::Gray; 
-            severityStr = "TRACE";
-            break;
-        case SDL_LOG_PRIORITY_DEBUG:    
-            color = ConsoleColor::Cyan; 
-            severityStr = "DEBUG";
-            break;
-        case SDL_LOG_PRIORITY_INFO:     
-            color = ConsoleColor::Green; 
-            severityStr = "INFO";
-            break;
-        case SDL_LOG_PRIORITY_WARN:     
-            color = ConsoleColor::Yellow; 
-            severityStr = "WARN";
-            break;
-        case SDL_LOG_PRIORITY_ERROR:    
-            color = ConsoleColor::Red; 
-            severityStr = "ERROR";
-            break;
-        case SDL_LOG_PRIORITY_CRITICAL: 
-            color = ConsoleColor::BoldRed; 
-            severityStr = "CRITICAL";
-            break;
-        default: break;
-    }
-    
-    // Output the message (to stderr for errors/critical, stdout otherwise)
-    FILE* output = (priority >= SDL_LOG_PRIORITY_ERROR) ? stderr : stdout;
-    
-    // Print timestamp and severity in white
-    Platform::setConsoleColor(ConsoleColor::Reset);
-    fprintf(output, "[%02d:%02d:%02d.%03d %s] ", 
-            now_tm.tm_hour, now_tm.tm_min, now_tm.tm_sec, (int)now_ms.count(), severityStr);
-    
-    // Print message in severity color
-    Platform::setConsoleColor(color);
-    fprintf(output, "%s", message);
-    
-    // Reset color and newline
-    Platform::setConsoleColor(ConsoleColor::Reset);
-    fprintf(output, "\n");
-    fflush(output);
-    
-    // Also write to log file (without colors)
-    if (logFile.isOpen()) {
-        std::ostringstream oss;
-        oss << "["
-            << std::setfill('0') << std::setw(2) << now_tm.tm_hour << ":"
-            << std::setfill('0') << std::setw(2) << now_tm.tm_min << ":"
-            << std::setfill('0') << std::setw(2) << now_tm.tm_sec << "."
-            << std::setfill('0') << std::setw(3) << (int)now_ms.count() << " "
-            << severityStr << "] " << message;
-        logFile.writeLine(oss.str());
+
+// Trivially destructible: still valid while other statics log from their destructors
+std::atomic<LogLevel> runtimeLevel { DEFAULT_LEVEL };
+std::atomic<bool> backendAlive { false };
+
+struct LevelStyle {
+    ConsoleColor color;
+    const char* name;
+};
+
+LevelStyle getStyle(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace:    return { ConsoleColor::Gray, "TRACE" };
+        case LogLevel::Debug:    return { ConsoleColor::Cyan, "DEBUG" };
+        case LogLevel::Info:     return { ConsoleColor::Green, "INFO" };
+        case LogLevel::Warn:     return { ConsoleColor::Yellow, "WARN" };
+        case LogLevel::Error:    return { ConsoleColor::Red, "ERROR" };
+        case LogLevel::Critical: return { ConsoleColor::BoldRed, "CRITICAL" };
     }
+    return { ConsoleColor::Reset, "INFO" };
 }
 
-// Static initializer to set up custom log output
-class LogInitializer {
+SDL_LogPriority toSdlPriority(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace:    return SDL_LOG_PRIORITY_VERBOSE;
+        case LogLevel::Debug:    return SDL_LOG_PRIORITY_DEBUG;
+        case LogLevel::Info:     return SDL_LOG_PRIORITY_INFO;
+        case LogLevel::Warn:     return SDL_LOG_PRIORITY_WARN;
+        case LogLevel::Error:    return SDL_LOG_PRIORITY_ERROR;
+        case LogLevel::Critical: return SDL_LOG_PRIORITY_CRITICAL;
+    }
+    return SDL_LOG_PRIORITY_INFO;
+}
+
+LogLevel fromSdlPriority(SDL_LogPriority priority) {
+    switch (priority) {
+        case SDL_LOG_PRIORITY_TRACE:
+        case SDL_LOG_PRIORITY_VERBOSE:  return LogLevel::Trace;
+        case SDL_LOG_PRIORITY_DEBUG:    return LogLevel::Debug;
+        case SDL_LOG_PRIORITY_WARN:     return LogLevel::Warn;
+        case SDL_LOG_PRIORITY_ERROR:    return LogLevel::Error;
+        case SDL_LOG_PRIORITY_CRITICAL: return LogLevel::Critical;
+        default:                        return LogLevel::Info;
+    }
+}
+
+i64 nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Owns the ring and the writer thread. Records are formatted by the callers, the
+// writer only adds the timestamp prefix and colors
+class LogBackend {
 public:
-    LogInitializer() {
-        // Open log file
+    LogBackend() : ring(std::make_unique<MpscRing<LogRecord, RING_CAPACITY>>()) {
         logFile.open("LastRun.log");
         if (logFile.isOpen()) {
             logFile.writeLine("=== Log Started ===");
         }
-#if defined(NDEBUG)
-        SDL_SetLogPriorities(SDL_LOG_PRIORITY_WARN);
-#else
-        SDL_SetLogPriorities(SDL_LOG_PRIORITY_DEBUG);
-#endif
-        SDL_SetLogOutputFunction(CustomLogOutput, nullptr);
+        backendAlive.store(true, std::memory_order_release);
+        writer = std::thread([this] { run(); });
     }
-    
-    ~LogInitializer() {
+
+    ~LogBackend() {
+        backendAlive.store(false, std::memory_order_release);
+        running.store(false, std::memory_order_release);
+        if (writer.joinable()) {
+            writer.join();
+        }
         if (logFile.isOpen()) {
             logFile.writeLine("=== Log Ended ===");
             logFile.close();
         }
     }
+
+    static LogBackend& instance() {
+        static LogBackend backend;
+        return backend;
+    }
+
+    void push(LogLevel level, const char* fmt, va_list args) {
+        const i64 timestamp = nowMs();
+        auto fill = [&](LogRecord& record) {
+            record.timestampMs = timestamp;
+            record.level = level;
+            va_list copy;
+            va_copy(copy, args);
+            std::vsnprintf(record.text, sizeof(record.text), fmt, copy);
+            va_end(copy);
+        };
+
+        if (!ring->tryPush(fill)) {
+            if (level < LogLevel::Error) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            // Errors are not lost: wait for the writer to make room
+            while (!ring->tryPush(fill)) {
+                std::this_thread::yield();
+            }
+        }
+        pushed.fetch_add(1, std::memory_order_release);
+
+        if (level == LogLevel::Critical) {
+            flush();
+        }
+    }
+
+    void flush() {
+        const u64 target = pushed.load(std::memory_order_acquire);
+        while (written.load(std::memory_order_acquire) < target && running.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    u64 getDroppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    // Picked up by the writer on its next iteration
+    void requestWorkerPinning() {
+        pinRequested.store(true, std::memory_order_release);
+    }
+
+private:
+    void run() {
+        // Started before any thread layout exists: make way for the frame threads until
+        // Log::pinToWorkerCpus() moves the writer off their cores
+        Platform::setThreadName("Log");
+        Platform::setThreadPriority(services::ThreadPriority::Background);
+
+        u64 reportedDrops = 0;
+        for (;;) {
+            // Read the flag first: a final drain after it went down catches everything pushed before
+            const bool keepRunning = running.load(std::memory_order_acquire);
+
+            if (pinRequested.exchange(false, std::memory_order_acquire)) {
+                Platform::pinToWorkerCpus();
+            }
+
+            u32 count = 0;
+            while (ring->tryPop([this](const LogRecord& record) { writeRecord(record); })) {
+                count++;
+            }
+
+            // The report is not a pushed record: counting it would let flush() return early
+            bool reportedDrop = false;
+            const u64 drops = dropped.load(std::memory_order_relaxed);
+            if (drops != reportedDrops) {
+                LogRecord record;
+                record.timestampMs = nowMs();
+                record.level = LogLevel::Warn;
+                std::snprintf(record.text, sizeof(record.text), "Log: %llu messages dropped, ring full",
+                    static_cast<unsigned long long>(drops - reportedDrops));
+                writeRecord(record);
+                reportedDrops = drops;
+                reportedDrop = true;
+            }
+
+            if (count > 0 || reportedDrop) {
+                // One flush per batch instead of one per message
+                std::fflush(stdout);
+                std::fflush(stderr);
+                logFile.flush();
+                written.fetch_add(count, std::memory_order_release);
+            }
+
+            if (!keepRunning) break;
+            if (count == 0 && !reportedDrop) {
+                std::this_thread::sleep_for(IDLE_SLEEP);
+            }
+        }
+    }
+
+    void writeRecord(const LogRecord& record) {
+        // localtime is not free: only convert when the second changes
+        const i64 seconds = record.timestampMs / 1000;
+        if (seconds != cachedSecond) {
+            const std::time_t time = static_cast<std::time_t>(seconds);
+#ifdef _WIN32
+            localtime_s(&cachedTime, &time);
+#else
+            localtime_r(&time, &cachedTime);
+#endif
+            cachedSecond = seconds;
+        }
+
+        const LevelStyle style = getStyle(record.level);
+        char prefix[32];
+        std::snprintf(prefix, sizeof(prefix), "[%02d:%02d:%02d.%03d %s] ", cachedTime.tm_hour, cachedTime.tm_min,
+            cachedTime.tm_sec, static_cast<int>(record.timestampMs % 1000), style.name);
+
+        // Errors and critical to stderr, stdout otherwise
+        FILE* output = record.level >= LogLevel::Error ? stderr : stdout;
+        Platform::setConsoleColor(ConsoleColor::Reset);
+        std::fputs(prefix, output);
+        Platform::setConsoleColor(style.color);
+        std::fputs(record.text, output);
+        Platform::setConsoleColor(ConsoleColor::Reset);
+        std::fputc('\n', output);
+
+        // Also write to log file (without colors)
+        if (logFile.isOpen()) {
+            logFile.write(prefix);
+            logFile.writeLine(record.text);
+        }
+    }
+
+    std::unique_ptr<MpscRing<LogRecord, RING_CAPACITY>> ring;
+    std::thread writer;
+    std::atomic<bool> running { true };
+    std::atomic<u64> pushed { 0 };
+    std::atomic<u64> written { 0 };
+    std::atomic<u64> dropped { 0 };
+    std::atomic<bool> pinRequested { false };
+
+    // Writer thread only
+    FileWriter logFile;
+    i64 cachedSecond { -1 };
+    std::tm cachedTime {};
 };
 
-static LogInitializer logInit; // Runs before main()
+// Used once the backend is gone, by statics destroyed after it
+void writeSynchronously(LogLevel level, const char* fmt, va_list args) {
+    char text[services::Log::MAX_MESSAGE_LENGTH + 1];
+    std::vsnprintf(text, sizeof(text), fmt, args);
+    std::fprintf(stderr, "[%s] %s\n", getStyle(level).name, text);
+}
+
+void SDLCALL sdlLogOutput(void* userdata, int category, SDL_LogPriority priority, const char* message) {
+    services::Log::write(fromSdlPriority(priority), "%s", message);
+}
+
+// Static initializer: starts the writer and takes over SDL's output before main()
+class LogInitializer {
+public:
+    LogInitializer() {
+        LogBackend::instance();
+        SDL_SetLogPriorities(toSdlPriority(DEFAULT_LEVEL));
+        SDL_SetLogOutputFunction(sdlLogOutput, nullptr);
+    }
+};
+
+LogInitializer logInit;
+
+} // namespace
 
 namespace services {
 
-void Log::Trace(const char* fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
-    SDL_LogMessageV(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_VERBOSE, fmt, args);
-    va_end(args);
+void Log::setLevel(LogLevel level) {
+    runtimeLevel.store(level, std::memory_order_relaxed);
+    SDL_SetLogPriorities(toSdlPriority(level));
 }
 
-void Log::Debug(const char* fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
-    SDL_LogMessageV(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_DEBUG, fmt, args);
-    va_end(args);
+LogLevel Log::getLevel() {
+    return runtimeLevel.load(std::memory_order_relaxed);
 }
 
-void Log::Info(const char* fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
-    SDL_LogMessageV(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO, fmt, args);
-    va_end(args);
+bool Log::isEnabled(LogLevel level) {
+    return level >= COMPILED_LEVEL && level >= runtimeLevel.load(std::memory_order_relaxed);
 }
 
-void Log::Warn(const char* fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
-    SDL_LogMessageV(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN, fmt, args);
-    va_end(args);
+void Log::flush() {
+    if (backendAlive.load(std::memory_order_acquire)) {
+        LogBackend::instance().flush();
+    }
 }
 
-void Log::Error(const char* fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
-    SDL_LogMessageV(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_ERROR, fmt, args);
-    va_end(args);
+u64 Log::getDroppedCount() {
+    return backendAlive.load(std::memory_order_acquire) ? LogBackend::instance().getDroppedCount() : 0;
 }
 
-void Log::Critical(const char* fmt, ...) {
+void Log::pinToWorkerCpus() {
+    if (backendAlive.load(std::memory_order_acquire)) {
+        LogBackend::instance().requestWorkerPinning();
+    }
+}
+
+void Log::write(LogLevel level, const char* fmt, ...) {
+    if (level < runtimeLevel.load(std::memory_order_relaxed)) return;
+
     va_list args;
     va_start(args, fmt);
-    SDL_LogMessageV(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_CRITICAL, fmt, args);
+    if (backendAlive.load(std::memory_order_acquire)) {
+        LogBackend::instance().push(level, fmt, args);
+    } else {
+        writeSynchronously(level, fmt, args);
+    }
     va_end(args);
 }
 
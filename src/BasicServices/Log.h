@@ -1,9 +1,49 @@
 #pragma once
 
+#include "../Defines.h"
+
+// Lowest level compiled in: 0 Trace, 1 Debug, 2 Info, 3 Warn, 4 Error, 5 Critical.
+// Formatting and pushing of calls below it are removed at compile time, but their arguments are
+// still evaluated at the call site: keep expensive ones out of Trace and Debug calls, or test
+// Log::isEnabled first. Set by CMake (MEADOWS_LOG_LEVEL)
+#ifndef MEADOWS_LOG_LEVEL
+    #if defined(NDEBUG)
+        #define MEADOWS_LOG_LEVEL 2
+    #else
+        #define MEADOWS_LOG_LEVEL 0
+    #endif
+#endif
+
 namespace services {
 
+enum class LogLevel : u8 {
+    Trace,
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Critical
+};
+
+/**
+ * Engine logging, printf style.
+ *
+ * A call formats its message into a fixed-size record of a lock-free ring and returns:
+ * a background thread writes the records to the console and LastRun.log, flushing once
+ * per batch. Logging from a frame never waits on the terminal or the disk.
+ *
+ * Two filters apply. Levels below MEADOWS_LOG_LEVEL are not formatted nor pushed (their
+ * arguments are still evaluated); the others are filtered at runtime with setLevel (default Warn in release, Debug otherwise).
+ *
+ * When the ring is full, Trace to Warn messages are dropped and counted, Error and
+ * Critical wait for room. Critical also waits for the message to be written, as a
+ * crash usually follows. Messages longer than MAX_MESSAGE_LENGTH are truncated.
+ */
 class Log {
 public:
+    static constexpr LogLevel COMPILED_LEVEL = static_cast<LogLevel>(MEADOWS_LOG_LEVEL);
+    static constexpr u32 MAX_MESSAGE_LENGTH = 240;
+
     // Prevent instantiation
     Log() = delete;
     ~Log() = delete;
@@ -11,12 +51,44 @@ public:
     Log& operator=(const Log&) = delete;
 
     // Logging methods
-    static void Trace(const char* fmt, ...);
-    static void Debug(const char* fmt, ...);
-    static void Info(const char* fmt, ...);
-    static void Warn(const char* fmt, ...);
-    static void Error(const char* fmt, ...);
-    static void Critical(const char* fmt, ...);
+    template <typename... Args>
+    static void Trace(const char* fmt, Args... args) { emit<LogLevel::Trace>(fmt, args...); }
+    template <typename... Args>
+    static void Debug(const char* fmt, Args... args) { emit<LogLevel::Debug>(fmt, args...); }
+    template <typename... Args>
+    static void Info(const char* fmt, Args... args) { emit<LogLevel::Info>(fmt, args...); }
+    template <typename... Args>
+    static void Warn(const char* fmt, Args... args) { emit<LogLevel::Warn>(fmt, args...); }
+    template <typename... Args>
+    static void Error(const char* fmt, Args... args) { emit<LogLevel::Error>(fmt, args...); }
+    template <typename... Args>
+    static void Critical(const char* fmt, Args... args) { emit<LogLevel::Critical>(fmt, args...); }
+
+    // Runtime filter, also applied to SDL's own messages
+    static void setLevel(LogLevel level);
+    static LogLevel getLevel();
+    static bool isEnabled(LogLevel level);
+
+    // Blocks until every message logged before the call is written
+    static void flush();
+
+    // Messages lost because the ring was full, since start
+    static u64 getDroppedCount();
+
+    // Moves the writer thread onto the worker CPUs, call after Platform::setWorkerCpus().
+    // The writer starts before main() and cannot know the thread layout by itself
+    static void pinToWorkerCpus();
+
+    // Backend of the logging methods
+    static void write(LogLevel level, const char* fmt, ...);
+
+private:
+    template <LogLevel level, typename... Args>
+    static void emit(const char* fmt, Args... args) {
+        if constexpr (level >= COMPILED_LEVEL) {
+            write(level, fmt, args...);
+        }
+    }
 };
 
 } // namespace services
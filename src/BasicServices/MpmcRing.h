@@ -0,0 +1,102 @@
+#pragma once
+
+#include "../Defines.h"
+#include <array>
+#include <atomic>
+
+namespace services {
+
+/**
+ * Bounded multi-producer multi-consumer ring of fixed-size values.
+ *
+ * The MpscRing scheme with a shared head: each cell carries a sequence number
+ * telling whose turn it is, producers claim a cell with a CAS on the tail and
+ * consumers with a CAS on the head, then hand it over by bumping its sequence.
+ * Nothing is allocated after construction and no lock is ever taken; a thread
+ * only retries when another one claimed the same cell first.
+ *
+ * Meant for free-lists of handles that any thread takes and gives back. Values
+ * come out roughly in push order, but nothing should rely on it.
+ *
+ *     MpmcRing<Handle, 256> freeList;
+ *     freeList.tryPush([&](Handle& slot) { slot = handle; });     // any thread
+ *     freeList.tryPop([&](const Handle& slot) { handle = slot; }); // any thread
+ */
+template <typename T, u32 Capacity>
+class MpmcRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MpmcRing() {
+        for (u32 i = 0; i < Capacity; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcRing(const MpmcRing&) = delete;
+    MpmcRing& operator=(const MpmcRing&) = delete;
+
+    // Claims a cell and calls fill(T&) on it. Returns false, without calling fill, when the ring is full
+    template <typename Fill>
+    bool tryPush(Fill&& fill) {
+        u64 position = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & MASK];
+            const u64 sequence = cell.sequence.load(std::memory_order_acquire);
+            const i64 difference = static_cast<i64>(sequence) - static_cast<i64>(position);
+
+            if (difference == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    fill(cell.value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                // No consumer has released this cell from the previous lap yet
+                return false;
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Claims the oldest published value and calls read(const T&) on it. Returns false when empty
+    template <typename Read>
+    bool tryPop(Read&& read) {
+        u64 position = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & MASK];
+            const u64 sequence = cell.sequence.load(std::memory_order_acquire);
+            const i64 difference = static_cast<i64>(sequence) - static_cast<i64>(position + 1);
+
+            if (difference == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    read(static_cast<const T&>(cell.value));
+                    // Give the cell back to producers for the next lap
+                    cell.sequence.store(position + Capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                // Nothing published in this cell yet: the ring is empty
+                return false;
+            } else {
+                // Another consumer took it, catch up
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    static constexpr u64 MASK = Capacity - 1;
+
+    struct alignas(64) Cell {
+        std::atomic<u64> sequence { 0 };
+        T value {};
+    };
+
+    std::array<Cell, Capacity> cells;
+    alignas(64) std::atomic<u64> tail { 0 };    // Next cell producers claim
+    alignas(64) std::atomic<u64> head { 0 };    // Next cell consumers claim
+};
+
+} // namespace services
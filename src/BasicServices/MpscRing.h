@@ -0,0 +1,93 @@
+#pragma once
+
+#include "../Defines.h"
+#include <array>
+#include <atomic>
+
+namespace services {
+
+/**
+ * Bounded multi-producer single-consumer ring of fixed-size values.
+ *
+ * Each cell carries a sequence number telling whose turn it is: producers claim a
+ * cell with a CAS on the tail, fill it in place, then publish it by bumping its
+ * sequence; the consumer reads published cells in order and hands them back.
+ * Nothing is allocated after construction and no lock is ever taken, producers
+ * only contend on the tail counter.
+ *
+ * A full ring is reported to the producer (tryPush returns false) rather than
+ * overwriting old values: the caller decides whether to drop or retry.
+ *
+ *     MpscRing<Record, 1024> ring;
+ *     ring.tryPush([&](Record& record) { record = ...; });     // any thread
+ *     while (ring.tryPop([&](const Record& record) { ... })) {} // one thread
+ */
+template <typename T, u32 Capacity>
+class MpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MpscRing() {
+        for (u32 i = 0; i < Capacity; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Claims a cell and calls fill(T&) on it. Returns false, without calling fill, when the ring is full
+    template <typename Fill>
+    bool tryPush(Fill&& fill) {
+        u64 position = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & MASK];
+            const u64 sequence = cell.sequence.load(std::memory_order_acquire);
+            const i64 difference = static_cast<i64>(sequence) - static_cast<i64>(position);
+
+            if (difference == 0) {
+                // Free cell for this lap: try to own it
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    fill(cell.value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                // The consumer has not released this cell from the previous lap yet
+                return false;
+            } else {
+                // Another producer took it, catch up
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Calls read(const T&) on the oldest published value. Consumer thread only. Returns false when empty
+    template <typename Read>
+    bool tryPop(Read&& read) {
+        Cell& cell = cells[head & MASK];
+        if (cell.sequence.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+
+        read(static_cast<const T&>(cell.value));
+        // Give the cell back to producers for the next lap
+        cell.sequence.store(head + Capacity, std::memory_order_release);
+        head++;
+        return true;
+    }
+
+private:
+    static constexpr u64 MASK = Capacity - 1;
+
+    struct alignas(64) Cell {
+        std::atomic<u64> sequence { 0 };
+        T value {};
+    };
+
+    std::array<Cell, Capacity> cells;
+    alignas(64) std::atomic<u64> tail { 0 };    // Next cell producers claim
+    alignas(64) u64 head { 0 };                 // Next cell the consumer reads
+};
+
+} // namespace services
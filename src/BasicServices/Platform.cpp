@@ -0,0 +1,54 @@
+#include "Platform.h"
+#include <algorithm>
+#include <mutex>
+
+namespace services {
+
+namespace {
+
+std::mutex workerCpusMutex;
+vector<u32> workerCpus;
+
+} // namespace
+
+ThreadLayout Platform::planThreadLayout(const CpuTopology& topology) {
+    ThreadLayout layout;
+    // Pinning two cores out of three or fewer would starve everything else
+    if (topology.cores.size() < 4) return layout;
+
+    // Cores are sorted fastest first: the main thread takes the first one, the render
+    // thread the next fast one sharing its cache, the two hand frame packets over
+    const CpuCore& mainCore = topology.cores[0];
+    const CpuCore* renderCore = &topology.cores[1];
+    for (size_t i = 1; i < topology.cores.size(); i++) {
+        const CpuCore& core = topology.cores[i];
+        if (core.efficiency) break;
+        if (core.cluster == mainCore.cluster) {
+            renderCore = &core;
+            break;
+        }
+    }
+
+    layout.mainCpus = mainCore.logicalCpus;
+    layout.renderCpus = renderCore->logicalCpus;
+    for (const CpuCore& core : topology.cores) {
+        if (&core == &mainCore || &core == renderCore) continue;
+        layout.workerCpus.insert(layout.workerCpus.end(), core.logicalCpus.begin(), core.logicalCpus.end());
+    }
+    std::sort(layout.workerCpus.begin(), layout.workerCpus.end());
+    return layout;
+}
+
+void Platform::setWorkerCpus(std::span<const u32> logicalCpus) {
+    std::lock_guard lock(workerCpusMutex);
+    workerCpus.assign(logicalCpus.begin(), logicalCpus.end());
+}
+
+void Platform::pinToWorkerCpus() {
+    std::lock_guard lock(workerCpusMutex);
+    if (!workerCpus.empty()) {
+        setThreadAffinity(workerCpus);
+    }
+}
+
+} // namespace services
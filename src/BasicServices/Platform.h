@@ -1,5 +1,8 @@
 #pragma once
 
+#include "../Defines.h"
+#include <span>
+
 namespace services {
 
 enum class ConsoleColor {
@@ -12,6 +15,35 @@ enum class ConsoleColor {
     Reset
 };
 
+enum class ThreadPriority {
+    Background,     // Yields to everything else (nice 10 on Linux)
+    Normal,
+    High            // Frame critical. Needs CAP_SYS_NICE on Linux, stays Normal without it
+};
+
+// One physical core and the logical CPUs (SMT siblings) it runs
+struct CpuCore {
+    vector<u32> logicalCpus;        // OS CPU indices, lowest first
+    u32 package { 0 };
+    u32 cluster { 0 };              // Cores sharing a last level cache have the same cluster
+    u32 performance { 0 };          // cpu_capacity when known, else max frequency in kHz. 0 if unknown
+    bool efficiency { false };      // Little core of a hybrid (big/little) CPU
+};
+
+struct CpuTopology {
+    vector<CpuCore> cores;          // Fastest first, then by cluster
+    u32 logicalCpuCount { 0 };
+    u32 clusterCount { 0 };
+    bool hybrid { false };
+};
+
+// Where the long lived threads run. Empty sets mean "leave it to the scheduler"
+struct ThreadLayout {
+    vector<u32> mainCpus;           // Every logical CPU of one physical core
+    vector<u32> renderCpus;         // Another physical core, in the same cluster when possible
+    vector<u32> workerCpus;         // Everything else: loaders, animation jobs, logging
+};
+
 class Platform {
 public:
     // Prevent instantiation
@@ -22,6 +54,24 @@ public:
 
     // Platform-specific console color setting
     static void setConsoleColor(ConsoleColor color);
+
+    // Read once, on first use (/sys/devices/system/cpu on Linux)
+    static const CpuTopology& getCpuTopology();
+
+    // Main and render threads on two distinct fast physical cores, workers on the rest.
+    // Empty when there are too few cores to spare two of them
+    static ThreadLayout planThreadLayout(const CpuTopology& topology);
+
+    // The following apply to the calling thread and return false when the OS refused
+    static bool setThreadAffinity(std::span<const u32> logicalCpus);
+    static bool setThreadPriority(ThreadPriority priority);
+    // Shown by debuggers, top and perf. Truncated to 15 characters on Linux
+    static void setThreadName(const char* name);
+
+    // CPUs for background work, set once by whoever planned the layout (any thread)
+    static void setWorkerCpus(std::span<const u32> logicalCpus);
+    // Moves the calling thread to the worker CPUs. Nothing happens before they are set
+    static void pinToWorkerCpus();
 };
 
 } // namespace services
@@ -1,8 +1,136 @@
 #include "Platform.h"
+#include <algorithm>
 #include <cstdio>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 namespace services
 {
+    namespace {
+        const str CPU_ROOT = "/sys/devices/system/cpu";
+
+        // Little cores of hybrid CPUs are well below this fraction of the fastest core,
+        // while favored cores of a uniform CPU only boost a few percent higher
+        constexpr f32 EFFICIENCY_CORE_RATIO = 0.8f;
+
+        bool readLine(const str& path, str& line) {
+            std::ifstream file(path);
+            return file && std::getline(file, line);
+        }
+
+        bool readU32(const str& path, u32& value) {
+            std::ifstream file(path);
+            return file && (file >> value);
+        }
+
+        // Kernel CPU lists, e.g. "0-3,8,10-11"
+        vector<u32> parseCpuList(const str& list) {
+            vector<u32> cpus;
+            size_t position = 0;
+            while (position < list.size()) {
+                size_t end = list.find(',', position);
+                if (end == str::npos) end = list.size();
+                const str range = list.substr(position, end - position);
+                const size_t dash = range.find('-');
+                try {
+                    const u32 first = static_cast<u32>(std::stoul(range.substr(0, dash)));
+                    const u32 last = dash == str::npos ? first : static_cast<u32>(std::stoul(range.substr(dash + 1)));
+                    for (u32 cpu = first; cpu <= last; cpu++) {
+                        cpus.push_back(cpu);
+                    }
+                } catch (const std::exception&) {
+                    // Trailing newline or garbage, keep what was parsed
+                }
+                position = end + 1;
+            }
+            return cpus;
+        }
+
+        // CPUs sharing the last level data cache of cpuN, as listed by the kernel
+        str readLastLevelCache(const str& cpuPath) {
+            str shared;
+            u32 highestLevel = 0;
+            for (u32 index = 0;; index++) {
+                const str cachePath = cpuPath + "/cache/index" + std::to_string(index);
+                u32 level = 0;
+                if (!readU32(cachePath + "/level", level)) break;
+                str type;
+                readLine(cachePath + "/type", type);
+                if (type == "Instruction" || level < highestLevel) continue;
+                if (readLine(cachePath + "/shared_cpu_list", shared)) {
+                    highestLevel = level;
+                }
+            }
+            return shared;
+        }
+
+        CpuTopology readCpuTopology() {
+            CpuTopology topology;
+
+            str online;
+            vector<u32> cpus = readLine(CPU_ROOT + "/online", online) ? parseCpuList(online) : vector<u32> {};
+            if (cpus.empty()) {
+                // No sysfs (container, sandbox): one core per logical CPU, nothing else known
+                const u32 count = std::max(1u, std::thread::hardware_concurrency());
+                for (u32 cpu = 0; cpu < count; cpu++) {
+                    topology.cores.push_back(CpuCore { { cpu } });
+                }
+                topology.logicalCpuCount = count;
+                topology.clusterCount = 1;
+                return topology;
+            }
+
+            std::map<std::pair<u32, u32>, size_t> coreIndices;     // (package, core_id) -> cores
+            std::map<str, u32> clusters;                            // Last level cache CPU list -> cluster
+            for (const u32 cpu : cpus) {
+                const str cpuPath = CPU_ROOT + "/cpu" + std::to_string(cpu);
+                u32 package = 0;
+                u32 coreId = cpu;
+                readU32(cpuPath + "/topology/physical_package_id", package);
+                readU32(cpuPath + "/topology/core_id", coreId);
+
+                const auto [it, inserted] = coreIndices.try_emplace({ package, coreId }, topology.cores.size());
+                if (inserted) {
+                    CpuCore core;
+                    core.package = package;
+                    const str cache = readLastLevelCache(cpuPath);
+                    core.cluster = clusters.try_emplace(cache, static_cast<u32>(clusters.size())).first->second;
+                    if (!readU32(cpuPath + "/cpu_capacity", core.performance)) {
+                        readU32(cpuPath + "/cpufreq/cpuinfo_max_freq", core.performance);
+                    }
+                    topology.cores.push_back(std::move(core));
+                }
+                topology.cores[it->second].logicalCpus.push_back(cpu);
+            }
+
+            u32 fastest = 0;
+            for (const CpuCore& core : topology.cores) {
+                fastest = std::max(fastest, core.performance);
+            }
+            for (CpuCore& core : topology.cores) {
+                core.efficiency = core.performance > 0 && core.performance < fastest * EFFICIENCY_CORE_RATIO;
+                topology.hybrid = topology.hybrid || core.efficiency;
+                std::sort(core.logicalCpus.begin(), core.logicalCpus.end());
+            }
+
+            std::stable_sort(topology.cores.begin(), topology.cores.end(), [](const CpuCore& a, const CpuCore& b) {
+                if (a.performance != b.performance) return a.performance > b.performance;
+                if (a.cluster != b.cluster) return a.cluster < b.cluster;
+                return a.logicalCpus.front() < b.logicalCpus.front();
+            });
+
+            topology.logicalCpuCount = static_cast<u32>(cpus.size());
+            topology.clusterCount = std::max(1u, static_cast<u32>(clusters.size()));
+            return topology;
+        }
+    }
+
     void Platform::setConsoleColor(ConsoleColor color) {
         const char* code = "\033[0m"; // Reset
 
@@ -32,4 +160,42 @@ namespace services
 
         printf("%s", code);
     }
+
+    const CpuTopology& Platform::getCpuTopology() {
+        static const CpuTopology topology = readCpuTopology();
+        return topology;
+    }
+
+    bool Platform::setThreadAffinity(std::span<const u32> logicalCpus) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const u32 cpu : logicalCpus) {
+            if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        }
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+
+    bool Platform::setThreadPriority(ThreadPriority priority) {
+        int niceness = 0;
+        switch (priority) {
+            case ThreadPriority::Background:
+                niceness = 10;
+                break;
+            case ThreadPriority::Normal:
+                niceness = 0;
+                break;
+            case ThreadPriority::High:
+                niceness = -5;
+                break;
+        }
+        // Linux applies niceness per thread when given a thread id
+        const id_t threadId = static_cast<id_t>(syscall(SYS_gettid));
+        return setpriority(PRIO_PROCESS, threadId, niceness) == 0;
+    }
+
+    void Platform::setThreadName(const char* name) {
+        char truncated[16] {};
+        std::snprintf(truncated, sizeof(truncated), "%s", name);
+        pthread_setname_np(pthread_self(), truncated);
+    }
 }
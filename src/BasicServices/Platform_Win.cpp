@@ -1,5 +1,6 @@
 #include "Platform.h"
 #include <windows.h>
+#include <thread>
 
 
 namespace services {
@@ -35,4 +36,52 @@ void Platform::setConsoleColor(ConsoleColor color) {
     SetConsoleTextAttribute(hConsole, attribute);
 }
 
+// Flat topology: one core per logical CPU. Enough for the layout, which then leaves
+// SMT siblings to the scheduler
+const CpuTopology& Platform::getCpuTopology() {
+    static const CpuTopology topology = [] {
+        CpuTopology result;
+        // windows.h defines a max macro
+        const u32 count = std::thread::hardware_concurrency();
+        result.logicalCpuCount = count > 0 ? count : 1;
+        result.clusterCount = 1;
+        for (u32 cpu = 0; cpu < result.logicalCpuCount; cpu++) {
+            result.cores.push_back(CpuCore { { cpu } });
+        }
+        return result;
+    }();
+    return topology;
+}
+
+bool Platform::setThreadAffinity(std::span<const u32> logicalCpus) {
+    // Single processor group: the first 64 logical CPUs
+    DWORD_PTR mask = 0;
+    for (const u32 cpu : logicalCpus) {
+        if (cpu < sizeof(DWORD_PTR) * 8) mask |= DWORD_PTR(1) << cpu;
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+}
+
+bool Platform::setThreadPriority(ThreadPriority priority) {
+    int value = THREAD_PRIORITY_NORMAL;
+    switch (priority) {
+        case ThreadPriority::Background:
+            value = THREAD_PRIORITY_BELOW_NORMAL;
+            break;
+        case ThreadPriority::Normal:
+            value = THREAD_PRIORITY_NORMAL;
+            break;
+        case ThreadPriority::High:
+            value = THREAD_PRIORITY_ABOVE_NORMAL;
+            break;
+    }
+    return SetThreadPriority(GetCurrentThread(), value) != 0;
+}
+
+void Platform::setThreadName(const char* name) {
+    wchar_t wideName[64] {};
+    MultiByteToWideChar(CP_UTF8, 0, name, -1, wideName, 63);
+    SetThreadDescription(GetCurrentThread(), wideName);
+}
+
 } // namespace services
@@ -0,0 +1,170 @@
+#include "Profiler.h"
+#include "FileWriter.h"
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
+
+namespace services {
+
+namespace {
+    str escapeJson(const char* text) {
+        str escaped;
+        for (const char* c = text; *c; c++) {
+            if (*c == '"' || *c == '\\') escaped += '\\';
+            escaped += *c;
+        }
+        return escaped;
+    }
+}
+
+u64 Profiler::now() {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+Profiler::ThreadBufferLease::~ThreadBufferLease() {
+    if (buffer) {
+        Profiler::Instance().releaseThreadBuffer(buffer);
+    }
+}
+
+Profiler::ThreadBuffer& Profiler::getThreadBuffer() {
+    // Each thread caches its own buffer: recording never goes through the registry lock
+    thread_local ThreadBufferLease lease;
+    if (lease.buffer) {
+        return *lease.buffer;
+    }
+
+    // First zone on this thread: take the buffer of an exited thread, or a new one
+    std::lock_guard lock(registryMutex);
+    if (!freeBuffers.empty()) {
+        lease.buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+        // Its events stay in the capture, under the same trace thread
+        lease.buffer->name.store(nullptr, std::memory_order_release);
+        return *lease.buffer;
+    }
+
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->threadId = static_cast<u32>(threadBuffers.size()) + 1;
+    lease.buffer = buffer.get();
+    threadBuffers.push_back(std::move(buffer));
+    return *lease.buffer;
+}
+
+void Profiler::releaseThreadBuffer(ThreadBuffer* buffer) {
+    std::lock_guard lock(registryMutex);
+    freeBuffers.push_back(buffer);
+}
+
+void Profiler::setThreadName(const char* name) {
+    getThreadBuffer().name.store(name, std::memory_order_release);
+}
+
+void Profiler::record(const char* name, u64 start, u64 end) {
+    ThreadBuffer& buffer = getThreadBuffer();
+
+    // Lazily forget the events of a previous capture
+    const u32 currentGeneration = generation.load(std::memory_order_acquire);
+    if (buffer.generation.load(std::memory_order_relaxed) != currentGeneration) {
+        buffer.count.store(0, std::memory_order_relaxed);
+        buffer.dropped.store(0, std::memory_order_relaxed);
+        buffer.generation.store(currentGeneration, std::memory_order_release);
+    }
+
+    const u32 index = buffer.count.load(std::memory_order_relaxed);
+    if (index == 0 && buffer.events.empty()) {
+        // Threads that only name themselves never pay for it. Nothing reads events while count is 0
+        buffer.events.resize(MAX_EVENTS_PER_THREAD);
+    }
+    if (index >= MAX_EVENTS_PER_THREAD) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.events[index] = { name, start, end };
+    // Publish the event: a reader seeing the new count also sees its data
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+// =========================================================================
+// Capture
+// =========================================================================
+
+void Profiler::startCapture() {
+    captureStart = now();
+    generation.fetch_add(1, std::memory_order_release);
+    capturing.store(true, std::memory_order_release);
+}
+
+void Profiler::stopCapture() {
+    capturing.store(false, std::memory_order_release);
+}
+
+void Profiler::captureFrames(u32 frameCount, const str& path) {
+    if (frameCount == 0 || isCapturing()) return;
+
+    framesToCapture = frameCount;
+    capturePath = path;
+    startCapture();
+    Log::Info("CPU profiler: capturing %u frames", frameCount);
+}
+
+void Profiler::endFrame() {
+    if (framesToCapture == 0) return;
+
+    if (--framesToCapture == 0) {
+        stopCapture();
+        exportChromeTrace(capturePath);
+    }
+}
+
+bool Profiler::exportChromeTrace(const str& path) const {
+    FileWriter writer;
+    if (!writer.open(path)) {
+        Log::Error("CPU profiler: cannot open %s", path.c_str());
+        return false;
+    }
+
+    const u32 capturedGeneration = generation.load(std::memory_order_acquire);
+    u32 eventCount = 0;
+    u32 droppedCount = 0;
+    bool first = true;
+
+    writer.writeLine("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    std::lock_guard lock(registryMutex);
+    for (const auto& buffer : threadBuffers) {
+        if (buffer->generation.load(std::memory_order_acquire) != capturedGeneration) continue;
+
+        const char* threadName = buffer->name.load(std::memory_order_acquire);
+        writer.write(fmt::format("{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+            first ? "" : ",\n", buffer->threadId,
+            threadName ? escapeJson(threadName) : fmt::format("Thread {}", buffer->threadId)));
+        first = false;
+
+        const u32 count = buffer->count.load(std::memory_order_acquire);
+        for (u32 i = 0; i < count; i++) {
+            const Event& event = buffer->events[i];
+            // Trace timestamps are microseconds
+            const f64 ts = static_cast<f64>(std::max(event.start, captureStart) - captureStart) / 1000.0;
+            const f64 dur = static_cast<f64>(event.end - event.start) / 1000.0;
+            writer.write(fmt::format(",\n{{\"name\":\"{}\",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":1,\"tid\":{}}}",
+                escapeJson(event.name), ts, dur, buffer->threadId));
+        }
+        eventCount += count;
+        droppedCount += buffer->dropped.load(std::memory_order_relaxed);
+    }
+
+    writer.writeLine("\n]}");
+    writer.close();
+
+    if (droppedCount > 0) {
+        Log::Warn("CPU profiler: %u events dropped, buffers full", droppedCount);
+    }
+    Log::Info("CPU profiler: %u events exported to %s", eventCount, path.c_str());
+    return true;
+}
+
+} // namespace services
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "../Defines.h"
+#include <atomic>
+#include <mutex>
+
+/**
+ * CPU zone profiler.
+ *
+ * Zones are scoped timers that record into a buffer owned by the calling thread,
+ * so recording never takes a lock: the only shared state is the capture flag.
+ * A buffer outlives its thread and goes to the next thread started: short lived
+ * workers reuse the same few buffers instead of each keeping one until exit.
+ * Nothing is recorded outside of a capture, and when MEADOWS_PROFILING is not
+ * defined the zone macros compile to nothing.
+ *
+ * A capture is exported as Chrome trace-event JSON, which can be opened in
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ *     void Renderer::updateScene() {
+ *         PROFILE_FUNCTION();
+ *         {
+ *             PROFILE_ZONE("Culling");
+ *             ...
+ *         }
+ *     }
+ *
+ * Zone names must outlive the capture (string literals or __func__).
+ */
+
+namespace services {
+
+class Profiler {
+public:
+    static constexpr u32 MAX_EVENTS_PER_THREAD = 1 << 16;
+
+    static Profiler& Instance() {
+        static Profiler instance;
+        return instance;
+    }
+
+    // Monotonic clock in nanoseconds, available even when zones are stripped
+    static u64 now();
+    static f32 toMilliseconds(u64 nanoseconds) { return static_cast<f32>(static_cast<f64>(nanoseconds) / 1'000'000.0); }
+
+    // Capture control and endFrame: the thread that renders frames, i.e. the render thread
+    // (UI button included), or the main thread in headless runs. Zones record from any thread
+    void startCapture();
+    void stopCapture();
+    bool isCapturing() const { return capturing.load(std::memory_order_relaxed); }
+
+    // Captures the next frameCount frames, then exports them to path
+    void captureFrames(u32 frameCount, const str& path);
+    // Marks the end of a frame, to be called once per rendered frame
+    void endFrame();
+
+    // Writes the last capture as Chrome trace-event JSON. Returns false on I/O error
+    bool exportChromeTrace(const str& path) const;
+
+    // Names the calling thread in the trace
+    void setThreadName(const char* name);
+
+    // Called by ProfileZone
+    void record(const char* name, u64 start, u64 end);
+
+private:
+    struct Event {
+        const char* name;
+        u64 start;
+        u64 end;
+    };
+
+    struct ThreadBuffer {
+        u32 threadId { 0 };
+        std::atomic<const char*> name { nullptr };
+        std::atomic<u32> generation { 0 }; // Capture the events belong to
+        std::atomic<u32> count { 0 };      // Published events, written by the owner thread only
+        std::atomic<u32> dropped { 0 };    // Events lost because the buffer was full
+        vector<Event> events;              // Allocated on the first recorded zone
+    };
+
+    // Returns the calling thread's buffer to the free list when the thread exits
+    struct ThreadBufferLease {
+        ThreadBuffer* buffer { nullptr };
+        ~ThreadBufferLease();
+    };
+
+    Profiler() = default;
+    ~Profiler() = default;
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    ThreadBuffer& getThreadBuffer();
+    void releaseThreadBuffer(ThreadBuffer* buffer);
+
+    std::atomic<bool> capturing { false };
+    std::atomic<u32> generation { 0 };
+    u64 captureStart { 0 };
+
+    u32 framesToCapture { 0 };
+    str capturePath;
+
+    // Only touched when a thread records for the first time or exits, and when exporting
+    mutable std::mutex registryMutex;
+    vector<uptr<ThreadBuffer>> threadBuffers;
+    vector<ThreadBuffer*> freeBuffers;     // Of exited threads
+};
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name)
+        : name(name), start(Profiler::Instance().isCapturing() ? Profiler::now() : 0) {}
+
+    ~ProfileZone() {
+        if (start != 0) {
+            Profiler::Instance().record(name, start, Profiler::now());
+        }
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name;
+    u64 start;
+};
+
+} // namespace services
+
+#define MEADOWS_PROFILE_CONCAT_INNER(a, b) a##b
+#define MEADOWS_PROFILE_CONCAT(a, b) MEADOWS_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef MEADOWS_PROFILING
+    #define PROFILE_ZONE(name) services::ProfileZone MEADOWS_PROFILE_CONCAT(profileZone, __LINE__)(name)
+    #define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+    #define PROFILE_THREAD_NAME(name) services::Profiler::Instance().setThreadName(name)
+#else
+    #define PROFILE_ZONE(name) ((void)0)
+    #define PROFILE_FUNCTION() ((void)0)
+    #define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
@@ -14,6 +14,11 @@ namespace services {
         i32 drawcallCount = 0;
         f32 sceneUpdateTime = 0.0f;
         f32 meshDrawTime = 0.0f;
+        i32 shadowDrawcallCount = 0;
+        i32 shadowCasterCulledCount = 0;    ///< In the light frustum but unable to shadow the view
+        i32 barrierCount = 0;               ///< Pipeline barrier commands recorded this frame
+        i32 descriptorSetCount = 0;         ///< Sets allocated from the frame descriptors this frame
+        i32 descriptorPoolsCreated = 0;     ///< Frame descriptor pools created while recording, 0 once warmed up
 
     private:
         RenderingStats() = default;
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "../Defines.h"
+#include <array>
+#include <atomic>
+
+namespace services {
+
+/**
+ * Bounded single-producer single-consumer ring of reusable slots.
+ *
+ * Unlike MpscRing, values are not copied in and out: the producer fills a slot in
+ * place and publishes it, the consumer works on it in place and releases it. Slots
+ * are reused lap after lap, so containers inside T keep their capacity and a
+ * steady stream of values allocates nothing.
+ *
+ * Both sides block when there is nothing to do (full for the producer, empty for
+ * the consumer), sleeping on the other side's counter rather than spinning.
+ *
+ *     SpscRing<Packet, 2> ring;
+ *     Packet& packet = ring.acquireWrite();   // producer thread
+ *     ...
+ *     ring.publish();
+ *
+ *     Packet& packet = ring.acquireRead();    // consumer thread
+ *     ...
+ *     ring.release();
+ */
+template <typename T, u32 Capacity>
+class SpscRing {
+    static_assert(Capacity >= 1 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscRing() = default;
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer: waits for a free slot and returns it, to be filled then published
+    T& acquireWrite() {
+        const u64 write = tail.load(std::memory_order_relaxed);
+        u64 read = head.load(std::memory_order_acquire);
+        while (write - read >= Capacity) {
+            head.wait(read, std::memory_order_acquire);
+            read = head.load(std::memory_order_acquire);
+        }
+        return slots[write & MASK].value;
+    }
+
+    // Producer: hands the slot returned by acquireWrite() to the consumer
+    void publish() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        tail.notify_one();
+    }
+
+    // Consumer: waits for the oldest published slot and returns it
+    T& acquireRead() {
+        const u64 read = head.load(std::memory_order_relaxed);
+        u64 write = tail.load(std::memory_order_acquire);
+        while (write == read) {
+            tail.wait(write, std::memory_order_acquire);
+            write = tail.load(std::memory_order_acquire);
+        }
+        return slots[read & MASK].value;
+    }
+
+    // Consumer: gives the slot returned by acquireRead() back to the producer
+    void release() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        head.notify_one();
+    }
+
+    // Published slots not released yet. Approximate when read from the other side
+    u32 size() const {
+        return static_cast<u32>(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+    }
+
+private:
+    static constexpr u64 MASK = Capacity - 1;
+
+    struct alignas(64) Slot {
+        T value {};
+    };
+
+    std::array<Slot, Capacity> slots;
+    alignas(64) std::atomic<u64> tail { 0 };    // Next slot the producer fills
+    alignas(64) std::atomic<u64> head { 0 };    // Next slot the consumer reads
+};
+
+} // namespace services
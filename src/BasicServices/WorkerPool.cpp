@@ -0,0 +1,112 @@
+#include "WorkerPool.h"
+#include "Platform.h"
+#include "Profiler.h"
+#include <algorithm>
+
+namespace services {
+
+void WorkerPool::start(u32 threadCount) {
+    std::lock_guard runLock(runMutex);
+    startThreads(threadCount);
+}
+
+void WorkerPool::startThreads(u32 threadCount) {
+    if (!threads.empty()) return;
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    }
+    threads.reserve(threadCount);
+    for (u32 i = 0; i < threadCount; i++) {
+        threads.emplace_back([this] { workerLoop(); });
+    }
+}
+
+void WorkerPool::stop() {
+    std::lock_guard runLock(runMutex);
+    if (threads.empty()) return;
+
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+
+    std::lock_guard lock(mutex);
+    stopping = false;
+}
+
+void WorkerPool::run(u32 count, const std::function<void(u32)>& fn) {
+    if (count == 0) return;
+    std::lock_guard runLock(runMutex);
+    startThreads(0);
+
+    // Waking workers costs more than a single job
+    if (count == 1 || threads.empty()) {
+        for (u32 i = 0; i < count; i++) {
+            fn(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        job = &fn;
+        jobCount = count;
+        remainingJobs = count;
+        nextJob.store(0, std::memory_order_relaxed);
+        batchOpen = true;
+        batch++;
+    }
+    wake.notify_all();
+
+    const u32 taken = takeJobs();
+
+    // Workers still inside the batch read job: it must outlive them
+    std::unique_lock lock(mutex);
+    remainingJobs -= taken;
+    done.wait(lock, [this] { return remainingJobs == 0 && activeWorkers == 0; });
+    batchOpen = false;
+    job = nullptr;
+}
+
+u32 WorkerPool::takeJobs() {
+    u32 count = 0;
+    for (u32 i = nextJob.fetch_add(1, std::memory_order_relaxed); i < jobCount; i = nextJob.fetch_add(1, std::memory_order_relaxed)) {
+        (*job)(i);
+        count++;
+    }
+    return count;
+}
+
+void WorkerPool::workerLoop() {
+    // Once for the thread's lifetime, instead of once per job
+    Platform::setThreadName("Worker");
+    Platform::pinToWorkerCpus();
+    PROFILE_THREAD_NAME("Worker");
+
+    u64 lastBatch = 0;
+    std::unique_lock lock(mutex);
+    for (;;) {
+        // A worker waking after its batch closed waits for the next one
+        wake.wait(lock, [&] { return stopping || (batchOpen && batch != lastBatch); });
+        if (stopping) return;
+
+        lastBatch = batch;
+        activeWorkers++;
+        lock.unlock();
+        const u32 taken = takeJobs();
+        lock.lock();
+        activeWorkers--;
+        remainingJobs -= taken;
+        if (remainingJobs == 0 && activeWorkers == 0) {
+            done.notify_one();
+        }
+    }
+}
+
+} // namespace services
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "../Defines.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * Persistent threads for the per-frame parallel work (animation for now).
+ *
+ * Starting a thread per job every frame costs a thread creation, a join and an
+ * affinity change each time. The pool's threads start once, pin themselves to the
+ * worker CPUs and name themselves, then sleep until a batch of jobs comes.
+ *
+ * run() hands out job indices through an atomic counter: the calling thread takes
+ * jobs too, and returns once every job is done and every worker is out of the batch.
+ * One batch at a time; jobs must not call run().
+ *
+ * Start the pool after Platform::setWorkerCpus(), threads started before stay where
+ * they were created. Without start(), the first run() starts it with the defaults.
+ */
+
+namespace services {
+
+class WorkerPool {
+public:
+    static WorkerPool& Instance() {
+        static WorkerPool instance;
+        return instance;
+    }
+
+    // 0 for one thread per hardware thread but the caller's. Nothing happens when already started
+    void start(u32 threadCount = 0);
+    // Joins the workers. Not while a batch runs
+    void stop();
+
+    // Calls job(i) for every i below jobCount, on the workers and the calling thread. Blocks until done
+    void run(u32 jobCount, const std::function<void(u32)>& job);
+
+    u32 getThreadCount() const { return static_cast<u32>(threads.size()); }
+
+private:
+    WorkerPool() = default;
+    ~WorkerPool() { stop(); }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Callers hold runMutex
+    void startThreads(u32 threadCount);
+    void workerLoop();
+    // Runs jobs of the current batch until none is left, returns how many
+    u32 takeJobs();
+
+    std::mutex runMutex;                    // One batch at a time
+    vector<std::thread> threads;
+
+    std::mutex mutex;                       // Guards everything below but nextJob
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(u32)>* job { nullptr };
+    u32 jobCount { 0 };
+    u32 remainingJobs { 0 };
+    u32 activeWorkers { 0 };                // Inside the current batch
+    u64 batch { 0 };
+    bool batchOpen { false };
+    bool stopping { false };
+    std::atomic<u32> nextJob { 0 };
+};
+
+} // namespace services
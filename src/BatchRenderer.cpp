@@ -0,0 +1,118 @@
+#include "BatchRenderer.h"
+#include "Benchmark.h"
+#include "BasicServices/Log.h"
+#include "BasicServices/Profiler.h"
+#include "Graphics/Camera.h"
+#include <algorithm>
+#include <fmt/format.h>
+#include <fstream>
+#include <sstream>
+
+using services::Log;
+
+namespace {
+    bool parseFormat(const str& text, graphics::ImageFileFormat& format) {
+        if (text == "png") format = graphics::ImageFileFormat::Png;
+        else if (text == "exr") format = graphics::ImageFileFormat::Exr;
+        else return false;
+        return true;
+    }
+}
+
+bool BatchJob::loadList(const str& path, vector<BatchJob>& jobs) {
+    std::ifstream file(path);
+    if (!file) {
+        Log::Error("Batch: cannot open job list %s", path.c_str());
+        return false;
+    }
+
+    str line;
+    u32 lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (const size_t comment = line.find('#'); comment != str::npos) {
+            line.erase(comment);
+        }
+        std::istringstream fields(line);
+        BatchJob job;
+        if (!(fields >> job.name)) continue;   // Blank line
+
+        f32 yawDegrees = 0.f;
+        f32 pitchDegrees = 0.f;
+        str format { "png" };
+        if (!(fields >> job.scene >> job.technique >> job.position.x >> job.position.y >> job.position.z
+                    >> yawDegrees >> pitchDegrees)) {
+            Log::Error("Batch: %s:%u: expected name scene technique x y z yaw pitch [png|exr]", path.c_str(), lineNumber);
+            return false;
+        }
+        fields >> format;
+        if (!parseFormat(format, job.format)) {
+            Log::Error("Batch: %s:%u: unknown format '%s' (png, exr)", path.c_str(), lineNumber, format.c_str());
+            return false;
+        }
+        if (job.technique == "-") job.technique.clear();
+        job.yaw = glm::radians(yawDegrees);
+        job.pitch = glm::radians(pitchDegrees);
+        jobs.push_back(std::move(job));
+    }
+    return true;
+}
+
+vector<BatchJob> BatchJob::orbit(const str& scene, const str& technique, const BenchmarkCameraPath& path,
+                                 u32 count, graphics::ImageFileFormat format) {
+    vector<BatchJob> jobs(count);
+    for (u32 i = 0; i < count; i++) {
+        graphics::Camera camera;
+        path.place(static_cast<f32>(i) / static_cast<f32>(count), camera);
+
+        BatchJob& job = jobs[i];
+        job.name = fmt::format("{}_{:04}", scene, i);
+        job.scene = scene;
+        job.technique = technique;
+        job.position = camera.position;
+        job.yaw = camera.yaw;
+        job.pitch = camera.pitch;
+        job.format = format;
+    }
+    return jobs;
+}
+
+void BatchImageWriter::init(u32 maxInFlight, const str& directory) {
+    this->directory = directory;
+    this->maxInFlight = std::max(maxInFlight, 1u);
+}
+
+void BatchImageWriter::acquire() {
+    PROFILE_ZONE("Batch Image Wait");
+    std::unique_lock lock(mutex);
+    released.wait(lock, [this] { return inFlight < maxInFlight; });
+    inFlight++;
+}
+
+void BatchImageWriter::write(const graphics::Readback& readback, const BatchJob& job) {
+    const u64 start = services::Profiler::now();
+    bool written = false;
+    if (readback.data.empty()) {
+        Log::Error("Batch: the image of job '%s' was not read back", job.name.c_str());
+    } else {
+        PROFILE_ZONE("Encode Image");
+        const str path = fmt::format("{}/{}.{}", directory, job.name, graphics::getExtension(job.format));
+        const std::span<const u16> pixels(reinterpret_cast<const u16*>(readback.data.data()), readback.data.size() / sizeof(u16));
+        written = graphics::writeImage(path, job.format, readback.extent.width, readback.extent.height, pixels);
+    }
+    const f32 elapsedMs = services::Profiler::toMilliseconds(services::Profiler::now() - start);
+
+    {
+        std::lock_guard lock(mutex);
+        inFlight--;
+        if (written) imagesWritten++;
+        else failures++;
+        encodeMs += elapsedMs;
+    }
+    released.notify_all();
+}
+
+void BatchImageWriter::waitIdle() {
+    std::unique_lock lock(mutex);
+    released.wait(lock, [this] { return inFlight == 0; });
+}
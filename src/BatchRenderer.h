@@ -0,0 +1,73 @@
+#pragma once
+#include "Defines.h"
+#include "Graphics/ImageWriter.h"
+#include "Graphics/ReadbackRing.h"
+#include <condition_variable>
+#include <mutex>
+
+struct BenchmarkCameraPath;
+
+// One image of a batch: what to draw, from where, and the file it goes to
+struct BatchJob {
+    str name;                       // Output file name, without directory nor extension
+    str scene { "shadow" };         // basic | shadow | deferred
+    str technique;                  // Empty: the scene's own technique. Else basic | shadow | deferred
+    Vec3 position { 0.f };
+    f32 yaw { 0.f };                // Radians, as graphics::Camera
+    f32 pitch { 0.f };
+    graphics::ImageFileFormat format { graphics::ImageFileFormat::Png };
+
+    // Job list, one job per line, '#' starts a comment:
+    //   name scene technique|- x y z yaw_degrees pitch_degrees [png|exr]
+    static bool loadList(const str& path, vector<BatchJob>& jobs);
+    // count views of a scene, evenly spaced along its benchmark orbit
+    static vector<BatchJob> orbit(const str& scene, const str& technique, const BenchmarkCameraPath& path,
+                                  u32 count, graphics::ImageFileFormat format);
+};
+
+/**
+ * Writes the final images of a batch to files without making the GPU wait on the disk.
+ *
+ * Each frame reads its final image back through the renderer's ReadbackRing
+ * (Renderer::readFinalImage). The copy lands in persistently mapped memory and,
+ * once the frame's fence has signaled, write() encodes it on a readback worker.
+ *
+ * The render loop only waits in acquire(), when maxInFlight images are still
+ * being copied or written: the disk is then the bottleneck. maxInFlight must be
+ * above FRAME_OVERLAP, or the loop would wait for copies only it can deliver, and
+ * the ring's budget must hold that many images, or their copies are dropped.
+ */
+class BatchImageWriter {
+public:
+    BatchImageWriter() = default;
+
+    BatchImageWriter(const BatchImageWriter&) = delete;
+    BatchImageWriter& operator=(const BatchImageWriter&) = delete;
+
+    void init(u32 maxInFlight, const str& directory);
+
+    // Takes a place for the next image. Blocks while maxInFlight images are not written yet. Render thread
+    void acquire();
+    // Readback callback of an acquired image: writes it and gives its place back. Readback worker
+    void write(const graphics::Readback& readback, const BatchJob& job);
+    // Blocks until every acquired image is written
+    void waitIdle();
+
+    // Totals, read after waitIdle()
+    u32 getImagesWritten() const { return imagesWritten; }
+    u32 getFailures() const { return failures; }
+    f64 getEncodeMs() const { return encodeMs; }   // Summed over all workers
+
+private:
+    str directory;
+    u32 maxInFlight { 1 };
+
+    std::mutex mutex;
+    std::condition_variable released;
+    u32 inFlight { 0 };
+
+    // Guarded by mutex
+    u32 imagesWritten { 0 };
+    u32 failures { 0 };
+    f64 encodeMs { 0.0 };
+};
@@ -0,0 +1,255 @@
+#include "Benchmark.h"
+#include "BasicServices/FileWriter.h"
+#include "BasicServices/Log.h"
+#include "BasicServices/RenderingStats.h"
+#include "Graphics/Camera.h"
+#include "Graphics/GpuProfiler.h"
+#include "Graphics/MemoryTracker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fmt/format.h>
+#include <glm/gtc/constants.hpp>
+
+using services::Log;
+
+namespace {
+    struct Summary {
+        f32 min { 0.f };
+        f32 average { 0.f };
+        f32 p50 { 0.f };
+        f32 p90 { 0.f };
+        f32 p95 { 0.f };
+        f32 p99 { 0.f };
+        f32 max { 0.f };
+    };
+
+    Summary summarize(vector<f32> samples) {
+        Summary summary;
+        if (samples.empty()) return summary;
+
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [&](f32 fraction) {
+            const size_t index = static_cast<size_t>(fraction * static_cast<f32>(samples.size() - 1) + 0.5f);
+            return samples[std::min(index, samples.size() - 1)];
+        };
+
+        f64 sum = 0.0;
+        for (const f32 sample : samples) {
+            sum += sample;
+        }
+
+        summary.min = samples.front();
+        summary.average = static_cast<f32>(sum / static_cast<f64>(samples.size()));
+        summary.p50 = percentile(0.50f);
+        summary.p90 = percentile(0.90f);
+        summary.p95 = percentile(0.95f);
+        summary.p99 = percentile(0.99f);
+        summary.max = samples.back();
+        return summary;
+    }
+
+    str toJson(const Summary& s, size_t count) {
+        return fmt::format("{{\"samples\":{},\"min_ms\":{:.4f},\"avg_ms\":{:.4f},\"p50_ms\":{:.4f},\"p90_ms\":{:.4f},"
+                           "\"p95_ms\":{:.4f},\"p99_ms\":{:.4f},\"max_ms\":{:.4f}}}",
+                           count, s.min, s.average, s.p50, s.p90, s.p95, s.p99, s.max);
+    }
+
+    bool parseU32(const char* text, u32& out) {
+        char* end = nullptr;
+        const unsigned long value = std::strtoul(text, &end, 10);
+        if (end == text || *end != '\0') return false;
+        out = static_cast<u32>(value);
+        return true;
+    }
+}
+
+std::optional<BenchmarkSettings> BenchmarkSettings::fromArguments(int argc, char* argv[]) {
+    bool bench = false;
+    BenchmarkSettings settings;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--bench") == 0) {
+            bench = true;
+            continue;
+        }
+        if (!value) {
+            Log::Warn("Benchmark: missing value for %s", arg);
+            continue;
+        }
+
+        bool valid = true;
+        if (std::strcmp(arg, "--scene") == 0) settings.scene = value;
+        else if (std::strcmp(arg, "--technique") == 0) settings.technique = value;
+        else if (std::strcmp(arg, "--width") == 0) valid = parseU32(value, settings.width);
+        else if (std::strcmp(arg, "--height") == 0) valid = parseU32(value, settings.height);
+        else if (std::strcmp(arg, "--warmup") == 0) valid = parseU32(value, settings.warmupFrames);
+        else if (std::strcmp(arg, "--frames") == 0) valid = parseU32(value, settings.frames);
+        else if (std::strcmp(arg, "--output") == 0) settings.output = value;
+        else if (std::strcmp(arg, "--replay") == 0) settings.replay = value;
+        else if (std::strcmp(arg, "--repeat") == 0) valid = parseU32(value, settings.repeat);
+        else if (std::strcmp(arg, "--batch") == 0) settings.batch = value;
+        else if (std::strcmp(arg, "--images") == 0) settings.imageDirectory = value;
+        else if (std::strcmp(arg, "--views") == 0) valid = parseU32(value, settings.views) && settings.views > 0;
+        else if (std::strcmp(arg, "--format") == 0) {
+            valid = std::strcmp(value, "png") == 0 || std::strcmp(value, "exr") == 0;
+            if (valid) settings.imageFormat = value;
+        }
+        else {
+            Log::Warn("Benchmark: unknown argument %s", arg);
+            continue;
+        }
+
+        if (!valid) {
+            Log::Warn("Benchmark: invalid value '%s' for %s", value, arg);
+        }
+        i++;
+    }
+
+    // A batch is a headless run too
+    if (!bench && settings.batch.empty()) return std::nullopt;
+
+    settings.width = std::max(settings.width, 1u);
+    settings.height = std::max(settings.height, 1u);
+    settings.frames = std::max(settings.frames, 1u);
+    settings.repeat = std::max(settings.repeat, 1u);
+    return settings;
+}
+
+Benchmark::Benchmark(const BenchmarkSettings& settings) : settings(settings) {
+    cpuFrameTimes.reserve(settings.frames);
+    gpuFrameTimes.reserve(settings.frames);
+}
+
+void BenchmarkCameraPath::place(f32 t, graphics::Camera& camera) const {
+    const f32 angle = t * glm::two_pi<f32>();
+
+    camera.position = center + Vec3(
+        std::sin(angle) * radius,
+        height + std::sin(angle * 2.f) * heightVariation,
+        std::cos(angle) * radius);
+    camera.velocity = Vec3(0.f);
+
+    // Camera looks down -Z at yaw 0, yaw turns around -Y
+    const Vec3 direction = center - camera.position;
+    camera.yaw = std::atan2(direction.x, -direction.z);
+    camera.pitch = std::atan2(direction.y, std::sqrt(direction.x * direction.x + direction.z * direction.z));
+}
+
+void Benchmark::placeCamera(u32 frame, graphics::Camera& camera, f32 phase) const {
+    // Warm-up frames stay at the start of the path; measured frames do one full orbit
+    const u32 measuredFrame = frame > settings.warmupFrames ? frame - settings.warmupFrames : 0;
+    const f32 t = static_cast<f32>(std::min(measuredFrame, settings.frames)) / static_cast<f32>(settings.frames);
+    cameraPath.place(phase > 0.f ? std::fmod(t + phase, 1.f) : t, camera);
+}
+
+void Benchmark::begin(const graphics::GpuProfiler& profiler) {
+    firstProfilerFrame = profiler.getFrameCount();
+}
+
+void Benchmark::recordFrame(u32 frame, f32 cpuFrameMs, const graphics::GpuProfiler& profiler) {
+    if (isMeasured(frame)) {
+        cpuFrameTimes.push_back(cpuFrameMs);
+
+        const auto& stats = services::RenderingStats::Instance();
+        counters.drawCalls += stats.drawcallCount;
+        counters.shadowDrawCalls += stats.shadowDrawcallCount;
+        counters.triangles += stats.triangleCount;
+        counters.barriers += stats.barrierCount;
+        counters.descriptorSets += stats.descriptorSetCount;
+    }
+
+    // GPU results arrive a few frames late: map the resolved frame back to a benchmark frame
+    const u64 resolved = profiler.getLastResolvedFrame();
+    if (resolved == UINT64_MAX || resolved == lastRecordedGpuFrame || resolved < firstProfilerFrame) return;
+    lastRecordedGpuFrame = resolved;
+    if (!isMeasured(static_cast<u32>(resolved - firstProfilerFrame))) return;
+
+    gpuFrameTimes.push_back(profiler.getLastFrameMs());
+    for (const graphics::GpuPassSample& sample : profiler.getLastFrameSamples()) {
+        auto it = std::find_if(passes.begin(), passes.end(),
+            [&](const PassSamples& pass) { return pass.name == sample.name; });
+        if (it == passes.end()) {
+            passes.push_back({ sample.name, {} });
+            it = passes.end() - 1;
+        }
+        it->samples.push_back(sample.ms);
+    }
+}
+
+void Benchmark::recordMemory(const graphics::MemoryTracker& tracker) {
+    gpuBytes = 0;
+    gpuPeakBytes = 0;
+    for (const auto& category : tracker.getCategoryStats()) {
+        gpuBytes += category.bytes;
+        gpuPeakBytes += category.peakBytes;
+    }
+
+    cpuBytes = 0;
+    for (const auto& counter : tracker.getCpuCounters()) {
+        cpuBytes += counter.bytes;
+    }
+}
+
+void Benchmark::recordThroughput(u32 images, f64 seconds, f64 encodeMs) {
+    throughput = { images, seconds, encodeMs };
+}
+
+bool Benchmark::writeReport(const str& deviceName, const str& techniqueName) const {
+    services::FileWriter writer;
+    if (!writer.open(settings.output)) {
+        Log::Error("Benchmark: cannot open %s", settings.output.c_str());
+        return false;
+    }
+
+    const Summary cpu = summarize(cpuFrameTimes);
+    const Summary gpu = summarize(gpuFrameTimes);
+
+    writer.writeLine("{");
+    writer.writeLine(fmt::format("  \"device\": \"{}\",", deviceName));
+    writer.writeLine(fmt::format("  \"scene\": \"{}\",", settings.scene));
+    writer.writeLine(fmt::format("  \"technique\": \"{}\",", techniqueName));
+    writer.writeLine(fmt::format("  \"width\": {},", settings.width));
+    writer.writeLine(fmt::format("  \"height\": {},", settings.height));
+    writer.writeLine(fmt::format("  \"warmup_frames\": {},", settings.warmupFrames));
+    writer.writeLine(fmt::format("  \"frames\": {},", settings.frames));
+    writer.writeLine(fmt::format("  \"views\": {},", settings.views));
+    writer.writeLine(fmt::format("  \"cpu_frame\": {},", toJson(cpu, cpuFrameTimes.size())));
+    writer.writeLine(fmt::format("  \"gpu_frame\": {},", toJson(gpu, gpuFrameTimes.size())));
+
+    // Averages per measured frame
+    const f64 measured = static_cast<f64>(std::max<size_t>(cpuFrameTimes.size(), 1));
+    writer.writeLine(fmt::format("  \"counters\": {{\"draw_calls\":{:.2f},\"shadow_draw_calls\":{:.2f},\"triangles\":{:.2f},"
+                                 "\"barriers\":{:.2f},\"descriptor_sets\":{:.2f}}},",
+                                 counters.drawCalls / measured, counters.shadowDrawCalls / measured, counters.triangles / measured,
+                                 counters.barriers / measured, counters.descriptorSets / measured));
+    writer.writeLine(fmt::format("  \"memory\": {{\"gpu_bytes\":{},\"gpu_peak_bytes\":{},\"cpu_bytes\":{}}},",
+                                 gpuBytes, gpuPeakBytes, cpuBytes));
+    if (throughput.images > 0) {
+        writer.writeLine(fmt::format("  \"throughput\": {{\"images\":{},\"seconds\":{:.4f},\"images_per_second\":{:.3f},"
+                                     "\"avg_encode_ms\":{:.4f}}},",
+                                     throughput.images, throughput.seconds,
+                                     static_cast<f64>(throughput.images) / std::max(throughput.seconds, 1e-9),
+                                     throughput.encodeMs / static_cast<f64>(throughput.images)));
+    }
+    writer.writeLine("  \"gpu_passes\": {");
+    for (size_t i = 0; i < passes.size(); i++) {
+        writer.writeLine(fmt::format("    \"{}\": {}{}", passes[i].name,
+            toJson(summarize(passes[i].samples), passes[i].samples.size()), i + 1 < passes.size() ? "," : ""));
+    }
+    writer.writeLine("  }");
+    writer.writeLine("}");
+    writer.close();
+
+    Log::Info("Benchmark: %zu frames, CPU avg %.3f ms p99 %.3f ms, GPU avg %.3f ms p99 %.3f ms -> %s",
+        cpuFrameTimes.size(), cpu.average, cpu.p99, gpu.average, gpu.p99, settings.output.c_str());
+    if (throughput.images > 0) {
+        Log::Info("Benchmark: %u images in %.2f s, %.2f images/s, encode avg %.2f ms", throughput.images, throughput.seconds,
+            static_cast<f64>(throughput.images) / std::max(throughput.seconds, 1e-9), throughput.encodeMs / throughput.images);
+    }
+    return true;
+}
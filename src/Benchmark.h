@@ -0,0 +1,113 @@
+#pragma once
+#include "Defines.h"
+#include "Graphics/Types.h"
+#include <optional>
+
+namespace graphics {
+    class Camera;
+    class GpuProfiler;
+    class MemoryTracker;
+}
+
+// Command line options of the headless benchmark (meadows --bench ...)
+struct BenchmarkSettings {
+    str scene { "shadow" };         // basic | shadow | deferred
+    str technique;                  // Empty: the scene's own technique. Else basic | shadow | deferred
+    u32 width { 1920 };
+    u32 height { 1080 };
+    u32 warmupFrames { 60 };        // Rendered but not measured (pipeline caches, driver warm-up)
+    u32 frames { 600 };             // Measured frames
+    str output { "bench_report.json" };
+    str replay;                     // Frame capture to play back instead of the camera orbit (see FrameCapture)
+    u32 repeat { 10 };              // Replay: measured frames = captured frames x repeat
+    str batch;                      // Job list to render to image files, or "orbit" for `frames` views of the scene (see BatchRenderer)
+    str imageDirectory { "batch" }; // Where batch images are written
+    str imageFormat { "png" };      // png | exr, for orbit batches
+    u32 views { 1 };                // Cameras per frame: the orbit, plus insets further along it (see graphics::FrameViews)
+
+    // Returns settings when --bench is on the command line, nullopt otherwise
+    static std::optional<BenchmarkSettings> fromArguments(int argc, char* argv[]);
+};
+
+// Deterministic camera orbit, the same for every run of a scene
+struct BenchmarkCameraPath {
+    Vec3 center { 0.f };            // Point the camera looks at
+    f32 radius { 10.f };            // Horizontal distance to the center
+    f32 height { 5.f };             // Height above the center
+    f32 heightVariation { 0.f };    // Amplitude of a slow up/down motion
+
+    // Places the camera at t in [0, 1] along one orbit, looking at the center
+    void place(f32 t, graphics::Camera& camera) const;
+};
+
+/**
+ * Collects CPU and GPU timings of a headless run and writes them as JSON.
+ *
+ * Frames 0..warmup-1 are not measured. GPU timestamps are read FRAME_OVERLAP
+ * frames after a frame is recorded, so the run is extended by FRAME_OVERLAP
+ * frames to resolve the last measured ones; those extra frames are not measured either.
+ *
+ * Besides timings, the report holds the average per-frame counters (draw calls,
+ * barriers, descriptor sets) and the memory totals: the perf-check gate compares
+ * all of them to perf/baseline.json.
+ */
+class Benchmark {
+public:
+    explicit Benchmark(const BenchmarkSettings& settings);
+
+    void setCameraPath(const BenchmarkCameraPath& path) { cameraPath = path; }
+    u32 getTotalFrames() const { return settings.warmupFrames + settings.frames + FRAME_OVERLAP; }
+    bool isMeasured(u32 frame) const { return frame >= settings.warmupFrames && frame < settings.warmupFrames + settings.frames; }
+
+    // Places the camera for this frame. Depends only on the frame index.
+    // phase in [0, 1) moves it further along the orbit, for the other views
+    void placeCamera(u32 frame, graphics::Camera& camera, f32 phase = 0.f) const;
+
+    // Call before the first frame, to map renderer frames to benchmark frames
+    void begin(const graphics::GpuProfiler& profiler);
+    // Call after each frame has been submitted. Also samples the frame's RenderingStats counters
+    void recordFrame(u32 frame, f32 cpuFrameMs, const graphics::GpuProfiler& profiler);
+    // Call after the last frame: memory totals of the run
+    void recordMemory(const graphics::MemoryTracker& tracker);
+    // Batch runs: images written in seconds of wall-clock time, and the encoders' time summed
+    void recordThroughput(u32 images, f64 seconds, f64 encodeMs);
+
+    bool writeReport(const str& deviceName, const str& techniqueName) const;
+
+private:
+    struct PassSamples {
+        str name;
+        vector<f32> samples;
+    };
+
+    BenchmarkSettings settings;
+    BenchmarkCameraPath cameraPath;
+
+    u64 firstProfilerFrame { 0 };
+    u64 lastRecordedGpuFrame { UINT64_MAX };
+    vector<f32> cpuFrameTimes;
+    vector<f32> gpuFrameTimes;
+    vector<PassSamples> passes;
+
+    // Per-frame counters, summed over the measured frames
+    struct Counters {
+        f64 drawCalls { 0.0 };
+        f64 shadowDrawCalls { 0.0 };
+        f64 triangles { 0.0 };
+        f64 barriers { 0.0 };
+        f64 descriptorSets { 0.0 };
+    };
+    Counters counters;
+
+    u64 gpuBytes { 0 };
+    u64 gpuPeakBytes { 0 };
+    u64 cpuBytes { 0 };
+
+    // Batch runs only, no "throughput" section when images is 0
+    struct Throughput {
+        u32 images { 0 };
+        f64 seconds { 0.0 };
+        f64 encodeMs { 0.0 };
+    };
+    Throughput throughput;
+};
@@ -1,5 +1,6 @@
 #include "Engine.h"
 #include "BasicServices/Log.h"
+#include "BasicServices/Profiler.h"
 #include "Graphics/VulkanContext.h"
 #include "Graphics/Renderer.h"
 #include "Graphics/Techniques/BasicTechnique.h"
@@ -8,13 +9,50 @@
 #include "Graphics/KTXLoader.h"
 #include "Graphics/Pipelines/GLTFMetallicRoughness.h"
 #include "Scene.h"
-#include <backends/imgui_impl_sdl3.h>
 
 #include "BasicServices/RenderingStats.h"
+#include "BasicServices/FrameHistory.h"
+#include "BasicServices/FramePacer.h"
+#include "BasicServices/Platform.h"
+#include "BasicServices/WorkerPool.h"
 #include <glm/gtx/transform.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fmt/format.h>
 
 using services::Log;
 
+namespace {
+    constexpr u32 CAPTURE_FRAME_COUNT = 60;
+    constexpr const char* CAPTURE_PATH = "frame_capture.mcap";
+
+    // Models do not change after loading (the armor material is written last): report them once
+    void reportModelMemory(graphics::MemoryTracker& tracker, const char* name, const sptr<graphics::LoadedGLTF>& model) {
+        if (!model) return;
+        tracker.setCpuCounter(name, model->getCpuMemory(), model->nodes.size());
+        tracker.setDescriptorPools(name, model->descriptorPool.getUsage());
+    }
+
+    str formatCpus(const vector<u32>& cpus) {
+        str text;
+        for (const u32 cpu : cpus) {
+            if (!text.empty()) text += ",";
+            text += std::to_string(cpu);
+        }
+        return text.empty() ? "any" : text;
+    }
+
+    // Names, pins and prioritizes the calling thread. Failures only cost frame-time stability
+    void placeThread(const char* name, const vector<u32>& cpus, services::ThreadPriority priority) {
+        services::Platform::setThreadName(name);
+        if (!cpus.empty() && !services::Platform::setThreadAffinity(cpus)) {
+            Log::Warn("%s thread: could not pin to CPUs %s", name, formatCpus(cpus).c_str());
+        }
+        if (!services::Platform::setThreadPriority(priority)) {
+            Log::Debug("%s thread: priority not changed (CAP_SYS_NICE needed to raise it)", name);
+        }
+    }
+}
 
 Engine::~Engine() {
     cleanup();
@@ -38,7 +76,37 @@ void Engine::init() {
     Log::Info("Engine Initialized");
 }
 
+void Engine::initBenchmark(const BenchmarkSettings& settings) {
+    benchmarkSettings = settings;
+
+    // No SDL window: the context renders offscreen at the requested resolution
+    vulkanContext = std::make_unique<VulkanContext>(vk::Extent2D { settings.width, settings.height });
+    try {
+        vulkanContext->init();
+    } catch (const std::exception& e) {
+        Log::Error("Vulkan Initialization Error: %s", e.what());
+        cleanup();
+        exit(-1);
+    }
+
+    renderer = std::make_unique<Renderer>(vulkanContext.get());
+    renderer->init();
+
+    initScenes();
+
+    Log::Info("Engine Initialized (headless benchmark, %ux%u)", settings.width, settings.height);
+}
+
 void Engine::initScenes() {
+    // Start reading every file: they parse on workers while the techniques build their pipelines.
+    // The renderer already asked for structure.glb, both get the same model
+    auto& loader = renderer->getSceneLoader();
+    loader.requestGltf(Renderer::STRUCTURE_SCENE_PATH);
+    loader.requestGltf("assets/vulkanscene_shadow.gltf");
+    loader.requestGltf("assets/armor/armor.gltf");
+    loader.requestKtx("assets/armor/colormap_rgba.ktx");
+    loader.requestKtx("assets/armor/normalmap_rgba.ktx");
+
     // Initialize rendering techniques
     basicTechnique = std::make_unique<graphics::techniques::BasicTechnique>();
     basicTechnique->init(renderer.get());
@@ -49,14 +117,22 @@ void Engine::initScenes() {
     deferredTechnique = std::make_unique<graphics::techniques::DeferredRenderingTechnique>();
     deferredTechnique->init(renderer.get());
 
+    // Ambient particles, shared by every scene (disabled until toggled in the UI)
+    auto& particles = renderer->getParticleSystem();
+    particles.addEmitter(graphics::techniques::ParticleEmitterSettings::dust());
+    particles.addEmitter(graphics::techniques::ParticleEmitterSettings::pollen());
+    particles.addEmitter(graphics::techniques::ParticleEmitterSettings::fireflies());
+
+    // Creates every file's GPU resources as its worker finishes, then uploads them all at once
+    renderer->finishLoading();
+
     // Create scene with basic technique (no shadows)
     basicScene = std::make_unique<Scene>(renderer.get());
     basicScene->setRenderingTechnique(basicTechnique.get());
 
     // Load a model into the basic scene
-    auto basicModel = graphics::loadGltf(renderer.get(), "assets/structure.glb");
-    if (basicModel.has_value()) {
-        basicSceneModel = *basicModel;
+    basicSceneModel = loader.getGltf(Renderer::STRUCTURE_SCENE_PATH);
+    if (basicSceneModel) {
         Log::Info("Loaded model for basic scene");
     }
 
@@ -65,9 +141,8 @@ void Engine::initScenes() {
     shadowScene->setRenderingTechnique(shadowMappingTechnique.get());
 
     // Load a model into the shadow scene (same as VulkanDemo shadowmapping example)
-    auto shadowModel = graphics::loadGltf(renderer.get(), "assets/vulkanscene_shadow.gltf");
-    if (shadowModel.has_value()) {
-        shadowSceneModel = *shadowModel;
+    shadowSceneModel = loader.getGltf("assets/vulkanscene_shadow.gltf");
+    if (shadowSceneModel) {
         Log::Info("Loaded model for shadow scene");
     }
 
@@ -76,9 +151,8 @@ void Engine::initScenes() {
     deferredScene->setRenderingTechnique(deferredTechnique.get());
 
     // Load a model into the deferred scene (armor model from Sascha Willems)
-    auto deferredModel = graphics::loadGltf(renderer.get(), "assets/armor/armor.gltf");
-    if (deferredModel.has_value()) {
-        deferredSceneModel = *deferredModel;
+    deferredSceneModel = loader.getGltf("assets/armor/armor.gltf");
+    if (deferredSceneModel) {
         Log::Info("Loaded model for deferred scene: %zu meshes, %zu topNodes",
             deferredSceneModel->meshes.size(), deferredSceneModel->topNodes.size());
 
@@ -89,9 +163,9 @@ void Engine::initScenes() {
             Log::Debug("  Mesh '%s': %zu surfaces", name.c_str(), mesh->surfaces.size());
         }
 
-        // Load KTX textures for the armor model
-        armorColorMap = graphics::loadKTXImage(renderer.get(), "assets/armor/colormap_rgba.ktx");
-        armorNormalMap = graphics::loadKTXImage(renderer.get(), "assets/armor/normalmap_rgba.ktx");
+        // KTX textures for the armor model, owned by the loader
+        armorColorMap = loader.getKtx("assets/armor/colormap_rgba.ktx");
+        armorNormalMap = loader.getKtx("assets/armor/normalmap_rgba.ktx");
 
         if (armorColorMap.has_value()) {
             Log::Info("Loaded armor color map KTX texture");
@@ -101,7 +175,9 @@ void Engine::initScenes() {
                 vulkanContext.get(),
                 sizeof(graphics::pipelines::GLTFMetallicRoughness::MaterialConstants),
                 vk::BufferUsageFlagBits::eUniformBuffer,
-                VMA_MEMORY_USAGE_CPU_TO_GPU
+                VMA_MEMORY_USAGE_CPU_TO_GPU,
+                graphics::MemoryCategory::Uniform,
+                "Armor material constants"
             );
 
             // Set material constants
@@ -139,6 +215,16 @@ void Engine::initScenes() {
         }
     }
 
+    graphics::MemoryTracker& memoryTracker = vulkanContext->getMemoryTracker();
+    reportModelMemory(memoryTracker, "glTF structure", basicSceneModel);
+    reportModelMemory(memoryTracker, "glTF vulkanscene_shadow", shadowSceneModel);
+    reportModelMemory(memoryTracker, "glTF armor", deferredSceneModel);
+
+    // Captured draws refer to these paths
+    if (basicSceneModel) frameCapture.registerModel(Renderer::STRUCTURE_SCENE_PATH, *basicSceneModel);
+    if (shadowSceneModel) frameCapture.registerModel("assets/vulkanscene_shadow.gltf", *shadowSceneModel);
+    if (deferredSceneModel) frameCapture.registerModel("assets/armor/armor.gltf", *deferredSceneModel);
+
     // Set the default active scene
     setActiveScene(basicScene.get());
 }
@@ -182,15 +268,11 @@ void Engine::cleanup() {
     // Wait for device to be idle before destroying renderer
     vulkanContext->getDevice().waitIdle();
 
-    // Cleanup KTX textures
-    if (armorColorMap.has_value()) {
-        armorColorMap->destroy(vulkanContext.get());
-        armorColorMap.reset();
-    }
-    if (armorNormalMap.has_value()) {
-        armorNormalMap->destroy(vulkanContext.get());
-        armorNormalMap.reset();
-    }
+    services::WorkerPool::Instance().stop();
+
+    // KTX textures are destroyed with the renderer's scene loader
+    armorColorMap.reset();
+    armorNormalMap.reset();
     armorMaterialBuffer.destroy();
 
     // Cleanup loaded models
@@ -223,8 +305,10 @@ void Engine::cleanup() {
     renderer.reset();
     vulkanContext.reset();
 
-    SDL_DestroyWindow(window);
-    window = nullptr;
+    if (window) {
+        SDL_DestroyWindow(window);
+        window = nullptr;
+    }
 
     Log::Info("Engine Cleaned Up");
     SDL_Quit();
@@ -239,6 +323,290 @@ void Engine::run() {
     mainLoop();
 }
 
+int Engine::runBenchmark() {
+    if (!renderer || !benchmarkSettings) {
+        Log::Critical("Engine not initialized for benchmarking. Quitting.");
+        return 1;
+    }
+    if (!benchmarkSettings->replay.empty()) {
+        return runReplay();
+    }
+    if (!benchmarkSettings->batch.empty()) {
+        return runBatch();
+    }
+    const BenchmarkSettings& settings = *benchmarkSettings;
+
+    BenchmarkCameraPath path;
+    Scene* scene = findBenchmarkScene(settings.scene, path);
+    if (!scene) {
+        Log::Error("Benchmark: unknown scene '%s' (basic, shadow, deferred)", settings.scene.c_str());
+        return 1;
+    }
+
+    if (!settings.technique.empty()) {
+        graphics::techniques::IRenderingTechnique* technique = findTechnique(settings.technique);
+        if (!technique) {
+            Log::Error("Benchmark: unknown technique '%s' (basic, shadow, deferred)", settings.technique.c_str());
+            return 1;
+        }
+        scene->setRenderingTechnique(technique);
+    }
+
+    setActiveScene(scene);
+    // Wall-clock light animation would make runs differ
+    renderer->setAnimateLight(false);
+
+    // Extra views: insets in a row along the top of the frame, further along the orbit
+    const u32 viewCount = std::min(settings.views, graphics::FrameViews::MAX_VIEWS);
+    vector<graphics::RenderView>& views = renderer->getViews();
+    views.clear();
+    for (u32 i = 1; i < viewCount; i++) {
+        const f32 width = 1.f / static_cast<f32>(viewCount - 1);
+        views.push_back(graphics::RenderView { fmt::format("Inset {}", i), {}, { static_cast<f32>(i - 1) * width, 0.f, width, 0.25f } });
+    }
+
+    Benchmark benchmark(settings);
+    benchmark.setCameraPath(path);
+    benchmark.begin(renderer->getGpuProfiler());
+
+    Log::Info("Benchmark: %s / %s, %u warm-up + %u measured frames, %u views",
+        settings.scene.c_str(), scene->getRenderingTechnique()->getName().c_str(), settings.warmupFrames, settings.frames, viewCount);
+
+    // Fixed time step: animations advance the same way whatever the frame rate
+    constexpr f32 FIXED_DELTA_TIME = 1.0f / 60.0f;
+    PROFILE_THREAD_NAME("Main");
+    for (u32 frame = 0; frame < benchmark.getTotalFrames(); frame++) {
+        PROFILE_ZONE("Frame");
+        const u64 frameStart = services::Profiler::now();
+
+        benchmark.placeCamera(frame, renderer->mainCamera);
+        for (u32 i = 0; i < views.size(); i++) {
+            benchmark.placeCamera(frame, views[i].camera, static_cast<f32>(i + 1) / static_cast<f32>(viewCount));
+        }
+        updateFrame(FIXED_DELTA_TIME, scene->getDrawContext(), renderer->getSkinningPass().getBatch(), renderer->getFrameIndex());
+        renderer->draw();
+
+        const f32 frameTime = services::Profiler::toMilliseconds(services::Profiler::now() - frameStart);
+        services::RenderingStats::Instance().frameTime = frameTime;
+        benchmark.recordFrame(frame, frameTime, renderer->getGpuProfiler());
+        services::Profiler::Instance().endFrame();
+    }
+
+    vulkanContext->getDevice().waitIdle();
+    views.clear();
+    benchmark.recordMemory(vulkanContext->getMemoryTracker());
+
+    const str deviceName = vulkanContext->getPhysicalDevice().getProperties().deviceName.data();
+    return benchmark.writeReport(deviceName, scene->getRenderingTechnique()->getName()) ? 0 : 1;
+}
+
+int Engine::runReplay() {
+    BenchmarkSettings settings = *benchmarkSettings;
+    if (!frameCapture.load(settings.replay)) {
+        return 1;
+    }
+
+    // The capture's technique, unless overridden on the command line
+    graphics::techniques::IRenderingTechnique* techniques[] = {
+        basicTechnique.get(), shadowMappingTechnique.get(), deferredTechnique.get()
+    };
+    const char* techniqueArguments[] = { "basic", "shadow", "deferred" };
+    graphics::techniques::IRenderingTechnique* technique = nullptr;
+    for (size_t i = 0; i < std::size(techniques); i++) {
+        const bool match = settings.technique.empty()
+            ? techniques[i]->getName() == frameCapture.getTechniqueName()
+            : settings.technique == techniqueArguments[i];
+        if (match) technique = techniques[i];
+    }
+    if (!technique) {
+        Log::Error("Benchmark: unknown technique '%s'",
+            settings.technique.empty() ? frameCapture.getTechniqueName().c_str() : settings.technique.c_str());
+        return 1;
+    }
+
+    // No scene: the draw list comes from the capture
+    setActiveScene(nullptr);
+    renderer->setDrawContext(&replayDrawContext);
+    renderer->setRenderingTechnique(technique);
+
+    // Warm-up and measured frames loop over the captured ones
+    settings.frames = frameCapture.getFrameCount() * settings.repeat;
+    settings.scene = settings.replay;
+    Benchmark benchmark(settings);
+    benchmark.begin(renderer->getGpuProfiler());
+
+    Log::Info("Benchmark: replaying %s with %s, %u captured frames x %u", settings.replay.c_str(),
+        technique->getName().c_str(), frameCapture.getFrameCount(), settings.repeat);
+
+    PROFILE_THREAD_NAME("Main");
+    for (u32 frame = 0; frame < benchmark.getTotalFrames(); frame++) {
+        PROFILE_ZONE("Frame");
+        const u64 frameStart = services::Profiler::now();
+
+        // Captured frame 0 lines up with the first measured frame
+        const u32 capturedFrame = (frame + frameCapture.getFrameCount() - settings.warmupFrames % frameCapture.getFrameCount())
+            % frameCapture.getFrameCount();
+        frameCapture.apply(capturedFrame, *renderer, replayDrawContext);
+        renderer->draw();
+
+        const f32 frameTime = services::Profiler::toMilliseconds(services::Profiler::now() - frameStart);
+        services::RenderingStats::Instance().frameTime = frameTime;
+        benchmark.recordFrame(frame, frameTime, renderer->getGpuProfiler());
+        services::Profiler::Instance().endFrame();
+    }
+
+    vulkanContext->getDevice().waitIdle();
+    renderer->setSceneDataOverride(std::nullopt);
+    benchmark.recordMemory(vulkanContext->getMemoryTracker());
+
+    const str deviceName = vulkanContext->getPhysicalDevice().getProperties().deviceName.data();
+    return benchmark.writeReport(deviceName, technique->getName()) ? 0 : 1;
+}
+
+Scene* Engine::findBenchmarkScene(const str& name, BenchmarkCameraPath& path) const {
+    // Each scene orbits around its model, at roughly the interactive start position
+    if (name == "basic") {
+        path = { Vec3(0.0f, 0.0f, 0.0f), 5.0f, 1.0f, 0.5f };
+        return basicScene.get();
+    }
+    if (name == "shadow") {
+        path = { Vec3(0.0f, 1.0f, 0.0f), 10.0f, 4.0f, 1.0f };
+        return shadowScene.get();
+    }
+    if (name == "deferred") {
+        path = { Vec3(0.0f, 50.0f, 0.0f), 100.0f, 20.0f, 10.0f };
+        return deferredScene.get();
+    }
+    return nullptr;
+}
+
+graphics::techniques::IRenderingTechnique* Engine::findTechnique(const str& name) const {
+    if (name == "basic") return basicTechnique.get();
+    if (name == "shadow") return shadowMappingTechnique.get();
+    if (name == "deferred") return deferredTechnique.get();
+    return nullptr;
+}
+
+int Engine::runBatch() {
+    BenchmarkSettings settings = *benchmarkSettings;
+
+    vector<BatchJob> jobs;
+    if (settings.batch == "orbit") {
+        BenchmarkCameraPath path;
+        if (!findBenchmarkScene(settings.scene, path)) {
+            Log::Error("Batch: unknown scene '%s' (basic, shadow, deferred)", settings.scene.c_str());
+            return 1;
+        }
+        const auto format = settings.imageFormat == "exr" ? graphics::ImageFileFormat::Exr : graphics::ImageFileFormat::Png;
+        jobs = BatchJob::orbit(settings.scene, settings.technique, path, settings.frames, format);
+    } else if (!BatchJob::loadList(settings.batch, jobs)) {
+        return 1;
+    }
+    if (jobs.empty()) {
+        Log::Error("Batch: no job in %s", settings.batch.c_str());
+        return 1;
+    }
+
+    // Resolve every job before rendering the first one: a typo should not cost a half-written batch.
+    // Jobs without a technique keep their scene's own
+    struct ResolvedJob {
+        Scene* scene;
+        graphics::techniques::IRenderingTechnique* technique;
+    };
+    vector<ResolvedJob> resolved;
+    resolved.reserve(jobs.size());
+    for (const BatchJob& job : jobs) {
+        BenchmarkCameraPath path;
+        Scene* scene = findBenchmarkScene(job.scene, path);
+        graphics::techniques::IRenderingTechnique* technique =
+            job.technique.empty() && scene ? scene->getRenderingTechnique() : findTechnique(job.technique);
+        if (!scene || !technique) {
+            Log::Error("Batch: job '%s' has an unknown scene '%s' or technique '%s'",
+                job.name.c_str(), job.scene.c_str(), job.technique.c_str());
+            return 1;
+        }
+        resolved.push_back({ scene, technique });
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(settings.imageDirectory, error);
+    if (error) {
+        Log::Error("Batch: cannot create %s: %s", settings.imageDirectory.c_str(), error.message().c_str());
+        return 1;
+    }
+
+    // One measured frame per job. Warm-up frames render the first job, the trailing
+    // frames the last one, and neither is written
+    settings.frames = static_cast<u32>(jobs.size());
+    settings.scene = settings.batch;
+    Benchmark benchmark(settings);
+    benchmark.begin(renderer->getGpuProfiler());
+
+    // Images are encoded by the readback workers. Frames in flight hold one image each until
+    // their fence signals, workers one each while writing, and one more lets the next frame record
+    graphics::ReadbackRing& readback = renderer->getReadback();
+    const u32 maxInFlight = FRAME_OVERLAP + readback.getWorkerCount() + 1;
+    const vk::DeviceSize imageBytes = static_cast<vk::DeviceSize>(settings.width) * settings.height * 8;  // RGBA16F
+    readback.setBudget(std::max(readback.getBudget(), (maxInFlight + 1) * std::max(imageBytes, graphics::ReadbackRing::CHUNK_SIZE)));
+    BatchImageWriter imageWriter;
+    imageWriter.init(maxInFlight, settings.imageDirectory);
+
+    Log::Info("Batch: %zu images to %s, %u warm-up frames", jobs.size(), settings.imageDirectory.c_str(), settings.warmupFrames);
+
+    constexpr f32 FIXED_DELTA_TIME = 1.0f / 60.0f;
+    Scene* scene = nullptr;
+    graphics::techniques::IRenderingTechnique* technique = nullptr;
+    u64 batchStart = 0;
+    PROFILE_THREAD_NAME("Main");
+    for (u32 frame = 0; frame < benchmark.getTotalFrames(); frame++) {
+        PROFILE_ZONE("Frame");
+        const u64 frameStart = services::Profiler::now();
+        const bool measured = benchmark.isMeasured(frame);
+        const u32 jobIndex = std::min(frame > settings.warmupFrames ? frame - settings.warmupFrames : 0u, settings.frames - 1);
+        const BatchJob& job = jobs[jobIndex];
+
+        if (resolved[jobIndex].scene != scene || resolved[jobIndex].technique != technique) {
+            scene = resolved[jobIndex].scene;
+            technique = resolved[jobIndex].technique;
+            scene->setRenderingTechnique(technique);
+            setActiveScene(scene);
+            // Wall-clock light animation would make images depend on the frame rate
+            renderer->setAnimateLight(false);
+        }
+        renderer->mainCamera.position = job.position;
+        renderer->mainCamera.yaw = job.yaw;
+        renderer->mainCamera.pitch = job.pitch;
+        renderer->mainCamera.velocity = Vec3(0.f);
+
+        if (measured) {
+            if (batchStart == 0) batchStart = frameStart;
+            imageWriter.acquire();
+            renderer->readFinalImage([&imageWriter, &job](const graphics::Readback& image) { imageWriter.write(image, job); });
+        }
+        updateFrame(FIXED_DELTA_TIME, scene->getDrawContext(), renderer->getSkinningPass().getBatch(), renderer->getFrameIndex());
+        renderer->draw();
+
+        const f32 frameTime = services::Profiler::toMilliseconds(services::Profiler::now() - frameStart);
+        services::RenderingStats::Instance().frameTime = frameTime;
+        benchmark.recordFrame(frame, frameTime, renderer->getGpuProfiler());
+        services::Profiler::Instance().endFrame();
+    }
+
+    // The last copies complete here, then their files are written
+    renderer->finishFrames();
+    imageWriter.waitIdle();
+    const f64 seconds = static_cast<f64>(services::Profiler::now() - batchStart) / 1'000'000'000.0;
+
+    vulkanContext->getDevice().waitIdle();
+    benchmark.recordThroughput(imageWriter.getImagesWritten(), seconds, imageWriter.getEncodeMs());
+    benchmark.recordMemory(vulkanContext->getMemoryTracker());
+    const u32 failures = imageWriter.getFailures();
+
+    const str deviceName = vulkanContext->getPhysicalDevice().getProperties().deviceName.data();
+    const bool reported = benchmark.writeReport(deviceName, technique->getName());
+    return reported && failures == 0 ? 0 : 1;
+}
+
 void Engine::initWindow() {
     // Create window with Vulkan flag
     window = SDL_CreateWindow(
@@ -265,48 +633,184 @@ void Engine::initVulkan() {
 }
 
 void Engine::mainLoop() {
+    // From here on the renderer belongs to the render thread, see FramePacket for the ownership rules
+    graphics::Camera camera = renderer->mainCamera;
+    graphics::ImGuiInput& imguiInput = renderer->getImGuiInput();
+    u64 frameNumber = 0;
+
+    // Main and render threads get a fast physical core each, everything else stays off them.
+    // Threads inherit the affinity of their creator: workers spawned later pin themselves
+    const services::CpuTopology& topology = services::Platform::getCpuTopology();
+    threadLayout = services::Platform::planThreadLayout(topology);
+    services::Platform::setWorkerCpus(threadLayout.workerCpus);
+    Log::pinToWorkerCpus();
+    // One pool thread per worker CPU, the main thread takes its share of the jobs
+    services::WorkerPool::Instance().start(static_cast<u32>(threadLayout.workerCpus.size()));
+    Log::Info("CPU: %u logical CPUs, %zu physical cores, %u cache clusters%s", topology.logicalCpuCount,
+        topology.cores.size(), topology.clusterCount, topology.hybrid ? ", hybrid" : "");
+    Log::Info("Threads: main on CPUs %s, render on CPUs %s, workers on CPUs %s", formatCpus(threadLayout.mainCpus).c_str(),
+        formatCpus(threadLayout.renderCpus).c_str(), formatCpus(threadLayout.workerCpus).c_str());
+
+    renderThread = std::thread([this] { renderLoop(); });
+    placeThread("Main", threadLayout.mainCpus, services::ThreadPriority::High);
+
     bool quit = false;
     SDL_Event e;
+    auto lastFrame = std::chrono::steady_clock::now();
+    PROFILE_THREAD_NAME("Main");
+
+    // SDL only lets the main thread query the window: the render thread gets its size in the packets
+    int windowWidth = 0;
+    int windowHeight = 0;
+    SDL_GetWindowSizeInPixels(window, &windowWidth, &windowHeight);
+    bool minimized = (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED) != 0;
 
     while (!quit) {
-        // Begin stats clock
-        auto start = std::chrono::system_clock::now();
+        // Blocks while the render thread is a packet behind: input is sampled as late as possible
+        graphics::FramePacket& packet = framePackets.acquireWrite();
+        {
+            PROFILE_ZONE("Frame Limiter");
+            services::FramePacer::Instance().wait();
+        }
+        PROFILE_ZONE("Simulation");
+        packet.reset();
+        packet.inputTimestamp = services::Profiler::now();
+
+        auto now = std::chrono::steady_clock::now();
+        const f32 deltaTime = std::chrono::duration<f32>(now - lastFrame).count();
+        lastFrame = now;
 
         // Handle events on queue
-        while (SDL_PollEvent(&e)) {
-            ImGui_ImplSDL3_ProcessEvent(&e);
+        {
+            PROFILE_ZONE("Events");
+            const auto handleEvent = [&](const SDL_Event& event) {
+                switch (event.type) {
+                case SDL_EVENT_QUIT:
+                    quit = true;
+                    break;
+                case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                    windowWidth = event.window.data1;
+                    windowHeight = event.window.data2;
+                    break;
+                case SDL_EVENT_WINDOW_MINIMIZED:
+                    minimized = true;
+                    break;
+                case SDL_EVENT_WINDOW_RESTORED:
+                case SDL_EVENT_WINDOW_MAXIMIZED:
+                    minimized = false;
+                    break;
+                default:
+                    break;
+                }
 
-            if (e.type == SDL_EVENT_QUIT) {
-                quit = true;
-            }
+                // Record the next frames for offline replay (meadows --bench --replay)
+                if (event.type == SDL_EVENT_KEY_DOWN && event.key.key == SDLK_F9 && !event.key.repeat) {
+                    packet.captureRequested = true;
+                }
 
-            // Pass events to renderer for camera control
-            renderer->processEvent(e);
-        }
+                imguiInput.processEvent(event);
+                camera.processSDLEvent(event);
+            };
+
+            while (SDL_PollEvent(&e)) {
+                handleEvent(e);
+            }
 
-        // Update active scene DrawContext with loaded model
-        if (activeScene) {
-            activeScene->getDrawContext().opaqueSurfaces.clear();
-            activeScene->getDrawContext().transparentSurfaces.clear();
-
-            if (activeScene == basicScene.get() && basicSceneModel) {
-                basicSceneModel->draw(Mat4{1.f}, activeScene->getDrawContext());
-            } else if (activeScene == shadowScene.get() && shadowSceneModel) {
-                shadowSceneModel->draw(Mat4{1.f}, activeScene->getDrawContext());
-            } else if (activeScene == deferredScene.get() && deferredSceneModel) {
-                // Scale up the armor model (it has internal scale of ~0.03) and center it
-                Mat4 transform = glm::scale(Vec3(30.0f)) * glm::translate(Vec3(0.0f, 2.3f, 0.0f));
-                deferredSceneModel->draw(transform, activeScene->getDrawContext());
+            // Nothing to present while minimized: sleep on the event queue rather than publish
+            // frames the render thread would skip, both threads spinning
+            if (minimized && !quit) {
+                PROFILE_ZONE("Minimized");
+                while (minimized && !quit && SDL_WaitEvent(&e)) {
+                    handleEvent(e);
+                }
+                // Time asleep is neither input latency nor animation time
+                lastFrame = std::chrono::steady_clock::now();
+                packet.inputTimestamp = services::Profiler::now();
             }
+            imguiInput.newFrame(packet.ui);
         }
 
-        renderer->draw();
+        camera.update();
+        packet.frameNumber = frameNumber++;
+        packet.deltaTime = deltaTime;
+        packet.windowExtent = minimized ? vk::Extent2D {} : vk::Extent2D { static_cast<u32>(windowWidth), static_cast<u32>(windowHeight) };
+        packet.camera = camera;
+        renderer->fillCameraData(camera, packet.sceneData);
+
+        updateFrame(deltaTime, packet.drawContext, packet.skinning, static_cast<u32>(packet.frameNumber % FRAME_OVERLAP));
 
-        // End stats clock
-        auto end = std::chrono::system_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        services::RenderingStats::Instance().frameTime = static_cast<float>(elapsed.count()) / 1000.f;
+        packet.lastFrame = quit;
+        framePackets.publish();
     }
 
+    renderThread.join();
     vulkanContext->getDevice().waitIdle();
 }
+
+void Engine::renderLoop() {
+    PROFILE_THREAD_NAME("Render");
+    placeThread("Render", threadLayout.renderCpus, services::ThreadPriority::High);
+    u64 frameStart = services::Profiler::now();
+
+    for (;;) {
+        graphics::FramePacket& packet = framePackets.acquireRead();
+        if (packet.lastFrame) {
+            framePackets.release();
+            break;
+        }
+
+        {
+            PROFILE_ZONE("Frame");
+            if (packet.captureRequested) {
+                frameCapture.start(CAPTURE_FRAME_COUNT, CAPTURE_PATH);
+            }
+
+            renderer->draw(packet);
+            services::FramePacer::Instance().recordLatency(
+                services::Profiler::toMilliseconds(services::Profiler::now() - packet.inputTimestamp));
+            if (activeScene) {
+                frameCapture.record(*renderer, packet.drawContext);
+            }
+        }
+        // The simulation can refill the packet now, while this thread waits on the next one
+        framePackets.release();
+
+        // Frame time is the present-to-present interval of this thread
+        const u64 frameEnd = services::Profiler::now();
+        const f32 frameTime = services::Profiler::toMilliseconds(frameEnd - frameStart);
+        frameStart = frameEnd;
+        services::RenderingStats::Instance().frameTime = frameTime;
+        services::FrameHistory::Instance().endFrame(frameTime);
+        services::Profiler::Instance().endFrame();
+    }
+}
+
+void Engine::updateFrame(f32 deltaTime, graphics::DrawContext& drawContext, graphics::SkinningBatch& skinningBatch, u32 frameIndex) {
+    // Update the draw context with the loaded model
+    if (activeScene) {
+        PROFILE_ZONE("Scene Update");
+        drawContext.opaqueSurfaces.clear();
+        drawContext.transparentSurfaces.clear();
+
+        graphics::LoadedGLTF* activeModel = nullptr;
+        Mat4 transform { 1.f };
+        if (activeScene == basicScene.get()) {
+            activeModel = basicSceneModel.get();
+        } else if (activeScene == shadowScene.get()) {
+            activeModel = shadowSceneModel.get();
+        } else if (activeScene == deferredScene.get()) {
+            activeModel = deferredSceneModel.get();
+            // Scale up the armor model (it has internal scale of ~0.03) and center it
+            transform = glm::scale(Vec3(30.0f)) * glm::translate(Vec3(0.0f, 2.3f, 0.0f));
+        }
+
+        if (activeModel) {
+            // Animate, then queue compute skinning before the draw picks up the posed buffers
+            graphics::LoadedGLTF* animatedModels[] = { activeModel };
+            graphics::updateAnimations(animatedModels, deltaTime);
+            activeModel->submitSkinning(skinningBatch, frameIndex);
+
+            activeModel->draw(transform, drawContext);
+        }
+    }
+}
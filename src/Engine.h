@@ -9,6 +9,13 @@
 #include "Graphics/Techniques/ShadowMappingTechnique.h"
 #include "Graphics/Techniques/DeferredRenderingTechnique.h"
 #include "Scene.h"
+#include "Benchmark.h"
+#include "BatchRenderer.h"
+#include "FrameCapture.h"
+#include "Graphics/FramePacket.h"
+#include "BasicServices/SpscRing.h"
+#include "BasicServices/Platform.h"
+#include <thread>
 
 using graphics::VulkanContext;
 using graphics::Renderer;
@@ -22,13 +29,28 @@ public:
     void run();
     void cleanup();
 
+    // Headless benchmark: offscreen rendering, no window nor swapchain. Returns the process exit code.
+    void initBenchmark(const BenchmarkSettings& settings);
+    int runBenchmark();
+
     void setActiveScene(Scene* scene);
 
 private:
     void initWindow();
     void initVulkan();
     void initScenes();
+    int runReplay();
+    // Renders the --batch jobs to image files, measuring images per second
+    int runBatch();
+    // Benchmark scene by command line name, and the orbit its camera follows. nullptr when unknown
+    Scene* findBenchmarkScene(const str& name, BenchmarkCameraPath& path) const;
+    // Technique by command line name (basic | shadow | deferred). nullptr when unknown
+    graphics::techniques::IRenderingTechnique* findTechnique(const str& name) const;
+    // Interactive loop: simulation on the calling thread, recording and presenting on renderThread
     void mainLoop();
+    void renderLoop();
+    // Animates the active scene's model and fills its draw list and skinning jobs for a frame in flight
+    void updateFrame(f32 deltaTime, graphics::DrawContext& drawContext, graphics::SkinningBatch& skinningBatch, u32 frameIndex);
 
     struct SDL_Window* window{ nullptr };
     uptr<VulkanContext> vulkanContext;
@@ -40,6 +62,19 @@ private:
     uptr<Scene> deferredScene;
     Scene* activeScene { nullptr };
 
+    std::optional<BenchmarkSettings> benchmarkSettings;
+
+    // Simulation -> render thread hand-off. Two packets: one being rendered, one being built
+    static constexpr u32 FRAME_PACKET_COUNT = 2;
+    services::SpscRing<graphics::FramePacket, FRAME_PACKET_COUNT> framePackets;
+    std::thread renderThread;
+    // CPUs of the main and render threads, planned from the CPU topology when the loop starts
+    services::ThreadLayout threadLayout;
+
+    // Frame capture (F9 in the interactive app) and its replay draw list
+    FrameCapture frameCapture;
+    graphics::DrawContext replayDrawContext;
+
     // Loaded models (kept alive for scenes)
     sptr<graphics::LoadedGLTF> basicSceneModel;
     sptr<graphics::LoadedGLTF> shadowSceneModel;
@@ -50,7 +85,7 @@ private:
     uptr<graphics::techniques::ShadowMappingTechnique> shadowMappingTechnique;
     uptr<graphics::techniques::DeferredRenderingTechnique> deferredTechnique;
 
-    // KTX textures for armor model
+    // KTX textures for armor model (owned by the renderer's scene loader)
     std::optional<graphics::Image> armorColorMap;
     std::optional<graphics::Image> armorNormalMap;
     graphics::Buffer armorMaterialBuffer;
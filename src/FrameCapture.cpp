@@ -0,0 +1,358 @@
+#include "FrameCapture.h"
+#include "BasicServices/File.h"
+#include "BasicServices/Log.h"
+#include "Graphics/LoadedGLTF.h"
+#include "Graphics/Renderer.h"
+#include "Graphics/RenderObject.h"
+#include "Graphics/Techniques/DeferredRenderingTechnique.h"
+#include "Graphics/Techniques/ShadowMappingTechnique.h"
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+using services::Log;
+
+namespace {
+    constexpr char MAGIC[4] = { 'M', 'C', 'A', 'P' };
+    // Bump when a captured struct changes: frames are stored as raw structs
+    constexpr u32 VERSION = 1;
+
+    // Fixed part of a frame, written as one block
+    struct FrameHeader {
+        Vec3 cameraPosition;
+        f32 cameraPitch;
+        f32 cameraYaw;
+        Vec3 lightPosition;
+        graphics::GPUSceneData sceneData;
+        CapturedSettings settings;
+        u32 drawCount;
+    };
+
+    struct DrawRecord {
+        u32 mesh;
+        u16 surface;
+        u16 transparent;
+        Mat4 transform;
+    };
+
+    class BinaryWriter {
+    public:
+        explicit BinaryWriter(const str& path) : stream(path, std::ios::binary) {}
+
+        bool isOpen() const { return stream.is_open(); }
+        bool isGood() const { return stream.good(); }
+
+        template <typename T>
+        void put(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void putString(const str& text) {
+            put(static_cast<u32>(text.size()));
+            stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+
+    private:
+        std::ofstream stream;
+    };
+
+    class BinaryReader {
+    public:
+        explicit BinaryReader(const vector<char>& data) : data(data) {}
+
+        template <typename T>
+        bool get(T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (offset + sizeof(T) > data.size()) return false;
+            std::memcpy(&value, data.data() + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        bool getString(str& text) {
+            u32 size = 0;
+            if (!get(size) || offset + size > data.size()) return false;
+            text.assign(data.data() + offset, size);
+            offset += size;
+            return true;
+        }
+
+    private:
+        const vector<char>& data;
+        size_t offset { 0 };
+    };
+
+    u64 toKey(vk::Buffer buffer) {
+        return reinterpret_cast<u64>(static_cast<VkBuffer>(buffer));
+    }
+}
+
+void FrameCapture::registerModel(const str& path, const graphics::LoadedGLTF& model) {
+    const u32 modelIndex = static_cast<u32>(models.size());
+    models.emplace_back(path, &model);
+
+    for (const auto& [name, mesh] : model.meshes) {
+        const u64 indexBuffer = toKey(mesh->meshBuffers.indexBuffer.buffer);
+        for (size_t i = 0; i < mesh->surfaces.size(); i++) {
+            surfaceLookup[{ indexBuffer, mesh->surfaces[i].startIndex }] = { modelIndex, mesh.get(), static_cast<u16>(i) };
+        }
+    }
+}
+
+void FrameCapture::start(u32 frameCount, const str& path) {
+    if (isCapturing() || frameCount == 0) return;
+
+    techniqueName.clear();
+    modelPaths.clear();
+    for (const auto& [modelPath, model] : models) {
+        modelPaths.push_back(modelPath);
+    }
+    meshes.clear();
+    meshIndices.clear();
+    frames.clear();
+    frames.reserve(frameCount);
+    unknownDraws = 0;
+
+    framesToCapture = frameCount;
+    outputPath = path;
+    Log::Info("Frame capture: recording %u frames", frameCount);
+}
+
+void FrameCapture::record(graphics::Renderer& renderer, const graphics::DrawContext& drawContext) {
+    if (!isCapturing()) return;
+
+    auto* technique = renderer.getRenderingTechnique();
+    if (frames.empty() && technique) {
+        techniqueName = technique->getName();
+    }
+
+    CapturedFrame& frame = frames.emplace_back();
+    frame.cameraPosition = renderer.mainCamera.position;
+    frame.cameraPitch = renderer.mainCamera.pitch;
+    frame.cameraYaw = renderer.mainCamera.yaw;
+    frame.lightPosition = renderer.getLightPosition();
+    frame.sceneData = renderer.getSceneData();
+
+    CapturedSettings& settings = frame.settings;
+    settings.bloom = renderer.getBloomParams();
+    settings.ssao = renderer.getSSAOParams();
+    settings.shadowCasterCulling = renderer.isShadowCasterCullingEnabled();
+    settings.shadowProjectionFitting = renderer.isShadowProjectionFittingEnabled();
+    settings.particles = renderer.getParticleSystem().isEnabled();
+    if (technique && technique->getTechnique() == graphics::techniques::TechniqueType::ShadowMapping) {
+        auto* shadow = static_cast<graphics::techniques::ShadowMappingTechnique*>(technique);
+        settings.enablePCF = shadow->isPCFEnabled();
+        settings.shadowFilter = static_cast<u32>(shadow->getShadowFilter());
+    } else if (technique && technique->getTechnique() == graphics::techniques::TechniqueType::Deferred) {
+        auto* deferred = static_cast<graphics::techniques::DeferredRenderingTechnique*>(technique);
+        settings.deferredDebugMode = static_cast<u32>(deferred->getDebugMode());
+    }
+
+    frame.draws.reserve(drawContext.opaqueSurfaces.size() + drawContext.transparentSurfaces.size());
+    auto addDraws = [&](const vector<graphics::RenderObject>& objects, bool transparent) {
+        for (const graphics::RenderObject& object : objects) {
+            const auto it = surfaceLookup.find({ toKey(object.indexBuffer), object.firstIndex });
+            if (it == surfaceLookup.end()) {
+                // Not from a registered model: cannot be replayed
+                unknownDraws++;
+                continue;
+            }
+
+            const SurfaceSource& source = it->second;
+            auto [meshIt, inserted] = meshIndices.try_emplace(source.mesh, static_cast<u32>(meshes.size()));
+            if (inserted) {
+                meshes.push_back({ source.model, source.mesh->name, source.mesh });
+            }
+            frame.draws.push_back({ meshIt->second, source.surface, transparent, object.transform });
+        }
+    };
+    addDraws(drawContext.opaqueSurfaces, false);
+    addDraws(drawContext.transparentSurfaces, true);
+
+    if (--framesToCapture == 0) {
+        if (unknownDraws > 0) {
+            Log::Warn("Frame capture: %u draws skipped, their mesh is not from a registered model", unknownDraws);
+        }
+        write();
+    }
+}
+
+bool FrameCapture::write() const {
+    BinaryWriter writer(outputPath);
+    if (!writer.isOpen()) {
+        Log::Error("Frame capture: cannot open %s", outputPath.c_str());
+        return false;
+    }
+
+    writer.put(MAGIC);
+    writer.put(VERSION);
+    writer.putString(techniqueName);
+
+    writer.put(static_cast<u32>(modelPaths.size()));
+    for (const str& path : modelPaths) {
+        writer.putString(path);
+    }
+
+    writer.put(static_cast<u32>(meshes.size()));
+    for (const MeshReference& mesh : meshes) {
+        writer.put(mesh.model);
+        writer.putString(mesh.name);
+    }
+
+    size_t drawCount = 0;
+    writer.put(static_cast<u32>(frames.size()));
+    for (const CapturedFrame& frame : frames) {
+        const FrameHeader header { frame.cameraPosition, frame.cameraPitch, frame.cameraYaw, frame.lightPosition,
+                                   frame.sceneData, frame.settings, static_cast<u32>(frame.draws.size()) };
+        writer.put(header);
+        for (const CapturedDraw& draw : frame.draws) {
+            writer.put(DrawRecord { draw.mesh, draw.surface, static_cast<u16>(draw.transparent), draw.transform });
+        }
+        drawCount += frame.draws.size();
+    }
+
+    if (!writer.isGood()) {
+        Log::Error("Frame capture: error while writing %s", outputPath.c_str());
+        return false;
+    }
+    Log::Info("Frame capture: %zu frames, %zu draws, %zu meshes written to %s",
+        frames.size(), drawCount, meshes.size(), outputPath.c_str());
+    return true;
+}
+
+bool FrameCapture::load(const str& path) {
+    const vector<char> data = services::File::readBinary(path);
+    if (data.empty()) return false;
+
+    BinaryReader reader(data);
+    char magic[4] {};
+    u32 version = 0;
+    if (!reader.get(magic) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || !reader.get(version)) {
+        Log::Error("Frame capture: %s is not a capture file", path.c_str());
+        return false;
+    }
+    if (version != VERSION) {
+        Log::Error("Frame capture: %s has version %u, this build reads version %u", path.c_str(), version, VERSION);
+        return false;
+    }
+
+    bool valid = reader.getString(techniqueName);
+
+    // Map the capture's models to the registered ones
+    u32 modelCount = 0;
+    valid = valid && reader.get(modelCount);
+    modelPaths.assign(valid ? modelCount : 0, {});
+    vector<const graphics::LoadedGLTF*> resolvedModels(modelPaths.size(), nullptr);
+    for (u32 i = 0; valid && i < modelCount; i++) {
+        valid = reader.getString(modelPaths[i]);
+        for (const auto& [modelPath, model] : models) {
+            if (modelPath == modelPaths[i]) resolvedModels[i] = model;
+        }
+    }
+
+    u32 meshCount = 0;
+    valid = valid && reader.get(meshCount);
+    meshes.assign(valid ? meshCount : 0, {});
+    for (u32 i = 0; valid && i < meshCount; i++) {
+        MeshReference& mesh = meshes[i];
+        valid = reader.get(mesh.model) && reader.getString(mesh.name) && mesh.model < modelCount;
+        if (!valid) break;
+
+        if (!resolvedModels[mesh.model]) {
+            Log::Error("Frame capture: model %s is not loaded", modelPaths[mesh.model].c_str());
+            return false;
+        }
+        const auto it = resolvedModels[mesh.model]->meshes.find(mesh.name);
+        if (it == resolvedModels[mesh.model]->meshes.end()) {
+            Log::Error("Frame capture: mesh '%s' not found in %s", mesh.name.c_str(), modelPaths[mesh.model].c_str());
+            return false;
+        }
+        mesh.asset = it->second.get();
+    }
+
+    u32 frameCount = 0;
+    valid = valid && reader.get(frameCount);
+    frames.clear();
+    for (u32 i = 0; valid && i < frameCount; i++) {
+        FrameHeader header {};
+        valid = reader.get(header) && header.settings.shadowFilter < static_cast<u32>(graphics::ShadowFilter::Count);
+        if (!valid) break;
+
+        CapturedFrame& frame = frames.emplace_back();
+        frame.cameraPosition = header.cameraPosition;
+        frame.cameraPitch = header.cameraPitch;
+        frame.cameraYaw = header.cameraYaw;
+        frame.lightPosition = header.lightPosition;
+        frame.sceneData = header.sceneData;
+        frame.settings = header.settings;
+        frame.draws.reserve(header.drawCount);
+
+        for (u32 d = 0; valid && d < header.drawCount; d++) {
+            DrawRecord record {};
+            valid = reader.get(record) && record.mesh < meshes.size()
+                && record.surface < meshes[record.mesh].asset->surfaces.size();
+            if (valid) {
+                frame.draws.push_back({ record.mesh, record.surface, record.transparent != 0, record.transform });
+            }
+        }
+    }
+
+    if (!valid || frames.empty()) {
+        Log::Error("Frame capture: %s is truncated or corrupted", path.c_str());
+        frames.clear();
+        return false;
+    }
+
+    Log::Info("Frame capture: %zu frames loaded from %s (%s)", frames.size(), path.c_str(), techniqueName.c_str());
+    return true;
+}
+
+void FrameCapture::apply(u32 frameIndex, graphics::Renderer& renderer, graphics::DrawContext& drawContext) const {
+    const CapturedFrame& frame = frames[frameIndex % frames.size()];
+
+    renderer.mainCamera.position = frame.cameraPosition;
+    renderer.mainCamera.pitch = frame.cameraPitch;
+    renderer.mainCamera.yaw = frame.cameraYaw;
+    renderer.mainCamera.velocity = Vec3(0.f);
+    renderer.setAnimateLight(false);
+    renderer.setLightPosition(frame.lightPosition);
+    renderer.setSceneDataOverride(frame.sceneData);
+
+    const CapturedSettings& settings = frame.settings;
+    renderer.getBloomParams() = settings.bloom;
+    renderer.getSSAOParams() = settings.ssao;
+    renderer.setShadowCasterCulling(settings.shadowCasterCulling);
+    renderer.setShadowProjectionFitting(settings.shadowProjectionFitting);
+    renderer.getParticleSystem().setEnabled(settings.particles);
+
+    auto* technique = renderer.getRenderingTechnique();
+    if (technique && technique->getTechnique() == graphics::techniques::TechniqueType::ShadowMapping) {
+        auto* shadow = static_cast<graphics::techniques::ShadowMappingTechnique*>(technique);
+        shadow->setEnablePCF(settings.enablePCF);
+        shadow->setShadowFilter(static_cast<graphics::ShadowFilter>(settings.shadowFilter));
+    } else if (technique && technique->getTechnique() == graphics::techniques::TechniqueType::Deferred) {
+        auto* deferred = static_cast<graphics::techniques::DeferredRenderingTechnique*>(technique);
+        deferred->setDebugMode(static_cast<graphics::techniques::DeferredRenderingTechnique::DebugMode>(settings.deferredDebugMode));
+    }
+
+    // Same RenderObjects as MeshNode::draw, in the bind pose
+    drawContext.opaqueSurfaces.clear();
+    drawContext.transparentSurfaces.clear();
+    for (const CapturedDraw& draw : frame.draws) {
+        const graphics::MeshAsset& mesh = *meshes[draw.mesh].asset;
+        const graphics::GeoSurface& surface = mesh.surfaces[draw.surface];
+
+        graphics::RenderObject object;
+        object.indexCount = surface.count;
+        object.firstIndex = surface.startIndex;
+        object.indexBuffer = mesh.meshBuffers.indexBuffer.buffer;
+        object.material = &surface.material->data;
+        object.bounds = surface.bounds;
+        object.transform = draw.transform;
+        object.vertexBufferAddress = mesh.meshBuffers.vertexBufferAddress;
+        object.positionBufferAddress = mesh.meshBuffers.positionBufferAddress;
+
+        (draw.transparent ? drawContext.transparentSurfaces : drawContext.opaqueSurfaces).push_back(object);
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include "Defines.h"
+#include "Graphics/Types.h"
+#include "Graphics/Techniques/BloomTechnique.h"
+#include "Graphics/Techniques/SSAOTechnique.h"
+#include <map>
+#include <unordered_map>
+
+namespace graphics {
+    class Renderer;
+    class LoadedGLTF;
+    struct MeshAsset;
+    struct DrawContext;
+}
+
+// Renderer and technique switches of a captured frame
+struct CapturedSettings {
+    graphics::techniques::BloomParams bloom;
+    graphics::techniques::SSAOParams ssao;
+    u32 shadowFilter { 1 };         // graphics::ShadowFilter
+    u32 deferredDebugMode { 0 };    // DeferredRenderingTechnique::DebugMode
+    bool enablePCF { true };
+    bool shadowCasterCulling { true };
+    bool shadowProjectionFitting { false };
+    bool particles { false };
+};
+
+// One RenderObject, referencing its surface by asset instead of by GPU handles
+struct CapturedDraw {
+    u32 mesh;                       // Index in the capture's mesh table
+    u16 surface;                    // Index in MeshAsset::surfaces
+    bool transparent;
+    Mat4 transform;
+};
+
+// Everything a frame's rendering depends on
+struct CapturedFrame {
+    Vec3 cameraPosition { 0.f };
+    f32 cameraPitch { 0.f };
+    f32 cameraYaw { 0.f };
+    Vec3 lightPosition { 0.f };
+    graphics::GPUSceneData sceneData {};
+    CapturedSettings settings;
+    vector<CapturedDraw> draws;
+};
+
+/**
+ * Records a few frames of the interactive app to a binary file, and plays them back headless.
+ *
+ * A capture holds the camera, the GPUSceneData, the renderer settings and the draw
+ * list of each frame. Draws refer to meshes by model path and mesh name, so the file
+ * stays small and can be replayed by another build on another machine, as long as
+ * it loads the same assets: meadows --bench --replay capture.mcap --repeat 10.
+ *
+ * Skinned meshes are replayed in their bind pose, animations are not captured.
+ */
+class FrameCapture {
+public:
+    // Models draws can come from. Register them before starting or loading a capture
+    void registerModel(const str& path, const graphics::LoadedGLTF& model);
+
+    // Recording: call record() after each rendered frame, the file is written after the last one
+    void start(u32 frameCount, const str& path);
+    bool isCapturing() const { return framesToCapture > 0; }
+    void record(graphics::Renderer& renderer, const graphics::DrawContext& drawContext);
+
+    // Replay
+    bool load(const str& path);
+    u32 getFrameCount() const { return static_cast<u32>(frames.size()); }
+    const str& getTechniqueName() const { return techniqueName; }
+    // Restores the camera, light, settings and scene data of a frame, and rebuilds its draw list
+    void apply(u32 frame, graphics::Renderer& renderer, graphics::DrawContext& drawContext) const;
+
+private:
+    // Where a RenderObject comes from
+    struct SurfaceSource {
+        u32 model;                  // Index in models
+        const graphics::MeshAsset* mesh;
+        u16 surface;
+    };
+
+    struct MeshReference {
+        u32 model;                  // Index in modelPaths
+        str name;
+        const graphics::MeshAsset* asset { nullptr };   // Resolved against the registered models
+    };
+
+    bool write() const;
+
+    // Registered models, and their surfaces by (index buffer, first index)
+    vector<std::pair<str, const graphics::LoadedGLTF*>> models;
+    std::map<std::pair<u64, u32>, SurfaceSource> surfaceLookup;
+    std::unordered_map<const graphics::MeshAsset*, u32> meshIndices;    // Mesh table of the recording
+
+    // File content
+    str techniqueName;
+    vector<str> modelPaths;
+    vector<MeshReference> meshes;
+    vector<CapturedFrame> frames;
+
+    u32 framesToCapture { 0 };
+    str outputPath;
+    u32 unknownDraws { 0 };
+};
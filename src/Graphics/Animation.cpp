@@ -0,0 +1,141 @@
+/**
+ * @file Animation.cpp
+ * @brief Keyframe sampling for glTF animation clips.
+ */
+
+#include "Animation.h"
+#include "LoadedGLTF.h"
+#include "BasicServices/WorkerPool.h"
+
+#include <algorithm>
+#include <glm/gtx/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
+
+namespace graphics {
+
+    Mat4 NodeTRS::toMatrix() const {
+        return glm::translate(Mat4(1.f), translation) * glm::toMat4(rotation) * glm::scale(Mat4(1.f), scale);
+    }
+
+    namespace {
+        /**
+         * Moves the cursor so that times[cursor] <= time < times[cursor + 1].
+         * Caller guarantees times.front() < time < times.back().
+         */
+        u32 findKey(const vector<f32>& times, f32 time, u32 cursor) {
+            if (cursor + 1 >= times.size() || times[cursor] > time) {
+                cursor = 0;
+            }
+            while (times[cursor + 1] <= time) {
+                cursor++;
+            }
+            return cursor;
+        }
+
+        Vec4 hermite(const Vec4& p0, const Vec4& m0, const Vec4& p1, const Vec4& m1, f32 t) {
+            const f32 t2 = t * t;
+            const f32 t3 = t2 * t;
+            return (2.f * t3 - 3.f * t2 + 1.f) * p0
+                 + (t3 - 2.f * t2 + t) * m0
+                 + (-2.f * t3 + 3.f * t2) * p1
+                 + (t3 - t2) * m1;
+        }
+
+        Vec4 sampleValue(const AnimationSampler& sampler, AnimationPath path, f32 time, u32& cursor) {
+            const vector<f32>& times = sampler.times;
+            const bool cubic = sampler.interpolation == AnimationInterpolation::CubicSpline;
+            const auto valueAt = [&](u32 key) { return sampler.values[cubic ? key * 3 + 1 : key]; };
+
+            if (times.size() == 1 || time <= times.front()) {
+                cursor = 0;
+                return valueAt(0);
+            }
+            if (time >= times.back()) {
+                cursor = static_cast<u32>(times.size()) - 1;
+                return valueAt(cursor);
+            }
+
+            cursor = findKey(times, time, cursor);
+            const u32 next = cursor + 1;
+            const f32 keyDelta = times[next] - times[cursor];
+            const f32 t = (time - times[cursor]) / keyDelta;
+
+            switch (sampler.interpolation) {
+            case AnimationInterpolation::Step:
+                return valueAt(cursor);
+
+            case AnimationInterpolation::CubicSpline: {
+                const Vec4 p0 = sampler.values[cursor * 3 + 1];
+                const Vec4 m0 = sampler.values[cursor * 3 + 2] * keyDelta;
+                const Vec4 p1 = sampler.values[next * 3 + 1];
+                const Vec4 m1 = sampler.values[next * 3] * keyDelta;
+                Vec4 result = hermite(p0, m0, p1, m1, t);
+                if (path == AnimationPath::Rotation) {
+                    result = glm::normalize(result);
+                }
+                return result;
+            }
+
+            case AnimationInterpolation::Linear:
+            default:
+                if (path == AnimationPath::Rotation) {
+                    const Vec4 a = valueAt(cursor);
+                    const Vec4 b = valueAt(next);
+                    const Quat q = glm::slerp(Quat(a.w, a.x, a.y, a.z), Quat(b.w, b.x, b.y, b.z), t);
+                    return Vec4(q.x, q.y, q.z, q.w);
+                }
+                return glm::mix(valueAt(cursor), valueAt(next), t);
+            }
+        }
+    }
+
+    void sampleAnimation(const AnimationClip& clip, AnimationState& state, std::span<NodeTRS> pose) {
+        if (state.cursors.size() != clip.samplers.size()) {
+            state.cursors.assign(clip.samplers.size(), 0);
+        }
+
+        for (const AnimationChannel& channel : clip.channels) {
+            const AnimationSampler& sampler = clip.samplers[channel.sampler];
+            if (sampler.times.empty() || channel.node >= pose.size()) continue;
+
+            const Vec4 value = sampleValue(sampler, channel.path, state.time, state.cursors[channel.sampler]);
+            NodeTRS& trs = pose[channel.node];
+
+            switch (channel.path) {
+            case AnimationPath::Translation:
+                trs.translation = Vec3(value);
+                break;
+            case AnimationPath::Rotation:
+                // glTF stores quaternions as xyzw, glm::quat constructor takes wxyz
+                trs.rotation = Quat(value.w, value.x, value.y, value.z);
+                break;
+            case AnimationPath::Scale:
+                trs.scale = Vec3(value);
+                break;
+            }
+        }
+    }
+
+    void updateAnimations(std::span<LoadedGLTF* const> models, f32 deltaTime) {
+        if (models.size() <= 1) {
+            for (LoadedGLTF* model : models) {
+                if (model) model->updateAnimation(deltaTime);
+            }
+            return;
+        }
+
+        // Split the models in contiguous chunks, one per pool thread plus the calling thread
+        services::WorkerPool& pool = services::WorkerPool::Instance();
+        const size_t chunkCount = std::min(static_cast<size_t>(pool.getThreadCount()) + 1, models.size());
+        const size_t chunkSize = (models.size() + chunkCount - 1) / chunkCount;
+
+        pool.run(static_cast<u32>(chunkCount), [&models, deltaTime, chunkSize](u32 chunk) {
+            const size_t begin = chunk * chunkSize;
+            const size_t end = std::min(begin + chunkSize, models.size());
+            for (size_t i = begin; i < end; i++) {
+                if (models[i]) models[i]->updateAnimation(deltaTime);
+            }
+        });
+    }
+
+} // namespace graphics
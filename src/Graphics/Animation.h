@@ -0,0 +1,125 @@
+/**
+ * @file Animation.h
+ * @brief glTF skins, animation clips and keyframe sampling.
+ */
+
+#pragma once
+
+#include "Types.h"
+#include <span>
+#include <glm/gtc/quaternion.hpp>
+
+namespace graphics {
+    class LoadedGLTF;
+
+    /**
+     * @struct Skin
+     * @brief A glTF skin: the list of joint nodes driving a skinned mesh.
+     *
+     * ## What is Skinning?
+     * A skinned mesh is deformed by a hierarchy of "joints" (bones). Each vertex
+     * stores up to 4 joint indices and weights. At runtime we build a "joint palette":
+     * one matrix per joint that moves a vertex from its bind pose to its animated pose.
+     *
+     * ## The joint matrix
+     * @code
+     * jointMatrix[i] = inverse(meshNodeWorld) * jointNodeWorld[i] * inverseBindMatrix[i]
+     * @endcode
+     * - inverseBindMatrix: brings the vertex from mesh space into the joint's local space
+     * - jointNodeWorld: the animated joint transform
+     * - inverse(meshNodeWorld): keeps the result in mesh space, so the usual
+     *   world matrix push constant still applies when drawing
+     */
+    struct Skin {
+        str name;
+        vector<u32> joints;               ///< Node indices (LoadedGLTF::nodeList) of each joint
+        vector<Mat4> inverseBindMatrices; ///< One per joint (identity when absent from the file)
+    };
+
+    /// Node transform split in its components, so animation channels can override each part
+    struct NodeTRS {
+        Vec3 translation { 0.f };
+        Quat rotation { 1.f, 0.f, 0.f, 0.f };
+        Vec3 scale { 1.f };
+
+        Mat4 toMatrix() const;
+    };
+
+    enum class AnimationPath : u8 {
+        Translation,
+        Rotation,
+        Scale
+    };
+
+    enum class AnimationInterpolation : u8 {
+        Linear,
+        Step,
+        CubicSpline
+    };
+
+    /**
+     * @struct AnimationSampler
+     * @brief Keyframe times and values for one animated property.
+     *
+     * Values are stored as Vec4 for every path (xyz for translation/scale,
+     * xyzw quaternion for rotation) so sampling is the same code for all of them.
+     * Cubic spline samplers store 3 values per key: in-tangent, value, out-tangent.
+     */
+    struct AnimationSampler {
+        vector<f32> times;
+        vector<Vec4> values;
+        AnimationInterpolation interpolation { AnimationInterpolation::Linear };
+    };
+
+    struct AnimationChannel {
+        u32 sampler;        ///< Index into AnimationClip::samplers
+        u32 node;           ///< Index into LoadedGLTF::nodeList
+        AnimationPath path;
+    };
+
+    struct AnimationClip {
+        str name;
+        f32 duration { 0.f };
+        vector<AnimationSampler> samplers;
+        vector<AnimationChannel> channels;
+        vector<u32> animatedNodes;   ///< Unique nodes touched by the channels
+    };
+
+    /**
+     * @struct AnimationState
+     * @brief Playback state of one model.
+     *
+     * ## Keyframe cursors
+     * Looking up the current keyframe with a binary search on every sampler every frame
+     * is wasted work: time only moves forward by a tiny step. Each sampler remembers the
+     * key it used last frame and we only walk forward from there, which is O(1) amortized.
+     * The cursors are reset when the clip loops or the clip changes.
+     */
+    struct AnimationState {
+        i32 clip { -1 };      ///< Playing clip index, -1 = bind pose
+        f32 time { 0.f };
+        f32 speed { 1.f };
+        bool playing { true };
+        bool loop { true };
+        vector<u32> cursors;  ///< Last keyframe used, one per sampler of the clip
+    };
+
+    /**
+     * @brief Samples a clip at the state's time and writes the result into the pose.
+     * @param clip The clip to sample.
+     * @param state Playback state (its keyframe cursors are updated).
+     * @param pose Per-node TRS, indexed like LoadedGLTF::nodeList.
+     */
+    void sampleAnimation(const AnimationClip& clip, AnimationState& state, std::span<NodeTRS> pose);
+
+    /**
+     * @brief Advances animation and joint palettes of several models in parallel.
+     *
+     * Each model only touches its own data in LoadedGLTF::updateAnimation, so models
+     * are spread across the threads of services::WorkerPool and the calling thread.
+     * Skinning submission must still happen on the thread building the frame
+     * afterwards (see LoadedGLTF::submitSkinning).
+     */
+    void updateAnimations(std::span<LoadedGLTF* const> models, f32 deltaTime);
+
+} // namespace graphics
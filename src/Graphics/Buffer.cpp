@@ -16,7 +16,8 @@ namespace graphics {
     // Constructor
     // =========================================================================
 
-    Buffer::Buffer(VulkanContext* context, size_t allocSize, vk::BufferUsageFlags usage, VmaMemoryUsage memoryUsage)
+    Buffer::Buffer(VulkanContext* context, size_t allocSize, vk::BufferUsageFlags usage, VmaMemoryUsage memoryUsage,
+                   MemoryCategory category, const char* name)
         : context(context), buffer(nullptr), allocation(), info(), size(allocSize) {
         allocation = nullptr;
         info = {};
@@ -32,7 +33,8 @@ namespace graphics {
 
         // Automatically map CPU-visible buffers for convenience
         // This allows direct access via info.pMappedData without explicit map/unmap
-        if (memoryUsage == VMA_MEMORY_USAGE_CPU_ONLY || memoryUsage == VMA_MEMORY_USAGE_CPU_TO_GPU) {
+        if (memoryUsage == VMA_MEMORY_USAGE_CPU_ONLY || memoryUsage == VMA_MEMORY_USAGE_CPU_TO_GPU
+            || memoryUsage == VMA_MEMORY_USAGE_GPU_TO_CPU) {
             allocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
         }
 
@@ -46,6 +48,8 @@ namespace graphics {
                                       &info);  // info contains pMappedData if mapped
         assert(result == VK_SUCCESS && "failed to create buffer!");
         buffer = vk::Buffer(vkBuffer);
+
+        context->getMemoryTracker().track(allocation, category, name);
     }
 
     // =========================================================================
@@ -127,6 +131,20 @@ namespace graphics {
         unmap();
     }
 
+    void Buffer::invalidate(vk::DeviceSize offset, vk::DeviceSize size) const {
+        vmaInvalidateAllocation(context->getAllocator(), allocation, offset, size);
+    }
+
+    // =========================================================================
+    // Device Address
+    // =========================================================================
+
+    vk::DeviceAddress Buffer::getDeviceAddress() const {
+        vk::BufferDeviceAddressInfo deviceAddressInfo {};
+        deviceAddressInfo.buffer = buffer;
+        return context->getDevice().getBufferAddress(deviceAddressInfo);
+    }
+
     // =========================================================================
     // Cleanup
     // =========================================================================
@@ -134,6 +152,7 @@ namespace graphics {
     void Buffer::destroy() {
         if (context && buffer) {
             // VMA handles both buffer destruction and memory deallocation
+            context->getMemoryTracker().untrack(allocation);
             vmaDestroyBuffer(context->getAllocator(), buffer, allocation);
             buffer = nullptr;
             allocation = nullptr;
@@ -8,6 +8,8 @@
 #include <vulkan/vulkan.hpp>
 #include <vk_mem_alloc.h>
 
+#include "MemoryTracker.h"
+
 namespace graphics {
     class VulkanContext;
 
@@ -56,11 +58,14 @@ namespace graphics {
          * @param allocSize Size of the buffer in bytes.
          * @param usage How the buffer will be used (vertex, index, uniform, etc.).
          * @param memoryUsage Where to allocate the memory (GPU-only, CPU-visible, etc.).
+         * @param category Subsystem the memory is accounted to (see MemoryTracker).
+         * @param name Debug name, shown in the memory table and VMA dumps.
          *
-         * For CPU-visible memory types (CPU_ONLY, CPU_TO_GPU), the buffer is
+         * For CPU-visible memory types (CPU_ONLY, CPU_TO_GPU, GPU_TO_CPU), the buffer is
          * automatically mapped and accessible via info.pMappedData.
          */
-        Buffer(VulkanContext* context, size_t allocSize, vk::BufferUsageFlags usage, VmaMemoryUsage memoryUsage);
+        Buffer(VulkanContext* context, size_t allocSize, vk::BufferUsageFlags usage, VmaMemoryUsage memoryUsage,
+               MemoryCategory category = MemoryCategory::Untagged, const char* name = nullptr);
 
         /**
          * @brief Destructor - automatically destroys the buffer and frees memory.
@@ -108,6 +113,14 @@ namespace graphics {
          */
         void write(void* data, vk::DeviceSize size, vk::DeviceSize offset = 0);
 
+        /**
+         * @brief Makes GPU writes visible to the CPU through info.pMappedData.
+         *
+         * Needed before reading a GPU_TO_CPU buffer when its memory is not host
+         * coherent; does nothing when it is.
+         */
+        void invalidate(vk::DeviceSize offset = 0, vk::DeviceSize size = VK_WHOLE_SIZE) const;
+
         /**
          * @brief Destroys the buffer and frees its memory.
          *
@@ -119,6 +132,13 @@ namespace graphics {
         /// Returns the Vulkan buffer handle
         vk::Buffer getBuffer() const { return buffer; }
 
+        /**
+         * @brief Queries the 64-bit GPU address of this buffer.
+         *
+         * @note The buffer must have been created with eShaderDeviceAddress usage.
+         */
+        vk::DeviceAddress getDeviceAddress() const;
+
     public:
         // =====================================================================
         // Buffer Resources (public for convenience)
@@ -149,5 +169,7 @@ namespace graphics {
         Buffer indexBuffer;                    ///< Buffer containing triangle indices
         Buffer vertexBuffer;                   ///< Buffer containing vertex data
         vk::DeviceAddress vertexBufferAddress; ///< GPU address for bindless access
+        Buffer positionBuffer;                 ///< Optional tightly packed positions (3 floats each) for depth-only passes
+        vk::DeviceAddress positionBufferAddress { 0 };
     };
 } // namespace graphics
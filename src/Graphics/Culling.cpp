@@ -0,0 +1,114 @@
+/**
+ * @file Culling.cpp
+ * @brief Implementation of frustum culling and draw ordering.
+ */
+
+#include "Culling.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+
+namespace graphics {
+
+    bool isVisible(const RenderObject& obj, const Mat4& viewProj) {
+        // 8 corners of a unit cube
+        const std::array<Vec3, 8> corners {
+            Vec3 { 1, 1, 1 },
+            Vec3 { 1, 1, -1 },
+            Vec3 { 1, -1, 1 },
+            Vec3 { 1, -1, -1 },
+            Vec3 { -1, 1, 1 },
+            Vec3 { -1, 1, -1 },
+            Vec3 { -1, -1, 1 },
+            Vec3 { -1, -1, -1 },
+        };
+
+        // Transform from object space to clip space
+        const Mat4 matrix = viewProj * obj.transform;
+
+        // Track min/max of transformed corners in clip space
+        Vec3 min = { 1.5f, 1.5f, 1.5f };
+        Vec3 max = { -1.5f, -1.5f, -1.5f };
+
+        for (int c = 0; c < 8; c++) {
+            // Transform corner to clip space
+            Vec4 v = matrix * Vec4(obj.bounds.origin + (corners[c] * obj.bounds.extents), 1.f);
+
+            // Perspective divide (clip space -> normalized device coordinates)
+            v.x = v.x / v.w;
+            v.y = v.y / v.w;
+            v.z = v.z / v.w;
+
+            min = glm::min(Vec3{ v.x, v.y, v.z }, min);
+            max = glm::max(Vec3{ v.x, v.y, v.z }, max);
+        }
+
+        // Check against NDC bounds [-1, 1] for X/Y and [0, 1] for Z
+        if (min.z > 1.f || max.z < 0.f || min.x > 1.f || max.x < -1.f || min.y > 1.f || max.y < -1.f) {
+            return false;
+        }
+        return true;
+    }
+
+    void cullVisible(std::span<const RenderObject> objects, const Mat4& viewProj, vector<u32>& visible) {
+        for (u32 i = 0; i < objects.size(); i++) {
+            if (isVisible(objects[i], viewProj)) {
+                visible.push_back(i);
+            }
+        }
+    }
+
+    void cullViews(std::span<const RenderObject> objects, std::span<const Mat4> viewProjs, vector<u32>& masks) {
+        assert(viewProjs.size() <= 32);
+
+        // Clip planes from the rows of each matrix: -w <= x, y <= w and 0 <= z <= w.
+        // Not normalized, only the sign of the distances matters
+        std::array<std::array<Vec4, 6>, 32> planes {};
+        for (size_t v = 0; v < viewProjs.size(); v++) {
+            const Mat4 m = glm::transpose(viewProjs[v]);
+            planes[v] = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[2], m[3] - m[2] };
+        }
+
+        masks.resize(objects.size());
+        for (size_t i = 0; i < objects.size(); i++) {
+            // World-space AABB of the transformed local box, shared by every view
+            const RenderObject& object = objects[i];
+            const Mat4& t = object.transform;
+            const Vec3 center = Vec3(t * Vec4(object.bounds.origin, 1.f));
+            const Vec3 e = object.bounds.extents;
+            const Vec3 extents {
+                std::abs(t[0][0]) * e.x + std::abs(t[1][0]) * e.y + std::abs(t[2][0]) * e.z,
+                std::abs(t[0][1]) * e.x + std::abs(t[1][1]) * e.y + std::abs(t[2][1]) * e.z,
+                std::abs(t[0][2]) * e.x + std::abs(t[1][2]) * e.y + std::abs(t[2][2]) * e.z
+            };
+
+            u32 mask = 0;
+            for (size_t v = 0; v < viewProjs.size(); v++) {
+                bool inside = true;
+                for (const Vec4& plane : planes[v]) {
+                    const Vec3 normal = Vec3(plane);
+                    if (glm::dot(normal, center) + plane.w + glm::dot(glm::abs(normal), extents) < 0.f) {
+                        inside = false;
+                        break;
+                    }
+                }
+                if (inside) mask |= 1u << v;
+            }
+            masks[i] = mask;
+        }
+    }
+
+    void sortByMaterial(std::span<const RenderObject> objects, vector<u32>& draws) {
+        std::ranges::sort(draws, [&](const u32 iA, const u32 iB) {
+            const RenderObject& A = objects[iA];
+            const RenderObject& B = objects[iB];
+            if (A.material == B.material) {
+                return A.indexBuffer < B.indexBuffer;  // Same material: sort by mesh
+            }
+            return A.material < B.material;  // Different materials: sort by material
+        });
+    }
+
+} // namespace graphics
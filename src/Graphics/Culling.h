@@ -0,0 +1,54 @@
+/**
+ * @file Culling.h
+ * @brief Camera frustum culling and draw ordering of render objects.
+ */
+
+#pragma once
+
+#include "Types.h"
+#include "RenderObject.h"
+#include <span>
+
+namespace graphics {
+
+    /**
+     * @brief Tests if a render object is visible in the camera frustum.
+     *
+     * The object's bounding box corners are transformed to clip space, then the
+     * box is rejected if it lies completely outside one of the NDC bounds
+     * ([-1, 1] for X/Y, [0, 1] for Z).
+     *
+     * @param obj The render object to test.
+     * @param viewProj Combined view-projection matrix.
+     * @return true if the object is potentially visible.
+     */
+    bool isVisible(const RenderObject& obj, const Mat4& viewProj);
+
+    /**
+     * @brief Appends the indices of the visible objects to visible.
+     *
+     * visible is not cleared, so callers can reuse its capacity from frame to frame.
+     */
+    void cullVisible(std::span<const RenderObject> objects, const Mat4& viewProj, vector<u32>& visible);
+
+    /**
+     * @brief Culls every object against several views in one pass.
+     *
+     * The world-space box of each object is computed once, then tested against
+     * the 6 clip planes of each view. Boxes crossing the camera plane are kept,
+     * where isVisible() may reject them after the perspective divide.
+     *
+     * @param viewProjs At most 32 view-projection matrices.
+     * @param masks Resized to the object count. Bit v of masks[i] is set when object i may be visible in view v.
+     */
+    void cullViews(std::span<const RenderObject> objects, std::span<const Mat4> viewProjs, vector<u32>& masks);
+
+    /**
+     * @brief Sorts draw indices by material, then by index buffer.
+     *
+     * Consecutive draws then share pipeline, descriptor set and index buffer
+     * binds as often as possible.
+     */
+    void sortByMaterial(std::span<const RenderObject> objects, vector<u32>& draws);
+
+} // namespace graphics
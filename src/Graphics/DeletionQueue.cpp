@@ -1,6 +1,5 @@
 #include "DeletionQueue.hpp"
 
-#include <ranges>
 #include "BasicServices/Log.h"
 #include "fmt/base.h"
 
@@ -12,11 +11,9 @@ namespace graphics
     }
 
     void DeletionQueue::flush() {
-        for (auto & deletor : std::ranges::reverse_view(deletors)) {
-            auto deletedName = names.back();
-            names.pop_back();
-            services::Log::Trace(("Deletion queue: " + deletedName).c_str());
-            deletor();
+        for (size_t i = deletors.size(); i-- > 0;) {
+            services::Log::Trace("Deletion queue: %s", names[i].c_str());
+            deletors[i]();
         }
         deletors.clear();
         names.clear();
@@ -8,6 +8,10 @@
  */
 
 #include "DescriptorAllocatorGrowable.h"
+#include "FrameDescriptorAllocator.h"
+#include "BasicServices/FrameHistory.h"
+
+#include <algorithm>
 
 namespace graphics {
 
@@ -32,21 +36,38 @@ namespace graphics {
         readyPools.push_back(newPool);
     }
 
+    DescriptorAllocatorGrowable::DescriptorAllocatorGrowable(DescriptorPoolCache& cache) :
+        device { cache.getDevice() }, poolCache { &cache } {
+        // Pools come from the cache on demand: a thread that never allocates holds none
+    }
+
     // =========================================================================
     // Destructor
     // =========================================================================
 
     DescriptorAllocatorGrowable::~DescriptorAllocatorGrowable() {
+        releasePools();
+    }
+
+    void DescriptorAllocatorGrowable::releasePools() {
         // IMPORTANT: In Vulkan, resources must be explicitly destroyed
-        // Destroy all pools (ready and full)
+        // Destroy all pools (ready and full), unless they belong to a cache
 
         for (const auto p : readyPools) {
-            device.destroyDescriptorPool(p, nullptr);
+            if (poolCache) {
+                poolCache->release(p);
+            } else {
+                device.destroyDescriptorPool(p, nullptr);
+            }
         }
         readyPools.clear();
 
         for (const auto p : fullPools) {
-            device.destroyDescriptorPool(p, nullptr);
+            if (poolCache) {
+                poolCache->release(p);
+            } else {
+                device.destroyDescriptorPool(p, nullptr);
+            }
         }
         fullPools.clear();
     }
@@ -56,6 +77,15 @@ namespace graphics {
     // =========================================================================
 
     void DescriptorAllocatorGrowable::clear() {
+        if (poolCache) {
+            // The cache resets them, and hands them to whichever thread needs a pool next
+            releasePools();
+            usage = {};
+            // A layout destroyed since could hand its handle to a different one
+            layoutCounts.clear();
+            return;
+        }
+
         // resetDescriptorPool() frees all Descriptor Sets allocated from this pool
         // without destroying the pool itself. This is more efficient than recreating pools.
 
@@ -70,6 +100,7 @@ namespace graphics {
             readyPools.push_back(p);  // The pool is usable again
         }
         fullPools.clear();
+        usage.allocatedSets = 0;
 
         // After clear(), all previously allocated Descriptor Sets are INVALID!
         // Do not use them anymore, they will point to recycled memory.
@@ -113,6 +144,20 @@ namespace graphics {
         // The used pool is put back in the available pools list
         // (it may be marked as full during a future allocation)
         readyPools.push_back(poolToUse);
+        usage.allocatedSets++;
+
+        // What the sets hold, for the cache to size its pools after
+        if (poolCache) {
+            auto known = std::find_if(layoutCounts.begin(), layoutCounts.end(),
+                [&](const auto& entry) { return entry.first == layout; });
+            if (known == layoutCounts.end()) {
+                layoutCounts.emplace_back(layout, DescriptorLayoutBuilder::getDescriptorCounts(layout));
+                known = layoutCounts.end() - 1;
+            }
+            for (u32 type = 0; type < DESCRIPTOR_TYPE_COUNT; type++) {
+                usage.allocatedDescriptors[type] += known->second[type];
+            }
+        }
         return ds;
     }
 
@@ -127,8 +172,16 @@ namespace graphics {
             // Simple case: we have an available pool, use it
             newPool = readyPools.back();
             readyPools.pop_back();
+        } else if (poolCache) {
+            // Fixed size pools: the cache grows by count, not by size
+            newPool = poolCache->acquire();
+            usage.pools++;
+            usage.setCapacity += poolCache->getSetsPerPool();
+            usage.descriptorCapacity += poolCache->getDescriptorsPerPool();
         } else {
             // No pool available: we need to create a new one
+            services::ScopedFrameEvent frameEvent(services::FrameEvent::DescriptorPoolGrowth,
+                std::to_string(setsPerPool) + " sets");
             newPool = createPool(setsPerPool, ratios);
 
             // Exponential growth strategy:
@@ -146,7 +199,7 @@ namespace graphics {
         return newPool;
     }
 
-    vk::DescriptorPool DescriptorAllocatorGrowable::createPool(u32 setCount, std::span<PoolSizeRatio> poolRatios) const {
+    vk::DescriptorPool DescriptorAllocatorGrowable::createPool(u32 setCount, std::span<PoolSizeRatio> poolRatios) {
         // Calculate sizes for each descriptor type
         // The ratio is multiplied by the number of sets to get the total descriptor count
         std::vector<vk::DescriptorPoolSize> poolSizes;
@@ -157,7 +210,10 @@ namespace graphics {
             // the pool can contain 200 samplers in total
             descriptorPoolSize.descriptorCount = static_cast<u32>(ratio.ratio * static_cast<float>(setCount));
             poolSizes.push_back(descriptorPoolSize);
+            usage.descriptorCapacity += descriptorPoolSize.descriptorCount;
         }
+        usage.pools++;
+        usage.setCapacity += setCount;
 
         // Pool configuration
         vk::DescriptorPoolCreateInfo poolInfo = {};
@@ -177,31 +233,33 @@ namespace graphics {
     // resources must only be destroyed once.
 
     DescriptorAllocatorGrowable::DescriptorAllocatorGrowable(DescriptorAllocatorGrowable&& other) noexcept
-        : device(other.device), setsPerPool(other.setsPerPool), ratios(std::move(other.ratios)),
-          fullPools(std::move(other.fullPools)), readyPools(std::move(other.readyPools)) {
+        : device(other.device), poolCache(other.poolCache), setsPerPool(other.setsPerPool), ratios(std::move(other.ratios)), usage(other.usage),
+          layoutCounts(std::move(other.layoutCounts)), fullPools(std::move(other.fullPools)), readyPools(std::move(other.readyPools)) {
         // The old object no longer owns the resources
         other.device = nullptr;
+        other.poolCache = nullptr;
+        other.usage = {};
     }
 
     DescriptorAllocatorGrowable& DescriptorAllocatorGrowable::operator=(DescriptorAllocatorGrowable&& other) noexcept {
         if (this != &other) {
             // First, release our own resources before taking new ones
-            for (const auto p : readyPools) {
-                device.destroyDescriptorPool(p, nullptr);
-            }
-            for (const auto p: fullPools) {
-                device.destroyDescriptorPool(p, nullptr);
-            }
+            releasePools();
 
             // Transfer ownership
             device = other.device;
+            poolCache = other.poolCache;
             setsPerPool = other.setsPerPool;
             ratios = std::move(other.ratios);
+            usage = other.usage;
+            layoutCounts = std::move(other.layoutCounts);
             fullPools = std::move(other.fullPools);
             readyPools = std::move(other.readyPools);
 
             // The old object no longer owns the resources
             other.device = nullptr;
+            other.poolCache = nullptr;
+            other.usage = {};
         }
         return *this;
     }
@@ -1,8 +1,23 @@
 ﻿#pragma once
 #include "Types.h"
+#include "DescriptorLayoutBuilder.hpp"
 
 namespace graphics {
 
+    class DescriptorPoolCache;
+
+    /**
+     * @struct DescriptorPoolUsage
+     * @brief How much an allocator's pools hold and use, for memory accounting.
+     */
+    struct DescriptorPoolUsage {
+        u32 pools { 0 };                ///< Pools created (ready and full), or held from the cache
+        u32 setCapacity { 0 };          ///< Sum of the pools' maxSets
+        u32 allocatedSets { 0 };        ///< Sets allocated since the last clear()
+        u64 descriptorCapacity { 0 };   ///< Descriptors of every type the pools can hold
+        DescriptorTypeCounts allocatedDescriptors {};   ///< Per type, in the sets since the last clear(). Cache backed only
+    };
+
     /**
      * @class DescriptorAllocatorGrowable
      * @brief Dynamic Descriptor Set manager for Vulkan.
@@ -24,6 +39,10 @@ namespace graphics {
      * - Progressively increasing pool sizes (the "growable" strategy)
      * - Managing the pool lifecycle (creation, reset, destruction)
      *
+     * Built from a DescriptorPoolCache instead, it creates no pool itself: it takes
+     * same-sized pools from the cache and gives them back on clear(). That is how
+     * each recording thread gets its own allocator (see FrameDescriptorAllocator).
+     *
      * @note This class uses move semantics and disallows copying to avoid
      *       Vulkan resource management issues.
      */
@@ -54,6 +73,14 @@ namespace graphics {
          */
         DescriptorAllocatorGrowable(vk::Device device, u32 initialSets, std::span<PoolSizeRatio> poolRatios);
 
+        /**
+         * @brief Cache backed constructor.
+         * @param cache Where pools are taken from and returned to. Must outlive the allocator.
+         *
+         * No pool is taken until the first allocation.
+         */
+        explicit DescriptorAllocatorGrowable(DescriptorPoolCache& cache);
+
         /**
          * @brief Destructor - releases all Vulkan pools.
          *
@@ -67,6 +94,7 @@ namespace graphics {
          * After clear(), all previously allocated Descriptor Sets become invalid,
          * but pools can be reused for new allocations.
          * Useful between frames to recycle resources.
+         * A cache backed allocator returns its pools to the cache instead.
          */
         void clear();
 
@@ -81,6 +109,9 @@ namespace graphics {
          */
         vk::DescriptorSet allocate(vk::DescriptorSetLayout layout, const void* pNext = nullptr);
 
+        /// Pools, capacity and sets allocated since the last clear()
+        const DescriptorPoolUsage& getUsage() const { return usage; }
+
         // =====================================================================
         // Move Semantics
         // =====================================================================
@@ -101,7 +132,8 @@ namespace graphics {
          *
          * Uses the following strategy:
          * 1. If a pool is available in readyPools, use it
-         * 2. Otherwise, create a new pool with 50% increased capacity
+         * 2. Otherwise, take one from the cache when there is one
+         * 3. Otherwise, create a new pool with 50% increased capacity
          */
         vk::DescriptorPool getPool();
 
@@ -111,15 +143,23 @@ namespace graphics {
          * @param poolRatios Ratios defining the capacity for each descriptor type.
          * @return The newly created Vulkan pool.
          */
-        vk::DescriptorPool createPool(u32 setCount, std::span<PoolSizeRatio> poolRatios) const;
+        vk::DescriptorPool createPool(u32 setCount, std::span<PoolSizeRatio> poolRatios);
+
+        /// Destroys every pool, or returns them to the cache
+        void releasePools();
 
         // =====================================================================
         // Private Members
         // =====================================================================
 
         vk::Device device { nullptr };  ///< Vulkan logical device (needed to create/destroy pools)
+        DescriptorPoolCache* poolCache { nullptr }; ///< Source of the pools when cache backed
         u32 setsPerPool { 0 };          ///< Capacity of the next pool to create (grows with each new pool)
         vector<PoolSizeRatio> ratios;   ///< Configuration of descriptor types and their proportions
+        DescriptorPoolUsage usage;      ///< Counters for the memory tracker
+
+        /// Descriptor counts of the layouts seen so far, to avoid the builder's lock (cache backed only)
+        vector<std::pair<vk::DescriptorSetLayout, DescriptorTypeCounts>> layoutCounts;
 
         /**
          * @brief Completely filled pools.
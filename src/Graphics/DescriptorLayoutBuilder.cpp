@@ -8,8 +8,18 @@
 
 #include "DescriptorLayoutBuilder.hpp"
 
+#include <mutex>
+#include <unordered_map>
+
 namespace graphics
 {
+    namespace {
+        // What each built layout holds, for allocators that learn their pool sizes.
+        // Handles of destroyed layouts get overwritten when the driver reuses them
+        std::mutex layoutCountsMutex;
+        std::unordered_map<VkDescriptorSetLayout, DescriptorTypeCounts> layoutCounts;
+    }
+
     void DescriptorLayoutBuilder::addBinding(u32 binding, vk::DescriptorType type) {
         // Create a new binding configuration
         vk::DescriptorSetLayoutBinding newBinding {};
@@ -43,6 +53,24 @@ namespace graphics
         // Create and return the descriptor set layout
         vk::DescriptorSetLayout set;
         set = device.createDescriptorSetLayout(info);
+
+        DescriptorTypeCounts counts {};
+        for (const auto& binding : bindings) {
+            const u32 type = static_cast<u32>(binding.descriptorType);
+            if (type < DESCRIPTOR_TYPE_COUNT) {
+                counts[type] += binding.descriptorCount;
+            }
+        }
+        {
+            std::lock_guard lock(layoutCountsMutex);
+            layoutCounts[static_cast<VkDescriptorSetLayout>(set)] = counts;
+        }
         return set;
     }
+
+    DescriptorTypeCounts DescriptorLayoutBuilder::getDescriptorCounts(vk::DescriptorSetLayout layout) {
+        std::lock_guard lock(layoutCountsMutex);
+        const auto it = layoutCounts.find(static_cast<VkDescriptorSetLayout>(layout));
+        return it != layoutCounts.end() ? it->second : DescriptorTypeCounts {};
+    }
 }
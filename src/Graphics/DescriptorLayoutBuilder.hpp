@@ -3,9 +3,16 @@
 
 #include "DescriptorLayoutBuilder.hpp"
 #include "Types.h"
+#include <array>
 
 namespace graphics
 {
+    /// Core descriptor types, eSampler (0) to eInputAttachment (10)
+    static constexpr u32 DESCRIPTOR_TYPE_COUNT = 11;
+
+    /// A number of descriptors per type, indexed by the vk::DescriptorType value
+    using DescriptorTypeCounts = std::array<u32, DESCRIPTOR_TYPE_COUNT>;
+
     /**
      * @class DescriptorLayoutBuilder
      * @brief Builder pattern for creating Vulkan Descriptor Set Layouts.
@@ -67,5 +74,13 @@ namespace graphics
          *       using device.destroyDescriptorSetLayout().
          */
         vk::DescriptorSetLayout build(vk::Device device, vk::ShaderStageFlags shaderStages, void* pNext = nullptr, vk::DescriptorSetLayoutCreateFlagBits flags = {});
+
+        /**
+         * @brief Descriptors of each type in one set of a layout made by build().
+         * @return All zeros for a layout this builder did not make.
+         *
+         * Takes a lock: callers allocating often should remember the result.
+         */
+        static DescriptorTypeCounts getDescriptorCounts(vk::DescriptorSetLayout layout);
     };
 }
\ No newline at end of file
@@ -0,0 +1,392 @@
+/**
+ * @file FrameDescriptorAllocator.cpp
+ * @brief Implementation of the shared pool cache and the per-thread frame allocator.
+ */
+
+#include "FrameDescriptorAllocator.h"
+#include "BasicServices/FileWriter.h"
+#include "BasicServices/FrameHistory.h"
+#include "BasicServices/Log.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fmt/format.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace graphics {
+
+    namespace {
+
+        // One bit per slot in use. A slot is held by a thread for its whole life, so
+        // a short lived job thread gives its slot back to the next one
+        std::atomic<u32> claimedSlots { 0 };
+        static_assert(FrameDescriptorAllocator::MAX_THREADS <= 32, "Slots are tracked in a 32 bit mask");
+        constexpr u32 ALL_SLOTS = FrameDescriptorAllocator::MAX_THREADS == 32
+            ? ~0u : (1u << FrameDescriptorAllocator::MAX_THREADS) - 1;
+
+        struct ThreadSlot {
+            u32 index { 0 };
+
+            ThreadSlot() {
+                bool warned = false;
+                u32 claimed = claimedSlots.load(std::memory_order_relaxed);
+                for (;;) {
+                    if (claimed != ALL_SLOTS) {
+                        const u32 free = static_cast<u32>(std::countr_one(claimed));
+                        if (claimedSlots.compare_exchange_weak(claimed, claimed | (1u << free), std::memory_order_acquire)) {
+                            index = free;
+                            return;
+                        }
+                        continue;
+                    }
+                    // Sharing a slot would race: wait for a recording thread to exit instead
+                    if (!warned) {
+                        services::Log::Warn("More than %u threads allocate frame descriptors, waiting for a free slot",
+                            FrameDescriptorAllocator::MAX_THREADS);
+                        warned = true;
+                    }
+                    std::this_thread::yield();
+                    claimed = claimedSlots.load(std::memory_order_relaxed);
+                }
+            }
+
+            ~ThreadSlot() {
+                claimedSlots.fetch_and(~(1u << index), std::memory_order_release);
+            }
+        };
+
+        thread_local ThreadSlot threadSlot;
+
+    } // namespace
+
+    // =========================================================================
+    // DescriptorPoolCache
+    // =========================================================================
+
+    DescriptorPoolCache::~DescriptorPoolCache() {
+        destroy();
+    }
+
+    void DescriptorPoolCache::init(vk::Device device, u32 setsPerPool, std::span<const DescriptorAllocatorGrowable::PoolSizeRatio> poolRatios) {
+        this->device = device;
+
+        std::array<f32, DESCRIPTOR_TYPE_COUNT> guessedRatios {};
+        for (const DescriptorAllocatorGrowable::PoolSizeRatio& ratio : poolRatios) {
+            const u32 type = static_cast<u32>(ratio.type);
+            if (type < DESCRIPTOR_TYPE_COUNT) {
+                guessedRatios[type] = ratio.ratio;
+                knownTypes[type] = true;
+            }
+        }
+        applyShape(setsPerPool, guessedRatios);
+    }
+
+    void DescriptorPoolCache::destroy() {
+        if (!device) return;
+
+        vk::DescriptorPool pool;
+        while (popFree(pool)) {
+            destroyPool(pool);
+        }
+        if (poolCount.load(std::memory_order_relaxed) != 0) {
+            services::Log::Warn("%u descriptor pools were still in use when their cache was destroyed",
+                poolCount.load(std::memory_order_relaxed));
+        }
+        poolShapes.clear();
+        device = nullptr;
+    }
+
+    vk::DescriptorPool DescriptorPoolCache::acquire() {
+        vk::DescriptorPool pool;
+        if (popFree(pool)) {
+            return pool;
+        }
+
+        // What prewarm() is there to avoid: once the marks have settled, this stops happening
+        createdWhileRecording.fetch_add(1, std::memory_order_relaxed);
+        createdThisFrame.fetch_add(1, std::memory_order_relaxed);
+        services::ScopedFrameEvent frameEvent(services::FrameEvent::DescriptorPoolGrowth,
+            std::to_string(setsPerPool) + " sets (shared)");
+        return createPool();
+    }
+
+    void DescriptorPoolCache::release(vk::DescriptorPool pool) {
+        bool stale;
+        {
+            std::lock_guard lock(shapeMutex);
+            const auto it = poolShapes.find(static_cast<VkDescriptorPool>(pool));
+            stale = it == poolShapes.end() || it->second != shape;
+        }
+        // Made before the last reshape: its sizes are no longer the ones wanted
+        if (stale) {
+            destroyPool(pool);
+            return;
+        }
+
+        // Only the pool is externally synchronized: threads can reset theirs side by side
+        device.resetDescriptorPool(pool, {});
+        if (freePools.tryPush([&](vk::DescriptorPool& free) { free = pool; })) {
+            freeCount.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            destroyPool(pool);
+        }
+    }
+
+    void DescriptorPoolCache::recordFrame(const DescriptorPoolUsage& total, u32 busiestThreadSets) {
+        createdThisFrame.store(0, std::memory_order_relaxed);
+        // Idle or minimized frames say nothing about what a frame needs
+        if (total.allocatedSets == 0) return;
+
+        const f32 sets = static_cast<f32>(total.allocatedSets);
+        threadSets.observe(static_cast<f32>(busiestThreadSets));
+        framePools.observe(static_cast<f32>(total.pools));
+        for (u32 type = 0; type < DESCRIPTOR_TYPE_COUNT; type++) {
+            if (total.allocatedDescriptors[type] > 0) {
+                knownTypes[type] = true;
+            }
+            typeRatios[type].observe(static_cast<f32>(total.allocatedDescriptors[type]) / sets);
+        }
+
+        u32 targetSets;
+        std::array<f32, DESCRIPTOR_TYPE_COUNT> targetRatios;
+        if (!computeShape(targetSets, targetRatios)) return;
+
+        // The pools a frame held were of the old size: scale the mark so prewarm() stays about right
+        framePools.value = std::ceil(framePools.value * static_cast<f32>(setsPerPool) / static_cast<f32>(targetSets));
+        framePools.recentMax = 0.f;
+        framePools.quietFrames = 0;
+
+        applyShape(targetSets, targetRatios);
+        shape++;
+        reshapes++;
+
+        // Free pools have the old shape. Those still held by frames are destroyed when released
+        vk::DescriptorPool pool;
+        while (popFree(pool)) {
+            destroyPool(pool);
+        }
+        services::Log::Info("Frame descriptor pools resized to %u sets, %llu descriptors (busiest thread: %.0f sets)",
+            setsPerPool, static_cast<unsigned long long>(descriptorsPerPool), threadSets.value);
+    }
+
+    void DescriptorPoolCache::prewarm() {
+        const u32 target = std::min(static_cast<u32>(std::ceil(framePools.value)), MAX_FREE_POOLS);
+        while (freeCount.load(std::memory_order_relaxed) < target) {
+            const vk::DescriptorPool pool = createPool();
+            if (freePools.tryPush([&](vk::DescriptorPool& free) { free = pool; })) {
+                freeCount.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                destroyPool(pool);
+                break;
+            }
+        }
+    }
+
+    bool DescriptorPoolCache::loadProfile(const str& path) {
+        std::ifstream file(path);
+        if (!file) return false;
+
+        str line;
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            str key;
+            fields >> key;
+            if (key == "thread_sets") {
+                fields >> threadSets.value;
+            } else if (key == "frame_pools") {
+                fields >> framePools.value;
+            } else if (key == "ratio") {
+                u32 type { DESCRIPTOR_TYPE_COUNT };
+                f32 ratio { 0.f };
+                fields >> type >> ratio;
+                if (type < DESCRIPTOR_TYPE_COUNT && ratio > 0.f) {
+                    typeRatios[type].value = ratio;
+                    knownTypes[type] = true;
+                }
+            }
+        }
+
+        u32 targetSets;
+        std::array<f32, DESCRIPTOR_TYPE_COUNT> targetRatios;
+        if (computeShape(targetSets, targetRatios)) {
+            // framePools was saved for the shape the marks give, nothing to scale
+            applyShape(targetSets, targetRatios);
+        }
+        services::Log::Info("Frame descriptor pools: %u sets, %.0f pools per frame, from %s",
+            setsPerPool, framePools.value, path.c_str());
+        return true;
+    }
+
+    bool DescriptorPoolCache::saveProfile(const str& path) const {
+        if (threadSets.value <= 0.f) return false;
+
+        services::FileWriter writer;
+        if (!writer.open(path)) {
+            services::Log::Error("Descriptor pools: cannot open %s", path.c_str());
+            return false;
+        }
+        writer.writeLine("# Frame descriptor usage learned by DescriptorPoolCache, rewritten on exit");
+        writer.writeLine(fmt::format("thread_sets {}", threadSets.value));
+        writer.writeLine(fmt::format("frame_pools {}", framePools.value));
+        for (u32 type = 0; type < DESCRIPTOR_TYPE_COUNT; type++) {
+            if (typeRatios[type].value > 0.f) {
+                writer.writeLine(fmt::format("ratio {} {}", type, typeRatios[type].value));
+            }
+        }
+        return true;
+    }
+
+    DescriptorPoolUsage DescriptorPoolCache::getUsage() const {
+        const u32 pools = poolCount.load(std::memory_order_relaxed);
+        DescriptorPoolUsage usage;
+        usage.pools = pools;
+        usage.setCapacity = pools * setsPerPool;
+        usage.descriptorCapacity = pools * descriptorsPerPool;
+        return usage;
+    }
+
+    DescriptorPoolCache::Stats DescriptorPoolCache::getStats() const {
+        Stats stats;
+        stats.pools = poolCount.load(std::memory_order_relaxed);
+        stats.freePools = freeCount.load(std::memory_order_relaxed);
+        stats.reshapes = reshapes;
+        stats.createdWhileRecording = createdWhileRecording.load(std::memory_order_relaxed);
+        stats.createdThisFrame = createdThisFrame.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void DescriptorPoolCache::HighWaterMark::observe(f32 sample) {
+        if (sample >= value) {
+            value = sample;
+            recentMax = 0.f;
+            quietFrames = 0;
+            return;
+        }
+        if (sample >= value * 0.5f) {
+            // Still busy enough to keep the mark
+            recentMax = 0.f;
+            quietFrames = 0;
+            return;
+        }
+        recentMax = std::max(recentMax, sample);
+        if (++quietFrames >= SHRINK_FRAMES) {
+            value = recentMax;
+            recentMax = 0.f;
+            quietFrames = 0;
+        }
+    }
+
+    bool DescriptorPoolCache::computeShape(u32& targetSets, std::array<f32, DESCRIPTOR_TYPE_COUNT>& targetRatios) const {
+        // Nothing learned yet: keep the guess
+        if (threadSets.value <= 0.f) return false;
+
+        // One pool per thread for its busiest frame, in power of two steps so small drifts do not reshape
+        const u32 wantedSets = static_cast<u32>(std::ceil(threadSets.value * HEADROOM));
+        targetSets = std::clamp(std::bit_ceil(wantedSets), MIN_SETS_PER_POOL, MAX_SETS_PER_POOL);
+        bool changed = targetSets != setsPerPool;
+
+        for (u32 type = 0; type < DESCRIPTOR_TYPE_COUNT; type++) {
+            targetRatios[type] = typeRatios[type].value * HEADROOM;
+            // Within a quarter of the current ratio is close enough
+            const f32 current = ratios[type];
+            if (std::abs(targetRatios[type] - current) > 0.25f * std::max(current, targetRatios[type])) {
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    void DescriptorPoolCache::applyShape(u32 targetSets, const std::array<f32, DESCRIPTOR_TYPE_COUNT>& targetRatios) {
+        setsPerPool = targetSets;
+        ratios = targetRatios;
+
+        poolSizes.clear();
+        descriptorsPerPool = 0;
+        for (u32 type = 0; type < DESCRIPTOR_TYPE_COUNT; type++) {
+            if (!knownTypes[type]) continue;
+            // A type guessed but not used yet keeps a few descriptors, in case a scene needs it later
+            const u32 count = std::max(MIN_DESCRIPTORS_PER_TYPE,
+                static_cast<u32>(std::ceil(ratios[type] * static_cast<f32>(setsPerPool))));
+            poolSizes.push_back({ static_cast<vk::DescriptorType>(type), count });
+            descriptorsPerPool += count;
+        }
+    }
+
+    vk::DescriptorPool DescriptorPoolCache::createPool() {
+        vk::DescriptorPoolCreateInfo poolInfo {};
+        poolInfo.maxSets = setsPerPool;
+        poolInfo.poolSizeCount = static_cast<u32>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        const vk::DescriptorPool pool = device.createDescriptorPool(poolInfo, nullptr);
+        {
+            std::lock_guard lock(shapeMutex);
+            poolShapes[static_cast<VkDescriptorPool>(pool)] = shape;
+        }
+        poolCount.fetch_add(1, std::memory_order_relaxed);
+        return pool;
+    }
+
+    void DescriptorPoolCache::destroyPool(vk::DescriptorPool pool) {
+        device.destroyDescriptorPool(pool, nullptr);
+        {
+            std::lock_guard lock(shapeMutex);
+            poolShapes.erase(static_cast<VkDescriptorPool>(pool));
+        }
+        poolCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    bool DescriptorPoolCache::popFree(vk::DescriptorPool& pool) {
+        if (!freePools.tryPop([&](const vk::DescriptorPool& free) { pool = free; })) {
+            return false;
+        }
+        freeCount.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // =========================================================================
+    // FrameDescriptorAllocator
+    // =========================================================================
+
+    void FrameDescriptorAllocator::init(DescriptorPoolCache& cache) {
+        this->cache = &cache;
+        for (ThreadAllocator& thread : threads) {
+            thread.allocator = DescriptorAllocatorGrowable { cache };
+        }
+    }
+
+    void FrameDescriptorAllocator::clear() {
+        if (cache) {
+            u32 busiestThreadSets = 0;
+            for (const ThreadAllocator& thread : threads) {
+                busiestThreadSets = std::max(busiestThreadSets, thread.allocator.getUsage().allocatedSets);
+            }
+            cache->recordFrame(getUsage(), busiestThreadSets);
+        }
+        for (ThreadAllocator& thread : threads) {
+            thread.allocator.clear();
+        }
+    }
+
+    DescriptorPoolUsage FrameDescriptorAllocator::getUsage() const {
+        DescriptorPoolUsage total;
+        for (const ThreadAllocator& thread : threads) {
+            const DescriptorPoolUsage& usage = thread.allocator.getUsage();
+            total.pools += usage.pools;
+            total.setCapacity += usage.setCapacity;
+            total.allocatedSets += usage.allocatedSets;
+            total.descriptorCapacity += usage.descriptorCapacity;
+            for (u32 type = 0; type < DESCRIPTOR_TYPE_COUNT; type++) {
+                total.allocatedDescriptors[type] += usage.allocatedDescriptors[type];
+            }
+        }
+        return total;
+    }
+
+    u32 FrameDescriptorAllocator::getThreadSlot() {
+        return threadSlot.index;
+    }
+
+} // namespace graphics
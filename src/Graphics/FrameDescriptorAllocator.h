@@ -0,0 +1,210 @@
+/**
+ * @file FrameDescriptorAllocator.h
+ * @brief Per-frame descriptor allocation from any recording thread.
+ */
+
+#pragma once
+
+#include "DescriptorAllocatorGrowable.h"
+#include "BasicServices/MpmcRing.h"
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace graphics {
+
+    /**
+     * @class DescriptorPoolCache
+     * @brief Lock-free free-list of same-sized descriptor pools, shared by all threads.
+     *
+     * ## Why a cache?
+     * A DescriptorAllocatorGrowable keeps its pools in plain vectors: it is fast,
+     * but only one thread may use it. Thread-local allocators fix that, yet each
+     * would then grow its own pools for its worst frame. Instead, every pool comes
+     * from this cache and goes back to it when its frame is reset, so a thread that
+     * records little this frame leaves its pools to a busier one.
+     *
+     * ## Learned sizes
+     * The ratios given to init() are only a first guess. Each frame reset reports
+     * what the frame used (recordFrame): the sets of its busiest thread, the
+     * descriptors of each type per set, and the pools it held. High-water marks of
+     * these rise at once and only fall after a long quiet stretch, so the pool
+     * shape follows the scenes without flapping. When the shape changes, pools of
+     * the old shape are destroyed as they come back, and new ones are made to fit.
+     *
+     * prewarm() then creates, at frame start, the pools the busiest frame needed,
+     * so allocations while recording find one ready instead of creating it. The
+     * learned marks are saved on exit and loaded on start (saveProfile/loadProfile).
+     */
+    class DescriptorPoolCache {
+    public:
+        static constexpr u32 MAX_FREE_POOLS = 256;  ///< Pools released beyond this are destroyed
+        static constexpr u32 MIN_SETS_PER_POOL = 64;
+        static constexpr u32 MAX_SETS_PER_POOL = 4096;
+        static constexpr u32 MIN_DESCRIPTORS_PER_TYPE = 16;    ///< Per pool, for every type seen or guessed
+        static constexpr f32 HEADROOM = 1.25f;                  ///< Over the high-water marks
+        static constexpr u32 SHRINK_FRAMES = 1800;              ///< Quiet frames before a mark falls (~30s at 60 Hz)
+
+        /// Pool counts, for the rendering stats and hitch hunting
+        struct Stats {
+            u32 pools { 0 };                ///< Created and not destroyed
+            u32 freePools { 0 };
+            u32 reshapes { 0 };             ///< Pool shape changes since start
+            u32 createdWhileRecording { 0 };///< Pools acquire() had to create since start
+            u32 createdThisFrame { 0 };     ///< Of those, since the last frame reset
+        };
+
+        DescriptorPoolCache() = default;
+        ~DescriptorPoolCache();
+
+        DescriptorPoolCache(const DescriptorPoolCache&) = delete;
+        DescriptorPoolCache& operator=(const DescriptorPoolCache&) = delete;
+
+        /**
+         * @brief Sets the first guess at the pools to hand out. Creates none yet.
+         * @param device The Vulkan logical device used to create pools.
+         * @param setsPerPool maxSets of every pool, until usage says otherwise.
+         * @param poolRatios Descriptor types and their count per set, until usage says otherwise.
+         */
+        void init(vk::Device device, u32 setsPerPool, std::span<const DescriptorAllocatorGrowable::PoolSizeRatio> poolRatios);
+
+        /// Destroys every free pool. Pools still held by allocators must have been released first
+        void destroy();
+
+        /// A free pool, or a new one when none is left. Any thread
+        vk::DescriptorPool acquire();
+
+        /// Resets the pool and makes it available again. Its sets must no longer be in use. Any thread
+        void release(vk::DescriptorPool pool);
+
+        /**
+         * @brief Learns from one frame's usage, and reshapes the pools when the marks moved enough.
+         * @param total Sets and descriptors of every thread, pools held by all of them.
+         * @param busiestThreadSets Sets of the thread that allocated the most.
+         *
+         * Frame reset only (render thread), while no thread is recording.
+         */
+        void recordFrame(const DescriptorPoolUsage& total, u32 busiestThreadSets);
+
+        /// Creates free pools up to the learned need of a frame. Frame start, render thread
+        void prewarm();
+
+        /// Restores the marks saved by a previous run, then the shape they give. After init(), false if none
+        bool loadProfile(const str& path);
+        bool saveProfile(const str& path) const;
+
+        vk::Device getDevice() const { return device; }
+        u32 getSetsPerPool() const { return setsPerPool; }
+        u64 getDescriptorsPerPool() const { return descriptorsPerPool; }
+
+        /// Every pool created, free or in use. allocatedSets is left to the allocators
+        DescriptorPoolUsage getUsage() const;
+        Stats getStats() const;
+
+    private:
+        /// Rises at once to any sample above it, falls to the highest recent sample
+        /// only after SHRINK_FRAMES samples in a row under half of it
+        struct HighWaterMark {
+            f32 value { 0.f };
+            f32 recentMax { 0.f };
+            u32 quietFrames { 0 };
+
+            void observe(f32 sample);
+        };
+
+        /// Pool sizes from the marks. True when they differ enough from the current ones to reshape
+        bool computeShape(u32& targetSets, std::array<f32, DESCRIPTOR_TYPE_COUNT>& targetRatios) const;
+        void applyShape(u32 targetSets, const std::array<f32, DESCRIPTOR_TYPE_COUNT>& targetRatios);
+        vk::DescriptorPool createPool();
+        void destroyPool(vk::DescriptorPool pool);
+        bool popFree(vk::DescriptorPool& pool);
+
+        vk::Device device { nullptr };
+        u32 setsPerPool { 0 };
+        u64 descriptorsPerPool { 0 };
+        std::array<f32, DESCRIPTOR_TYPE_COUNT> ratios {};   ///< Descriptors per set of the current shape
+        std::array<bool, DESCRIPTOR_TYPE_COUNT> knownTypes {};  ///< Guessed by init() or seen since: every pool has some
+        vector<vk::DescriptorPoolSize> poolSizes;           ///< Same for every pool of the current shape
+
+        // Render thread, at frame reset
+        HighWaterMark threadSets;                           ///< Sets of the busiest thread
+        HighWaterMark framePools;                           ///< Pools held by a whole frame
+        std::array<HighWaterMark, DESCRIPTOR_TYPE_COUNT> typeRatios;  ///< Descriptors per set, per type
+        u32 reshapes { 0 };
+
+        services::MpmcRing<vk::DescriptorPool, MAX_FREE_POOLS> freePools;
+        std::atomic<u32> poolCount { 0 };           ///< Created and not destroyed
+        std::atomic<u32> freeCount { 0 };           ///< In freePools
+        std::atomic<u32> createdWhileRecording { 0 };
+        std::atomic<u32> createdThisFrame { 0 };
+        u32 shape { 0 };                            ///< Bumped on reshape
+
+        /// Shape each live pool was made with. Only touched when a pool is created or released
+        std::mutex shapeMutex;
+        std::unordered_map<VkDescriptorPool, u32> poolShapes;
+    };
+
+    /**
+     * @class FrameDescriptorAllocator
+     * @brief One frame in flight's descriptor sets, with a sub-allocator per recording thread.
+     *
+     * ## How it works
+     * Each thread that records gets a slot index the first time it allocates, and
+     * keeps it until it exits. The slot is a DescriptorAllocatorGrowable fed by the
+     * shared DescriptorPoolCache: a thread only ever touches its own slot, so
+     * allocating takes no lock, and only goes to the cache (lock-free) when its
+     * current pool is full.
+     *
+     * When the frame's fence has signaled, clear() tells the cache what the frame
+     * used, then hands every slot's pools back to it, ready for whichever thread
+     * needs them next.
+     *
+     * ## Threading
+     * - allocate() / local(): any thread, each on its own slot.
+     * - clear(), getUsage(), getThreadUsage(): the frame's owner (render thread),
+     *   while no other thread records for this frame.
+     */
+    class FrameDescriptorAllocator {
+    public:
+        static constexpr u32 MAX_THREADS = 32;  ///< Threads allocating descriptors at the same time
+
+        FrameDescriptorAllocator() = default;
+
+        FrameDescriptorAllocator(const FrameDescriptorAllocator&) = delete;
+        FrameDescriptorAllocator& operator=(const FrameDescriptorAllocator&) = delete;
+
+        /// Binds every slot to the cache. Allocates nothing until a thread asks
+        void init(DescriptorPoolCache& cache);
+
+        /// The calling thread's sub-allocator for this frame
+        DescriptorAllocatorGrowable& local() { return threads[getThreadSlot()].allocator; }
+
+        /// Allocates from the calling thread's sub-allocator
+        vk::DescriptorSet allocate(vk::DescriptorSetLayout layout, const void* pNext = nullptr) {
+            return local().allocate(layout, pNext);
+        }
+
+        /// Reports the frame's usage to the cache and returns every slot's pools. All sets of this frame become invalid
+        void clear();
+
+        /// Pools held and sets allocated by every thread this frame
+        DescriptorPoolUsage getUsage() const;
+
+        /// What one slot holds and allocated this frame
+        const DescriptorPoolUsage& getThreadUsage(u32 slot) const { return threads[slot].allocator.getUsage(); }
+
+        /// Slot of the calling thread, claimed on first call and freed when the thread exits
+        static u32 getThreadSlot();
+
+    private:
+        /// Own cache line per slot, so threads allocating side by side do not share one
+        struct alignas(64) ThreadAllocator {
+            DescriptorAllocatorGrowable allocator;
+        };
+
+        std::array<ThreadAllocator, MAX_THREADS> threads;
+        DescriptorPoolCache* cache { nullptr };
+    };
+
+} // namespace graphics
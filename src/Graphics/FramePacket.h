@@ -0,0 +1,68 @@
+/**
+ * @file FramePacket.h
+ * @brief Everything the simulation hands to the render thread for one frame.
+ */
+
+#pragma once
+
+#include "Types.h"
+#include "Camera.h"
+#include "ImGuiInput.h"
+#include "RenderObject.h"
+#include "SkinningPass.h"
+
+namespace graphics {
+
+    /**
+     * @struct FramePacket
+     * @brief One simulated frame, ready to be recorded.
+     *
+     * ## Why packets?
+     * The interactive loop runs on two threads: the main thread polls input,
+     * moves the camera, animates and builds draw lists, while the render thread
+     * waits on fences, records and presents. A packet is the only thing they
+     * share. The simulation fills one in place, publishes it through an SpscRing,
+     * and does not touch it again until the render thread has released it, so
+     * the render thread reads it without locks and treats it as immutable.
+     *
+     * ## Ownership
+     * - Simulation thread: camera, animations, scene graph, draw lists and
+     *   skinning jobs. It only reads GPU handles (buffers, materials, posed
+     *   vertex addresses) created before the threads started.
+     * - Render thread: everything that records, submits or presents, FrameData
+     *   and deletion queues, the ImGui UI, and every renderer and technique setting
+     *   (they are edited through ImGui, on that thread). The ImGui SDL3 backend
+     *   stays on the main thread, SDL only allows window calls there (see ImGuiInput).
+     * - GPU resources are created and destroyed on the render thread, or while it
+     *   is not running (Engine::init, before the loop; cleanup, after the join).
+     *   Uploads go through ImmediateSubmitter, which submits to the graphics queue,
+     *   and queue submission is not thread safe.
+     */
+    struct FramePacket {
+        u64 frameNumber { 0 };          ///< Chosen by the simulation, selects the frame in flight
+        f32 deltaTime { 0.f };
+        u64 inputTimestamp { 0 };       ///< When input was sampled (Profiler::now), for latency
+        vk::Extent2D windowExtent {};   ///< Window size in pixels, 0 x 0 while minimized
+
+        Camera camera;                  ///< Already updated for this frame
+        GPUSceneData sceneData {};      ///< View and projection only, lighting is the renderer's
+        DrawContext drawContext;
+        SkinningBatch skinning;         ///< Targets the posed buffers of frameNumber % FRAME_OVERLAP
+
+        ImGuiFrameInput ui;             ///< Display size and input for the render thread's ImGui context
+
+        bool captureRequested { false };    ///< Start a frame capture (F9)
+        bool lastFrame { false };           ///< Stops the render thread, nothing to draw
+
+        /// Makes a recycled packet ready to be filled again, keeping its capacities
+        void reset() {
+            drawContext.opaqueSurfaces.clear();
+            drawContext.transparentSurfaces.clear();
+            skinning.clear();
+            ui.clear();
+            captureRequested = false;
+            lastFrame = false;
+        }
+    };
+
+} // namespace graphics
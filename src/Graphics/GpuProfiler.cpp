@@ -0,0 +1,387 @@
+/**
+ * @file GpuProfiler.cpp
+ * @brief Implementation of the timestamp query profiler.
+ */
+
+#include "GpuProfiler.h"
+
+#include "VulkanContext.h"
+#include "../BasicServices/FileWriter.h"
+#include "../BasicServices/Log.h"
+#include <algorithm>
+#include <cstring>
+#include <fmt/format.h>
+#include <imgui.h>
+
+using services::Log;
+
+namespace graphics {
+
+    namespace {
+        constexpr u32 INVALID_SCOPE = UINT32_MAX;
+
+        // Results come back in bit order, one u64 per flag
+        constexpr vk::QueryPipelineStatisticFlags PIPELINE_STATISTICS =
+            vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+            vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+            vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+            vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+            vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations |
+            vk::QueryPipelineStatisticFlagBits::eComputeShaderInvocations;
+
+        f32 percentile(const vector<f32>& sorted, f32 fraction) {
+            const size_t index = static_cast<size_t>(fraction * static_cast<f32>(sorted.size() - 1) + 0.5f);
+            return sorted[std::min(index, sorted.size() - 1)];
+        }
+    }
+
+    GpuPipelineStats& GpuPipelineStats::operator+=(const GpuPipelineStats& other) {
+        inputVertices += other.inputVertices;
+        inputPrimitives += other.inputPrimitives;
+        vertexInvocations += other.vertexInvocations;
+        clippingPrimitives += other.clippingPrimitives;
+        fragmentInvocations += other.fragmentInvocations;
+        computeInvocations += other.computeInvocations;
+        targetPixels = std::max(targetPixels, other.targetPixels);
+        return *this;
+    }
+
+    // =========================================================================
+    // Lifetime
+    // =========================================================================
+
+    void GpuProfiler::init(VulkanContext* context) {
+        this->context = context;
+
+        const vk::PhysicalDevice physicalDevice = context->getPhysicalDevice();
+        const vk::PhysicalDeviceLimits limits = physicalDevice.getProperties().limits;
+        const auto queueFamilies = physicalDevice.getQueueFamilyProperties();
+        const u32 validBits = queueFamilies[context->getGraphicsQueueFamily()].timestampValidBits;
+
+        if (validBits == 0 || limits.timestampPeriod <= 0.0f) {
+            Log::Warn("GPU profiler: timestamps not supported on the graphics queue, disabled");
+            supported = false;
+            return;
+        }
+
+        supported = true;
+        timestampPeriod = limits.timestampPeriod;
+        timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+        vk::QueryPoolCreateInfo poolInfo {};
+        poolInfo.queryType = vk::QueryType::eTimestamp;
+        poolInfo.queryCount = MAX_SCOPES * 2;
+
+        // Statistics queries need a device feature, enabled by VulkanContext when available
+        pipelineStatisticsSupported = context->supportsPipelineStatistics();
+
+        vk::QueryPoolCreateInfo statsPoolInfo {};
+        statsPoolInfo.queryType = vk::QueryType::ePipelineStatistics;
+        statsPoolInfo.queryCount = MAX_SCOPES;
+        statsPoolInfo.pipelineStatistics = PIPELINE_STATISTICS;
+
+        for (FrameQueries& frame : frames) {
+            frame.pool = context->getDevice().createQueryPool(poolInfo);
+            if (pipelineStatisticsSupported) {
+                frame.statsPool = context->getDevice().createQueryPool(statsPoolInfo);
+            }
+            frame.scopes.reserve(MAX_SCOPES);
+        }
+    }
+
+    void GpuProfiler::cleanup(vk::Device device) {
+        for (FrameQueries& frame : frames) {
+            if (frame.pool) {
+                device.destroyQueryPool(frame.pool);
+                frame.pool = nullptr;
+            }
+            if (frame.statsPool) {
+                device.destroyQueryPool(frame.statsPool);
+                frame.statsPool = nullptr;
+            }
+            frame.scopes.clear();
+        }
+        currentFrame = nullptr;
+    }
+
+    // =========================================================================
+    // Recording
+    // =========================================================================
+
+    void GpuProfiler::beginFrame(vk::CommandBuffer cmd, u32 frameIndex) {
+        currentFrame = nullptr;
+        if (!supported) return;
+
+        FrameQueries& frame = frames[frameIndex];
+        // The frame fence has been waited on: these queries are complete
+        resolve(frame);
+        frame.scopes.clear();
+        frame.openScopes = 0;
+        frame.statsQueryCount = 0;
+        frame.frameNumber = frameCount++;
+
+        if (!enabled) return;
+
+        cmd.resetQueryPool(frame.pool, 0, MAX_SCOPES * 2);
+        if (isPipelineStatisticsEnabled()) {
+            cmd.resetQueryPool(frame.statsPool, 0, MAX_SCOPES);
+        }
+        currentFrame = &frame;
+    }
+
+    u32 GpuProfiler::beginScope(vk::CommandBuffer cmd, const char* name, u64 targetPixels) {
+        if (!currentFrame || currentFrame->scopes.size() >= MAX_SCOPES) {
+            return INVALID_SCOPE;
+        }
+
+        const u32 scope = static_cast<u32>(currentFrame->scopes.size());
+        const u32 depth = currentFrame->openScopes++;
+
+        // Statistics only on top-level scopes: a nested query of the same type is not allowed
+        u32 statsQuery = NO_QUERY;
+        if (depth == 0 && isPipelineStatisticsEnabled()) {
+            statsQuery = currentFrame->statsQueryCount++;
+        }
+
+        currentFrame->scopes.push_back({ name, depth, statsQuery, targetPixels > 0 ? targetPixels : frameTargetPixels });
+        cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eTopOfPipe, currentFrame->pool, scope * 2);
+        if (statsQuery != NO_QUERY) {
+            cmd.beginQuery(currentFrame->statsPool, statsQuery, {});
+        }
+        return scope;
+    }
+
+    void GpuProfiler::endScope(vk::CommandBuffer cmd, u32 scope) {
+        if (!currentFrame || scope == INVALID_SCOPE) return;
+
+        const u32 statsQuery = currentFrame->scopes[scope].statsQuery;
+        if (statsQuery != NO_QUERY) {
+            cmd.endQuery(currentFrame->statsPool, statsQuery);
+        }
+
+        // Written once all previous commands have completed
+        cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eBottomOfPipe, currentFrame->pool, scope * 2 + 1);
+        currentFrame->openScopes--;
+    }
+
+    // =========================================================================
+    // Results
+    // =========================================================================
+
+    void GpuProfiler::resolve(FrameQueries& frame) {
+        if (frame.scopes.empty()) return;
+
+        const u32 queryCount = static_cast<u32>(frame.scopes.size()) * 2;
+        std::array<u64, MAX_SCOPES * 2> timestamps {};
+        const vk::Result result = context->getDevice().getQueryPoolResults(
+            frame.pool, 0, queryCount, queryCount * sizeof(u64), timestamps.data(), sizeof(u64),
+            vk::QueryResultFlagBits::e64);
+        if (result != vk::Result::eSuccess) {
+            // eNotReady should not happen after the fence wait; drop the frame rather than stall
+            return;
+        }
+
+        std::array<u64, MAX_SCOPES * PIPELINE_STATISTICS_COUNT> statistics {};
+        bool hasStatistics = false;
+        if (frame.statsQueryCount > 0) {
+            constexpr u32 stride = PIPELINE_STATISTICS_COUNT * sizeof(u64);
+            const vk::Result statsResult = context->getDevice().getQueryPoolResults(
+                frame.statsPool, 0, frame.statsQueryCount, frame.statsQueryCount * stride, statistics.data(), stride,
+                vk::QueryResultFlagBits::e64);
+            hasStatistics = statsResult == vk::Result::eSuccess;
+        }
+
+        // Same-name scopes (e.g. two shadow passes) are summed into one sample
+        vector<GpuPassSample>& frameSamples = lastFrameSamples;
+        frameSamples.clear();
+        f32 frameTotal = 0.0f;
+        for (u32 i = 0; i < frame.scopes.size(); i++) {
+            const Scope& scope = frame.scopes[i];
+            const u64 ticks = (timestamps[i * 2 + 1] - timestamps[i * 2]) & timestampMask;
+            const f32 ms = static_cast<f32>(static_cast<f64>(ticks) * timestampPeriod / 1'000'000.0);
+            if (scope.depth == 0) {
+                frameTotal += ms;
+            }
+
+            GpuPipelineStats pipeline;
+            const bool scopeHasStatistics = hasStatistics && scope.statsQuery != NO_QUERY;
+            if (scopeHasStatistics) {
+                const u64* counters = &statistics[scope.statsQuery * PIPELINE_STATISTICS_COUNT];
+                pipeline.inputVertices = counters[0];
+                pipeline.inputPrimitives = counters[1];
+                pipeline.vertexInvocations = counters[2];
+                pipeline.clippingPrimitives = counters[3];
+                pipeline.fragmentInvocations = counters[4];
+                pipeline.computeInvocations = counters[5];
+                pipeline.targetPixels = scope.targetPixels;
+            }
+
+            auto it = std::find_if(frameSamples.begin(), frameSamples.end(),
+                [&](const GpuPassSample& sample) { return std::strcmp(sample.name, scope.name) == 0; });
+            if (it != frameSamples.end()) {
+                it->ms += ms;
+                it->hasPipelineStats |= scopeHasStatistics;
+                it->pipeline += pipeline;
+            } else {
+                frameSamples.push_back({ scope.name, ms, scopeHasStatistics, pipeline });
+            }
+        }
+
+        for (const GpuPassSample& sample : frameSamples) {
+            addSample(sample);
+        }
+        lastFrameMs = frameTotal;
+        lastResolvedFrame = frame.frameNumber;
+    }
+
+    void GpuProfiler::addSample(const GpuPassSample& sample) {
+        const f32 ms = sample.ms;
+        size_t index = 0;
+        while (index < passStats.size() && passStats[index].name != sample.name) {
+            index++;
+        }
+        if (index == passStats.size()) {
+            GpuPassStats stats;
+            stats.name = sample.name;
+            passStats.push_back(stats);
+            passHistories.emplace_back();
+            passHistories.back().reserve(HISTORY_SIZE);
+            historyCursors.push_back(0);
+        }
+
+        vector<f32>& history = passHistories[index];
+        if (history.size() < HISTORY_SIZE) {
+            history.push_back(ms);
+        } else {
+            history[historyCursors[index]] = ms;
+        }
+        historyCursors[index] = (historyCursors[index] + 1) % HISTORY_SIZE;
+
+        passStats[index].lastMs = ms;
+        passStats[index].hasPipelineStats = sample.hasPipelineStats;
+        passStats[index].pipeline = sample.pipeline;
+        updateStats(passStats[index], history);
+    }
+
+    void GpuProfiler::updateStats(GpuPassStats& stats, const vector<f32>& history) {
+        vector<f32> sorted = history;
+        std::sort(sorted.begin(), sorted.end());
+
+        f32 sum = 0.0f;
+        for (const f32 sample : sorted) {
+            sum += sample;
+        }
+
+        stats.sampleCount = static_cast<u32>(sorted.size());
+        stats.averageMs = sum / static_cast<f32>(sorted.size());
+        stats.p50Ms = percentile(sorted, 0.50f);
+        stats.p95Ms = percentile(sorted, 0.95f);
+        stats.p99Ms = percentile(sorted, 0.99f);
+        stats.maxMs = sorted.back();
+    }
+
+    bool GpuProfiler::exportCsv(const str& path) const {
+        services::FileWriter writer;
+        if (!writer.open(path)) {
+            Log::Error("GPU profiler: cannot open %s", path.c_str());
+            return false;
+        }
+
+        writer.writeLine("pass,samples,last_ms,avg_ms,p50_ms,p95_ms,p99_ms,max_ms,"
+                         "ia_vertices,ia_primitives,vs_invocations,clipping_primitives,fs_invocations,cs_invocations,overdraw");
+        for (const GpuPassStats& stats : passStats) {
+            const GpuPipelineStats& p = stats.pipeline;
+            writer.writeLine(fmt::format("{},{},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{},{},{},{},{},{},{:.3f}",
+                stats.name, stats.sampleCount, stats.lastMs, stats.averageMs,
+                stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs,
+                p.inputVertices, p.inputPrimitives, p.vertexInvocations, p.clippingPrimitives,
+                p.fragmentInvocations, p.computeInvocations, p.getOverdraw()));
+        }
+        writer.close();
+
+        Log::Info("GPU profiler: %zu passes exported to %s", passStats.size(), path.c_str());
+        return true;
+    }
+
+    // =========================================================================
+    // ImGui
+    // =========================================================================
+
+    void GpuProfiler::drawImGui() {
+        if (ImGui::Begin("GPU Profiler")) {
+            if (!supported) {
+                ImGui::Text("Timestamp queries are not supported on this device");
+                ImGui::End();
+                return;
+            }
+
+            ImGui::Checkbox("Enabled", &enabled);
+            ImGui::SameLine();
+            if (ImGui::Button("Export CSV")) {
+                exportCsv("gpu_profile.csv");
+            }
+            if (pipelineStatisticsSupported) {
+                ImGui::Checkbox("Pipeline statistics", &pipelineStatisticsEnabled);
+            } else {
+                ImGui::TextDisabled("Pipeline statistics not supported");
+            }
+            ImGui::Text("GPU frame: %.3f ms (last %u frames)", lastFrameMs, HISTORY_SIZE);
+
+            const bool showStatistics = isPipelineStatisticsEnabled();
+            const int columns = showStatistics ? 12 : 6;
+            constexpr ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+            if (ImGui::BeginTable("GpuPasses", columns, flags)) {
+                ImGui::TableSetupColumn("Pass");
+                ImGui::TableSetupColumn("Last");
+                ImGui::TableSetupColumn("Avg");
+                ImGui::TableSetupColumn("P95");
+                ImGui::TableSetupColumn("P99");
+                ImGui::TableSetupColumn("Max");
+                if (showStatistics) {
+                    ImGui::TableSetupColumn("Prims");
+                    ImGui::TableSetupColumn("VS");
+                    ImGui::TableSetupColumn("Clipped");
+                    ImGui::TableSetupColumn("FS");
+                    ImGui::TableSetupColumn("Overdraw");
+                    ImGui::TableSetupColumn("FS/VS");
+                }
+                ImGui::TableHeadersRow();
+
+                for (const GpuPassStats& stats : passStats) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(stats.name.c_str());
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.lastMs);
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.averageMs);
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.p95Ms);
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.p99Ms);
+                    ImGui::TableNextColumn(); ImGui::Text("%.3f", stats.maxMs);
+                    if (!showStatistics) continue;
+
+                    const GpuPipelineStats& p = stats.pipeline;
+                    if (!stats.hasPipelineStats) {
+                        // Nested scope, counted in its parent
+                        for (int i = 0; i < 6; i++) {
+                            ImGui::TableNextColumn(); ImGui::TextDisabled("-");
+                        }
+                    } else if (p.inputPrimitives == 0 && p.computeInvocations > 0) {
+                        // Compute pass: only invocations are meaningful
+                        ImGui::TableNextColumn(); ImGui::Text("CS %llu", static_cast<unsigned long long>(p.computeInvocations));
+                        for (int i = 0; i < 5; i++) {
+                            ImGui::TableNextColumn(); ImGui::TextDisabled("-");
+                        }
+                    } else {
+                        ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(p.inputPrimitives));
+                        ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(p.vertexInvocations));
+                        ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(p.clippingPrimitives));
+                        ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(p.fragmentInvocations));
+                        ImGui::TableNextColumn(); ImGui::Text("%.2fx", p.getOverdraw());
+                        ImGui::TableNextColumn(); ImGui::Text("%.1f", p.getFragmentsPerVertex());
+                    }
+                }
+                ImGui::EndTable();
+            }
+        }
+        ImGui::End();
+    }
+
+} // namespace graphics
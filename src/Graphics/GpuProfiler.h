@@ -0,0 +1,211 @@
+/**
+ * @file GpuProfiler.h
+ * @brief Per-pass GPU timings with timestamp queries.
+ */
+
+#pragma once
+
+#include "Types.h"
+#include <array>
+
+namespace graphics {
+    class VulkanContext;
+
+    /**
+     * @struct GpuPipelineStats
+     * @brief Pipeline statistics query counters of one pass.
+     */
+    struct GpuPipelineStats {
+        u64 inputVertices { 0 };        ///< Vertices read by the input assembler
+        u64 inputPrimitives { 0 };      ///< Primitives assembled
+        u64 vertexInvocations { 0 };    ///< Vertex shader runs (below inputVertices when the post-transform cache hits)
+        u64 clippingPrimitives { 0 };   ///< Primitives left after clipping and culling
+        u64 fragmentInvocations { 0 };  ///< Fragment shader runs
+        u64 computeInvocations { 0 };   ///< Compute shader invocations
+        u64 targetPixels { 0 };         ///< Pixels of the pass's render target, 0 if unknown
+
+        /// Fragment shader runs per target pixel: 1 = each pixel shaded once, 3 = shaded three times on average
+        f32 getOverdraw() const {
+            return targetPixels > 0 ? static_cast<f32>(fragmentInvocations) / static_cast<f32>(targetPixels) : 0.0f;
+        }
+
+        /// Fragment per vertex shader runs: large when the pass is fragment-heavy, small when vertex-heavy
+        f32 getFragmentsPerVertex() const {
+            return vertexInvocations > 0 ? static_cast<f32>(fragmentInvocations) / static_cast<f32>(vertexInvocations) : 0.0f;
+        }
+
+        GpuPipelineStats& operator+=(const GpuPipelineStats& other);
+    };
+
+    /**
+     * @struct GpuPassStats
+     * @brief Rolling statistics of one named GPU pass, in milliseconds.
+     */
+    struct GpuPassStats {
+        str name;
+        f32 lastMs { 0.0f };
+        f32 averageMs { 0.0f };
+        f32 p50Ms { 0.0f };
+        f32 p95Ms { 0.0f };
+        f32 p99Ms { 0.0f };
+        f32 maxMs { 0.0f };
+        u32 sampleCount { 0 };
+        bool hasPipelineStats { false };    ///< True if pipeline holds counters of the last resolved frame
+        GpuPipelineStats pipeline;          ///< Counters of the last resolved frame
+    };
+
+    /**
+     * @struct GpuPassSample
+     * @brief Time of one pass in one resolved frame.
+     */
+    struct GpuPassSample {
+        const char* name;
+        f32 ms;
+        bool hasPipelineStats { false };
+        GpuPipelineStats pipeline;
+    };
+
+    /**
+     * @class GpuProfiler
+     * @brief Measures how long each render pass takes on the GPU.
+     *
+     * ## How are GPU passes timed?
+     * CPU timers only measure command recording. To know what the GPU spends, we ask it
+     * to write timestamps (vkCmdWriteTimestamp2) in the command buffer before and after
+     * each pass. The difference, multiplied by timestampPeriod, gives nanoseconds.
+     *
+     * ## Reading results without stalling
+     * Each frame in flight owns its own query pool. Results are read when that frame
+     * slot comes around again, right after its fence has been waited on, i.e.
+     * FRAME_OVERLAP frames later. At that point the queries are guaranteed to be
+     * available, so vkGetQueryPoolResults never blocks.
+     *
+     * ## Usage
+     * @code
+     * {
+     *     GpuScope scope(renderer->getGpuProfiler(), cmd, "Shadow");
+     *     // ... record the shadow pass ...
+     * }   // end timestamp written here
+     * @endcode
+     *
+     * Scopes may nest. Passes with the same name recorded several times in a frame are summed.
+     *
+     * ## Pipeline statistics
+     * When enabled (and the device supports pipelineStatisticsQuery), top-level scopes
+     * also run a pipeline statistics query counting vertices, primitives and shader
+     * invocations. They are read back like timestamps, without stalling. Dividing the
+     * fragment invocations by the target pixels gives the pass overdraw; comparing them
+     * to vertex invocations tells whether the pass is vertex- or fragment-heavy.
+     * Nested scopes only get timestamps: a command buffer can have a single active
+     * query of a type at a time.
+     */
+    class GpuProfiler {
+    public:
+        static constexpr u32 MAX_SCOPES = 64;       ///< Scopes per frame
+        static constexpr u32 HISTORY_SIZE = 240;    ///< Samples kept per pass for averages/percentiles
+
+        void init(VulkanContext* context);
+        void cleanup(vk::Device device);
+
+        /// Collects the results of this frame slot's previous use and resets its queries.
+        /// Call once per frame, after the frame fence wait and command.begin().
+        void beginFrame(vk::CommandBuffer cmd, u32 frameIndex);
+
+        /// Pixels of the render target passes cover unless their scope says otherwise (overdraw)
+        void setFrameTargetPixels(u64 pixels) { frameTargetPixels = pixels; }
+
+        /// Writes the start timestamp of a pass. Returns a scope id for endScope (or UINT32_MAX if full).
+        /// targetPixels overrides the frame target size for passes drawing elsewhere (e.g. the shadow map)
+        u32 beginScope(vk::CommandBuffer cmd, const char* name, u64 targetPixels = 0);
+        void endScope(vk::CommandBuffer cmd, u32 scope);
+
+        bool isSupported() const { return supported; }
+        bool isEnabled() const { return enabled && supported; }
+        void setEnabled(bool enable) { enabled = enable; }
+
+        bool isPipelineStatisticsSupported() const { return pipelineStatisticsSupported; }
+        bool isPipelineStatisticsEnabled() const { return pipelineStatisticsEnabled && pipelineStatisticsSupported; }
+        void setPipelineStatisticsEnabled(bool enable) { pipelineStatisticsEnabled = enable; }
+
+        /// Statistics of every pass seen so far, in first-seen order
+        const vector<GpuPassStats>& getPassStats() const { return passStats; }
+        /// Sum of the top-level scopes of the last resolved frame
+        f32 getLastFrameMs() const { return lastFrameMs; }
+        /// Per-pass times of the last resolved frame (same-name scopes summed)
+        const vector<GpuPassSample>& getLastFrameSamples() const { return lastFrameSamples; }
+        /// Number of frames begun so far; frame N is resolved FRAME_OVERLAP frames later
+        u64 getFrameCount() const { return frameCount; }
+        /// Number of the last resolved frame, or UINT64_MAX if none yet
+        u64 getLastResolvedFrame() const { return lastResolvedFrame; }
+
+        /// Writes one line per pass (name, samples, last, avg, p50, p95, p99, max, then the
+        /// pipeline statistics of the last frame). Returns false on I/O error
+        bool exportCsv(const str& path) const;
+
+        void drawImGui();
+
+    private:
+        static constexpr u32 PIPELINE_STATISTICS_COUNT = 6;  ///< Counters per statistics query
+        static constexpr u32 NO_QUERY = UINT32_MAX;
+
+        struct Scope {
+            const char* name;
+            u32 depth;          ///< Nesting level, 0 = top-level pass
+            u32 statsQuery;     ///< Pipeline statistics query, NO_QUERY if none
+            u64 targetPixels;
+        };
+
+        struct FrameQueries {
+            vk::QueryPool pool { nullptr };
+            vk::QueryPool statsPool { nullptr };    ///< Pipeline statistics, null if unsupported
+            u64 frameNumber { 0 };
+            vector<Scope> scopes;
+            u32 openScopes { 0 };
+            u32 statsQueryCount { 0 };
+        };
+
+        void resolve(FrameQueries& frame);
+        void addSample(const GpuPassSample& sample);
+        void updateStats(GpuPassStats& stats, const vector<f32>& history);
+
+        VulkanContext* context { nullptr };
+        bool supported { false };
+        bool enabled { true };
+        f32 timestampPeriod { 1.0f };   ///< Nanoseconds per timestamp tick
+        u64 timestampMask { ~0ull };    ///< Valid bits of a timestamp
+        bool pipelineStatisticsSupported { false };
+        bool pipelineStatisticsEnabled { false };
+        u64 frameTargetPixels { 0 };
+
+        std::array<FrameQueries, FRAME_OVERLAP> frames;
+        FrameQueries* currentFrame { nullptr };
+
+        vector<GpuPassStats> passStats;
+        vector<vector<f32>> passHistories;  ///< Ring buffers, parallel to passStats
+        vector<u32> historyCursors;
+        f32 lastFrameMs { 0.0f };
+        vector<GpuPassSample> lastFrameSamples;
+        u64 frameCount { 0 };
+        u64 lastResolvedFrame { UINT64_MAX };
+    };
+
+    /**
+     * @class GpuScope
+     * @brief RAII timestamp pair around a GPU pass.
+     */
+    class GpuScope {
+    public:
+        GpuScope(GpuProfiler& profiler, vk::CommandBuffer cmd, const char* name, u64 targetPixels = 0)
+            : profiler(profiler), cmd(cmd), scope(profiler.beginScope(cmd, name, targetPixels)) {}
+        ~GpuScope() { profiler.endScope(cmd, scope); }
+
+        GpuScope(const GpuScope&) = delete;
+        GpuScope& operator=(const GpuScope&) = delete;
+
+    private:
+        GpuProfiler& profiler;
+        vk::CommandBuffer cmd;
+        u32 scope;
+    };
+
+} // namespace graphics
@@ -0,0 +1,12 @@
+/**
+ * @file ImGuiConfig.h
+ * @brief ImGui build configuration, included by imgui.h through IMGUI_USER_CONFIG.
+ */
+
+#pragma once
+
+// The current ImGui context is per thread: the main thread runs the SDL3 platform
+// backend on a context of its own, the render thread builds the UI on another (see ImGuiInput)
+struct ImGuiContext;
+extern thread_local ImGuiContext* ImGuiThreadContext;
+#define GImGui ImGuiThreadContext
@@ -0,0 +1,132 @@
+/**
+ * @file ImGuiInput.cpp
+ * @brief Implementation of the ImGui platform to UI hand-over between threads.
+ */
+
+#include "ImGuiInput.h"
+
+#include <backends/imgui_impl_sdl3.h>
+
+// Current context of each thread, see ImGuiConfig.h
+thread_local ImGuiContext* ImGuiThreadContext = nullptr;
+
+namespace graphics {
+
+    void ImGuiInput::init(SDL_Window* window, ImGuiContext* renderContext) {
+        ImGuiContext* previous = ImGui::GetCurrentContext();
+
+        platformContext = ImGui::CreateContext();
+        ImGui::SetCurrentContext(platformContext);
+        ImGui_ImplSDL3_InitForVulkan(window);
+        const ImGuiBackendFlags platformFlags = ImGui::GetIO().BackendFlags;
+
+        // The render context has no platform backend: text input requests come here instead
+        ImGui::SetCurrentContext(renderContext);
+        ImGuiIO& io = ImGui::GetIO();
+        io.UserData = this;
+        io.BackendFlags |= platformFlags & ImGuiBackendFlags_HasMouseCursors;
+        ImGui::GetPlatformIO().Platform_SetImeDataFn = storeImeData;
+
+        ImGui::SetCurrentContext(previous);
+    }
+
+    void ImGuiInput::cleanup() {
+        if (!platformContext) return;
+
+        ImGuiContext* previous = ImGui::GetCurrentContext();
+        ImGui::SetCurrentContext(platformContext);
+        ImGui_ImplSDL3_Shutdown();
+        ImGui::DestroyContext(platformContext);
+        ImGui::SetCurrentContext(previous != platformContext ? previous : nullptr);
+        platformContext = nullptr;
+    }
+
+    void ImGuiInput::processEvent(const SDL_Event& event) {
+        ImGui::SetCurrentContext(platformContext);
+        ImGui_ImplSDL3_ProcessEvent(&event);
+    }
+
+    void ImGuiInput::newFrame(ImGuiFrameInput& input) {
+        ImGui::SetCurrentContext(platformContext);
+
+        ImGuiPlatformImeData ime;
+        bool imeRequested = false;
+        {
+            std::lock_guard lock(imeMutex);
+            std::swap(imeRequested, imeChanged);
+            ime = imeData;
+        }
+        ImGuiPlatformIO& platformIo = ImGui::GetPlatformIO();
+        if (imeRequested && platformIo.Platform_SetImeDataFn) {
+            platformIo.Platform_SetImeDataFn(platformContext, ImGui::GetMainViewport(), &ime);
+        }
+
+        // The backend sets the cursor shape its own context asks for
+        ImGui::SetMouseCursor(cursor.load(std::memory_order_relaxed));
+        ImGui_ImplSDL3_NewFrame();
+
+        const ImGuiIO& io = ImGui::GetIO();
+        input.displaySize = io.DisplaySize;
+        input.framebufferScale = io.DisplayFramebufferScale;
+        input.deltaTime = io.DeltaTime;
+
+        // This context never runs a frame: its queued input goes to the render thread's instead
+        ImGuiContext& g = *platformContext;
+        for (const ImGuiInputEvent& event : g.InputEventsQueue) {
+            input.events.push_back(event);
+            trackState(event);
+        }
+        g.InputEventsQueue.resize(0);
+    }
+
+    void ImGuiInput::trackState(const ImGuiInputEvent& event) {
+        // io.Add*Event() drop an event equal to the last known state, which a frame would
+        // have updated. Without it, a button released after its press was handed over is lost
+        ImGuiIO& io = ImGui::GetIO();
+        switch (event.Type) {
+        case ImGuiInputEventType_MousePos:
+            io.MousePos = ImVec2(event.MousePos.PosX, event.MousePos.PosY);
+            break;
+        case ImGuiInputEventType_MouseButton:
+            io.MouseDown[event.MouseButton.Button] = event.MouseButton.Down;
+            break;
+        case ImGuiInputEventType_Key: {
+            ImGuiKeyData* key = ImGui::GetKeyData(event.Key.Key);
+            key->Down = event.Key.Down;
+            key->AnalogValue = event.Key.AnalogValue;
+            break;
+        }
+        case ImGuiInputEventType_Focus:
+            io.AppFocusLost = !event.AppFocused.Focused;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void ImGuiInput::apply(const ImGuiFrameInput& input) {
+        ImGuiIO& io = ImGui::GetIO();
+        io.DisplaySize = input.displaySize;
+        io.DisplayFramebufferScale = input.framebufferScale;
+        io.DeltaTime = input.deltaTime > 0.f ? input.deltaTime : 1.f / 60.f;
+
+        // As if the backend had queued them on this context
+        ImGuiContext& g = *ImGui::GetCurrentContext();
+        for (ImGuiInputEvent event : input.events) {
+            event.EventId = g.InputEventsNextEventId++;
+            g.InputEventsQueue.push_back(event);
+        }
+    }
+
+    void ImGuiInput::publishCursor() {
+        cursor.store(ImGui::GetMouseCursor(), std::memory_order_relaxed);
+    }
+
+    void ImGuiInput::storeImeData(ImGuiContext* context, ImGuiViewport*, ImGuiPlatformImeData* data) {
+        ImGuiInput* input = static_cast<ImGuiInput*>(context->IO.UserData);
+        std::lock_guard lock(input->imeMutex);
+        input->imeData = *data;
+        input->imeChanged = true;
+    }
+
+} // namespace graphics
@@ -0,0 +1,87 @@
+/**
+ * @file ImGuiInput.h
+ * @brief ImGui platform side on the main thread, UI side on the render thread.
+ */
+
+#pragma once
+
+#include "Types.h"
+#include <atomic>
+#include <mutex>
+#include <imgui.h>
+#include <imgui_internal.h>
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_video.h>
+
+namespace graphics {
+
+    /// What the render thread's ImGui context needs from the platform for one frame
+    struct ImGuiFrameInput {
+        ImVec2 displaySize { 0.f, 0.f };
+        ImVec2 framebufferScale { 1.f, 1.f };
+        f32 deltaTime { 0.f };
+        vector<ImGuiInputEvent> events;     ///< Mouse, keyboard, text and focus, in order
+
+        void clear() { events.clear(); }
+    };
+
+    /**
+     * @class ImGuiInput
+     * @brief Runs the ImGui SDL3 backend on the main thread, for a UI built on the render thread.
+     *
+     * ## Why?
+     * SDL3 only allows window, input, cursor, clipboard and text input calls on the
+     * main thread, and ImGui_ImplSDL3_ProcessEvent() and ImGui_ImplSDL3_NewFrame()
+     * make them. The UI itself is built and recorded on the render thread, with
+     * the renderer's settings it edits.
+     *
+     * ## How it works
+     * Each thread has its own current ImGui context (see ImGuiConfig.h):
+     * - The main thread's context only holds the SDL3 backend. processEvent() and
+     *   newFrame() run it, then newFrame() moves the input events it queued, the
+     *   display size and the delta time into the frame packet.
+     * - The render thread's context has the Vulkan backend and no platform backend.
+     *   apply() queues the packet's input there before ImGui::NewFrame().
+     *
+     * Requests going the other way, the mouse cursor shape and text input (IME),
+     * are left here by the render thread and carried out by the next newFrame().
+     * Without a platform backend, the UI's clipboard stays inside ImGui.
+     */
+    class ImGuiInput {
+    public:
+        ImGuiInput() = default;
+
+        ImGuiInput(const ImGuiInput&) = delete;
+        ImGuiInput& operator=(const ImGuiInput&) = delete;
+
+        /// Main thread. Creates the platform context; renderContext gets the render thread's hooks
+        void init(SDL_Window* window, ImGuiContext* renderContext);
+        /// Main thread, before renderContext is destroyed
+        void cleanup();
+
+        /// Main thread, for each polled event
+        void processEvent(const SDL_Event& event);
+        /// Main thread, once the events are polled: fills the frame's input
+        void newFrame(ImGuiFrameInput& input);
+
+        /// Render thread, renderContext current, before ImGui::NewFrame()
+        static void apply(const ImGuiFrameInput& input);
+        /// Render thread, renderContext current, after ImGui::Render()
+        void publishCursor();
+
+    private:
+        /// Platform_SetImeDataFn of the render context
+        static void storeImeData(ImGuiContext* context, ImGuiViewport* viewport, ImGuiPlatformImeData* data);
+        /// Lets the platform context forget the state of events handed over, see newFrame()
+        static void trackState(const ImGuiInputEvent& event);
+
+        ImGuiContext* platformContext { nullptr };
+
+        std::atomic<i32> cursor { ImGuiMouseCursor_Arrow };   ///< Render thread's last requested cursor
+
+        std::mutex imeMutex;
+        ImGuiPlatformImeData imeData {};                       ///< Guarded by imeMutex
+        bool imeChanged { false };                             ///< Guarded by imeMutex
+    };
+
+} // namespace graphics
@@ -9,6 +9,7 @@
 #include "Image.h"
 
 #include "Buffer.h"
+#include "DeletionQueue.hpp"
 #include "Utils.hpp"
 #include "VulkanContext.h"
 #include "VulkanInit.hpp"
@@ -20,7 +21,7 @@ namespace graphics {
     // =========================================================================
 
     Image::Image(VulkanContext *context, vk::Extent3D size, vk::Format format, vk::ImageUsageFlags usage,
-                 bool mipmapped) : context(context), allocation(nullptr), imageExtent(size), imageFormat(format) {
+                 bool mipmapped, MemoryCategory category, const char* name) : context(context), allocation(nullptr), imageExtent(size), imageFormat(format) {
         image = nullptr;
         imageView = nullptr;
 
@@ -44,6 +45,7 @@ namespace graphics {
         VkImage newImage = VK_NULL_HANDLE;
         vmaCreateImage(context->getAllocator(), &img_info, &allocinfo, &newImage, &allocation, nullptr);
         image = newImage;
+        context->getMemoryTracker().track(allocation, category, name);
 
         // Determine the correct aspect flag based on format
         // Depth images use eDepth, color images use eColor
@@ -66,7 +68,7 @@ namespace graphics {
     // =========================================================================
 
     Image::Image(VulkanContext *context, vk::Extent3D size, vk::Format format, vk::ImageUsageFlags usage,
-                 uint32_t mipLevels) : context(context), allocation(nullptr), imageExtent(size), imageFormat(format) {
+                 uint32_t mipLevels, MemoryCategory category, const char* name) : context(context), allocation(nullptr), imageExtent(size), imageFormat(format) {
         image = nullptr;
         imageView = nullptr;
 
@@ -81,6 +83,7 @@ namespace graphics {
         VkImage newImage = VK_NULL_HANDLE;
         vmaCreateImage(context->getAllocator(), &img_info, &allocinfo, &newImage, &allocation, nullptr);
         image = newImage;
+        context->getMemoryTracker().track(allocation, category, name);
 
         // Determine aspect flag (depth vs color)
         vk::ImageAspectFlags aspectFlag = vk::ImageAspectFlagBits::eColor;
@@ -100,16 +103,18 @@ namespace graphics {
     // Constructor: Image with Data Upload
     // =========================================================================
 
-    Image::Image(VulkanContext *context, ImmediateSubmitter& submitter, void *data, vk::Extent3D size, vk::Format format, vk::ImageUsageFlags usage, bool mipmapped)
+    Image::Image(VulkanContext *context, ImmediateSubmitter& submitter, void *data, vk::Extent3D size, vk::Format format, vk::ImageUsageFlags usage, bool mipmapped,
+                 MemoryCategory category, const char* name)
         // First, create the image with transfer flags added (needed for upload and mipmap generation)
-        : Image(context, size, format, usage | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, mipmapped) {
+        : Image(context, size, format, usage | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, mipmapped, category, name) {
 
         // Calculate data size (assuming 4 bytes per pixel - RGBA)
         size_t data_size = static_cast<size_t>(size.depth) * size.width * size.height * 4;
 
         // Create a staging buffer in CPU-visible memory
         // The GPU can't read from CPU memory directly, so we need this intermediate buffer
-        Buffer uploadbuffer {context, data_size, vk::BufferUsageFlagBits::eTransferSrc, VMA_MEMORY_USAGE_CPU_TO_GPU};
+        Buffer uploadbuffer {context, data_size, vk::BufferUsageFlagBits::eTransferSrc, VMA_MEMORY_USAGE_CPU_TO_GPU,
+                             MemoryCategory::Staging, "Image upload"};
 
         // Copy pixel data to the staging buffer
         memcpy(uploadbuffer.info.pMappedData, data, data_size);
@@ -196,10 +201,20 @@ namespace graphics {
             }
             // Then destroy image and free memory through VMA
             if (image && allocation) {
+                ctx->getMemoryTracker().untrack(allocation);
                 vmaDestroyImage(ctx->getAllocator(), image, allocation);
                 image = nullptr;
                 allocation = nullptr;
             }
         }
     }
+
+    void Image::retire(const VulkanContext* ctx, DeletionQueue& queue) {
+        queue.pushFunction([ctx, retired = *this]() mutable {
+            retired.destroy(ctx);
+        }, "Retired image");
+        image = nullptr;
+        allocation = nullptr;
+        imageView = nullptr;
+    }
 }
@@ -6,12 +6,14 @@
 #pragma once
 #include <vk_mem_alloc.h>
 
+#include "MemoryTracker.h"
 #include "Types.h"
 
 namespace graphics {
 
     class VulkanContext;
     class ImmediateSubmitter;
+    class DeletionQueue;
 
     /**
      * @class Image
@@ -63,10 +65,13 @@ namespace graphics {
          * @param format Pixel format (e.g., eR8G8B8A8Srgb, eD32Sfloat for depth).
          * @param usage How the image will be used (sampled, color attachment, etc.).
          * @param mipmapped If true, automatically calculates and allocates mip levels.
+         * @param category Subsystem the memory is accounted to (see MemoryTracker).
+         * @param name Debug name, shown in the memory table and VMA dumps.
          *
          * The image is allocated in GPU-only memory for maximum performance.
          */
-        Image(VulkanContext* context, vk::Extent3D size, vk::Format format, vk::ImageUsageFlags usage, bool mipmapped = false);
+        Image(VulkanContext* context, vk::Extent3D size, vk::Format format, vk::ImageUsageFlags usage, bool mipmapped = false,
+              MemoryCategory category = MemoryCategory::Untagged, const char* name = nullptr);
 
         /**
          * @brief Creates an empty image with explicit mip level count.
@@ -75,8 +80,11 @@ namespace graphics {
          * @param format Pixel format.
          * @param usage Usage flags.
          * @param mipLevels Exact number of mip levels to allocate.
+         * @param category Subsystem the memory is accounted to.
+         * @param name Debug name.
          */
-        Image(VulkanContext* context, vk::Extent3D size, vk::Format format, vk::ImageUsageFlags usage, uint32_t mipLevels);
+        Image(VulkanContext* context, vk::Extent3D size, vk::Format format, vk::ImageUsageFlags usage, uint32_t mipLevels,
+              MemoryCategory category = MemoryCategory::Untagged, const char* name = nullptr);
 
         /**
          * @brief Creates an image and uploads pixel data to it.
@@ -87,6 +95,8 @@ namespace graphics {
          * @param format Pixel format.
          * @param usage Usage flags (eTransferDst is added automatically).
          * @param mipmapped If true, generates mipmaps after upload.
+         * @param category Subsystem the memory is accounted to.
+         * @param name Debug name.
          *
          * This constructor:
          * 1. Creates a staging buffer with the pixel data
@@ -94,7 +104,8 @@ namespace graphics {
          * 3. Copies data from buffer to image
          * 4. Generates mipmaps (if requested) or transitions to shader-read layout
          */
-        Image(VulkanContext* context, ImmediateSubmitter& submitter, void* data, vk::Extent3D size, vk::Format format, vk::ImageUsageFlags usage, bool mipmapped = false);
+        Image(VulkanContext* context, ImmediateSubmitter& submitter, void* data, vk::Extent3D size, vk::Format format, vk::ImageUsageFlags usage, bool mipmapped = false,
+              MemoryCategory category = MemoryCategory::Texture, const char* name = nullptr);
 
         ~Image() = default;
 
@@ -107,6 +118,16 @@ namespace graphics {
          */
         void destroy(const VulkanContext* context);
 
+        /**
+         * @brief Hands the image over to a deletion queue and resets this one.
+         * @param context The Vulkan context.
+         * @param queue Queue flushed once the GPU no longer uses the image.
+         *
+         * For images recorded in frames still in flight (e.g. render targets
+         * replaced on resize): this object can be recreated right away.
+         */
+        void retire(const VulkanContext* context, DeletionQueue& queue);
+
         // =====================================================================
         // Image Resources
         // =====================================================================
@@ -0,0 +1,151 @@
+/**
+ * @file ImageWriter.cpp
+ * @brief PNG through stb_image_write, EXR written by hand (uncompressed scanlines).
+ */
+
+#include "ImageWriter.h"
+#include "BasicServices/Log.h"
+
+#include <cstring>
+#include <fstream>
+#include <glm/gtc/packing.hpp>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+using services::Log;
+
+namespace graphics {
+
+    namespace {
+
+        // =====================================================================
+        // PNG
+        // =====================================================================
+
+        bool writePng(const str& path, u32 width, u32 height, std::span<const u16> pixels) {
+            vector<u8> rgb(static_cast<size_t>(width) * height * 3);
+            for (size_t pixel = 0; pixel < static_cast<size_t>(width) * height; pixel++) {
+                for (size_t channel = 0; channel < 3; channel++) {
+                    const f32 value = glm::unpackHalf1x16(pixels[pixel * 4 + channel]);
+                    rgb[pixel * 3 + channel] = static_cast<u8>(glm::clamp(value, 0.f, 1.f) * 255.f + 0.5f);
+                }
+            }
+            return stbi_write_png(path.c_str(), static_cast<int>(width), static_cast<int>(height), 3,
+                rgb.data(), static_cast<int>(width * 3)) != 0;
+        }
+
+        // =====================================================================
+        // EXR
+        // =====================================================================
+        // OpenEXR 2 single-part scanline file, no compression: a header of named
+        // attributes, a table of line offsets, then each line as y, byte count and
+        // the channels one after the other, in alphabetical order (B, G, R).
+
+        struct ExrBytes {
+            vector<u8> bytes;
+
+            void putBytes(const void* data, size_t size) {
+                const auto* begin = static_cast<const u8*>(data);
+                bytes.insert(bytes.end(), begin, begin + size);
+            }
+            // Little endian hosts only
+            void putI32(i32 value) { putBytes(&value, sizeof(value)); }
+            void putU64(u64 value) { putBytes(&value, sizeof(value)); }
+            void putF32(f32 value) { putBytes(&value, sizeof(value)); }
+            void putText(const char* value) { putBytes(value, std::strlen(value) + 1); }
+
+            void putAttribute(const char* name, const char* type, i32 size) {
+                putText(name);
+                putText(type);
+                putI32(size);
+            }
+        };
+
+        bool writeExr(const str& path, u32 width, u32 height, std::span<const u16> pixels) {
+            constexpr const char* CHANNELS[] = { "B", "G", "R" };
+            constexpr u32 CHANNEL_OFFSETS[] = { 2, 1, 0 };  // In the RGBA pixels
+            constexpr i32 HALF = 1;
+
+            ExrBytes out;
+            out.bytes.reserve(512 + static_cast<size_t>(height) * (16 + width * 6));
+            out.putI32(20000630);  // Magic number
+            out.putI32(2);         // Version 2, single part scanline
+
+            out.putAttribute("channels", "chlist", 3 * (2 + 16) + 1);
+            for (const char* channel : CHANNELS) {
+                out.putText(channel);
+                out.putI32(HALF);
+                out.putI32(0);     // pLinear and reserved
+                out.putI32(1);     // x sampling
+                out.putI32(1);     // y sampling
+            }
+            out.putBytes("", 1);
+
+            out.putAttribute("compression", "compression", 1);
+            out.putBytes("", 1);     // NO_COMPRESSION
+            for (const char* window : { "dataWindow", "displayWindow" }) {
+                out.putAttribute(window, "box2i", 16);
+                out.putI32(0);
+                out.putI32(0);
+                out.putI32(static_cast<i32>(width) - 1);
+                out.putI32(static_cast<i32>(height) - 1);
+            }
+            out.putAttribute("lineOrder", "lineOrder", 1);
+            out.putBytes("", 1);     // INCREASING_Y
+            out.putAttribute("pixelAspectRatio", "float", 4);
+            out.putF32(1.f);
+            out.putAttribute("screenWindowCenter", "v2f", 8);
+            out.putF32(0.f);
+            out.putF32(0.f);
+            out.putAttribute("screenWindowWidth", "float", 4);
+            out.putF32(1.f);
+            out.putBytes("", 1);     // End of header
+
+            const i32 lineBytes = static_cast<i32>(width * 3 * sizeof(u16));
+            const u64 firstLine = out.bytes.size() + static_cast<u64>(height) * sizeof(u64);
+            for (u32 y = 0; y < height; y++) {
+                out.putU64(firstLine + static_cast<u64>(y) * (8 + lineBytes));
+            }
+
+            vector<u16> line(width);
+            for (u32 y = 0; y < height; y++) {
+                out.putI32(static_cast<i32>(y));
+                out.putI32(lineBytes);
+                const u16* row = pixels.data() + static_cast<size_t>(y) * width * 4;
+                for (const u32 offset : CHANNEL_OFFSETS) {
+                    for (u32 x = 0; x < width; x++) {
+                        line[x] = row[x * 4 + offset];
+                    }
+                    out.putBytes(line.data(), line.size() * sizeof(u16));
+                }
+            }
+
+            std::ofstream file(path, std::ios::binary);
+            if (!file) return false;
+            file.write(reinterpret_cast<const char*>(out.bytes.data()), static_cast<std::streamsize>(out.bytes.size()));
+            return static_cast<bool>(file);
+        }
+
+    } // namespace
+
+    const char* getExtension(ImageFileFormat format) {
+        return format == ImageFileFormat::Exr ? "exr" : "png";
+    }
+
+    bool writeImage(const str& path, ImageFileFormat format, u32 width, u32 height, std::span<const u16> pixels) {
+        if (pixels.size() < static_cast<size_t>(width) * height * 4) {
+            Log::Error("Image writer: %s needs %ux%u pixels, got %zu values", path.c_str(), width, height, pixels.size());
+            return false;
+        }
+
+        const bool written = format == ImageFileFormat::Exr
+            ? writeExr(path, width, height, pixels)
+            : writePng(path, width, height, pixels);
+        if (!written) {
+            Log::Error("Image writer: cannot write %s", path.c_str());
+        }
+        return written;
+    }
+
+} // namespace graphics
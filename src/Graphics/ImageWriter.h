@@ -0,0 +1,34 @@
+/**
+ * @file ImageWriter.h
+ * @brief Writes RGBA16F images read back from the GPU to PNG or EXR files.
+ */
+
+#pragma once
+
+#include "../Defines.h"
+#include <span>
+
+namespace graphics {
+
+    enum class ImageFileFormat {
+        Png,    ///< 8 bit RGB, values clamped to [0, 1] as the swapchain blit does
+        Exr     ///< Half float RGB, uncompressed: values above 1 are kept
+    };
+
+    /// "png" or "exr"
+    const char* getExtension(ImageFileFormat format);
+
+    /**
+     * @brief Writes tightly packed RGBA16F pixels (the draw image format) to a file.
+     * @param path Output file, extension included.
+     * @param width Image width in pixels.
+     * @param height Image height in pixels.
+     * @param pixels width * height * 4 halves, top row first.
+     * @return false when the file cannot be written (logged).
+     *
+     * Alpha is dropped: the draw image's alpha is whatever the passes left there.
+     * Any thread.
+     */
+    bool writeImage(const str& path, ImageFileFormat format, u32 width, u32 height, std::span<const u16> pixels);
+
+} // namespace graphics
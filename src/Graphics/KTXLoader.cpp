@@ -1,8 +1,10 @@
 #include "KTXLoader.h"
 #include "Renderer.h"
+#include "UploadBatch.h"
 #include "VulkanContext.h"
 #include "../BasicServices/Log.h"
 #include "../BasicServices/File.h"
+#include "../BasicServices/Profiler.h"
 #include <fstream>
 #include <cstring>
 
@@ -54,6 +56,7 @@ namespace graphics {
     }
 
     std::optional<KTXLoadResult> loadKTXFile(const std::string& filePath) {
+        PROFILE_FUNCTION();
         auto fsPath = services::File::getFileSystemPath(filePath);
         std::ifstream file(fsPath, std::ios::binary | std::ios::ate);
 
@@ -131,87 +134,31 @@ namespace graphics {
     }
 
     std::optional<Image> loadKTXImage(Renderer* renderer, const std::string& filePath) {
+        PROFILE_FUNCTION();
         auto ktxResult = loadKTXFile(filePath);
         if (!ktxResult.has_value()) {
             return std::nullopt;
         }
 
-        const auto& ktx = *ktxResult;
-        VulkanContext* context = renderer->getContext();
-        vk::Device device = context->getDevice();
+        UploadBatch batch(renderer->getContext(), *renderer->getImmediateSubmitter());
+        Image image = createKTXImage(renderer->getContext(), *ktxResult, filePath, batch);
+        batch.flush();
+        return image;
+    }
 
+    Image createKTXImage(VulkanContext* context, const KTXLoadResult& ktx, const std::string& name, UploadBatch& batch) {
         // Create the image with mipmaps
         vk::Extent3D imageExtent = { ktx.width, ktx.height, 1 };
 
         Image image(context, imageExtent, ktx.format,
             vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,
-            ktx.mipLevels);
-
-        // Create staging buffer
-        vk::DeviceSize bufferSize = ktx.data.size();
-        Buffer staging(context, bufferSize, vk::BufferUsageFlagBits::eTransferSrc, VMA_MEMORY_USAGE_CPU_ONLY);
-
-        // Copy data to staging buffer
-        memcpy(staging.info.pMappedData, ktx.data.data(), bufferSize);
-
-        // Upload to GPU
-        renderer->getImmediateSubmitter()->immediateSubmit(context, [&](vk::CommandBuffer cmd) {
-            // Transition image to transfer dst
-            vk::ImageMemoryBarrier barrier{};
-            barrier.oldLayout = vk::ImageLayout::eUndefined;
-            barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
-            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barrier.image = image.image;
-            barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
-            barrier.subresourceRange.baseMipLevel = 0;
-            barrier.subresourceRange.levelCount = ktx.mipLevels;
-            barrier.subresourceRange.baseArrayLayer = 0;
-            barrier.subresourceRange.layerCount = 1;
-            barrier.srcAccessMask = vk::AccessFlagBits::eNone;
-            barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
-
-            cmd.pipelineBarrier(
-                vk::PipelineStageFlagBits::eTopOfPipe,
-                vk::PipelineStageFlagBits::eTransfer,
-                {}, {}, {}, barrier
-            );
-
-            // Copy each mip level
-            for (uint32_t mip = 0; mip < ktx.mipLevels; mip++) {
-                uint32_t mipWidth = std::max(1u, ktx.width >> mip);
-                uint32_t mipHeight = std::max(1u, ktx.height >> mip);
-
-                vk::BufferImageCopy region{};
-                region.bufferOffset = ktx.mipOffsets[mip];
-                region.bufferRowLength = 0;
-                region.bufferImageHeight = 0;
-                region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-                region.imageSubresource.mipLevel = mip;
-                region.imageSubresource.baseArrayLayer = 0;
-                region.imageSubresource.layerCount = 1;
-                region.imageOffset = vk::Offset3D{0, 0, 0};
-                region.imageExtent = vk::Extent3D{mipWidth, mipHeight, 1};
-
-                cmd.copyBufferToImage(staging.buffer, image.image,
-                    vk::ImageLayout::eTransferDstOptimal, region);
-            }
-
-            // Transition to shader read optimal
-            barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-            barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-            barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-            barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-
-            cmd.pipelineBarrier(
-                vk::PipelineStageFlagBits::eTransfer,
-                vk::PipelineStageFlagBits::eFragmentShader,
-                {}, {}, {}, barrier
-            );
-        });
+            ktx.mipLevels, MemoryCategory::Texture, name.c_str());
+
+        // Every mip level is in the file: copied as is, shader readable once the batch flushes
+        memcpy(batch.addImageCopy(image, ktx.data.size(), ktx.mipOffsets), ktx.data.data(), ktx.data.size());
 
         Log::Info("Loaded KTX texture: %s (%dx%d, %d mips)",
-            filePath.c_str(), ktx.width, ktx.height, ktx.mipLevels);
+            name.c_str(), ktx.width, ktx.height, ktx.mipLevels);
 
         return image;
     }
@@ -11,6 +11,7 @@ namespace graphics {
     class Renderer;
     class VulkanContext;
     struct ImmediateSubmitter;
+    class UploadBatch;
 
     // KTX1 file header structure
     struct KTX1Header {
@@ -47,4 +48,7 @@ namespace graphics {
     // Load a KTX file directly as a Vulkan Image
     std::optional<Image> loadKTXImage(Renderer* renderer, const std::string& filePath);
 
+    // Create the Vulkan Image of a loaded KTX file. Its mip levels are filled when batch flushes
+    Image createKTXImage(VulkanContext* context, const KTXLoadResult& ktx, const std::string& name, UploadBatch& batch);
+
 } // namespace graphics
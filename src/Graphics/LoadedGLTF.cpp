@@ -1,5 +1,8 @@
 #include "LoadedGLTF.h"
 #include "Renderer.h"
+#include "SkinningPass.h"
+
+#include <cmath>
 
 namespace graphics {
 
@@ -10,6 +13,120 @@ namespace graphics {
         }
     }
 
+    void LoadedGLTF::playAnimation(i32 clipIndex, bool loop) {
+        // Restore the rest pose of the nodes the previous clip was driving
+        if (animationState.clip >= 0 && animationState.clip < static_cast<i32>(animations.size())) {
+            for (u32 node : animations[animationState.clip].animatedNodes) {
+                nodeList[node]->localTransform = restPose[node].toMatrix();
+            }
+        }
+
+        animationState.clip = clipIndex < static_cast<i32>(animations.size()) ? clipIndex : -1;
+        animationState.time = 0.f;
+        animationState.loop = loop;
+        animationState.playing = true;
+        animationState.cursors.clear();
+    }
+
+    void LoadedGLTF::updateAnimation(f32 deltaTime) {
+        const bool hasClip = animationState.clip >= 0 && animationState.clip < static_cast<i32>(animations.size());
+        if (!hasClip && skinnedMeshes.empty()) return;
+
+        if (hasClip) {
+            const AnimationClip& clip = animations[animationState.clip];
+
+            if (animationState.playing && clip.duration > 0.f) {
+                animationState.time += deltaTime * animationState.speed;
+                if (animationState.time > clip.duration) {
+                    // Keyframe cursors rewind by themselves when time goes backwards
+                    animationState.time = animationState.loop ? std::fmod(animationState.time, clip.duration) : clip.duration;
+                }
+            }
+
+            // Channels only override the paths they animate, the rest comes from the rest pose
+            if (pose.size() != restPose.size()) {
+                pose = restPose;
+            }
+            for (u32 node : clip.animatedNodes) {
+                pose[node] = restPose[node];
+            }
+
+            sampleAnimation(clip, animationState, pose);
+
+            for (u32 node : clip.animatedNodes) {
+                nodeList[node]->localTransform = pose[node].toMatrix();
+            }
+
+            for (auto& n : topNodes) {
+                n->refreshTransform(Mat4 { 1.f });
+            }
+        }
+
+        // Joint palettes, expressed in the mesh node's space so the draw keeps using its world matrix
+        for (SkinnedMeshInstance& instance : skinnedMeshes) {
+            const Skin& skin = skins[instance.skin];
+            const Mat4 inverseMeshTransform = glm::inverse(instance.node->worldTransform);
+
+            instance.palette.resize(skin.joints.size());
+            for (size_t i = 0; i < skin.joints.size(); i++) {
+                instance.palette[i] = inverseMeshTransform * nodeList[skin.joints[i]]->worldTransform * skin.inverseBindMatrices[i];
+            }
+
+            // Culling and shadow fitting would otherwise see the bind pose
+            const SkinBounds& skinBounds = instance.node->mesh->skinBounds;
+            if (!skinBounds.isEmpty()) {
+                instance.bounds = skinBounds.pose(instance.palette);
+            }
+        }
+    }
+
+    void LoadedGLTF::submitSkinning(SkinningBatch& batch, u32 frameIndex) {
+        for (SkinnedMeshInstance& instance : skinnedMeshes) {
+            MeshNode& node = *instance.node;
+            const MeshAsset& mesh = *node.mesh;
+
+            if (instance.palette.empty()) {
+                node.posedVertexAddress = 0;
+                node.posedBounds = nullptr;
+                continue;
+            }
+
+            const vk::DeviceAddress posed = instance.posedAddresses[frameIndex];
+            const bool queued = batch.enqueue(mesh.meshBuffers.vertexBufferAddress, mesh.skinBufferAddress, posed,
+                                             mesh.vertexCount, instance.palette);
+
+            // Fall back to the bind pose rather than drawing a buffer nobody wrote this frame
+            node.posedVertexAddress = queued ? posed : 0;
+            node.posedBounds = queued && !mesh.skinBounds.isEmpty() ? &instance.bounds : nullptr;
+        }
+    }
+
+    u64 LoadedGLTF::getCpuMemory() const {
+        // Capacities, not sizes: that is what is actually allocated
+        u64 bytes = nodeList.capacity() * sizeof(sptr<Node>) + topNodes.capacity() * sizeof(sptr<Node>);
+        bytes += restPose.capacity() * sizeof(NodeTRS) + pose.capacity() * sizeof(NodeTRS);
+        for (const auto& [name, node] : nodes) {
+            bytes += name.capacity() + sizeof(Node);
+            bytes += node->children.capacity() * sizeof(sptr<Node>);
+        }
+        for (const auto& [name, mesh] : meshes) {
+            bytes += sizeof(MeshAsset) + mesh->surfaces.capacity() * sizeof(GeoSurface);
+        }
+        for (const Skin& skin : skins) {
+            bytes += skin.joints.capacity() * sizeof(u32) + skin.inverseBindMatrices.capacity() * sizeof(Mat4);
+        }
+        for (const AnimationClip& clip : animations) {
+            bytes += clip.channels.capacity() * sizeof(AnimationChannel) + clip.animatedNodes.capacity() * sizeof(u32);
+            for (const AnimationSampler& sampler : clip.samplers) {
+                bytes += sampler.times.capacity() * sizeof(f32) + sampler.values.capacity() * sizeof(Vec4);
+            }
+        }
+        for (const SkinnedMeshInstance& instance : skinnedMeshes) {
+            bytes += instance.palette.capacity() * sizeof(Mat4);
+        }
+        return bytes;
+    }
+
     void LoadedGLTF::clearAll() {
         if (!creator) return;
 
@@ -31,6 +148,14 @@ namespace graphics {
         for (auto& [name, mesh] : meshes) {
             mesh->meshBuffers.indexBuffer.destroy();
             mesh->meshBuffers.vertexBuffer.destroy();
+            mesh->meshBuffers.positionBuffer.destroy();
+            mesh->skinBuffer.destroy();
+        }
+
+        for (auto& instance : skinnedMeshes) {
+            for (auto& posed : instance.posedVertices) {
+                posed.destroy();
+            }
         }
     }
 }
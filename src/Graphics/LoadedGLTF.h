@@ -6,9 +6,21 @@
 #include "DescriptorAllocatorGrowable.h"
 #include "Buffer.h"
 #include "Image.h"
+#include "Animation.h"
 
 namespace graphics {
     class Renderer;
+    struct SkinningBatch;
+
+    /// A mesh node driven by a skin, with its compute-skinned output buffers
+    struct SkinnedMeshInstance {
+        sptr<MeshNode> node;
+        u32 skin;
+        vector<Mat4> palette;                  ///< Joint matrices computed by updateAnimation
+        Bounds bounds {};                      ///< Of the whole mesh in the pose of the palette, see SkinBounds
+        Buffer posedVertices[FRAME_OVERLAP];   ///< Skinned output, one per frame in flight
+        vk::DeviceAddress posedAddresses[FRAME_OVERLAP] {};
+    };
 
     /***
      * LoadedGLTF
@@ -31,6 +43,16 @@ namespace graphics {
         // Nodes that dont have a parent, for iterating through the file in tree order
         vector<sptr<Node>> topNodes;
 
+        // Nodes in glTF file order: skins and animation channels refer to them by index
+        vector<sptr<Node>> nodeList;
+        vector<NodeTRS> restPose;
+
+        // Animation
+        vector<Skin> skins;
+        vector<AnimationClip> animations;
+        vector<SkinnedMeshInstance> skinnedMeshes;
+        AnimationState animationState;
+
         vector<vk::Sampler> samplers;
 
         DescriptorAllocatorGrowable descriptorPool;
@@ -43,7 +65,36 @@ namespace graphics {
 
         void draw(const Mat4& topMatrix, DrawContext& ctx) override;
 
+        bool hasAnimations() const { return !animations.empty(); }
+        bool hasSkins() const { return !skinnedMeshes.empty(); }
+
+        /// Starts playing a clip from the beginning (-1 returns to the bind pose)
+        void playAnimation(i32 clipIndex, bool loop = true);
+
+        /**
+         * @brief Advances the animation and rebuilds joint palettes and posed bounds.
+         *
+         * Only touches this model's data, so several models can be updated
+         * in parallel (see graphics::updateAnimations).
+         */
+        void updateAnimation(f32 deltaTime);
+
+        /**
+         * @brief Queues compute skinning for every skinned mesh of this model.
+         * @param batch The frame's skinning jobs (a FramePacket's, or SkinningPass::getBatch()).
+         * @param frameIndex Frame in flight the draw will happen in.
+         *
+         * Must be called by the thread building the frame, after updateAnimation and
+         * before draw(), so the MeshNodes point at this frame's posed vertex buffers.
+         */
+        void submitSkinning(SkinningBatch& batch, u32 frameIndex);
+
+        /// Bytes held by the CPU-side containers (nodes, poses, keyframes, palettes), for the memory tracker
+        u64 getCpuMemory() const;
+
     private:
         void clearAll();
+
+        vector<NodeTRS> pose;   ///< Working pose, reset from restPose for animated nodes each update
     };
 }
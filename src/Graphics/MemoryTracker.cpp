@@ -0,0 +1,348 @@
+/**
+ * @file MemoryTracker.cpp
+ * @brief Implementation of the GPU and CPU memory accounting.
+ */
+
+#include "MemoryTracker.h"
+
+#include "DescriptorAllocatorGrowable.h"
+#include "../BasicServices/FileWriter.h"
+#include "../BasicServices/Log.h"
+#include <algorithm>
+#include <fmt/format.h>
+#include <imgui.h>
+
+using services::Log;
+
+namespace graphics {
+
+    namespace {
+        constexpr f64 MEGABYTE = 1024.0 * 1024.0;
+
+        f64 toMegabytes(u64 bytes) {
+            return static_cast<f64>(bytes) / MEGABYTE;
+        }
+
+        str escapeJson(const str& text) {
+            str escaped;
+            for (const char c : text) {
+                if (c == '"' || c == '\\') escaped += '\\';
+                escaped += c;
+            }
+            return escaped;
+        }
+    }
+
+    const char* toString(MemoryCategory category) {
+        switch (category) {
+            case MemoryCategory::Untagged:     return "Untagged";
+            case MemoryCategory::Mesh:         return "Mesh";
+            case MemoryCategory::Texture:      return "Texture";
+            case MemoryCategory::RenderTarget: return "RenderTarget";
+            case MemoryCategory::Uniform:      return "Uniform";
+            case MemoryCategory::Staging:      return "Staging";
+            case MemoryCategory::Particles:    return "Particles";
+            case MemoryCategory::Skinning:     return "Skinning";
+            case MemoryCategory::Readback:     return "Readback";
+            default:                           return "Unknown";
+        }
+    }
+
+    void MemoryTracker::init(VmaAllocator vmaAllocator) {
+        allocator = vmaAllocator;
+    }
+
+    // =========================================================================
+    // GPU allocations
+    // =========================================================================
+
+    void MemoryTracker::track(VmaAllocation allocation, MemoryCategory category, const char* name) {
+        if (!allocator || !allocation) return;
+
+        VmaAllocationInfo info {};
+        vmaGetAllocationInfo(allocator, allocation, &info);
+        const char* debugName = name ? name : toString(category);
+        vmaSetAllocationName(allocator, allocation, debugName);
+
+        std::lock_guard lock(mutex);
+        allocations[allocation] = { category, debugName, info.size };
+
+        CategoryStats& stats = categories[static_cast<size_t>(category)];
+        stats.bytes += info.size;
+        stats.peakBytes = std::max(stats.peakBytes, stats.bytes);
+        stats.count++;
+    }
+
+    void MemoryTracker::untrack(VmaAllocation allocation) {
+        std::lock_guard lock(mutex);
+        const auto it = allocations.find(allocation);
+        if (it == allocations.end()) return;
+
+        CategoryStats& stats = categories[static_cast<size_t>(it->second.category)];
+        stats.bytes -= it->second.bytes;
+        stats.count--;
+        allocations.erase(it);
+    }
+
+    // =========================================================================
+    // Reported counters
+    // =========================================================================
+
+    void MemoryTracker::setCpuCounter(const char* name, u64 bytes, u64 count) {
+        std::lock_guard lock(mutex);
+        auto it = std::find_if(cpuCounters.begin(), cpuCounters.end(),
+            [&](const CpuCounter& counter) { return counter.name == name; });
+        if (it == cpuCounters.end()) {
+            cpuCounters.push_back({ name });
+            it = cpuCounters.end() - 1;
+        }
+        it->bytes = bytes;
+        it->peakBytes = std::max(it->peakBytes, bytes);
+        it->count = count;
+    }
+
+    void MemoryTracker::setDescriptorPools(const char* name, const DescriptorPoolUsage& usage) {
+        std::lock_guard lock(mutex);
+        auto it = std::find_if(descriptorCounters.begin(), descriptorCounters.end(),
+            [&](const DescriptorCounter& counter) { return counter.name == name; });
+        if (it == descriptorCounters.end()) {
+            descriptorCounters.push_back({ name });
+            it = descriptorCounters.end() - 1;
+        }
+        it->pools = usage.pools;
+        it->setCapacity = usage.setCapacity;
+        it->allocatedSets = usage.allocatedSets;
+        it->descriptorCapacity = usage.descriptorCapacity;
+    }
+
+    // =========================================================================
+    // Queries
+    // =========================================================================
+
+    std::array<MemoryTracker::CategoryStats, static_cast<size_t>(MemoryCategory::Count)> MemoryTracker::getCategoryStats() const {
+        std::lock_guard lock(mutex);
+        return categories;
+    }
+
+    vector<MemoryTracker::Allocation> MemoryTracker::getAllocations() const {
+        vector<Allocation> sorted;
+        {
+            std::lock_guard lock(mutex);
+            sorted.reserve(allocations.size());
+            for (const auto& [handle, allocation] : allocations) {
+                sorted.push_back(allocation);
+            }
+        }
+        std::sort(sorted.begin(), sorted.end(),
+            [](const Allocation& a, const Allocation& b) { return a.bytes > b.bytes; });
+        return sorted;
+    }
+
+    vector<MemoryTracker::CpuCounter> MemoryTracker::getCpuCounters() const {
+        std::lock_guard lock(mutex);
+        return cpuCounters;
+    }
+
+    vector<MemoryTracker::DescriptorCounter> MemoryTracker::getDescriptorCounters() const {
+        std::lock_guard lock(mutex);
+        return descriptorCounters;
+    }
+
+    vector<MemoryTracker::HeapStats> MemoryTracker::getHeapStats() const {
+        vector<HeapStats> heaps;
+        if (!allocator) return heaps;
+
+        const VkPhysicalDeviceMemoryProperties* properties = nullptr;
+        vmaGetMemoryProperties(allocator, &properties);
+
+        // Budgets are cheap: VMA keeps the statistics up to date, no walk over the blocks
+        std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets {};
+        vmaGetHeapBudgets(allocator, budgets.data());
+
+        heaps.resize(properties->memoryHeapCount);
+        for (u32 i = 0; i < properties->memoryHeapCount; i++) {
+            const VmaBudget& budget = budgets[i];
+            heaps[i].deviceLocal = (properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+            heaps[i].blockBytes = budget.statistics.blockBytes;
+            heaps[i].allocationBytes = budget.statistics.allocationBytes;
+            heaps[i].blockCount = budget.statistics.blockCount;
+            heaps[i].allocationCount = budget.statistics.allocationCount;
+            heaps[i].usage = budget.usage;
+            heaps[i].budget = budget.budget;
+        }
+        return heaps;
+    }
+
+    // =========================================================================
+    // Export
+    // =========================================================================
+
+    bool MemoryTracker::exportJson(const str& path) const {
+        services::FileWriter writer;
+        if (!writer.open(path)) {
+            Log::Error("Memory tracker: cannot open %s", path.c_str());
+            return false;
+        }
+
+        const auto categoryStats = getCategoryStats();
+        const vector<HeapStats> heaps = getHeapStats();
+        const vector<CpuCounter> cpu = getCpuCounters();
+        const vector<DescriptorCounter> descriptors = getDescriptorCounters();
+        const vector<Allocation> live = getAllocations();
+
+        writer.writeLine("{");
+        writer.writeLine("  \"categories\": {");
+        for (size_t i = 0; i < categoryStats.size(); i++) {
+            const CategoryStats& stats = categoryStats[i];
+            writer.writeLine(fmt::format("    \"{}\": {{\"count\":{},\"bytes\":{},\"peak_bytes\":{}}}{}",
+                toString(static_cast<MemoryCategory>(i)), stats.count, stats.bytes, stats.peakBytes,
+                i + 1 < categoryStats.size() ? "," : ""));
+        }
+        writer.writeLine("  },");
+
+        writer.writeLine("  \"heaps\": [");
+        for (size_t i = 0; i < heaps.size(); i++) {
+            const HeapStats& heap = heaps[i];
+            writer.writeLine(fmt::format("    {{\"device_local\":{},\"blocks\":{},\"block_bytes\":{},\"allocations\":{},"
+                                         "\"allocation_bytes\":{},\"usage\":{},\"budget\":{}}}{}",
+                heap.deviceLocal, heap.blockCount, heap.blockBytes, heap.allocationCount,
+                heap.allocationBytes, heap.usage, heap.budget, i + 1 < heaps.size() ? "," : ""));
+        }
+        writer.writeLine("  ],");
+
+        writer.writeLine("  \"descriptor_pools\": [");
+        for (size_t i = 0; i < descriptors.size(); i++) {
+            const DescriptorCounter& counter = descriptors[i];
+            writer.writeLine(fmt::format("    {{\"name\":\"{}\",\"pools\":{},\"set_capacity\":{},\"allocated_sets\":{},\"descriptor_capacity\":{}}}{}",
+                escapeJson(counter.name), counter.pools, counter.setCapacity, counter.allocatedSets,
+                counter.descriptorCapacity, i + 1 < descriptors.size() ? "," : ""));
+        }
+        writer.writeLine("  ],");
+
+        writer.writeLine("  \"cpu\": [");
+        for (size_t i = 0; i < cpu.size(); i++) {
+            writer.writeLine(fmt::format("    {{\"name\":\"{}\",\"count\":{},\"bytes\":{},\"peak_bytes\":{}}}{}",
+                escapeJson(cpu[i].name), cpu[i].count, cpu[i].bytes, cpu[i].peakBytes, i + 1 < cpu.size() ? "," : ""));
+        }
+        writer.writeLine("  ],");
+
+        writer.writeLine("  \"allocations\": [");
+        for (size_t i = 0; i < live.size(); i++) {
+            writer.writeLine(fmt::format("    {{\"name\":\"{}\",\"category\":\"{}\",\"bytes\":{}}}{}",
+                escapeJson(live[i].name), toString(live[i].category), live[i].bytes, i + 1 < live.size() ? "," : ""));
+        }
+        writer.writeLine("  ]");
+        writer.writeLine("}");
+        writer.close();
+
+        Log::Info("Memory tracker: %zu allocations exported to %s", live.size(), path.c_str());
+        return true;
+    }
+
+    // =========================================================================
+    // ImGui
+    // =========================================================================
+
+    void MemoryTracker::drawImGui() {
+        if (ImGui::Begin("Memory")) {
+            if (ImGui::Button("Dump JSON")) {
+                exportJson("memory_report.json");
+            }
+
+            constexpr ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+
+            ImGui::SeparatorText("GPU allocations");
+            const auto categoryStats = getCategoryStats();
+            if (ImGui::BeginTable("MemoryCategories", 4, flags)) {
+                ImGui::TableSetupColumn("Category");
+                ImGui::TableSetupColumn("Count");
+                ImGui::TableSetupColumn("MB");
+                ImGui::TableSetupColumn("Peak MB");
+                ImGui::TableHeadersRow();
+
+                u64 total = 0;
+                for (size_t i = 0; i < categoryStats.size(); i++) {
+                    const CategoryStats& stats = categoryStats[i];
+                    total += stats.bytes;
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(toString(static_cast<MemoryCategory>(i)));
+                    ImGui::TableNextColumn(); ImGui::Text("%u", stats.count);
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", toMegabytes(stats.bytes));
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", toMegabytes(stats.peakBytes));
+                }
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted("Total");
+                ImGui::TableNextColumn();
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", toMegabytes(total));
+                ImGui::EndTable();
+            }
+
+            ImGui::SeparatorText("Heaps (VMA)");
+            if (ImGui::BeginTable("MemoryHeaps", 5, flags)) {
+                ImGui::TableSetupColumn("Heap");
+                ImGui::TableSetupColumn("Blocks MB");
+                ImGui::TableSetupColumn("Used MB");
+                ImGui::TableSetupColumn("Usage MB");
+                ImGui::TableSetupColumn("Budget MB");
+                ImGui::TableHeadersRow();
+
+                const vector<HeapStats> heaps = getHeapStats();
+                for (size_t i = 0; i < heaps.size(); i++) {
+                    const HeapStats& heap = heaps[i];
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::Text("%zu %s", i, heap.deviceLocal ? "(device)" : "(host)");
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f (%u)", toMegabytes(heap.blockBytes), heap.blockCount);
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f (%u)", toMegabytes(heap.allocationBytes), heap.allocationCount);
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", toMegabytes(heap.usage));
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", toMegabytes(heap.budget));
+                }
+                ImGui::EndTable();
+            }
+
+            ImGui::SeparatorText("Descriptor pools");
+            if (ImGui::BeginTable("MemoryDescriptors", 4, flags)) {
+                ImGui::TableSetupColumn("Allocator");
+                ImGui::TableSetupColumn("Pools");
+                ImGui::TableSetupColumn("Sets");
+                ImGui::TableSetupColumn("Descriptors");
+                ImGui::TableHeadersRow();
+
+                for (const DescriptorCounter& counter : getDescriptorCounters()) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(counter.name.c_str());
+                    ImGui::TableNextColumn(); ImGui::Text("%u", counter.pools);
+                    ImGui::TableNextColumn(); ImGui::Text("%u / %u", counter.allocatedSets, counter.setCapacity);
+                    ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(counter.descriptorCapacity));
+                }
+                ImGui::EndTable();
+            }
+
+            ImGui::SeparatorText("CPU");
+            if (ImGui::BeginTable("MemoryCpu", 4, flags)) {
+                ImGui::TableSetupColumn("Container");
+                ImGui::TableSetupColumn("Count");
+                ImGui::TableSetupColumn("MB");
+                ImGui::TableSetupColumn("Peak MB");
+                ImGui::TableHeadersRow();
+
+                for (const CpuCounter& counter : getCpuCounters()) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(counter.name.c_str());
+                    ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(counter.count));
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", toMegabytes(counter.bytes));
+                    ImGui::TableNextColumn(); ImGui::Text("%.2f", toMegabytes(counter.peakBytes));
+                }
+                ImGui::EndTable();
+            }
+
+            if (ImGui::CollapsingHeader("Largest allocations")) {
+                const vector<Allocation> live = getAllocations();
+                const size_t shown = std::min<size_t>(live.size(), 32);
+                for (size_t i = 0; i < shown; i++) {
+                    ImGui::Text("%8.2f MB  %-12s %s", toMegabytes(live[i].bytes), toString(live[i].category), live[i].name.c_str());
+                }
+            }
+        }
+        ImGui::End();
+    }
+} // namespace graphics
@@ -0,0 +1,129 @@
+/**
+ * @file MemoryTracker.h
+ * @brief GPU and CPU memory accounting per subsystem.
+ */
+
+#pragma once
+
+#include "Types.h"
+#include <array>
+#include <mutex>
+#include <unordered_map>
+
+namespace graphics {
+    struct DescriptorPoolUsage;
+
+    /**
+     * @enum MemoryCategory
+     * @brief What a GPU allocation is used for. Every Buffer and Image is tagged with one.
+     */
+    enum class MemoryCategory : u8 {
+        Untagged,       ///< Created without a category: should not stay in the table for long
+        Mesh,           ///< Vertex, index and position buffers
+        Texture,        ///< Sampled images loaded from files or generated
+        RenderTarget,   ///< Draw/depth images, G-Buffer, post-processing and shadow maps
+        Uniform,        ///< Scene data, material constants, technique parameters
+        Staging,        ///< Upload buffers, alive during a transfer only
+        Particles,      ///< Particle pools and index lists
+        Skinning,       ///< Joint palettes, skin weights and posed vertices
+        Readback,       ///< Host-visible buffers the GPU copies results into
+        Count
+    };
+
+    const char* toString(MemoryCategory category);
+
+    /**
+     * @class MemoryTracker
+     * @brief Knows how much memory each subsystem holds, to catch regressions and size budgets.
+     *
+     * ## GPU memory
+     * Buffer and Image register their VMA allocation on creation with a category and a
+     * debug name, and unregister it when destroyed. The name is also given to VMA
+     * (vmaSetAllocationName) so it shows in VMA's own JSON dumps. Next to these
+     * per-category totals, VMA statistics give the real picture per memory heap: the
+     * bytes of the device memory blocks, how much of them allocations actually use,
+     * and the driver's budget.
+     *
+     * ## CPU memory and descriptor pools
+     * CPU containers and descriptor pools are not allocated through VMA. Their owners
+     * report them as named counters (setCpuCounter, setDescriptorPools); a counter
+     * keeps the last reported value, and its peak.
+     *
+     * ## Threading
+     * Allocations can be created from loading threads: every method locks.
+     */
+    class MemoryTracker {
+    public:
+        /// Totals of one category
+        struct CategoryStats {
+            u64 bytes { 0 };
+            u64 peakBytes { 0 };
+            u32 count { 0 };
+        };
+
+        /// One live GPU allocation
+        struct Allocation {
+            MemoryCategory category;
+            str name;
+            u64 bytes;
+        };
+
+        /// CPU memory reported by a subsystem
+        struct CpuCounter {
+            str name;
+            u64 bytes { 0 };
+            u64 peakBytes { 0 };
+            u64 count { 0 };    ///< Elements, meaning depends on the counter
+        };
+
+        /// Descriptor pools of an allocator
+        struct DescriptorCounter {
+            str name;
+            u32 pools { 0 };
+            u32 setCapacity { 0 };
+            u32 allocatedSets { 0 };
+            u64 descriptorCapacity { 0 };
+        };
+
+        /// One memory heap, from VMA
+        struct HeapStats {
+            bool deviceLocal { false };
+            u64 blockBytes { 0 };       ///< Device memory allocated by VMA
+            u64 allocationBytes { 0 };  ///< Part of the blocks used by allocations
+            u32 blockCount { 0 };
+            u32 allocationCount { 0 };
+            u64 usage { 0 };            ///< Process usage as seen by the driver
+            u64 budget { 0 };           ///< What the process can use before suffering
+        };
+
+        void init(VmaAllocator allocator);
+
+        /// Registers a new allocation. Size is read from VMA
+        void track(VmaAllocation allocation, MemoryCategory category, const char* name);
+        void untrack(VmaAllocation allocation);
+
+        void setCpuCounter(const char* name, u64 bytes, u64 count);
+        void setDescriptorPools(const char* name, const DescriptorPoolUsage& usage);
+
+        std::array<CategoryStats, static_cast<size_t>(MemoryCategory::Count)> getCategoryStats() const;
+        /// Live allocations, largest first
+        vector<Allocation> getAllocations() const;
+        vector<CpuCounter> getCpuCounters() const;
+        vector<DescriptorCounter> getDescriptorCounters() const;
+        vector<HeapStats> getHeapStats() const;
+
+        /// Writes categories, heaps, counters and every allocation. Returns false on I/O error
+        bool exportJson(const str& path) const;
+
+        void drawImGui();
+
+    private:
+        VmaAllocator allocator { nullptr };
+
+        mutable std::mutex mutex;
+        std::unordered_map<VmaAllocation, Allocation> allocations;
+        std::array<CategoryStats, static_cast<size_t>(MemoryCategory::Count)> categories {};
+        vector<CpuCounter> cpuCounters;
+        vector<DescriptorCounter> descriptorCounters;
+    };
+} // namespace graphics
@@ -34,10 +34,12 @@ namespace graphics {
             def.firstIndex = startIndex;
             def.indexBuffer = mesh->meshBuffers.indexBuffer.buffer;
             def.material = &material->data;
-            def.bounds = bounds;
+            def.bounds = posedVertexAddress && posedBounds ? *posedBounds : bounds;
 
             def.transform = nodeMatrix;
-            def.vertexBufferAddress = mesh->meshBuffers.vertexBufferAddress;
+            def.vertexBufferAddress = posedVertexAddress ? posedVertexAddress : mesh->meshBuffers.vertexBufferAddress;
+            // The position stream holds the bind pose, posed meshes fall back to their full vertices
+            def.positionBufferAddress = posedVertexAddress ? 0 : mesh->meshBuffers.positionBufferAddress;
 
             if (material->data.passType == MaterialPass::Transparent) {
                 ctx.transparentSurfaces.push_back(def);
@@ -3,6 +3,7 @@
 
 namespace graphics {
     struct MeshAsset;
+    struct Bounds;
 
     struct DrawContext;
 
@@ -31,6 +32,14 @@ namespace graphics {
 
     struct MeshNode : public Node {
         sptr<MeshAsset> mesh;
+
+        // Skinned meshes are drawn from the compute-skinned buffer of the current frame instead
+        // of the bind pose vertex buffer. Set each frame by LoadedGLTF::submitSkinning.
+        i32 skin { -1 };
+        vk::DeviceAddress posedVertexAddress { 0 };
+        // Bounds of the posed mesh, for every surface, while posedVertexAddress is set
+        const Bounds* posedBounds { nullptr };
+
         void draw(const Mat4& topMatrix, DrawContext& ctx) override;
     };
 
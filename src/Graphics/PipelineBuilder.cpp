@@ -14,6 +14,7 @@
 #include "VulkanInit.hpp"
 #include "BasicServices/File.h"
 #include "BasicServices/Log.h"
+#include "BasicServices/FrameHistory.h"
 
 namespace graphics {
 
@@ -72,6 +73,8 @@ namespace graphics {
     // =========================================================================
 
     uptr<MaterialPipeline> PipelineBuilder::buildPipeline(const vk::Device device) const {
+        services::ScopedFrameEvent frameEvent(services::FrameEvent::PipelineCompile);
+
         // Apply fragment specialization constants if set
         std::vector<vk::PipelineShaderStageCreateInfo> finalShaderStages = shaderStages;
         if (fragmentSpecialization.has_value() && finalShaderStages.size() > 1) {
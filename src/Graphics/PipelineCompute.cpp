@@ -12,6 +12,7 @@
 #include "Utils.hpp"
 #include "VulkanInit.hpp"
 #include "BasicServices/File.h"
+#include "BasicServices/FrameHistory.h"
 
 using services::File;
 
@@ -42,6 +43,8 @@ namespace graphics {
     // =========================================================================
 
     void PipelineCompute::createComputePipeline(const str& compFilepath) {
+        services::ScopedFrameEvent frameEvent(services::FrameEvent::PipelineCompile, compFilepath);
+
         // Step 1: Load the compiled shader code (SPIR-V binary)
         const auto compCode = File::readBinary(compFilepath);
 
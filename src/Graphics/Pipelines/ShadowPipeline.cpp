@@ -36,11 +36,11 @@ namespace graphics::pipelines {
 
     void ShadowPipeline::buildDepthPipeline(const Renderer* renderer, vk::Device device) {
         // -----------------------------------------------------------------
-        // Push constants for model matrix and vertex buffer address
+        // Push constants for model matrix and position stream address
         // -----------------------------------------------------------------
         vk::PushConstantRange matrixRange{};
         matrixRange.offset = 0;
-        matrixRange.size = sizeof(GraphicsPushConstants);
+        matrixRange.size = sizeof(DepthPushConstants);
         matrixRange.stageFlags = vk::ShaderStageFlagBits::eVertex;
 
         // -----------------------------------------------------------------
@@ -160,6 +160,10 @@ namespace graphics::pipelines {
 
         builder.pipelineLayout = shadowMeshPipelineLayout;
 
+        // PCF kernel is a specialization constant of meshShadow.frag
+        const ShadowFilterSpecialization specialization { ShadowFilter::Optimized };
+        builder.setFragmentSpecialization(specialization.get());
+
         shadowMeshPipeline = builder.buildPipeline(device);
 
         builder.destroyShaderModules(device);
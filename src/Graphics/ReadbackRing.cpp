@@ -0,0 +1,410 @@
+/**
+ * @file ReadbackRing.cpp
+ * @brief Implementation of the asynchronous GPU readback ring.
+ */
+
+#include "ReadbackRing.h"
+
+#include "VulkanContext.h"
+#include "../BasicServices/Log.h"
+#include "../BasicServices/Platform.h"
+#include "../BasicServices/Profiler.h"
+#include <algorithm>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+using services::Log;
+
+namespace graphics {
+
+    namespace {
+        // Copy offsets must be multiples of the texel size and of 4; 256 also covers nonCoherentAtomSize
+        constexpr vk::DeviceSize REGION_ALIGNMENT = 256;
+
+        vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        bool canConvert(ReadbackConversion conversion, vk::Format format) {
+            switch (conversion) {
+                case ReadbackConversion::None:
+                    return true;
+                case ReadbackConversion::Rgba16fToRgba8:
+                case ReadbackConversion::Rgba16fToRgba32f:
+                    return format == vk::Format::eR16G16B16A16Sfloat;
+                case ReadbackConversion::Bgra8ToRgba8:
+                    return format == vk::Format::eB8G8R8A8Unorm || format == vk::Format::eB8G8R8A8Srgb;
+            }
+            return false;
+        }
+
+        /// Converts texels from the mapped region into converted. Returns the format of the result
+        vk::Format convert(ReadbackConversion conversion, vk::Format format, std::span<const u8> source, vector<u8>& converted) {
+            switch (conversion) {
+                case ReadbackConversion::Rgba16fToRgba8: {
+                    const size_t values = source.size() / sizeof(u16);
+                    converted.resize(values);
+                    for (size_t i = 0; i < values; i++) {
+                        u16 half;
+                        std::memcpy(&half, source.data() + i * sizeof(u16), sizeof(u16));
+                        converted[i] = static_cast<u8>(glm::clamp(glm::unpackHalf1x16(half), 0.f, 1.f) * 255.f + 0.5f);
+                    }
+                    return vk::Format::eR8G8B8A8Unorm;
+                }
+                case ReadbackConversion::Rgba16fToRgba32f: {
+                    const size_t values = source.size() / sizeof(u16);
+                    converted.resize(values * sizeof(f32));
+                    for (size_t i = 0; i < values; i++) {
+                        u16 half;
+                        std::memcpy(&half, source.data() + i * sizeof(u16), sizeof(u16));
+                        const f32 value = glm::unpackHalf1x16(half);
+                        std::memcpy(converted.data() + i * sizeof(f32), &value, sizeof(f32));
+                    }
+                    return vk::Format::eR32G32B32A32Sfloat;
+                }
+                case ReadbackConversion::Bgra8ToRgba8: {
+                    converted.assign(source.begin(), source.end());
+                    for (size_t i = 0; i + 3 < converted.size(); i += 4) {
+                        std::swap(converted[i], converted[i + 2]);
+                    }
+                    return format == vk::Format::eB8G8R8A8Srgb ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+                }
+                case ReadbackConversion::None:
+                    break;
+            }
+            return format;
+        }
+    }
+
+    // =========================================================================
+    // Lifetime
+    // =========================================================================
+
+    ReadbackRing::~ReadbackRing() {
+        cleanup();
+    }
+
+    void ReadbackRing::init(VulkanContext* context, u32 workerCount) {
+        this->context = context;
+        stopping = false;
+        workers.reserve(workerCount);
+        for (u32 i = 0; i < workerCount; i++) {
+            workers.emplace_back([this] { runWorker(); });
+        }
+    }
+
+    void ReadbackRing::cleanup() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        queued.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+
+        for (vector<Request>& requests : pending) {
+            requests.clear();
+        }
+        current = nullptr;
+        chunks.clear();
+    }
+
+    // =========================================================================
+    // Frame
+    // =========================================================================
+
+    void ReadbackRing::beginFrame(u32 frameIndex, u64 frameNumber) {
+        PROFILE_ZONE("Readback Delivery");
+        deliverSlot(frameIndex);
+
+        recordingSlot = frameIndex;
+        recordingFrame = frameNumber;
+        copiesThisFrame = 0;
+        bytesThisFrame = 0;
+        trimChunks();
+    }
+
+    void ReadbackRing::endFrame(vk::CommandBuffer cmd) {
+        if (copiesThisFrame == 0) return;
+
+        // The fence makes the copies available, not visible: a host barrier is still needed
+        vk::MemoryBarrier2 toHost {};
+        toHost.srcStageMask = vk::PipelineStageFlagBits2::eCopy;
+        toHost.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+        toHost.dstStageMask = vk::PipelineStageFlagBits2::eHost;
+        toHost.dstAccessMask = vk::AccessFlagBits2::eHostRead;
+        vk::DependencyInfo dependency {};
+        dependency.memoryBarrierCount = 1;
+        dependency.pMemoryBarriers = &toHost;
+        cmd.pipelineBarrier2(dependency);
+    }
+
+    void ReadbackRing::flush() {
+        // Oldest slot first, so callbacks keep frame order
+        for (u32 i = 1; i <= FRAME_OVERLAP; i++) {
+            deliverSlot((recordingSlot + i) % FRAME_OVERLAP);
+        }
+        std::unique_lock lock(mutex);
+        drained.wait(lock, [this] { return queue.empty() && running == 0; });
+    }
+
+    // =========================================================================
+    // Copies
+    // =========================================================================
+
+    void ReadbackRing::readBuffer(vk::CommandBuffer cmd, vk::Buffer src, vk::DeviceSize offset, vk::DeviceSize size,
+                                  ReadbackCallback onRead, ReadbackDelivery delivery) {
+        Request request;
+        request.size = size;
+        request.delivery = delivery;
+        request.frameNumber = recordingFrame;
+        request.onRead = std::move(onRead);
+        request.chunk = allocate(size, request.offset);
+
+        if (request.chunk) {
+            const vk::BufferCopy region { offset, request.offset, size };
+            cmd.copyBuffer(src, request.chunk->buffer.buffer, 1, &region);
+            copiesThisFrame++;
+            bytesThisFrame += size;
+        }
+        pending[recordingSlot].push_back(std::move(request));
+    }
+
+    void ReadbackRing::readImage(vk::CommandBuffer cmd, const ReadbackImage& image, ReadbackCallback onRead,
+                                 ReadbackConversion conversion, ReadbackDelivery delivery) {
+        Request request;
+        request.extent = image.extent;
+        request.format = image.format;
+        request.conversion = conversion;
+        request.delivery = conversion == ReadbackConversion::None ? delivery : ReadbackDelivery::Worker;
+        request.frameNumber = recordingFrame;
+        request.onRead = std::move(onRead);
+
+        const u32 texelSize = getTexelSize(image.format);
+        if (texelSize == 0) {
+            Log::Error("Readback: cannot read images of format %s", vk::to_string(image.format).c_str());
+        } else if (!canConvert(conversion, image.format)) {
+            Log::Error("Readback: no such conversion from %s", vk::to_string(image.format).c_str());
+        } else {
+            request.size = static_cast<vk::DeviceSize>(image.extent.width) * image.extent.height * texelSize;
+            request.chunk = allocate(request.size, request.offset);
+        }
+
+        if (request.chunk) {
+            vk::BufferImageCopy region {};
+            region.bufferOffset = request.offset;
+            region.imageSubresource.aspectMask = image.aspect;
+            region.imageSubresource.mipLevel = image.mipLevel;
+            region.imageSubresource.baseArrayLayer = image.arrayLayer;
+            region.imageSubresource.layerCount = 1;
+            region.imageExtent = vk::Extent3D { image.extent.width, image.extent.height, 1 };
+            cmd.copyImageToBuffer(image.image, image.layout, request.chunk->buffer.buffer, 1, &region);
+            copiesThisFrame++;
+            bytesThisFrame += request.size;
+        }
+        pending[recordingSlot].push_back(std::move(request));
+    }
+
+    std::future<ReadbackData> ReadbackRing::readBufferAsync(vk::CommandBuffer cmd, vk::Buffer src,
+                                                            vk::DeviceSize offset, vk::DeviceSize size) {
+        auto promise = std::make_shared<std::promise<ReadbackData>>();
+        std::future<ReadbackData> future = promise->get_future();
+        readBuffer(cmd, src, offset, size, [promise](const Readback& readback) {
+            promise->set_value({ { readback.data.begin(), readback.data.end() }, readback.extent, readback.format, readback.frameNumber });
+        }, ReadbackDelivery::Worker);
+        return future;
+    }
+
+    std::future<ReadbackData> ReadbackRing::readImageAsync(vk::CommandBuffer cmd, const ReadbackImage& image,
+                                                           ReadbackConversion conversion) {
+        auto promise = std::make_shared<std::promise<ReadbackData>>();
+        std::future<ReadbackData> future = promise->get_future();
+        readImage(cmd, image, [promise](const Readback& readback) {
+            promise->set_value({ { readback.data.begin(), readback.data.end() }, readback.extent, readback.format, readback.frameNumber });
+        }, conversion, ReadbackDelivery::Worker);
+        return future;
+    }
+
+    // =========================================================================
+    // Chunks
+    // =========================================================================
+
+    ReadbackRing::Chunk* ReadbackRing::allocate(vk::DeviceSize size, vk::DeviceSize& offset) {
+        const vk::DeviceSize alignedSize = alignUp(size, REGION_ALIGNMENT);
+        const auto take = [&](Chunk* chunk) {
+            offset = chunk->used;
+            chunk->used += alignedSize;
+            chunk->regions.fetch_add(1, std::memory_order_relaxed);
+            chunk->lastUsedFrame = recordingFrame;
+            current = chunk;
+            return chunk;
+        };
+
+        // Nothing left in a chunk: it starts over. Acquire pairs with the release of its last region
+        const auto isIdle = [](const Chunk& chunk) { return chunk.regions.load(std::memory_order_acquire) == 0; };
+
+        if (current) {
+            if (isIdle(*current)) current->used = 0;
+            if (current->used + alignedSize <= current->buffer.size) return take(current);
+        }
+        for (const uptr<Chunk>& chunk : chunks) {
+            if (chunk.get() != current && isIdle(*chunk) && chunk->buffer.size >= alignedSize) {
+                chunk->used = 0;
+                return take(chunk.get());
+            }
+        }
+
+        vk::DeviceSize total = 0;
+        for (const uptr<Chunk>& chunk : chunks) {
+            total += chunk->buffer.size;
+        }
+        const vk::DeviceSize chunkSize = std::max(CHUNK_SIZE, alignedSize);
+        if (total + chunkSize > budget) {
+            if (rejectedCopies++ == 0) {
+                Log::Warn("Readback: %llu bytes do not fit in the %llu MB budget, copies are dropped until some are read",
+                    static_cast<unsigned long long>(size), static_cast<unsigned long long>(budget >> 20));
+            }
+            return nullptr;
+        }
+
+        auto chunk = std::make_unique<Chunk>();
+        chunk->buffer = Buffer(context, chunkSize, vk::BufferUsageFlagBits::eTransferDst, VMA_MEMORY_USAGE_GPU_TO_CPU,
+                               MemoryCategory::Readback, "Readback chunk");
+        chunks.push_back(std::move(chunk));
+        return take(chunks.back().get());
+    }
+
+    void ReadbackRing::trimChunks() {
+        std::erase_if(chunks, [this](const uptr<Chunk>& chunk) {
+            return chunk.get() != current
+                && chunk->regions.load(std::memory_order_acquire) == 0
+                && recordingFrame - chunk->lastUsedFrame > TRIM_FRAMES;
+        });
+    }
+
+    // =========================================================================
+    // Delivery
+    // =========================================================================
+
+    void ReadbackRing::deliverSlot(u32 frameIndex) {
+        vector<Request>& requests = pending[frameIndex];
+        if (requests.empty()) return;
+
+        bool notify = false;
+        for (Request& request : requests) {
+            if (request.delivery == ReadbackDelivery::RenderThread || workers.empty()) {
+                complete(request);
+                continue;
+            }
+            std::lock_guard lock(mutex);
+            queue.push_back(std::move(request));
+            notify = true;
+        }
+        requests.clear();
+        if (notify) queued.notify_all();
+    }
+
+    void ReadbackRing::complete(Request& request) {
+        Readback readback;
+        readback.extent = request.extent;
+        readback.format = request.format;
+        readback.frameNumber = request.frameNumber;
+
+        vector<u8> converted;
+        if (request.chunk) {
+            const Buffer& buffer = request.chunk->buffer;
+            buffer.invalidate(request.offset, request.size);
+            readback.data = { static_cast<const u8*>(buffer.info.pMappedData) + request.offset, request.size };
+            if (request.conversion != ReadbackConversion::None) {
+                readback.format = convert(request.conversion, request.format, readback.data, converted);
+                readback.data = converted;
+            }
+        }
+
+        request.onRead(readback);
+
+        if (request.chunk) {
+            request.chunk->regions.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    void ReadbackRing::runWorker() {
+        services::Platform::setThreadName("Readback");
+        services::Platform::pinToWorkerCpus();
+        PROFILE_THREAD_NAME("Readback");
+
+        std::unique_lock lock(mutex);
+        for (;;) {
+            // Queued requests are completed even when stopping
+            queued.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+
+            Request request = std::move(queue.front());
+            queue.pop_front();
+            running++;
+            lock.unlock();
+
+            {
+                PROFILE_ZONE("Readback Callback");
+                complete(request);
+            }
+
+            lock.lock();
+            running--;
+            if (queue.empty() && running == 0) {
+                drained.notify_all();
+            }
+        }
+    }
+
+    // =========================================================================
+    // Queries
+    // =========================================================================
+
+    ReadbackRing::Stats ReadbackRing::getStats() const {
+        Stats stats;
+        stats.chunks = static_cast<u32>(chunks.size());
+        for (const uptr<Chunk>& chunk : chunks) {
+            stats.chunkBytes += chunk->buffer.size;
+        }
+        stats.copiesThisFrame = copiesThisFrame;
+        stats.bytesThisFrame = bytesThisFrame;
+        stats.rejectedCopies = rejectedCopies;
+        for (const vector<Request>& requests : pending) {
+            stats.pendingCopies += static_cast<u32>(requests.size());
+        }
+        std::lock_guard lock(mutex);
+        stats.pendingCopies += static_cast<u32>(queue.size()) + running;
+        return stats;
+    }
+
+    u32 ReadbackRing::getTexelSize(vk::Format format) {
+        switch (format) {
+            case vk::Format::eR8Unorm:
+                return 1;
+            case vk::Format::eR16Sfloat:
+            case vk::Format::eD16Unorm:
+                return 2;
+            case vk::Format::eR8G8B8A8Unorm:
+            case vk::Format::eR8G8B8A8Srgb:
+            case vk::Format::eB8G8R8A8Unorm:
+            case vk::Format::eB8G8R8A8Srgb:
+            case vk::Format::eR16G16Sfloat:
+            case vk::Format::eR32Sfloat:
+            case vk::Format::eR32Uint:
+            case vk::Format::eD32Sfloat:
+            case vk::Format::eA2B10G10R10UnormPack32:
+                return 4;
+            case vk::Format::eR16G16B16A16Sfloat:
+            case vk::Format::eR32G32Sfloat:
+                return 8;
+            case vk::Format::eR32G32B32A32Sfloat:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+} // namespace graphics
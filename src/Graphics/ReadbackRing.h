@@ -0,0 +1,212 @@
+/**
+ * @file ReadbackRing.h
+ * @brief GPU to CPU copies delivered a few frames later, without stalling.
+ */
+
+#pragma once
+
+#include "Buffer.h"
+#include "Types.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <span>
+#include <thread>
+
+namespace graphics {
+    class VulkanContext;
+
+    /// Applied on a worker thread before the callback sees the data
+    enum class ReadbackConversion {
+        None,               ///< Bytes as the GPU wrote them
+        Rgba16fToRgba8,     ///< Half float RGBA to 8 bit RGBA, clamped to [0, 1] (screenshots)
+        Rgba16fToRgba32f,   ///< Half float RGBA to float RGBA (exposure, analysis)
+        Bgra8ToRgba8        ///< Swapchain order to file order
+    };
+
+    /// Where the callback runs
+    enum class ReadbackDelivery {
+        RenderThread,       ///< In beginFrame(), on the thread that records frames. Keep it short
+        Worker              ///< On a readback worker thread. Always the case when converting
+    };
+
+    /// What a readback callback receives. data is only valid during the call
+    struct Readback {
+        std::span<const u8> data;       ///< Empty when the copy did not fit in the ring budget
+        vk::Extent2D extent { 0, 0 };   ///< Images only
+        vk::Format format { vk::Format::eUndefined };   ///< Of data, after conversion. Images only
+        u64 frameNumber { 0 };          ///< Frame the copy was recorded in
+    };
+
+    using ReadbackCallback = std::function<void(const Readback&)>;
+
+    /// Owned copy of a Readback, for futures
+    struct ReadbackData {
+        vector<u8> bytes;
+        vk::Extent2D extent { 0, 0 };
+        vk::Format format { vk::Format::eUndefined };
+        u64 frameNumber { 0 };
+    };
+
+    /// One mip level and layer of an image to read back
+    struct ReadbackImage {
+        vk::Image image { nullptr };
+        vk::ImageLayout layout { vk::ImageLayout::eTransferSrcOptimal };   ///< TransferSrcOptimal or General
+        vk::Format format { vk::Format::eUndefined };
+        vk::Extent2D extent { 0, 0 };
+        vk::ImageAspectFlags aspect { vk::ImageAspectFlagBits::eColor };
+        u32 mipLevel { 0 };
+        u32 arrayLayer { 0 };
+    };
+
+    /**
+     * @class ReadbackRing
+     * @brief Copies GPU buffers and images to persistently mapped host memory, and hands them
+     *        to callbacks once the frame that copied them has finished.
+     *
+     * ## How it works
+     * readBuffer() and readImage() take a region of a host-visible chunk (GPU_TO_CPU,
+     * mapped for its whole life) and record the copy in the frame's command buffer.
+     * endFrame() makes those writes visible to the host. The region is then left
+     * alone until the frame slot comes around again: beginFrame() runs right after
+     * the slot's fence wait, like GpuProfiler::beginFrame(), so the data is there
+     * and nothing waits for the GPU.
+     *
+     * Callbacks run on the render thread, or on a worker thread when asked to or
+     * when the data needs converting. A region goes back to its chunk once its
+     * callback returns, whatever thread that is: a slow consumer holds memory, never
+     * the frame.
+     *
+     * ## Memory
+     * Chunks are allocated on demand, CHUNK_SIZE or one per larger copy, and reused
+     * once every region in them is released. Those idle for TRIM_FRAMES are freed.
+     * When a copy would push the total past the budget it is not recorded, and its
+     * callback gets empty data: callers that cannot lose a result limit what they
+     * keep in flight (see BatchImageWriter).
+     *
+     * ## Threading
+     * read*(), beginFrame(), endFrame(), flush(): the thread that records frames.
+     * Callbacks: see ReadbackDelivery.
+     */
+    class ReadbackRing {
+    public:
+        static constexpr vk::DeviceSize CHUNK_SIZE = 16ull << 20;
+        static constexpr vk::DeviceSize DEFAULT_BUDGET = 256ull << 20;
+        static constexpr u32 TRIM_FRAMES = 600;     ///< ~10s at 60 Hz
+
+        /// Bytes counted from the last beginFrame(), and totals
+        struct Stats {
+            u32 chunks { 0 };
+            u64 chunkBytes { 0 };
+            u32 copiesThisFrame { 0 };
+            u64 bytesThisFrame { 0 };
+            u32 pendingCopies { 0 };    ///< Recorded, callback not run yet
+            u32 rejectedCopies { 0 };   ///< Over budget, since start
+        };
+
+        ReadbackRing() = default;
+        ~ReadbackRing();
+
+        ReadbackRing(const ReadbackRing&) = delete;
+        ReadbackRing& operator=(const ReadbackRing&) = delete;
+
+        /// Starts the workers. Allocates nothing until the first copy
+        void init(VulkanContext* context, u32 workerCount);
+        /// Runs the queued worker callbacks, stops the workers and frees the chunks. Undelivered copies are dropped
+        void cleanup();
+
+        /// Upper bound of the host memory held by chunks
+        void setBudget(vk::DeviceSize bytes) { budget = bytes; }
+        vk::DeviceSize getBudget() const { return budget; }
+        u32 getWorkerCount() const { return static_cast<u32>(workers.size()); }
+
+        /// Delivers what this frame slot copied FRAME_OVERLAP frames ago. After the slot's fence wait
+        void beginFrame(u32 frameIndex, u64 frameNumber);
+
+        /**
+         * @brief Records a copy of a buffer range.
+         * @param cmd The frame's command buffer. Writes to src must be made visible to transfer reads before.
+         * @param onRead Called once, with size bytes (empty if over budget).
+         */
+        void readBuffer(vk::CommandBuffer cmd, vk::Buffer src, vk::DeviceSize offset, vk::DeviceSize size,
+                        ReadbackCallback onRead, ReadbackDelivery delivery = ReadbackDelivery::RenderThread);
+
+        /**
+         * @brief Records a copy of one image subresource, tightly packed rows.
+         * @param cmd The frame's command buffer. The image must be in image.layout, its writes visible to transfer reads.
+         * @param onRead Called once with the pixels after conversion (empty if over budget or unknown format).
+         */
+        void readImage(vk::CommandBuffer cmd, const ReadbackImage& image, ReadbackCallback onRead,
+                       ReadbackConversion conversion = ReadbackConversion::None,
+                       ReadbackDelivery delivery = ReadbackDelivery::RenderThread);
+
+        /// Same copies, with the data delivered to a future from a worker
+        std::future<ReadbackData> readBufferAsync(vk::CommandBuffer cmd, vk::Buffer src, vk::DeviceSize offset, vk::DeviceSize size);
+        std::future<ReadbackData> readImageAsync(vk::CommandBuffer cmd, const ReadbackImage& image,
+                                                 ReadbackConversion conversion = ReadbackConversion::None);
+
+        /// Makes this frame's copies visible to the host. Once per frame, after the last copy
+        void endFrame(vk::CommandBuffer cmd);
+
+        /// Delivers every recorded copy and waits for the worker callbacks. Every frame's fence must have signaled
+        void flush();
+
+        Stats getStats() const;
+
+        /// Bytes per texel of the formats readImage() understands, 0 for the others
+        static u32 getTexelSize(vk::Format format);
+
+    private:
+        struct Chunk {
+            Buffer buffer;
+            vk::DeviceSize used { 0 };
+            std::atomic<u32> regions { 0 };     ///< Handed out and not released. Workers decrement
+            u64 lastUsedFrame { 0 };
+        };
+
+        struct Request {
+            Chunk* chunk { nullptr };           ///< Null when rejected
+            vk::DeviceSize offset { 0 };
+            vk::DeviceSize size { 0 };
+            vk::Extent2D extent { 0, 0 };
+            vk::Format format { vk::Format::eUndefined };
+            ReadbackConversion conversion { ReadbackConversion::None };
+            ReadbackDelivery delivery { ReadbackDelivery::RenderThread };
+            u64 frameNumber { 0 };
+            ReadbackCallback onRead;
+        };
+
+        /// A region of size bytes, nullptr over budget
+        Chunk* allocate(vk::DeviceSize size, vk::DeviceSize& offset);
+        void trimChunks();
+        void deliverSlot(u32 frameIndex);
+        /// Converts if needed, runs the callback and releases the region. Any thread
+        static void complete(Request& request);
+        void runWorker();
+
+        VulkanContext* context { nullptr };
+        vk::DeviceSize budget { DEFAULT_BUDGET };
+        vector<uptr<Chunk>> chunks;
+        Chunk* current { nullptr };                 ///< Chunk new regions are taken from
+        std::array<vector<Request>, FRAME_OVERLAP> pending;
+        u32 recordingSlot { 0 };
+        u64 recordingFrame { 0 };
+        u32 copiesThisFrame { 0 };             ///< Recorded, rejected ones aside
+        u64 bytesThisFrame { 0 };
+        u32 rejectedCopies { 0 };
+
+        // Worker callbacks
+        vector<std::thread> workers;
+        mutable std::mutex mutex;
+        std::condition_variable queued;
+        std::condition_variable drained;
+        std::deque<Request> queue;
+        u32 running { 0 };
+        bool stopping { false };
+    };
+
+} // namespace graphics
@@ -13,6 +13,7 @@ namespace graphics {
 
         Mat4 transform;
         vk::DeviceAddress vertexBufferAddress;
+        vk::DeviceAddress positionBufferAddress { 0 };  ///< Packed positions for depth passes, 0 if unavailable
     };
 
     struct DrawContext {
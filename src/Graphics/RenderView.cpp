@@ -0,0 +1,86 @@
+/**
+ * @file RenderView.cpp
+ * @brief Implementation of the shared culling and sorting of the frame's views.
+ */
+
+#include "RenderView.h"
+#include "Culling.h"
+#include "BasicServices/Profiler.h"
+
+#include <algorithm>
+#include <bit>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace graphics {
+
+    Mat4 perspectiveProjection(f32 fovDegrees, f32 aspect) {
+        Mat4 proj = glm::perspective(glm::radians(fovDegrees), aspect, 0.1f, 10000.f);
+        proj[1][1] *= -1;
+        return proj;
+    }
+
+    vk::Rect2D viewportRect(const Vec4& viewport, vk::Extent2D extent) {
+        const Vec4 clamped = glm::clamp(viewport, Vec4 { 0.f }, Vec4 { 1.f });
+        const f32 width = static_cast<f32>(extent.width);
+        const f32 height = static_cast<f32>(extent.height);
+        const i32 x = static_cast<i32>(clamped.x * width);
+        const i32 y = static_cast<i32>(clamped.y * height);
+        const u32 right = std::min(static_cast<u32>((clamped.x + clamped.z) * width), extent.width);
+        const u32 bottom = std::min(static_cast<u32>((clamped.y + clamped.w) * height), extent.height);
+        return vk::Rect2D { { x, y }, { right > static_cast<u32>(x) ? right - x : 0, bottom > static_cast<u32>(y) ? bottom - y : 0 } };
+    }
+
+    vk::Viewport ViewDraws::getViewport() const {
+        vk::Viewport viewport {};
+        viewport.x = static_cast<f32>(rect.offset.x);
+        viewport.y = static_cast<f32>(rect.offset.y);
+        viewport.width = static_cast<f32>(rect.extent.width);
+        viewport.height = static_cast<f32>(rect.extent.height);
+        viewport.minDepth = 0.f;
+        viewport.maxDepth = 1.f;
+        return viewport;
+    }
+
+    ViewDraws* FrameViews::add(const vk::Rect2D& rect, vk::DeviceSize sceneDataOffset, const GPUSceneData& sceneData) {
+        if (count == MAX_VIEWS) return nullptr;
+
+        ViewDraws& view = views[count++];
+        view.rect = rect;
+        view.sceneDataOffset = sceneDataOffset;
+        view.sceneData = sceneData;
+        view.opaque.clear();
+        view.transparent.clear();
+        return &view;
+    }
+
+    void FrameViews::cull(const DrawContext& drawContext) {
+        PROFILE_FUNCTION();
+        std::array<Mat4, MAX_VIEWS> viewProjs;
+        for (u32 v = 0; v < count; v++) {
+            viewProjs[v] = views[v].sceneData.viewProj;
+        }
+        const std::span<const Mat4> frusta { viewProjs.data(), count };
+
+        // Opaque: one material sort for the union, each view keeps its objects in that order
+        cullViews(drawContext.opaqueSurfaces, frusta, masks);
+        visible.clear();
+        for (u32 i = 0; i < masks.size(); i++) {
+            if (masks[i]) visible.push_back(i);
+        }
+        sortByMaterial(drawContext.opaqueSurfaces, visible);
+        for (const u32 i : visible) {
+            for (u32 bits = masks[i]; bits; bits &= bits - 1) {
+                views[std::countr_zero(bits)].opaque.push_back(i);
+            }
+        }
+
+        // Transparent: blended in draw context order
+        cullViews(drawContext.transparentSurfaces, frusta, masks);
+        for (u32 i = 0; i < masks.size(); i++) {
+            for (u32 bits = masks[i]; bits; bits &= bits - 1) {
+                views[std::countr_zero(bits)].transparent.push_back(i);
+            }
+        }
+    }
+
+} // namespace graphics
@@ -0,0 +1,87 @@
+/**
+ * @file RenderView.h
+ * @brief Several cameras drawn into the same frame, and their shared draw lists.
+ */
+
+#pragma once
+
+#include "Camera.h"
+#include "RenderObject.h"
+#include "Types.h"
+#include <array>
+#include <span>
+
+namespace graphics {
+
+    /// Perspective projection with Y flipped, so that we are more similar to opengl and gltf axis
+    Mat4 perspectiveProjection(f32 fovDegrees, f32 aspect);
+
+    /// Pixels of an extent covered by a viewport given as fractions (x, y, width, height)
+    vk::Rect2D viewportRect(const Vec4& viewport, vk::Extent2D extent);
+
+    /**
+     * @struct RenderView
+     * @brief A camera drawn besides the main one: picture in picture, mirror, security camera, split screen.
+     */
+    struct RenderView {
+        str name;
+        Camera camera;                          ///< Not updated by the renderer: move it yourself
+        Vec4 viewport { 0.f, 0.f, 1.f, 1.f };   ///< x, y, width, height, as fractions of the scene image
+        f32 fovDegrees { 70.f };
+        bool enabled { true };
+    };
+
+    /// One view of the frame being recorded
+    struct ViewDraws {
+        vk::Rect2D rect {};                     ///< Pixels of the scene image, also the scissor
+        vk::DeviceSize sceneDataOffset { 0 };   ///< Of sceneData in the renderer's scene data buffer
+        GPUSceneData sceneData {};              ///< The frame's lighting, the view's camera
+        vector<u32> opaque;                     ///< Visible opaque surfaces, sorted by material
+        vector<u32> transparent;                ///< Visible transparent surfaces, in draw context order
+
+        vk::Viewport getViewport() const;
+    };
+
+    /**
+     * @class FrameViews
+     * @brief Culls and sorts the draw lists of every view of a frame at once.
+     *
+     * ## Why not draw each view as a frame of its own?
+     * Most of a frame does not depend on the camera: the shadow map, the skinning,
+     * the particle simulation, the post-processing, the swapchain work. Views only
+     * differ by their culling and their draws, so they share everything else:
+     * - the draw context is walked once, each object's world box computed once and
+     *   tested against every view's frustum (cullViews())
+     * - the objects seen by any view are sorted by material once, and each view
+     *   keeps its objects in that order
+     * - techniques draw every view inside the same rendering pass, one viewport
+     *   and scene data slot per view, so pipelines and targets are shared too
+     *
+     * View 0 is the main camera. Techniques that cannot draw several views draw it alone.
+     */
+    class FrameViews {
+    public:
+        static constexpr u32 MAX_VIEWS = 8;
+
+        /// Forgets the views, keeps the capacity of their lists
+        void clear() { count = 0; }
+
+        /// Adds a view with empty lists. nullptr once MAX_VIEWS are set
+        ViewDraws* add(const vk::Rect2D& rect, vk::DeviceSize sceneDataOffset, const GPUSceneData& sceneData);
+
+        /// Fills the draw lists of every view
+        void cull(const DrawContext& drawContext);
+
+        u32 size() const { return count; }
+        std::span<const ViewDraws> getViews() const { return { views.data(), count }; }
+        ViewDraws& operator[](u32 index) { return views[index]; }
+        const ViewDraws& operator[](u32 index) const { return views[index]; }
+
+    private:
+        std::array<ViewDraws, MAX_VIEWS> views;
+        u32 count { 0 };
+        vector<u32> masks;      ///< Per object, one bit per view
+        vector<u32> visible;    ///< Objects seen by any view
+    };
+
+} // namespace graphics
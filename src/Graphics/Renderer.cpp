@@ -1,16 +1,17 @@
 #include "Renderer.h"
 
 #include <vk_mem_alloc.h>
+#include <algorithm>
 #include <chrono>
 #include <glm/gtc/matrix_transform.hpp>
 #include <imgui.h>
-#include <backends/imgui_impl_sdl3.h>
 #include <backends/imgui_impl_vulkan.h>
 #include <glm/gtx/transform.hpp>
 
 #include "Swapchain.h"
 #include "MaterialPipeline.h"
 #include "Buffer.h"
+#include "Culling.h"
 #include "DescriptorLayoutBuilder.hpp"
 #include "DescriptorWriter.h"
 #include "Image.h"
@@ -23,6 +24,9 @@
 #include "Techniques/DeferredRenderingTechnique.h"
 #include "Techniques/ShadowMappingTechnique.h"
 #include "BasicServices/Log.h"
+#include "BasicServices/Profiler.h"
+#include "BasicServices/FrameHistory.h"
+#include "BasicServices/FramePacer.h"
 #include "BasicServices/RenderingStats.h"
 #include "fmt/color.h"
 #include "../Scene.h"
@@ -40,13 +44,31 @@ namespace graphics {
     }
 
     void Renderer::init() {
+        // The context sized its targets before the render scale was known. Nothing used them yet
+        DeletionQueue initialTargets;
+        context->resizeRenderTargets(getRenderTargetExtent(), initialTargets);
+        initialTargets.flush();
+        const vk::Extent3D targetExtent = context->getDrawImage().imageExtent;
+        renderTargetAspect = static_cast<f32>(targetExtent.width) / static_cast<f32>(targetExtent.height);
+
         createCommandPoolAndBuffers();
         createSyncObjects();
         createDescriptors();
         createPipelines();
+        sceneLoader.init(this);
         createSceneData();
         createPostProcessResources();
-        initImGui();
+        skinning.init(context);
+        particles.init(this);
+        gpuProfiler.init(context);
+        // Batches encode their images in readback callbacks: give them more workers
+        const u32 cores = std::max(std::thread::hardware_concurrency(), 1u);
+        readback.init(context, context->isHeadless() ? std::clamp(cores / 2, 1u, 8u) : std::clamp(cores / 4, 1u, 2u));
+        // Headless rendering has no window to draw the UI in
+        if (!context->isHeadless()) {
+            windowExtent = context->getOutputExtent();
+            initImGui();
+        }
     }
 
     void Renderer::cleanup() {
@@ -57,13 +79,24 @@ namespace graphics {
 
         // Cleanup loaded scenes
         loadedScenes.clear();
+        sceneLoader.cleanup();
 
         // Cleanup ImGui
-        ImGui_ImplVulkan_Shutdown();
-        ImGui_ImplSDL3_Shutdown();
-        ImGui::DestroyContext();
+        if (imguiDescriptorPool) {
+            ImGui::SetCurrentContext(imguiContext);
+            ImGui_ImplVulkan_Shutdown();
+            imguiInput.cleanup();
+            ImGui::DestroyContext(imguiContext);
+            imguiContext = nullptr;
+
+            device.destroyDescriptorPool(imguiDescriptorPool);
+        }
 
-        device.destroyDescriptorPool(imguiDescriptorPool);
+        skinning.cleanup(device);
+        particles.cleanup(device);
+        gpuProfiler.cleanup(device);
+        readback.flush();
+        readback.cleanup();
 
         // Cleanup post-processing
         bloom.cleanup(device);
@@ -83,6 +116,7 @@ namespace graphics {
 
         for (int i = 0; i < FRAME_OVERLAP; i++) {
             frames[i].deletionQueue.flush();
+            frames[i].frameDescriptors.clear();
 
             device.destroyCommandPool(frames[i].commandPool);
             device.destroySemaphore(frames[i].imageAvailableSemaphore);
@@ -93,15 +127,18 @@ namespace graphics {
             device.destroySemaphore(semaphore);
         }
         renderFinishedSemaphores.clear();
+        // Only the interactive app learns, see createDescriptors()
+        if (!context->isHeadless()) {
+            frameDescriptorPools.saveProfile(DESCRIPTOR_PROFILE_PATH);
+        }
+        frameDescriptorPools.destroy();
 
         context->flushMainDeletionQueue();
     }
 
     void Renderer::createCommandPoolAndBuffers() {
-        const QueueFamilyIndices queueFamilyIndices = context->findQueueFamilies(context->getPhysicalDevice());
-
         const auto poolInfo = graphics::commandPoolCreateInfo(
-            queueFamilyIndices.graphicsFamily.value(),
+            context->getGraphicsQueueFamily(),
             vk::CommandPoolCreateFlagBits::eResetCommandBuffer
         );
 
@@ -129,32 +166,29 @@ namespace graphics {
         DescriptorLayoutBuilder layoutBuilder;
         layoutBuilder.addBinding(0, vk::DescriptorType::eStorageImage);
         drawImageDescriptorLayout = layoutBuilder.build(device, vk::ShaderStageFlagBits::eCompute);
-
-        // Allocate a descriptor set for our draw image
-        drawImageDescriptors = context->getGlobalDescriptorAllocator()->allocate(drawImageDescriptorLayout);
-
-        // Write the descriptor set to point to our draw image
-        DescriptorWriter writer;
-        writer.writeImage(0, context->getDrawImage().imageView, nullptr, vk::ImageLayout::eGeneral, vk::DescriptorType::eStorageImage);
-
-        writer.updateSet(device, drawImageDescriptors);
+        // Its sets are written per frame in drawBackground(): the target images are reallocated on resize
 
         // Cleanup
         context->addToMainDeletionQueue([&]() {
             context->getDevice().destroyDescriptorSetLayout(drawImageDescriptorLayout);
         }, "drawImageDescriptorLayout");
 
-        // Create per-frame descriptor allocators
+        // Create per-frame descriptor allocators. Their pools are shared: a frame takes
+        // what it needs, per recording thread, and gives it back on reset
+        const vector<DescriptorAllocatorGrowable::PoolSizeRatio> frameSizes {
+            { vk::DescriptorType::eStorageImage, 3 },
+            { vk::DescriptorType::eStorageBuffer, 3 },
+            { vk::DescriptorType::eUniformBuffer, 3 },
+            { vk::DescriptorType::eCombinedImageSampler, 4 }
+        };
+        frameDescriptorPools.init(device, FRAME_DESCRIPTOR_POOL_SETS, frameSizes);
+        // Bench, perf-check and batch runs start from the default sizes: their results must not
+        // depend on what ran before, nor overwrite what the interactive app learned
+        if (!context->isHeadless()) {
+            frameDescriptorPools.loadProfile(DESCRIPTOR_PROFILE_PATH);
+        }
         for (int i = 0; i < FRAME_OVERLAP; i++) {
-            // create a descriptor pool
-            vector<DescriptorAllocatorGrowable::PoolSizeRatio> frameSizes {
-                { vk::DescriptorType::eStorageImage, 3 },
-                { vk::DescriptorType::eStorageBuffer, 3 },
-                { vk::DescriptorType::eUniformBuffer, 3 },
-                { vk::DescriptorType::eCombinedImageSampler, 4 }
-            };
-
-            frames[i].frameDescriptors = DescriptorAllocatorGrowable { device, 1000, frameSizes };
+            frames[i].frameDescriptors.init(frameDescriptorPools);
         }
 
         // We use uniform buffer here instead of SSBO because this is a small buffer.
@@ -170,8 +204,12 @@ namespace graphics {
         shadowBuilder.addBinding(1, vk::DescriptorType::eCombinedImageSampler);
         shadowSceneDataDescriptorLayout = shadowBuilder.build(device, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment);
 
-        // Create scene data buffer (single buffer, updated each frame after waitForFences)
-        sceneDataBuffer = Buffer { context, sizeof(GPUSceneData), vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU };
+        // Create scene data buffer (single buffer, updated each frame after waitForFences).
+        // One slot per view, the main view first: descriptors point at their view's offset
+        const vk::DeviceSize uniformAlignment = context->getPhysicalDevice().getProperties().limits.minUniformBufferOffsetAlignment;
+        sceneDataStride = (sizeof(GPUSceneData) + uniformAlignment - 1) / uniformAlignment * uniformAlignment;
+        sceneDataBuffer = Buffer { context, sceneDataStride * FrameViews::MAX_VIEWS, vk::BufferUsageFlagBits::eUniformBuffer,
+            VMA_MEMORY_USAGE_CPU_TO_GPU, MemoryCategory::Uniform, "Scene data" };
 
         // Create shadow map
         shadowMap = std::make_unique<ShadowMap>(context, 2048);
@@ -303,12 +341,7 @@ namespace graphics {
             frames[i].imageAvailableSemaphore = device.createSemaphore(semaphoreInfo);
         }
 
-        // Create one render finished semaphore per swapchain image
-        size_t imageCount = context->getSwapchain()->getImages().size();
-        renderFinishedSemaphores.resize(imageCount);
-        for (size_t i = 0; i < imageCount; i++) {
-            renderFinishedSemaphores[i] = device.createSemaphore(semaphoreInfo);
-        }
+        createRenderFinishedSemaphores();
 
         // Create a fence for immediate submits
         immSubmitter.immFence = device.createFence(graphics::fenceCreateInfo());
@@ -317,11 +350,27 @@ namespace graphics {
         }, "immFence");
     }
 
-    void Renderer::drawBackground(vk::CommandBuffer command, const vk::DescriptorSet* targetDescriptors, const Image* targetImage) {
-        // Use provided descriptors/image or default to drawImage
-        const vk::DescriptorSet& descriptors = targetDescriptors ? *targetDescriptors : drawImageDescriptors;
+    void Renderer::createRenderFinishedSemaphores() {
+        // One per swapchain image: a semaphore is only reused once its image is acquired again
+        const size_t imageCount = context->isHeadless() ? 0 : context->getSwapchain()->getImages().size();
+        renderFinishedSemaphores.resize(imageCount);
+        for (size_t i = 0; i < imageCount; i++) {
+            renderFinishedSemaphores[i] = context->getDevice().createSemaphore(graphics::semaphoreCreateInfo());
+        }
+    }
+
+    void Renderer::drawBackground(vk::CommandBuffer command, const Image* targetImage) {
+        // Use provided image or default to drawImage
         const Image& image = targetImage ? *targetImage : context->getDrawImage();
 
+        // Written each frame, the target may have been reallocated by a resize
+        vk::DescriptorSet descriptors = getCurrentFrame().frameDescriptors.allocate(drawImageDescriptorLayout);
+        {
+            DescriptorWriter writer;
+            writer.writeImage(0, image.imageView, nullptr, vk::ImageLayout::eGeneral, vk::DescriptorType::eStorageImage);
+            writer.updateSet(context->getDevice(), descriptors);
+        }
+
         // Bind compute pipeline and descriptor sets
         constexpr auto bindPoint = vk::PipelineBindPoint::eCompute;
         const ComputeEffect &effect = backgroundEffects[currentBackgroundEffect];
@@ -335,43 +384,6 @@ namespace graphics {
                          1);
     }
 
-    bool isVisible(const RenderObject& obj, const Mat4& viewProj) {
-        std::array<Vec3, 8> corners {
-            Vec3 { 1, 1, 1 },
-            Vec3 { 1, 1, -1 },
-            Vec3 { 1, -1, 1 },
-            Vec3 { 1, -1, -1 },
-            Vec3 { -1, 1, 1 },
-            Vec3 { -1, 1, -1 },
-            Vec3 { -1, -1, 1 },
-            Vec3 { -1, -1, -1 },
-        };
-
-        Mat4 matrix = viewProj * obj.transform;
-
-        Vec3 min = { 1.5f, 1.5f, 1.5f };
-        Vec3 max = { -1.5f, -1.5f, -1.5f };
-
-        for (int c = 0; c < 8; c++) {
-            // Transform corner to clip space
-            Vec4 v = matrix * Vec4(obj.bounds.origin + (corners[c] * obj.bounds.extents), 1.f);
-
-            // Perspective division
-            v.x = v.x / v.w;
-            v.y = v.y / v.w;
-            v.z = v.z / v.w;
-
-            min = glm::min(Vec3{ v.x, v.y, v.z }, min);
-            max = glm::max(Vec3{ v.x, v.y, v.z }, max);
-        }
-
-        // Check against view frustum in clip space
-        if (min.z > 1.f || max.z < 0.f || min.x > 1.f || max.x < -1.f || min.y > 1.f || max.y < -1.f) {
-            return false;
-        }
-        return true;
-    }
-
     void Renderer::drawGeometry(vk::CommandBuffer command) {
         // Reset stats counters
         auto& stats = services::RenderingStats::Instance();
@@ -384,7 +396,8 @@ namespace graphics {
         lastIndexBuffer = nullptr;
 
         // Begin clock
-        auto start = std::chrono::system_clock::now();
+        PROFILE_FUNCTION();
+        const u64 start = services::Profiler::now();
 
         // Get the active draw context (external or internal)
         DrawContext& ctx = *getDrawContext();
@@ -394,22 +407,16 @@ namespace graphics {
         opaqueDraws.reserve(ctx.opaqueSurfaces.size());
 
         // Frustum culling: only add visible objects to draw list
-        for (uint32_t i = 0; i < ctx.opaqueSurfaces.size(); i++) {
-            if (isVisible(ctx.opaqueSurfaces[i], sceneData.viewProj)) {
-                opaqueDraws.push_back(i);
-            }
+        {
+            PROFILE_ZONE("Culling");
+            cullVisible(ctx.opaqueSurfaces, sceneData.viewProj, opaqueDraws);
         }
 
         // Sort the opaque surfaces by material and mesh
-        std::ranges::sort(opaqueDraws, [&](const auto& iA, const auto& iB) {
-            const RenderObject& A = ctx.opaqueSurfaces[iA];
-            const RenderObject& B = ctx.opaqueSurfaces[iB];
-            if (A.material == B.material) {
-                return A.indexBuffer < B.indexBuffer;
-            }
-            // else
-            return A.material < B.material;
-        });
+        {
+            PROFILE_ZONE("Sort");
+            sortByMaterial(ctx.opaqueSurfaces, opaqueDraws);
+        }
 
 
         // Begin a render pass connected to our draw image
@@ -557,6 +564,7 @@ namespace graphics {
             stats.triangleCount += r.indexCount / 3;
         };
 
+        PROFILE_ZONE("Record");
         for (auto& r : opaqueDraws) {
             draw(ctx.opaqueSurfaces[r]);
         }
@@ -571,11 +579,7 @@ namespace graphics {
         command.endRendering();
 
         // End stats
-        auto end = std::chrono::system_clock::now();
-
-        // Convert to microseconds (integer), and then come back to milliseconds
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        stats.meshDrawTime = elapsed.count() / 1000.f;
+        stats.meshDrawTime = services::Profiler::toMilliseconds(services::Profiler::now() - start);
     }
 
     void Renderer::updateLightMatrices() {
@@ -616,6 +620,7 @@ namespace graphics {
     }
 
     void Renderer::drawShadowPass(vk::CommandBuffer command) {
+        PROFILE_FUNCTION();
         // Transition shadow map to depth attachment
         graphics::transitionImage(command, shadowMap->getImage().image,
             vk::ImageLayout::eUndefined, vk::ImageLayout::eDepthAttachmentOptimal);
@@ -675,20 +680,33 @@ namespace graphics {
             shadowPipeline.depthPipelineLayout, 0, 1, &sceneDescriptor, 0, nullptr);
 
         // Draw all opaque geometry from light's perspective
+        auto& stats = services::RenderingStats::Instance();
+        stats.shadowDrawcallCount = 0;
+        stats.shadowCasterCulledCount = 0;
+
         DrawContext& ctx = *getDrawContext();
         for (auto& r : ctx.opaqueSurfaces) {
             // Use frustum culling from light's perspective
-            if (isVisible(r, sceneData.lightSpaceMatrix)) {
-                GraphicsPushConstants pushConstants{};
-                pushConstants.vertexBuffer = r.vertexBufferAddress;
-                pushConstants.worldMatrix = r.transform;
-
-                command.pushConstants(shadowPipeline.depthPipelineLayout,
-                    vk::ShaderStageFlagBits::eVertex, 0, sizeof(GraphicsPushConstants), &pushConstants);
+            if (!isVisible(r, sceneData.lightSpaceMatrix)) continue;
 
-                command.bindIndexBuffer(r.indexBuffer, 0, vk::IndexType::eUint32);
-                command.drawIndexed(r.indexCount, 1, r.firstIndex, 0, 0);
+            // Inside the light frustum, but its shadow may still fall outside the views
+            if (shadowCasterCulling && !castsVisibleShadow(getShadowCasterVolumes(), r)) {
+                stats.shadowCasterCulledCount++;
+                continue;
             }
+
+            // Depth only needs positions: use the packed stream when the mesh has one
+            DepthPushConstants pushConstants{};
+            pushConstants.worldMatrix = r.transform;
+            pushConstants.positionBuffer = r.positionBufferAddress ? r.positionBufferAddress : r.vertexBufferAddress;
+            pushConstants.positionStride = r.positionBufferAddress ? PACKED_POSITION_STRIDE : VERTEX_POSITION_STRIDE;
+
+            command.pushConstants(shadowPipeline.depthPipelineLayout,
+                vk::ShaderStageFlagBits::eVertex, 0, sizeof(DepthPushConstants), &pushConstants);
+
+            command.bindIndexBuffer(r.indexBuffer, 0, vk::IndexType::eUint32);
+            command.drawIndexed(r.indexCount, 1, r.firstIndex, 0, 0);
+            stats.shadowDrawcallCount++;
         }
 
         command.endRendering();
@@ -704,20 +722,8 @@ namespace graphics {
         // Sort opaque draws
         std::vector<u32> opaqueDraws;
         opaqueDraws.reserve(ctx.opaqueSurfaces.size());
-        for (uint32_t i = 0; i < ctx.opaqueSurfaces.size(); i++) {
-            if (isVisible(ctx.opaqueSurfaces[i], sceneData.viewProj)) {
-                opaqueDraws.push_back(i);
-            }
-        }
-
-        std::ranges::sort(opaqueDraws, [&](const auto& iA, const auto& iB) {
-            const RenderObject& A = ctx.opaqueSurfaces[iA];
-            const RenderObject& B = ctx.opaqueSurfaces[iB];
-            if (A.material == B.material) {
-                return A.indexBuffer < B.indexBuffer;
-            }
-            return A.material < B.material;
-        });
+        cullVisible(ctx.opaqueSurfaces, sceneData.viewProj, opaqueDraws);
+        sortByMaterial(ctx.opaqueSurfaces, opaqueDraws);
 
         // Bind shadow mesh pipeline
         shadowPipeline.shadowMeshPipeline->bind(command);
@@ -804,21 +810,21 @@ namespace graphics {
             0,1,2,
             2,1,3
         };
-        rectangleMesh = uploadMesh(rectIndices, rectVertices);
+        rectangleMesh = uploadMesh(rectIndices, rectVertices, false, "Rectangle");  // Never drawn in depth passes
         */
 
         // Texture
         u32 white = glm::packUnorm4x8(glm::vec4(1, 1, 1, 1));
         whiteImage = Image{ context, immSubmitter, static_cast<void*>(&white), VkExtent3D{ 1, 1, 1 },
-            vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled };
+            vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled, false, MemoryCategory::Texture, "White" };
 
         u32 grey = glm::packUnorm4x8(glm::vec4(0.66f, 0.66f, 0.66f, 1));
         greyImage = Image{ context, immSubmitter, static_cast<void*>(&grey), VkExtent3D{ 1, 1, 1 },
-            vk::Format::eR8G8B8A8Unorm,vk::ImageUsageFlagBits::eSampled };
+            vk::Format::eR8G8B8A8Unorm,vk::ImageUsageFlagBits::eSampled, false, MemoryCategory::Texture, "Grey" };
 
         u32 black = glm::packUnorm4x8(glm::vec4(0, 0, 0, 1));
         blackImage = Image{ context, immSubmitter, static_cast<void*>(&black), VkExtent3D{ 1, 1, 1 },
-            vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled };
+            vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled, false, MemoryCategory::Texture, "Black" };
 
         u32 magenta = glm::packUnorm4x8(glm::vec4(1, 0, 1, 1));
         array<u32, 16 *16 > pixels; // for 16x16 checkerboard texture
@@ -828,7 +834,7 @@ namespace graphics {
             }
         }
         errorCheckerboardImage = Image{ context, immSubmitter, pixels.data(), VkExtent3D{16, 16, 1},
-            vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled };
+            vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled, false, MemoryCategory::Texture, "Error checkerboard" };
 
         vk::Device device = context->getDevice();
         vk::SamplerCreateInfo samplerInfo {};
@@ -867,7 +873,8 @@ namespace graphics {
         materialResources.metalRoughSampler = defaultSamplerLinear;
 
         // Set the uniform buffer for the material data
-        defaultMaterialConstants = Buffer { context, sizeof(GLTFMetallicRoughness::MaterialConstants), vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU };
+        defaultMaterialConstants = Buffer { context, sizeof(GLTFMetallicRoughness::MaterialConstants), vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU,
+            MemoryCategory::Uniform, "Default material constants" };
 
         // Write the buffer
         const auto sceneUniformData = static_cast<GLTFMetallicRoughness::MaterialConstants *>(defaultMaterialConstants.info.pMappedData);
@@ -895,22 +902,46 @@ namespace graphics {
         }
         */
         
-        // Load scene
-        std::string structurePath = { "assets/structure.glb" };
-        auto structureFile = loadGltf(this, structurePath);
-        assert(structureFile.has_value());
-
-        loadedScenes["structure"] = *structureFile;
+        // Load scene: parsed on a worker while the renderer initializes, created in finishLoading()
+        sceneLoader.requestGltf(STRUCTURE_SCENE_PATH);
         mainCamera.position = Vec3{ 30.f, 0.f, -85.f };
     }
 
+    void Renderer::finishLoading() {
+        sceneLoader.finish();
+
+        sptr<LoadedGLTF> structure = sceneLoader.getGltf(STRUCTURE_SCENE_PATH);
+        assert(structure);
+        loadedScenes["structure"] = structure;
+    }
+
     void Renderer::processEvent(const SDL_Event& event) {
         mainCamera.processSDLEvent(event);
     }
 
+    void Renderer::fillCameraData(const Camera& camera, GPUSceneData& data) const {
+        data.view = camera.getViewMatrix();
+        data.proj = perspectiveProjection(70.f, renderTargetAspect.load(std::memory_order_relaxed));
+        data.viewProj = data.proj * data.view;
+    }
+
     void Renderer::updateScene() {
-        // Update camera
-        mainCamera.update();
+        PROFILE_FUNCTION();
+        // A packet's camera has already been moved by the simulation
+        if (currentPacket) {
+            sceneData.view = currentPacket->sceneData.view;
+            sceneData.proj = currentPacket->sceneData.proj;
+            sceneData.viewProj = currentPacket->sceneData.viewProj;
+        } else {
+            mainCamera.update();
+            fillCameraData(mainCamera, sceneData);
+        }
+        // A main view narrower than the frame (split screen) keeps the aspect of its own rectangle
+        const vk::Rect2D mainRect = viewportRect(mainViewport, { sceneImage.imageExtent.width, sceneImage.imageExtent.height });
+        if (mainViewport != Vec4 { 0.f, 0.f, 1.f, 1.f } && mainRect.extent.width > 0 && mainRect.extent.height > 0) {
+            sceneData.proj = perspectiveProjection(70.f, static_cast<f32>(mainRect.extent.width) / static_cast<f32>(mainRect.extent.height));
+            sceneData.viewProj = sceneData.proj * sceneData.view;
+        }
 
         // Only clear internal context if no external context is provided
         if (!externalDrawContext) {
@@ -918,19 +949,6 @@ namespace graphics {
             mainDrawContext.transparentSurfaces.clear();
         }
 
-
-
-        const auto imageExtent = context->getDrawImage().imageExtent;
-
-        // Use camera for view matrix
-        sceneData.view = mainCamera.getViewMatrix();
-        sceneData.proj = glm::perspective(glm::radians(70.f), static_cast<float>(imageExtent.width) / static_cast<float>(imageExtent.height), 0.1f, 10000.f);
-
-        // Invert the Y direction on projection matrix so that we are more similar
-        // to opengl and gltf axis
-        sceneData.proj[1][1] *= -1;
-        sceneData.viewProj = sceneData.proj * sceneData.view;
-
         // Some default lighting parameters
         sceneData.ambientColor = glm::vec4(.1f);
         sceneData.sunlightColor = glm::vec4(1.f);
@@ -939,6 +957,10 @@ namespace graphics {
         // Update light matrices for shadow mapping
         updateLightMatrices();
 
+        if (sceneDataOverride) {
+            sceneData = *sceneDataOverride;
+        }
+
         /* Draw test GLTF nodes
 
         loadedNodes["Suzanne"]->draw(Mat4{1.f}, mainDrawContext);
@@ -952,21 +974,66 @@ namespace graphics {
         */
 
         // Only fill mainDrawContext if no external context is provided
-        if (!externalDrawContext) {
+        if (!externalDrawContext && loadedScenes["structure"]) {
             loadedScenes["structure"]->draw(Mat4{ 1.f }, mainDrawContext);
         }
+
+        updateViews();
+
+        // An overridden light matrix has already been fitted. Fitting to the main view would crop the shadows of the others
+        if (shadowProjectionFitting && !sceneDataOverride && frameViews.size() == 1) {
+            sceneData.lightSpaceMatrix = fitShadowProjection(sceneData.lightSpaceMatrix, sceneData.viewProj,
+                                                             shadowCasterVolumes[0], getDrawContext()->opaqueSurfaces);
+            frameViews[0].sceneData.lightSpaceMatrix = sceneData.lightSpaceMatrix;
+        }
+
+        // Culled once for every view, before the fence wait
+        frameViews.cull(*getDrawContext());
+    }
+
+    void Renderer::updateViews() {
+        const vk::Extent2D extent { sceneImage.imageExtent.width, sceneImage.imageExtent.height };
+        frameViews.clear();
+        frameViews.add(viewportRect(mainViewport, extent), 0, sceneData);
+
+        // Other views share the frame's lighting and shadow map, only the camera differs
+        for (const RenderView& view : views) {
+            const vk::Rect2D rect = viewportRect(view.viewport, extent);
+            if (!view.enabled || rect.extent.width == 0 || rect.extent.height == 0) continue;
+
+            GPUSceneData data = sceneData;
+            data.view = view.camera.getViewMatrix();
+            data.proj = perspectiveProjection(view.fovDegrees, static_cast<f32>(rect.extent.width) / static_cast<f32>(rect.extent.height));
+            data.viewProj = data.proj * data.view;
+            if (!frameViews.add(rect, frameViews.size() * sceneDataStride, data)) break;
+        }
+
+        // Shadow casters are culled against each view frustum extruded towards the light
+        for (u32 i = 0; i < frameViews.size(); i++) {
+            shadowCasterVolumes[i] = ShadowCasterVolume::fromPointLight(frameViews[i].sceneData.viewProj, lightPos);
+        }
     }
 
-    GPUMeshBuffers Renderer::uploadMesh(std::span<uint32_t> indices, std::span<Vertex> vertices) {
+    GPUMeshBuffers Renderer::uploadMesh(std::span<uint32_t> indices, std::span<Vertex> vertices, bool positionStream, const char* name) {
+        UploadBatch batch { context, immSubmitter };
+        GPUMeshBuffers newSurface = uploadMesh(batch, indices, vertices, positionStream, name);
+        batch.flush();
+        return newSurface;
+    }
+
+    GPUMeshBuffers Renderer::uploadMesh(UploadBatch& batch, std::span<uint32_t> indices, std::span<Vertex> vertices, bool positionStream, const char* name) {
+        PROFILE_FUNCTION();
         const size_t vertexBufferSize = vertices.size() * sizeof(Vertex);
         const size_t indexBufferSize = indices.size() * sizeof(uint32_t);
+        // Depth-only passes read 12 bytes per vertex from here instead of the 48 bytes Vertex
+        const size_t positionBufferSize = positionStream ? vertices.size() * PACKED_POSITION_STRIDE * sizeof(f32) : 0;
 
         GPUMeshBuffers newSurface;
 
         // Vertex buffer
         newSurface.vertexBuffer = Buffer {context, vertexBufferSize,
             vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-            VMA_MEMORY_USAGE_GPU_ONLY};
+            VMA_MEMORY_USAGE_GPU_ONLY, MemoryCategory::Mesh, name};
 
         // Find the address of the vertex buffer
         vk::BufferDeviceAddressInfo deviceAddressInfo {};
@@ -975,68 +1042,100 @@ namespace graphics {
 
         // Index buffer
         newSurface.indexBuffer = Buffer {context,indexBufferSize, vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst,
-            VMA_MEMORY_USAGE_GPU_ONLY};
+            VMA_MEMORY_USAGE_GPU_ONLY, MemoryCategory::Mesh, name};
+
+        // Position stream
+        if (positionBufferSize > 0) {
+            newSurface.positionBuffer = Buffer {context, positionBufferSize,
+                vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                VMA_MEMORY_USAGE_GPU_ONLY, MemoryCategory::Mesh, name};
+            newSurface.positionBufferAddress = newSurface.positionBuffer.getDeviceAddress();
+        }
 
-        // Uploading via staging buffers
-        const Buffer staging { context, vertexBufferSize + indexBufferSize, vk::BufferUsageFlagBits::eTransferSrc, VMA_MEMORY_USAGE_CPU_ONLY};
-        void* data = staging.info.pMappedData;
+        // Staged in the batch, copied when it flushes
+        memcpy(batch.addBufferCopy(newSurface.vertexBuffer.buffer, vertexBufferSize), vertices.data(), vertexBufferSize);
+        memcpy(batch.addBufferCopy(newSurface.indexBuffer.buffer, indexBufferSize), indices.data(), indexBufferSize);
 
-        // Copy  buffers
-        memcpy(data, vertices.data(), vertexBufferSize);
-        memcpy(static_cast<char *>(data) + vertexBufferSize, indices.data(), indexBufferSize);
+        if (positionBufferSize > 0) {
+            auto* positions = static_cast<f32*>(batch.addBufferCopy(newSurface.positionBuffer.buffer, positionBufferSize));
+            for (size_t i = 0; i < vertices.size(); i++) {
+                positions[i * PACKED_POSITION_STRIDE + 0] = vertices[i].position.x;
+                positions[i * PACKED_POSITION_STRIDE + 1] = vertices[i].position.y;
+                positions[i * PACKED_POSITION_STRIDE + 2] = vertices[i].position.z;
+            }
+        }
 
-        immSubmitter.immediateSubmit(context, [&](vk::CommandBuffer cmd) {
-            vk::BufferCopy vertexCopy{ 0 };
-            vertexCopy.dstOffset = 0;
-            vertexCopy.srcOffset = 0;
-            vertexCopy.size = vertexBufferSize;
+        return newSurface;
+    }
 
-            cmd.copyBuffer(staging.buffer, newSurface.vertexBuffer.buffer, 1, &vertexCopy);
+    Buffer Renderer::uploadSkinData(std::span<SkinVertex> skinVertices, const char* name) {
+        UploadBatch batch { context, immSubmitter };
+        Buffer skinBuffer = uploadSkinData(batch, skinVertices, name);
+        batch.flush();
+        return skinBuffer;
+    }
 
-            vk::BufferCopy indexCopy{ 0 };
-            indexCopy.dstOffset = 0;
-            indexCopy.srcOffset = vertexBufferSize;
-            indexCopy.size = indexBufferSize;
+    Buffer Renderer::uploadSkinData(UploadBatch& batch, std::span<SkinVertex> skinVertices, const char* name) {
+        const size_t bufferSize = skinVertices.size() * sizeof(SkinVertex);
 
-            cmd.copyBuffer(staging.buffer, newSurface.indexBuffer.buffer, 1, &indexCopy);
-        });
+        // Only read by the skinning compute shader, through its device address
+        Buffer skinBuffer { context, bufferSize,
+            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+            VMA_MEMORY_USAGE_GPU_ONLY, MemoryCategory::Skinning, name };
 
-        /*
-         * TODO Optimization
-         * This pattern is not very efficient, as we are waiting for the GPU command to fully execute before
-         * continuing with our CPU side logic. This is something people generally put on a background thread, whose
-         * sole job is to execute uploads like this one, and deleting/reusing the staging buffers.
-        */
-        return newSurface;
+        memcpy(batch.addBufferCopy(skinBuffer.buffer, bufferSize), skinVertices.data(), bufferSize);
+
+        return skinBuffer;
     }
 
 
     void Renderer::draw() {
+        PROFILE_FUNCTION();
         const vk::Device device = context->getDevice();
         FrameData &currentFrameData = getCurrentFrame();
 
         if (resizeRequested) {
-            context->resizeSwapchain();
+            // Nothing to present to while minimized: skip frames until the window is back
+            if (!recreateSwapchain()) {
+                skinning.reset();
+                return;
+            }
             resizeRequested = false;
         }
 
         updateScene();
 
         // Wait for previous frame
-        vk::Result fenceResult = device.waitForFences(1, &currentFrameData.renderFence, true, 1000000000);
+        vk::Result fenceResult;
+        {
+            PROFILE_ZONE("Wait Fence");
+            fenceResult = device.waitForFences(1, &currentFrameData.renderFence, true, 1000000000);
+        }
+        // Results this frame slot copied FRAME_OVERLAP frames ago are in memory now
+        readback.beginFrame(frameNumber % FRAME_OVERLAP, frameNumber);
         currentFrameData.deletionQueue.flush();
         currentFrameData.frameDescriptors.clear();
-        const auto res = device.resetFences(1, &currentFrameData.renderFence);
+        // Pools this frame is likely to need, created now rather than while recording
+        frameDescriptorPools.prewarm();
 
         // Request image from the swapchain
-        u32 imageIndex;
-        vk::Result result = device.acquireNextImageKHR(*context->getSwapchain()->getSwapchain(), 1000000000,
-                                                       currentFrameData.imageAvailableSemaphore, nullptr, &imageIndex);
+        const bool headless = context->isHeadless();
+        u32 imageIndex { 0 };
+        vk::Result result { vk::Result::eSuccess };
+        if (!headless) {
+            PROFILE_ZONE("Acquire");
+            result = device.acquireNextImageKHR(*context->getSwapchain()->getSwapchain(), 1000000000,
+                                                currentFrameData.imageAvailableSemaphore, nullptr, &imageIndex);
+        }
         if (result == vk::Result::eErrorOutOfDateKHR) {
             resizeRequested = true;
+            skinning.reset();
             return;
         }
 
+        // Only reset once something will be submitted, a skipped frame must leave the fence signaled
+        const auto res = device.resetFences(1, &currentFrameData.renderFence);
+
         const vk::CommandBuffer command = currentFrameData.mainCommandBuffer;
         command.reset();
 
@@ -1048,11 +1147,26 @@ namespace graphics {
         Image& drawImage = context->getDrawImage();
         Image& depthImage = context->getDepthImage();
 
-        auto swapchainExtent = context->getSwapchain()->getExtent();
+        auto swapchainExtent = context->getOutputExtent();
         drawExtent.width = std::min(swapchainExtent.width, drawImage.imageExtent.width) / renderScale;
         drawExtent.height = std::min(swapchainExtent.height, drawImage.imageExtent.height) / renderScale;
 
         command.begin(beginInfo);
+        services::RenderingStats::Instance().barrierCount = 0;
+
+        // Read back the timestamps this frame slot recorded FRAME_OVERLAP frames ago
+        gpuProfiler.beginFrame(command, frameNumber % FRAME_OVERLAP);
+        gpuProfiler.setFrameTargetPixels(static_cast<u64>(drawExtent.width) * drawExtent.height);
+
+        // Pose skinned meshes first: every pass below reads their posed vertex buffers
+        {
+            GpuScope scope(gpuProfiler, command, "Skinning");
+            if (currentPacket) {
+                skinning.record(command, frameNumber % FRAME_OVERLAP, currentPacket->skinning);
+            } else {
+                skinning.record(command, frameNumber % FRAME_OVERLAP);
+            }
+        }
 
         // Use external rendering technique if provided, otherwise use default shadow mapping
         if (externalRenderingTechnique) {
@@ -1060,32 +1174,58 @@ namespace graphics {
             // Draw background to sceneImage using compute shader
             graphics::transitionImage(command, sceneImage.image,
                                       vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral);
-            drawBackground(command, &sceneImageDescriptors, &sceneImage);
+            {
+                GpuScope scope(gpuProfiler, command, "Background");
+                drawBackground(command, &sceneImage);
+            }
 
             // Transition for rendering
             graphics::transitionImage(command, sceneImage.image,
                                       vk::ImageLayout::eGeneral, vk::ImageLayout::eColorAttachmentOptimal);
             graphics::transitionImage(command, depthImage.image, vk::ImageLayout::eUndefined, vk::ImageLayout::eDepthAttachmentOptimal);
 
-            // Write scene data buffer
-            auto sceneUniformData = static_cast<GPUSceneData*>(sceneDataBuffer.info.pMappedData);
-            *sceneUniformData = sceneData;
+            // Write scene data buffer, one slot per view
+            auto sceneUniformData = static_cast<u8*>(sceneDataBuffer.info.pMappedData);
+            for (const ViewDraws& view : frameViews.getViews()) {
+                *reinterpret_cast<GPUSceneData*>(sceneUniformData + view.sceneDataOffset) = view.sceneData;
+            }
 
-            // Use the external rendering technique - it renders to sceneImage
+            // Simulate particles before the scene passes, so the draw lists are ready afterwards
+            {
+                GpuScope scope(gpuProfiler, command, "Particles Simulate");
+                particles.update(command, sceneData, frameNumber % FRAME_OVERLAP);
+            }
+
+            // Use the external rendering technique - it renders to sceneImage.
+            // Its own targets follow the draw image, whether it was resized or the technique just switched in
+            externalRenderingTechnique->resize(drawImage.imageExtent, frames[lastSubmittedFrame].deletionQueue);
             DrawContext& ctx = *getDrawContext();
-            externalRenderingTechnique->render(command, ctx, sceneData, getCurrentFrame().frameDescriptors);
+            externalRenderingTechnique->render(command, ctx, sceneData, getCurrentFrame().frameDescriptors.local());
+
+            // Particles are blended over the lit scene, depth tested against it
+            {
+                GpuScope scope(gpuProfiler, command, "Particles Draw");
+                particles.render(command, sceneImage, depthImage, frameNumber % FRAME_OVERLAP);
+            }
 
             // Apply post-processing (bloom) from sceneImage to drawImage
             applyPostProcess(command);
         } else {
             // Default: Shadow pass - render depth from light's perspective
-            drawShadowPass(command);
+            {
+                const u64 shadowPixels = static_cast<u64>(shadowMap->getResolution()) * shadowMap->getResolution();
+                GpuScope scope(gpuProfiler, command, "Shadow", shadowPixels);
+                drawShadowPass(command);
+            }
 
             // Make the swapchain image into writeable mode before rendering
             graphics::transitionImage(command, drawImage.image,
                                       vk::ImageLayout::eUndefined, vk::ImageLayout::eGeneral);
 
-            drawBackground(command);
+            {
+                GpuScope scope(gpuProfiler, command, "Background");
+                drawBackground(command);
+            }
 
             // Transition draw image to color attachment optimal for geometry rendering
             graphics::transitionImage(command, drawImage.image, vk::ImageLayout::eGeneral, vk::ImageLayout::eColorAttachmentOptimal);
@@ -1096,7 +1236,9 @@ namespace graphics {
             {
                 DescriptorWriter writer;
                 writer.writeBuffer(0, sceneDataBuffer.buffer, sizeof(GPUSceneData), 0, vk::DescriptorType::eUniformBuffer);
-                writer.writeImage(1, shadowMap->getImage().imageView, shadowMap->getSampler(),
+                // The debug view reads raw depth, lighting goes through the comparison sampler
+                const vk::Sampler shadowSampler = displayShadowMap ? shadowMap->getSampler() : shadowMap->getCompareSampler();
+                writer.writeImage(1, shadowMap->getImage().imageView, shadowSampler,
                     vk::ImageLayout::eShaderReadOnlyOptimal, vk::DescriptorType::eCombinedImageSampler);
                 writer.updateSet(context->getDevice(), shadowSceneDescriptor);
             }
@@ -1112,6 +1254,7 @@ namespace graphics {
                 const auto imageExtent = drawImage.imageExtent;
                 const vk::Rect2D rect{ vk::Offset2D{0, 0}, {imageExtent.width, imageExtent.height} };
                 const vk::RenderingInfo renderInfo = graphics::renderingInfo(rect, &colorAttachment, &depthAttachment);
+                GpuScope scope(gpuProfiler, command, "Geometry");
                 command.beginRendering(&renderInfo);
 
                 drawShadowDebug(command, shadowSceneDescriptor);
@@ -1127,6 +1270,7 @@ namespace graphics {
                 const auto imageExtent = drawImage.imageExtent;
                 const vk::Rect2D rect{ vk::Offset2D{0, 0}, {imageExtent.width, imageExtent.height} };
                 const vk::RenderingInfo renderInfo = graphics::renderingInfo(rect, &colorAttachment, &depthAttachment);
+                GpuScope scope(gpuProfiler, command, "Geometry");
                 command.beginRendering(&renderInfo);
 
                 drawShadowGeometry(command, shadowSceneDescriptor);
@@ -1135,15 +1279,46 @@ namespace graphics {
             }
         }
 
+        // Every descriptor set of the frame has been allocated by now
+        updateMemoryCounters();
+
         // Transition the draw image and the swapchain image into their correct transfer layouts
         graphics::transitionImage(command, drawImage.image, vk::ImageLayout::eColorAttachmentOptimal,
                                   vk::ImageLayout::eTransferSrcOptimal);
+
+        // The final image, as the blit sees it: without the UI
+        const ReadbackImage finalImage { drawImage.image, vk::ImageLayout::eTransferSrcOptimal, drawImage.imageFormat, drawExtent };
+        for (auto& [onRead, conversion, delivery] : finalImageReads) {
+            readback.readImage(command, finalImage, std::move(onRead), conversion, delivery);
+        }
+        finalImageReads.clear();
+        readback.endFrame(command);
+
+        // Offscreen: the frame ends in drawImage, nothing to blit nor present
+        if (headless) {
+            command.end();
+
+            const vk::CommandBufferSubmitInfo commandInfo = graphics::commandBufferSubmitInfo(command);
+            const vk::SubmitInfo2 submit = graphics::submitInfo(&commandInfo, nullptr, nullptr);
+            {
+                PROFILE_ZONE("Submit");
+                const vk::Result submitResult = context->getGraphicsQueue().submit2(1, &submit, currentFrameData.renderFence);
+            }
+            lastSubmittedFrame = frameNumber % FRAME_OVERLAP;
+
+            frameNumber++;
+            return;
+        }
+
         graphics::transitionImage(command, context->getSwapchain()->getImages()[imageIndex],
                                   vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
 
         // Execute a copy from the draw image into the swapchain
-        graphics::copyImageToImage(command, drawImage.image, context->getSwapchain()->getImages()[imageIndex],
-                                   drawExtent, context->getSwapchain()->getExtent());
+        {
+            GpuScope scope(gpuProfiler, command, "Blit");
+            graphics::copyImageToImage(command, drawImage.image, context->getSwapchain()->getImages()[imageIndex],
+                                       drawExtent, context->getSwapchain()->getExtent());
+        }
 
         // Transition swapchain image to color attachment for ImGui rendering
         graphics::transitionImage(command, context->getSwapchain()->getImages()[imageIndex],
@@ -1155,9 +1330,13 @@ namespace graphics {
         vk::RenderingInfo renderInfo = graphics::renderingInfo(vk::Rect2D({0, 0}, context->getSwapchain()->getExtent()),
                                                                &colorAttachment);
 
-        command.beginRendering(renderInfo);
-        drawImGui(command);
-        command.endRendering();
+        {
+            const vk::Extent2D imguiExtent = context->getSwapchain()->getExtent();
+            GpuScope scope(gpuProfiler, command, "ImGui", static_cast<u64>(imguiExtent.width) * imguiExtent.height);
+            command.beginRendering(renderInfo);
+            drawImGui(command);
+            command.endRendering();
+        }
 
         // Set swapchain image layout to Present so we can show it on the screen
         graphics::transitionImage(command, context->getSwapchain()->getImages()[imageIndex],
@@ -1181,7 +1360,12 @@ namespace graphics {
         /* Submit command buffer to the queue and execute it.
          * renderFence will now block until the graphic commands finish execution
         */
-        vk::Result submitResult = context->getGraphicsQueue().submit2(1, &submit, currentFrameData.renderFence);
+        vk::Result submitResult;
+        {
+            PROFILE_ZONE("Submit");
+            submitResult = context->getGraphicsQueue().submit2(1, &submit, currentFrameData.renderFence);
+        }
+        lastSubmittedFrame = frameNumber % FRAME_OVERLAP;
 
         /* Prepare present
          * This will put the image we just rendered to into the visible window.
@@ -1198,42 +1382,139 @@ namespace graphics {
 
         presentInfo.pImageIndices = &imageIndex;
 
-        vk::Result queueResult = context->getGraphicsQueue().presentKHR(&presentInfo);
+        vk::Result queueResult;
+        {
+            PROFILE_ZONE("Present");
+            queueResult = context->getGraphicsQueue().presentKHR(&presentInfo);
+        }
         if (queueResult == vk::Result::eErrorOutOfDateKHR) {
             resizeRequested = true;
             return;
         }
+        // Suboptimal frames are still presented, but some platforms only report a resize that way
+        if (queueResult == vk::Result::eSuboptimalKHR) {
+            resizeRequested = true;
+        }
 
         // Increase the number of frames drawn
         frameNumber++;
     }
 
+    void Renderer::readFinalImage(ReadbackCallback onRead, ReadbackConversion conversion, ReadbackDelivery delivery) {
+        finalImageReads.emplace_back(std::move(onRead), conversion, delivery);
+    }
+
+    void Renderer::finishFrames() {
+        const vk::Device device = context->getDevice();
+        for (FrameData& frame : frames) {
+            const vk::Result result = device.waitForFences(1, &frame.renderFence, true, UINT64_MAX);
+        }
+        readback.flush();
+    }
+
+    void Renderer::draw(FramePacket& packet) {
+        // Queued even when the frame is skipped: the next UI frame gets it, no key stays down
+        if (imguiContext) {
+            ImGui::SetCurrentContext(imguiContext);
+            ImGuiInput::apply(packet.ui);
+        }
+
+        // Some platforms never report an out of date swapchain on resize
+        if (packet.windowExtent != windowExtent) {
+            windowExtent = packet.windowExtent;
+            resizeRequested = true;
+        }
+
+        // The simulation picked the frame in flight when it chose the posed vertex buffers.
+        // Frames skipped on an out of date swapchain leave a gap, which is harmless
+        frameNumber = static_cast<int>(packet.frameNumber);
+        mainCamera = packet.camera;
+
+        DrawContext* previousDrawContext = externalDrawContext;
+        externalDrawContext = &packet.drawContext;
+        currentPacket = &packet;
+
+        draw();
+
+        currentPacket = nullptr;
+        externalDrawContext = previousDrawContext;
+    }
+
     void Renderer::createPostProcessResources() {
         // Create scene image as intermediate render target
         // eStorage is needed for compute shader background rendering
         auto extent = context->getDrawImage().imageExtent;
+        createSceneTargets(extent);
+
+        // Initialize SSAO post-process
+        ssao.init(this, extent.width, extent.height);
+
+        // Initialize bloom post-process
+        bloom.init(this, extent.width, extent.height);
+    }
+
+    void Renderer::createSceneTargets(vk::Extent3D extent) {
         sceneImage = Image(context, extent,
             context->getDrawImage().imageFormat,
             vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled |
             vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst |
-            vk::ImageUsageFlagBits::eStorage);
-
-        // Create descriptor set for sceneImage (for background compute shader)
-        sceneImageDescriptors = context->getGlobalDescriptorAllocator()->allocate(drawImageDescriptorLayout);
-        DescriptorWriter sceneWriter;
-        sceneWriter.writeImage(0, sceneImage.imageView, nullptr, vk::ImageLayout::eGeneral, vk::DescriptorType::eStorageImage);
-        sceneWriter.updateSet(context->getDevice(), sceneImageDescriptors);
+            vk::ImageUsageFlagBits::eStorage, false, MemoryCategory::RenderTarget, "Scene image");
 
         // Create SSAO output image (used as intermediate between SSAO and bloom)
         ssaoOutputImage = Image(context, extent,
             context->getDrawImage().imageFormat,
-            vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst);
+            vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst,
+            false, MemoryCategory::RenderTarget, "SSAO output");
+    }
 
-        // Initialize SSAO post-process
-        ssao.init(this, extent.width, extent.height);
+    vk::Extent3D Renderer::getRenderTargetExtent() const {
+        // Headless targets are sized by the caller, and stay so
+        if (context->isHeadless()) return context->getDrawImage().imageExtent;
 
-        // Initialize bloom post-process
-        bloom.init(this, extent.width, extent.height);
+        // drawExtent = min(swapchain, draw) / renderScale must cover the draw image exactly
+        const vk::Extent2D output = context->getOutputExtent();
+        return {
+            std::max(1u, static_cast<u32>(static_cast<f32>(output.width) / renderScale)),
+            std::max(1u, static_cast<u32>(static_cast<f32>(output.height) / renderScale)),
+            1
+        };
+    }
+
+    bool Renderer::recreateSwapchain() {
+        // The last submitted frame is the last one that may use what gets replaced: every earlier
+        // frame completes before it, and none after it exists yet. Its slot's deletion queue is
+        // flushed once its fence signals, without a global device wait
+        DeletionQueue& retired = frames[lastSubmittedFrame].deletionQueue;
+        if (!context->resizeSwapchain(windowExtent, retired)) return false;
+
+        // Image count may change with the swapchain. Old semaphores may still be waited on by
+        // the last presents of the old swapchain, they are retired with it
+        retired.pushFunction([device = context->getDevice(), semaphores = std::move(renderFinishedSemaphores)]() {
+            for (const vk::Semaphore semaphore : semaphores) {
+                device.destroySemaphore(semaphore);
+            }
+        }, "Retired render finished semaphores");
+        renderFinishedSemaphores.clear();
+        createRenderFinishedSemaphores();
+
+        resizeRenderTargets(retired);
+        return true;
+    }
+
+    void Renderer::resizeRenderTargets(DeletionQueue& retired) {
+        const vk::Extent3D extent = getRenderTargetExtent();
+        if (context->getDrawImage().imageExtent == extent) return;
+
+        // Only window sized targets: the shadow map and particle buffers do not depend on it
+        context->resizeRenderTargets(extent, retired);
+        sceneImage.retire(context, retired);
+        ssaoOutputImage.retire(context, retired);
+        createSceneTargets(extent);
+        ssao.resize(extent.width, extent.height, retired);
+        bloom.resize(extent.width, extent.height, retired);
+        renderTargetAspect = static_cast<f32>(extent.width) / static_cast<f32>(extent.height);
+
+        services::Log::Info("Render targets resized to %ux%u", extent.width, extent.height);
     }
 
     void Renderer::applyPostProcess(vk::CommandBuffer cmd) {
@@ -1264,8 +1545,9 @@ namespace graphics {
                     vk::ImageLayout::eUndefined, vk::ImageLayout::eColorAttachmentOptimal);
 
                 // Apply SSAO: sceneImage + G-Buffer -> ssaoOutputImage
+                GpuScope scope(gpuProfiler, cmd, "SSAO");
                 ssao.apply(cmd, sceneImage, ssaoOutputImage, gBuffer->position, gBuffer->normal,
-                          sceneData.proj, sceneData.view, getCurrentFrame().frameDescriptors);
+                          sceneData.proj, sceneData.view, getCurrentFrame().frameDescriptors.local());
 
                 // Transition SSAO output for reading by bloom
                 graphics::transitionImage(cmd, ssaoOutputImage.image,
@@ -1280,7 +1562,8 @@ namespace graphics {
             vk::ImageLayout::eUndefined, vk::ImageLayout::eColorAttachmentOptimal);
 
         // Apply bloom (will blit directly if disabled)
-        bloom.apply(cmd, *ssaoInput, drawImage, getCurrentFrame().frameDescriptors);
+        GpuScope scope(gpuProfiler, cmd, "Bloom");
+        bloom.apply(cmd, *ssaoInput, drawImage, getCurrentFrame().frameDescriptors.local());
     }
 
     void Renderer::initImGui() {
@@ -1309,10 +1592,11 @@ namespace graphics {
         imguiDescriptorPool = context->getDevice().createDescriptorPool(pool_info);
 
         // 2: Initialize ImGui library
-        ImGui::CreateContext();
+        imguiContext = ImGui::CreateContext();
+        ImGui::SetCurrentContext(imguiContext);
 
-        // 3: Initialize ImGui for SDL3
-        ImGui_ImplSDL3_InitForVulkan(context->getWindow());
+        // 3: SDL3 platform backend, on a context of the main thread
+        imguiInput.init(context->getWindow(), imguiContext);
 
         // 4: Initialize ImGui for Vulkan (using dynamic rendering)
         ImGui_ImplVulkan_InitInfo init_info = {};
@@ -1340,7 +1624,7 @@ namespace graphics {
     float Renderer::getMinRenderScale() const {
         // Calculate min scale to avoid exceeding drawImage size
         auto drawImageExtent = context->getDrawImage().imageExtent;
-        auto swapchainExtent = context->getSwapchain()->getExtent();
+        auto swapchainExtent = context->getOutputExtent();
 
         // Formula: size = min(swap, draw) / scale
         // We want: scale >= min(swap, draw) / draw
@@ -1350,17 +1634,144 @@ namespace graphics {
         return std::max(minScaleX, minScaleY);
     }
 
+    void Renderer::updateMemoryCounters() {
+        MemoryTracker& tracker = context->getMemoryTracker();
+
+        const DrawContext& drawContext = *getDrawContext();
+        const size_t objects = drawContext.opaqueSurfaces.size() + drawContext.transparentSurfaces.size();
+        const size_t capacity = drawContext.opaqueSurfaces.capacity() + drawContext.transparentSurfaces.capacity();
+        tracker.setCpuCounter("Draw context", capacity * sizeof(RenderObject), objects);
+
+        // Capacity is the shared cache's, free pools included; sets are this frame's
+        const FrameDescriptorAllocator& frameDescriptors = getCurrentFrame().frameDescriptors;
+        DescriptorPoolUsage frameDescriptorUsage = frameDescriptorPools.getUsage();
+        frameDescriptorUsage.allocatedSets = frameDescriptors.getUsage().allocatedSets;
+        tracker.setDescriptorPools("Frame descriptors", frameDescriptorUsage);
+        services::RenderingStats::Instance().descriptorSetCount = static_cast<i32>(frameDescriptorUsage.allocatedSets);
+        services::RenderingStats::Instance().descriptorPoolsCreated = static_cast<i32>(frameDescriptorPools.getStats().createdThisFrame);
+        for (u32 slot = 0; slot < FrameDescriptorAllocator::MAX_THREADS; slot++) {
+            const DescriptorPoolUsage& threadUsage = frameDescriptors.getThreadUsage(slot);
+            const u32 bit = 1u << slot;
+            if (threadUsage.pools == 0 && !(reportedDescriptorThreads & bit)) continue;
+            reportedDescriptorThreads |= bit;
+            tracker.setDescriptorPools(("Frame descriptors, thread " + std::to_string(slot)).c_str(), threadUsage);
+        }
+        tracker.setDescriptorPools("Global descriptors", context->getGlobalDescriptorAllocator()->getUsage());
+    }
+
     void Renderer::drawImGui(vk::CommandBuffer commandBuffer) {
+        // Display size and input were applied by draw(FramePacket&)
+        ImGui::SetCurrentContext(imguiContext);
         ImGui_ImplVulkan_NewFrame();
-        ImGui_ImplSDL3_NewFrame();
         ImGui::NewFrame();
 
         // Let the active scene draw its own ImGui
         if (activeScene) {
             activeScene->drawImGui();
         }
+        gpuProfiler.drawImGui();
+        context->getMemoryTracker().drawImGui();
+        services::FrameHistory::Instance().drawImGui();
+        drawPresentationImGui();
+        drawViewsImGui();
 
         ImGui::Render();
+        imguiInput.publishCursor();
         ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
     }
+
+    void Renderer::setPresentMode(vk::PresentModeKHR mode) {
+        Swapchain* swapchain = context->getSwapchain();
+        if (!swapchain || swapchain->getRequestedPresentMode() == mode) return;
+        swapchain->setPresentMode(mode);
+        resizeRequested = true;
+    }
+
+    void Renderer::drawPresentationImGui() {
+        if (ImGui::Begin("Presentation")) {
+            if (const Swapchain* swapchain = context->getSwapchain()) {
+                constexpr vk::PresentModeKHR modes[] = {
+                    vk::PresentModeKHR::eFifo, vk::PresentModeKHR::eFifoRelaxed,
+                    vk::PresentModeKHR::eMailbox, vk::PresentModeKHR::eImmediate
+                };
+                const auto& supported = swapchain->getSupportedPresentModes();
+                const vk::PresentModeKHR current = swapchain->getPresentMode();
+                if (ImGui::BeginCombo("Present mode", vk::to_string(current).c_str())) {
+                    for (const vk::PresentModeKHR mode : modes) {
+                        const bool available = std::find(supported.begin(), supported.end(), mode) != supported.end();
+                        const str label = vk::to_string(mode) + (available ? "" : " (unsupported)");
+                        if (ImGui::Selectable(label.c_str(), mode == current, available ? 0 : ImGuiSelectableFlags_Disabled)) {
+                            setPresentMode(mode);
+                        }
+                    }
+                    ImGui::EndCombo();
+                }
+            }
+
+            auto& pacer = services::FramePacer::Instance();
+            bool capped = pacer.getTargetFps() > 0.f;
+            if (ImGui::Checkbox("Frame cap", &capped)) {
+                pacer.setTargetFps(capped ? 60.f : 0.f);
+            }
+            if (capped) {
+                f32 targetFps = pacer.getTargetFps();
+                ImGui::SameLine();
+                if (ImGui::SliderFloat("FPS", &targetFps, 10.f, 360.f, "%.0f")) {
+                    pacer.setTargetFps(targetFps);
+                }
+            }
+
+            ImGui::Text("Input to present: %.2f ms (avg %.2f, max %.2f over %u frames)",
+                pacer.getLastLatency(), pacer.getAverageLatency(), pacer.getMaxLatency(),
+                services::FramePacer::LATENCY_HISTORY_SIZE);
+        }
+        ImGui::End();
+    }
+
+    void Renderer::drawViewsImGui() {
+        if (ImGui::Begin("Views")) {
+            ImGui::Text("%u views drawn, %zu opaque draws in the main one", frameViews.size(),
+                frameViews.size() ? frameViews[0].opaque.size() : 0);
+            ImGui::TextDisabled("Views share the shadow map, the culling and the post-processing");
+
+            const bool room = views.size() < FrameViews::MAX_VIEWS - 1;
+            ImGui::BeginDisabled(!room);
+            if (ImGui::Button("Add picture in picture")) {
+                const f32 offset = 0.05f + 0.3f * static_cast<f32>(views.size() % 3);
+                views.push_back(RenderView { fmt::format("View {}", views.size() + 1), mainCamera, { 0.7f, offset, 0.25f, 0.25f } });
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Split screen")) {
+                mainViewport = { 0.f, 0.f, 0.5f, 1.f };
+                views.push_back(RenderView { fmt::format("View {}", views.size() + 1), mainCamera, { 0.5f, 0.f, 0.5f, 1.f } });
+            }
+            ImGui::EndDisabled();
+            ImGui::SameLine();
+            if (ImGui::Button("Clear")) {
+                views.clear();
+                mainViewport = { 0.f, 0.f, 1.f, 1.f };
+            }
+
+            ImGui::DragFloat4("Main viewport", &mainViewport.x, 0.005f, 0.f, 1.f);
+            for (size_t i = 0; i < views.size(); i++) {
+                RenderView& view = views[i];
+                ImGui::PushID(static_cast<int>(i));
+                ImGui::Checkbox(view.name.c_str(), &view.enabled);
+                ImGui::SameLine();
+                if (ImGui::SmallButton("From main camera")) {
+                    view.camera = mainCamera;
+                }
+                ImGui::SameLine();
+                const bool removed = ImGui::SmallButton("Remove");
+                ImGui::DragFloat4("Viewport", &view.viewport.x, 0.005f, 0.f, 1.f);
+                ImGui::SliderFloat("FOV", &view.fovDegrees, 10.f, 120.f, "%.0f");
+                ImGui::PopID();
+                if (removed) {
+                    views.erase(views.begin() + static_cast<std::ptrdiff_t>(i));
+                    break;
+                }
+            }
+        }
+        ImGui::End();
+    }
 } // namespace graphics
@@ -13,20 +13,35 @@
 #include <vulkan/vulkan.hpp>
 #include <vector>
 #include <chrono>
+#include <optional>
+#include <atomic>
+#include <tuple>
+#include <array>
 
 #include "Buffer.h"
 #include "Camera.h"
 #include "ComputeEffect.h"
 #include "DeletionQueue.hpp"
 #include "DescriptorAllocatorGrowable.h"
+#include "FrameDescriptorAllocator.h"
+#include "FramePacket.h"
+#include "GpuProfiler.h"
+#include "ImGuiInput.h"
 #include "MaterialPipeline.h"
+#include "ReadbackRing.h"
 #include "RenderObject.h"
+#include "RenderView.h"
+#include "SceneLoader.h"
 #include "Utils.hpp"
 #include "VulkanLoader.h"
 #include "Pipelines/GLTFMetallicRoughness.h"
 #include "Pipelines/ShadowPipeline.h"
 #include "ShadowMap.h"
+#include "ShadowCulling.h"
+#include "SkinningPass.h"
+#include "UploadBatch.h"
 #include "Techniques/BloomTechnique.h"
+#include "Techniques/ParticleSystem.h"
 #include "Techniques/SSAOTechnique.h"
 
 class Scene;
@@ -51,7 +66,7 @@ namespace graphics {
      * - **Semaphore**: Signals when swapchain image is ready
      * - **Fence**: CPU waits on this before reusing frame resources
      * - **Deletion Queue**: Deferred cleanup for this frame's temporary resources
-     * - **Frame Descriptors**: Per-frame descriptor set allocator
+     * - **Frame Descriptors**: Per-frame descriptor set allocator, one sub-allocator per recording thread
      */
     struct FrameData {
         vk::CommandPool commandPool;              ///< Pool for allocating command buffers
@@ -59,7 +74,7 @@ namespace graphics {
         vk::Semaphore imageAvailableSemaphore;    ///< Signaled when swapchain image is acquired
         vk::Fence renderFence;                    ///< Signaled when GPU finishes this frame
         DeletionQueue deletionQueue;              ///< Deferred deletion for frame resources
-        DescriptorAllocatorGrowable frameDescriptors; ///< Per-frame descriptor allocator
+        FrameDescriptorAllocator frameDescriptors;  ///< Per-frame descriptor allocator, pools from frameDescriptorPools
     };
 
     /**
@@ -125,12 +140,22 @@ namespace graphics {
      */
     class Renderer {
     public:
+        /// First guess at the sets of each shared frame descriptor pool, then learned from usage
+        static constexpr u32 FRAME_DESCRIPTOR_POOL_SETS = 256;
+        /// Frame descriptor usage learned by a previous interactive run, see DescriptorPoolCache. Headless runs ignore it
+        static constexpr const char* DESCRIPTOR_PROFILE_PATH = "descriptor_pools.txt";
+        /// Drawn when no scene provides a draw context. Requested in init(), shared through the scene loader
+        static constexpr const char* STRUCTURE_SCENE_PATH = "assets/structure.glb";
+
         Renderer(VulkanContext* context);
         ~Renderer();
 
         /// Initializes all rendering resources (called once at startup)
         void init();
 
+        /// Creates and uploads the files requested from getSceneLoader(). After init(), before the first frame
+        void finishLoading();
+
         /// Cleans up all Vulkan resources
         void cleanup();
 
@@ -145,11 +170,40 @@ namespace graphics {
          */
         void draw();
 
+        /**
+         * @brief Renders a frame simulated on another thread (render thread only).
+         *
+         * Takes the camera, draw lists and skinning jobs from the packet instead of
+         * the renderer's own camera, draw context and skinning queue, and records
+         * into the frame in flight the packet was built for. The packet is only read.
+         */
+        void draw(FramePacket& packet);
+
+        /**
+         * @brief Reads the final image of the next draw() back, before the UI is drawn over it.
+         * @param onRead Gets the draw image's RGBA16F pixels (or converted), FRAME_OVERLAP frames
+         *               later or in finishFrames(). See ReadbackRing.
+         */
+        void readFinalImage(ReadbackCallback onRead, ReadbackConversion conversion = ReadbackConversion::None,
+                            ReadbackDelivery delivery = ReadbackDelivery::Worker);
+
+        /// Waits for every frame in flight and delivers their readbacks, worker callbacks included
+        void finishFrames();
+
+        /// Fills the camera matrices of data for the render target aspect. Safe from the simulation thread
+        void fillCameraData(const Camera& camera, GPUSceneData& data) const;
+
         /// Forwards SDL events to the camera
         void processEvent(const SDL_Event& event);
 
-        /// Uploads mesh data to GPU buffers
-        GPUMeshBuffers uploadMesh(std::span<uint32_t> indices, std::span<Vertex> vertices);
+        /// Uploads mesh data to GPU buffers. With positionStream, also uploads packed positions for depth-only passes
+        GPUMeshBuffers uploadMesh(std::span<uint32_t> indices, std::span<Vertex> vertices, bool positionStream = true, const char* name = nullptr);
+        /// Same, the copies staged in batch: the buffers are filled when it flushes
+        GPUMeshBuffers uploadMesh(UploadBatch& batch, std::span<uint32_t> indices, std::span<Vertex> vertices, bool positionStream = true, const char* name = nullptr);
+
+        /// Uploads per-vertex joints/weights for the skinning compute pass
+        Buffer uploadSkinData(std::span<SkinVertex> skinVertices, const char* name = nullptr);
+        Buffer uploadSkinData(UploadBatch& batch, std::span<SkinVertex> skinVertices, const char* name = nullptr);
 
         // =====================================================================
         // Accessors
@@ -161,6 +215,13 @@ namespace graphics {
         ShadowMap* getShadowMap() { return shadowMap.get(); }
         Buffer& getSceneDataBuffer() { return sceneDataBuffer; }
         const Buffer& getSceneDataBuffer() const { return sceneDataBuffer; }
+        SkinningPass& getSkinningPass() { return skinning; }
+        SceneLoader& getSceneLoader() { return sceneLoader; }
+        /// Its platform side belongs to the main thread, see ImGuiInput
+        ImGuiInput& getImGuiInput() { return imguiInput; }
+
+        /// Index of the frame in flight the next draw() will record into
+        u32 getFrameIndex() const { return frameNumber % FRAME_OVERLAP; }
 
         // =====================================================================
         // External Scene Integration
@@ -174,9 +235,13 @@ namespace graphics {
         void setRenderingTechnique(techniques::IRenderingTechnique* technique) { externalRenderingTechnique = technique; }
         techniques::IRenderingTechnique* getRenderingTechnique() const { return externalRenderingTechnique; }
 
-        DescriptorAllocatorGrowable& getCurrentFrameDescriptors() { return getCurrentFrame().frameDescriptors; }
+        /// The calling thread's descriptor allocator for the current frame
+        DescriptorAllocatorGrowable& getCurrentFrameDescriptors() { return getCurrentFrame().frameDescriptors.local(); }
         GPUSceneData& getSceneData() { return sceneData; }
 
+        /// Replaces the scene data computed from the camera and light (frame replay). nullopt to stop
+        void setSceneDataOverride(const std::optional<GPUSceneData>& data) { sceneDataOverride = data; }
+
         /// Sets the active scene for ImGui rendering
         void setActiveScene(::Scene* scene) { activeScene = scene; }
         ::Scene* getActiveScene() const { return activeScene; }
@@ -185,14 +250,45 @@ namespace graphics {
         // Rendering Configuration
         // =====================================================================
 
+        /// Recreates the swapchain with this present mode before the next frame (falls back if unsupported)
+        void setPresentMode(vk::PresentModeKHR mode);
+
         void setAnimateLight(bool animate) { animateLight = animate; }
         bool isAnimatingLight() const { return animateLight; }
+        /// Only sticks while the light is not animated
+        void setLightPosition(const Vec3& position) { lightPos = position; }
+        const Vec3& getLightPosition() const { return lightPos; }
+
+        /// Skip shadow casters whose shadow cannot reach any view
+        void setShadowCasterCulling(bool enable) { shadowCasterCulling = enable; }
+        bool isShadowCasterCullingEnabled() const { return shadowCasterCulling; }
+        /// Crop the light projection to visible receivers and their casters. Main view only: skipped with several views
+        void setShadowProjectionFitting(bool enable) { shadowProjectionFitting = enable; }
+        bool isShadowProjectionFittingEnabled() const { return shadowProjectionFitting; }
+        /// One per view of the frame being recorded, in the same order
+        std::span<const ShadowCasterVolume> getShadowCasterVolumes() const { return { shadowCasterVolumes.data(), frameViews.size() }; }
 
         Image& getSceneImage() { return sceneImage; }
         techniques::BloomParams& getBloomParams() { return bloom.getParams(); }
         const techniques::BloomParams& getBloomParams() const { return bloom.getParams(); }
         techniques::SSAOParams& getSSAOParams() { return ssao.getParams(); }
         const techniques::SSAOParams& getSSAOParams() const { return ssao.getParams(); }
+        techniques::ParticleSystem& getParticleSystem() { return particles; }
+        GpuProfiler& getGpuProfiler() { return gpuProfiler; }
+        /// Copies to the CPU from the frame being recorded (render thread, while recording)
+        ReadbackRing& getReadback() { return readback; }
+
+        // =====================================================================
+        // Views
+        // =====================================================================
+
+        /// Views drawn besides the main camera, in the order they are drawn. Render thread
+        vector<RenderView>& getViews() { return views; }
+        /// Part of the scene image the main camera is drawn in: x, y, width, height as fractions
+        void setMainViewport(const Vec4& viewport) { mainViewport = viewport; }
+        const Vec4& getMainViewport() const { return mainViewport; }
+        /// Views of the frame being recorded, culled and sorted. View 0 is the main camera
+        const FrameViews& getFrameViews() const { return frameViews; }
 
         // =====================================================================
         // Default Resources (available for materials)
@@ -219,20 +315,44 @@ namespace graphics {
         void createMeshPipeline();
         void createSceneData();
         void createPostProcessResources();
+        void createSceneTargets(vk::Extent3D extent);
+        void createRenderFinishedSemaphores();
+
+        // =====================================================================
+        // Resizing
+        // =====================================================================
+        /**
+         * Recreates the swapchain and the window sized render targets without waiting on
+         * the device: what frames in flight may still use goes to the deletion queue of the
+         * last submitted frame. Returns false when there is nothing to present to.
+         */
+        bool recreateSwapchain();
+        /// Reallocates the draw, depth, scene, SSAO and bloom targets if the window size changed
+        void resizeRenderTargets(DeletionQueue& retired);
+        /// Output extent divided by renderScale
+        vk::Extent3D getRenderTargetExtent() const;
 
         // =====================================================================
         // Rendering Methods
         // =====================================================================
         void initImGui();
         void drawImGui(vk::CommandBuffer commandBuffer);
-        void drawBackground(vk::CommandBuffer, const vk::DescriptorSet* targetDescriptors = nullptr, const Image* targetImage = nullptr);
+        /// Present mode, frame cap and input latency
+        void drawPresentationImGui();
+        /// Picture in picture and split screen views
+        void drawViewsImGui();
+        void drawBackground(vk::CommandBuffer, const Image* targetImage = nullptr);
         void drawGeometry(vk::CommandBuffer);
         void drawShadowPass(vk::CommandBuffer);
         void drawShadowGeometry(vk::CommandBuffer, vk::DescriptorSet sceneDescriptor);
         void drawShadowDebug(vk::CommandBuffer, vk::DescriptorSet sceneDescriptor);
         void updateLightMatrices();
         void updateScene();
+        /// Fills frameViews and the caster volumes from the main camera and the enabled views
+        void updateViews();
         void applyPostProcess(vk::CommandBuffer cmd);
+        /// Reports draw lists and descriptor pools to the context's MemoryTracker
+        void updateMemoryCounters();
 
         float getMinRenderScale() const;
 
@@ -241,19 +361,20 @@ namespace graphics {
         // =====================================================================
         VulkanContext* context;         ///< Vulkan context (device, queues, etc.)
         bool resizeRequested {false};   ///< Flag for swapchain recreation
+        vk::Extent2D windowExtent {};   ///< Window size in pixels, from the last frame packet
         float renderScale { 0.5f };     ///< Resolution scale factor
         int frameNumber {0};            ///< Current frame counter
+        u32 lastSubmittedFrame {0};     ///< Frame slot of the last submit: its fence covers every earlier frame
+        std::atomic<f32> renderTargetAspect {16.f / 9.f};  ///< Read by the simulation thread for its projection
 
         // =====================================================================
         // Frame Synchronization
         // =====================================================================
-        /**
-         * FRAME_OVERLAP determines how many frames can be "in flight" simultaneously.
-         * With 2, CPU can prepare frame N+1 while GPU renders frame N.
-         * This hides latency and improves throughput.
-         */
-        static const int FRAME_OVERLAP = 2;
-        FrameData frames[FRAME_OVERLAP];
+        DescriptorPoolCache frameDescriptorPools;   ///< Shared by every frame and thread, outlives the frames
+        /// Recorded at the end of the next frame, see readFinalImage()
+        vector<std::tuple<ReadbackCallback, ReadbackConversion, ReadbackDelivery>> finalImageReads;
+        u32 reportedDescriptorThreads {0};          ///< Thread slots with a memory tracker counter
+        FrameData frames[FRAME_OVERLAP];  ///< See FRAME_OVERLAP in Types.h
         FrameData& getCurrentFrame() { return frames[frameNumber % FRAME_OVERLAP]; };
 
         /// One semaphore per swapchain image for proper synchronization
@@ -262,9 +383,7 @@ namespace graphics {
         // =====================================================================
         // Descriptor Sets
         // =====================================================================
-        vk::DescriptorSetLayout drawImageDescriptorLayout;
-        vk::DescriptorSet drawImageDescriptors;
-        vk::DescriptorSet sceneImageDescriptors;  // For background compute on sceneImage
+        vk::DescriptorSetLayout drawImageDescriptorLayout;  ///< Storage image for background compute, sets are per frame
 
         // =====================================================================
         // Immediate Submission (for uploads)
@@ -290,7 +409,9 @@ namespace graphics {
         GPUMeshBuffers rectangleMesh;
         vector<sptr<MeshAsset>> testMeshes;
         GPUSceneData sceneData;                           ///< Camera matrices, lighting
-        Buffer sceneDataBuffer;                           ///< GPU buffer for scene data
+        std::optional<GPUSceneData> sceneDataOverride;    ///< Used instead of sceneData when set
+        Buffer sceneDataBuffer;                           ///< GPU buffer for scene data, one slot per view
+        vk::DeviceSize sceneDataStride { sizeof(GPUSceneData) };   ///< Between slots, uniform offset aligned
         vk::DescriptorSetLayout gpuSceneDataDescriptorLayout;
         vk::DescriptorSetLayout shadowSceneDataDescriptorLayout;
         vk::DescriptorSetLayout singleImageDescriptorLayout;
@@ -306,6 +427,10 @@ namespace graphics {
         Vec3 lightPos { 40.0f, 50.0f, 25.0f };  // Above scene (Y inverted from VulkanDemo)
         float lightFOV { 45.0f };
         float lightAngle { 0.0f };
+        /// Frustum of each view extruded towards the light, rebuilt each frame
+        std::array<ShadowCasterVolume, FrameViews::MAX_VIEWS> shadowCasterVolumes;
+        bool shadowCasterCulling { true };
+        bool shadowProjectionFitting { false };
 
         // =====================================================================
         // Materials
@@ -319,7 +444,16 @@ namespace graphics {
         DrawContext mainDrawContext;
         std::unordered_map<std::string, sptr<Node>> loadedNodes;
         std::unordered_map<std::string, std::shared_ptr<LoadedGLTF>> loadedScenes;
+        SceneLoader sceneLoader;                          ///< Startup files, by path. Shares them with the engine
         DrawContext* externalDrawContext { nullptr };
+        const FramePacket* currentPacket { nullptr };   ///< Set while draw(FramePacket&) runs
+
+        // =====================================================================
+        // Views
+        // =====================================================================
+        vector<RenderView> views;               ///< Besides the main camera
+        Vec4 mainViewport { 0.f, 0.f, 1.f, 1.f };
+        FrameViews frameViews;                  ///< Built in updateScene(), read while recording
 
         // =====================================================================
         // Rendering Technique
@@ -338,10 +472,17 @@ namespace graphics {
         // ImGui
         // =====================================================================
         vk::DescriptorPool imguiDescriptorPool;
+        ImGuiContext* imguiContext { nullptr };    ///< The UI's, current on the thread that draws
+        ImGuiInput imguiInput;                     ///< Input from the main thread's SDL3 backend
         float rotationSpeed = 1.0f;
         float accumulatedRotation = 0.0f;
         std::chrono::high_resolution_clock::time_point lastFrameTime;
 
+        // =====================================================================
+        // Skinning
+        // =====================================================================
+        SkinningPass skinning;      ///< Compute pre-skinning, recorded before the scene passes
+
         // =====================================================================
         // Post-Processing
         // =====================================================================
@@ -349,6 +490,13 @@ namespace graphics {
         Image ssaoOutputImage;      ///< Output after SSAO (before bloom)
         techniques::BloomTechnique bloom;
         techniques::SSAOTechnique ssao;
+        techniques::ParticleSystem particles;   ///< GPU particles, drawn over the scene before post-processing
+
+        // =====================================================================
+        // Profiling
+        // =====================================================================
+        GpuProfiler gpuProfiler;    ///< Timestamp queries around each pass, read back FRAME_OVERLAP frames later
+        ReadbackRing readback;      ///< GPU to CPU copies, delivered FRAME_OVERLAP frames later
     };
 
 } // namespace graphics
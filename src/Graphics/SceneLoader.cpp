@@ -0,0 +1,170 @@
+/**
+ * @file SceneLoader.cpp
+ * @brief Implementation of the parallel startup loading of scenes.
+ */
+
+#include "SceneLoader.h"
+
+#include "LoadedGLTF.h"
+#include "Renderer.h"
+#include "UploadBatch.h"
+#include "../BasicServices/Log.h"
+#include "../BasicServices/Platform.h"
+#include "../BasicServices/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
+
+using services::Log;
+
+namespace graphics {
+
+    void SceneLoader::init(Renderer* renderer) {
+        this->renderer = renderer;
+    }
+
+    void SceneLoader::cleanup() {
+        // Workers of files never finished still write to their entries
+        for (auto& [path, entry] : gltfs) {
+            if (entry.parsing.valid()) entry.parsing.wait();
+        }
+        for (auto& [path, entry] : ktxs) {
+            if (entry.reading.valid()) entry.reading.wait();
+            if (entry.image.has_value()) entry.image->destroy(renderer->getContext());
+        }
+        gltfs.clear();
+        ktxs.clear();
+        pending.clear();
+        duplicateRequests = 0;
+    }
+
+    void SceneLoader::requestGltf(const str& path) {
+        auto [it, inserted] = gltfs.try_emplace(path);
+        if (!inserted) {
+            duplicateRequests++;
+            return;
+        }
+
+        it->second.parsing = std::async(std::launch::async, [path] {
+            services::Platform::pinToWorkerCpus();
+            return parseGltf(path);
+        });
+        pending.push_back({ path, false });
+    }
+
+    void SceneLoader::requestKtx(const str& path) {
+        auto [it, inserted] = ktxs.try_emplace(path);
+        if (!inserted) {
+            duplicateRequests++;
+            return;
+        }
+
+        // Map nodes do not move: the worker can write to its entry
+        KtxEntry* entry = &it->second;
+        entry->reading = std::async(std::launch::async, [path, entry] {
+            services::Platform::pinToWorkerCpus();
+            const u64 start = services::Profiler::now();
+            std::optional<KTXLoadResult> result = loadKTXFile(path);
+            entry->readMs = services::Profiler::toMilliseconds(services::Profiler::now() - start);
+            return result;
+        });
+        pending.push_back({ path, true });
+    }
+
+    bool SceneLoader::isReady(const Pending& file) const {
+        const auto ready = [](const auto& future) {
+            return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        };
+        return file.ktx ? ready(ktxs.at(file.path).reading) : ready(gltfs.at(file.path).parsing);
+    }
+
+    void SceneLoader::finish() {
+        if (pending.empty()) return;
+        PROFILE_FUNCTION();
+        const u64 start = services::Profiler::now();
+
+        UploadBatch batch { renderer->getContext(), *renderer->getImmediateSubmitter() };
+        Timings timings;
+        const u32 files = static_cast<u32>(pending.size());
+        const u32 steps = files + 1;    // Last step: the upload
+        u32 done = 0;
+
+        // In completion order: a file's GPU phase runs while the others are still parsing
+        while (!pending.empty()) {
+            auto ready = std::find_if(pending.begin(), pending.end(), [this](const Pending& p) { return isReady(p); });
+            if (ready == pending.end()) {
+                PROFILE_ZONE("Wait Scene Workers");
+                const u64 waitStart = services::Profiler::now();
+                const Pending& first = pending.front();
+                if (first.ktx) ktxs.at(first.path).reading.wait_for(std::chrono::milliseconds(2));
+                else gltfs.at(first.path).parsing.wait_for(std::chrono::milliseconds(2));
+                timings.wait += services::Profiler::toMilliseconds(services::Profiler::now() - waitStart);
+                continue;
+            }
+
+            const Pending file = *ready;
+            pending.erase(ready);
+            create(file, batch, timings);
+            logProgress(++done, steps, file.path);
+        }
+
+        const f64 stagedMb = static_cast<f64>(batch.getStats().bytes) / (1024.0 * 1024.0);
+        batch.flush();
+        logProgress(++done, steps, fmt::format("upload ({:.1f} MB)", stagedMb));
+
+        const UploadBatch::Stats& upload = batch.getStats();
+        Log::Info("Scene loading: %u files in %.1f ms, %u duplicate requests served from the cache",
+            files, services::Profiler::toMilliseconds(services::Profiler::now() - start), duplicateRequests);
+        Log::Info("  read + parse   %8.1f ms  (summed over workers)", timings.parse);
+        Log::Info("  image decode   %8.1f ms  (summed over workers)", timings.decode);
+        Log::Info("  geometry       %8.1f ms  (summed over workers)", timings.geometry);
+        Log::Info("  waiting        %8.1f ms  (main thread idle)", timings.wait);
+        Log::Info("  gpu resources  %8.1f ms  (images, buffers, materials, nodes)", timings.create);
+        Log::Info("  upload         %8.1f ms  (%u buffer and %u image copies, %u submits)",
+            upload.submitMs, upload.bufferCopies, upload.imageCopies, upload.submits);
+        duplicateRequests = 0;
+    }
+
+    void SceneLoader::create(const Pending& file, UploadBatch& batch, Timings& timings) {
+        if (file.ktx) {
+            KtxEntry& entry = ktxs.at(file.path);
+            std::optional<KTXLoadResult> ktx = entry.reading.get();
+            timings.parse += entry.readMs;
+            if (!ktx.has_value()) return;
+
+            const u64 start = services::Profiler::now();
+            entry.image = createKTXImage(renderer->getContext(), *ktx, file.path, batch);
+            timings.create += services::Profiler::toMilliseconds(services::Profiler::now() - start);
+            return;
+        }
+
+        GltfEntry& entry = gltfs.at(file.path);
+        std::optional<GltfData> data = entry.parsing.get();
+        if (!data.has_value()) return;
+        timings.parse += data->parseMs;
+        timings.decode += data->decodeMs;
+        timings.geometry += data->geometryMs;
+
+        const u64 start = services::Profiler::now();
+        entry.scene = createGltf(renderer, *data, batch);
+        timings.create += services::Profiler::toMilliseconds(services::Profiler::now() - start);
+    }
+
+    sptr<LoadedGLTF> SceneLoader::getGltf(const str& path) const {
+        const auto it = gltfs.find(path);
+        return it != gltfs.end() ? it->second.scene : nullptr;
+    }
+
+    std::optional<Image> SceneLoader::getKtx(const str& path) const {
+        const auto it = ktxs.find(path);
+        return it != ktxs.end() ? it->second.image : std::nullopt;
+    }
+
+    void SceneLoader::logProgress(u32 done, u32 total, const str& step) {
+        constexpr u32 BAR_WIDTH = 24;
+        const u32 filled = total > 0 ? done * BAR_WIDTH / total : BAR_WIDTH;
+        const str bar = str(filled, '#') + str(BAR_WIDTH - filled, '-');
+        Log::Info("Loading [%s] %u/%u %s", bar.c_str(), done, total, step.c_str());
+    }
+
+} // namespace graphics
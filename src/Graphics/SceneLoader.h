@@ -0,0 +1,116 @@
+/**
+ * @file SceneLoader.h
+ * @brief Startup loading of glTF scenes and KTX textures, parsed on workers, uploaded in one batch.
+ */
+
+#pragma once
+
+#include "Image.h"
+#include "KTXLoader.h"
+#include "Types.h"
+#include "VulkanLoader.h"
+#include <future>
+#include <optional>
+#include <unordered_map>
+
+namespace graphics {
+    class Renderer;
+    class LoadedGLTF;
+    class UploadBatch;
+
+    /**
+     * @class SceneLoader
+     * @brief Path keyed cache of the files a renderer loads, read in parallel.
+     *
+     * ## Why?
+     * Loading a glTF file one after the other on the main thread leaves every other
+     * core idle: reading, parsing, decoding PNG and JPEG images and building vertices
+     * are CPU work that does not need the GPU. Then each mesh and image waits for
+     * its own upload. Cold start is the sum of all of it.
+     *
+     * ## How it works
+     * Loading is split in two phases:
+     * - request*() start the CPU phase at once on a worker thread: parseGltf()
+     *   decodes the images of its file on more workers while it builds the meshes,
+     *   loadKTXFile() reads the mip chain. Asking twice for the same path starts nothing:
+     *   both get the same model
+     * - finish() runs the GPU phase on the calling thread, each file as soon as its
+     *   worker is done: images, buffers, materials and scene graph are created while the
+     *   other files are still parsing. Every copy goes into one UploadBatch, flushed last
+     *
+     * Requests can be made long before finish(), so that parsing overlaps the rest of
+     * the startup (pipeline creation). finish() logs a progress bar and the time spent
+     * in each phase.
+     *
+     * Vulkan objects are only created in finish(), on the thread that owns the
+     * renderer's immediate submitter: descriptor pools and the submitter are not
+     * thread safe.
+     *
+     * ## Ownership
+     * The loader keeps every model and texture until cleanup(). Models are shared;
+     * textures are handed out as copies of the handles, which must not be destroyed.
+     */
+    class SceneLoader {
+    public:
+        SceneLoader() = default;
+
+        SceneLoader(const SceneLoader&) = delete;
+        SceneLoader& operator=(const SceneLoader&) = delete;
+
+        void init(Renderer* renderer);
+        /// Waits for the workers, then frees every model and texture. The GPU must be idle
+        void cleanup();
+
+        /// Starts parsing a glTF file on a worker, unless the path was requested before
+        void requestGltf(const str& path);
+        /// Starts reading a KTX file on a worker, unless the path was requested before
+        void requestKtx(const str& path);
+
+        /// Creates the GPU resources of every requested file and uploads them. Blocks until done
+        void finish();
+
+        /// nullptr while not finished, or if loading failed
+        sptr<LoadedGLTF> getGltf(const str& path) const;
+        /// Owned by the loader. std::nullopt while not finished, or if loading failed
+        std::optional<Image> getKtx(const str& path) const;
+
+    private:
+        struct GltfEntry {
+            std::future<std::optional<GltfData>> parsing;
+            sptr<LoadedGLTF> scene;
+        };
+
+        struct KtxEntry {
+            std::future<std::optional<KTXLoadResult>> reading;
+            f32 readMs { 0.f };             ///< Written by the worker, read once reading is ready
+            std::optional<Image> image;
+        };
+
+        /// A file whose CPU phase is running
+        struct Pending {
+            str path;
+            bool ktx { false };
+        };
+
+        /// Time spent in each phase by the current finish(), in milliseconds
+        struct Timings {
+            f32 parse { 0.f };              ///< Reading files and parsing glTF, summed over workers
+            f32 decode { 0.f };             ///< Image decoding, summed over workers
+            f32 geometry { 0.f };           ///< Building vertices and indices, summed over workers
+            f32 wait { 0.f };               ///< Calling thread idle, waiting for workers
+            f32 create { 0.f };             ///< Images, buffers, materials and scene graphs
+        };
+
+        bool isReady(const Pending& file) const;
+        /// GPU phase of a file whose CPU phase is done
+        void create(const Pending& file, UploadBatch& batch, Timings& timings);
+        static void logProgress(u32 done, u32 total, const str& step);
+
+        Renderer* renderer { nullptr };
+        std::unordered_map<str, GltfEntry> gltfs;
+        std::unordered_map<str, KtxEntry> ktxs;
+        vector<Pending> pending;
+        u32 duplicateRequests { 0 };        ///< Since the last finish()
+    };
+
+} // namespace graphics
@@ -0,0 +1,240 @@
+/**
+ * @file ShadowCulling.cpp
+ * @brief Implementation of shadow caster culling and projection fitting.
+ */
+
+#include "ShadowCulling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace graphics {
+
+    namespace {
+        constexpr f32 EPSILON = 1e-6f;
+
+        // Frustum corner i has x = bit 0, y = bit 1, z = bit 2 (0 = min, 1 = max in NDC)
+        std::array<Vec3, 8> frustumCorners(const Mat4& viewProj) {
+            const Mat4 inverse = glm::inverse(viewProj);
+            std::array<Vec3, 8> corners {};
+            for (u32 i = 0; i < 8; i++) {
+                const Vec4 ndc { (i & 1) ? 1.f : -1.f, (i & 2) ? 1.f : -1.f, (i & 4) ? 1.f : 0.f, 1.f };
+                const Vec4 world = inverse * ndc;
+                corners[i] = Vec3(world) / world.w;
+            }
+            return corners;
+        }
+
+        /// Projects the object's bounding box corners. Returns false if a corner is behind the projection plane.
+        bool projectBounds(const RenderObject& object, const Mat4& viewProj, Vec3& outMin, Vec3& outMax) {
+            const Mat4 matrix = viewProj * object.transform;
+            outMin = Vec3(std::numeric_limits<f32>::max());
+            outMax = Vec3(std::numeric_limits<f32>::lowest());
+
+            for (u32 c = 0; c < 8; c++) {
+                const Vec3 corner { (c & 1) ? 1.f : -1.f, (c & 2) ? 1.f : -1.f, (c & 4) ? 1.f : -1.f };
+                const Vec4 v = matrix * Vec4(object.bounds.origin + corner * object.bounds.extents, 1.f);
+                if (v.w <= EPSILON) {
+                    return false;
+                }
+                const Vec3 ndc = Vec3(v) / v.w;
+                outMin = glm::min(outMin, ndc);
+                outMax = glm::max(outMax, ndc);
+            }
+            return true;
+        }
+
+        bool overlapsClipVolume(const Vec3& min, const Vec3& max) {
+            return !(min.x > 1.f || max.x < -1.f || min.y > 1.f || max.y < -1.f || min.z > 1.f || max.z < 0.f);
+        }
+    }
+
+    // =========================================================================
+    // Caster Volume
+    // =========================================================================
+
+    ShadowCasterVolume ShadowCasterVolume::fromPointLight(const Mat4& cameraViewProj, const Vec3& lightPosition) {
+        ShadowCasterVolume volume;
+        volume.build(cameraViewProj, Vec4(lightPosition, 1.f));
+        return volume;
+    }
+
+    ShadowCasterVolume ShadowCasterVolume::fromDirectionalLight(const Mat4& cameraViewProj, const Vec3& lightDirection) {
+        // Casters lie upstream of the receivers, so extrude towards -direction
+        ShadowCasterVolume volume;
+        volume.build(cameraViewProj, Vec4(-glm::normalize(lightDirection), 0.f));
+        return volume;
+    }
+
+    void ShadowCasterVolume::build(const Mat4& cameraViewProj, const Vec4& light) {
+        planeCount = 0;
+
+        const std::array<Vec3, 8> corners = frustumCorners(cameraViewProj);
+        Vec3 centroid { 0.f };
+        for (const Vec3& corner : corners) {
+            centroid += corner;
+        }
+        centroid /= 8.f;
+
+        // Face f = 2 * axis + side holds the 4 corners whose bit 'axis' equals 'side'.
+        // A face is kept when the light is on its inner side (homogeneous light:
+        // a point has w = 1, a direction w = 0, the same dot product covers both).
+        std::array<Vec4, 6> facePlanes {};
+        std::array<bool, 6> kept {};
+        for (u32 axis = 0; axis < 3; axis++) {
+            for (u32 side = 0; side < 2; side++) {
+                std::array<Vec3, 4> face {};
+                u32 count = 0;
+                for (u32 i = 0; i < 8; i++) {
+                    if (((i >> axis) & 1) == side) face[count++] = corners[i];
+                }
+
+                Vec3 normal = glm::normalize(glm::cross(face[1] - face[0], face[2] - face[0]));
+                f32 distance = -glm::dot(normal, face[0]);
+                if (glm::dot(normal, centroid) + distance < 0.f) {
+                    normal = -normal;
+                    distance = -distance;
+                }
+
+                const u32 f = axis * 2 + side;
+                facePlanes[f] = Vec4(normal, distance);
+                kept[f] = glm::dot(normal, Vec3(light)) + distance * light.w >= -EPSILON;
+                if (kept[f]) {
+                    planes[planeCount++] = facePlanes[f];
+                }
+            }
+        }
+
+        // Silhouette edges: one adjacent face kept, the other dropped.
+        // The hull closes there with a plane through the edge and the light.
+        for (u32 a = 0; a < 8; a++) {
+            for (u32 axis = 0; axis < 3; axis++) {
+                const u32 b = a | (1u << axis);
+                if (b == a) continue;  // Visit each edge once, from its lower corner
+
+                const u32 axis1 = (axis + 1) % 3;
+                const u32 axis2 = (axis + 2) % 3;
+                const u32 face1 = axis1 * 2 + ((a >> axis1) & 1);
+                const u32 face2 = axis2 * 2 + ((a >> axis2) & 1);
+                if (kept[face1] == kept[face2]) continue;
+
+                const Vec3 edge = corners[b] - corners[a];
+                const Vec3 towardsLight = light.w > 0.f ? Vec3(light) - corners[a] : Vec3(light);
+                const Vec3 normal = glm::cross(edge, towardsLight);
+                if (glm::length(normal) < EPSILON) continue;
+
+                addPlane(normal, corners[a], centroid);
+            }
+        }
+    }
+
+    void ShadowCasterVolume::addPlane(const Vec3& normal, const Vec3& pointOnPlane, const Vec3& insidePoint) {
+        if (planeCount >= MAX_PLANES) return;
+
+        Vec3 n = glm::normalize(normal);
+        f32 distance = -glm::dot(n, pointOnPlane);
+        if (glm::dot(n, insidePoint) + distance < 0.f) {
+            n = -n;
+            distance = -distance;
+        }
+        planes[planeCount++] = Vec4(n, distance);
+    }
+
+    bool ShadowCasterVolume::intersects(const RenderObject& object) const {
+        // World-space AABB of the transformed local box
+        const Mat4& m = object.transform;
+        const Vec3 center = Vec3(m * Vec4(object.bounds.origin, 1.f));
+        const Vec3 e = object.bounds.extents;
+        const Vec3 extents {
+            std::abs(m[0][0]) * e.x + std::abs(m[1][0]) * e.y + std::abs(m[2][0]) * e.z,
+            std::abs(m[0][1]) * e.x + std::abs(m[1][1]) * e.y + std::abs(m[2][1]) * e.z,
+            std::abs(m[0][2]) * e.x + std::abs(m[1][2]) * e.y + std::abs(m[2][2]) * e.z
+        };
+
+        for (u32 i = 0; i < planeCount; i++) {
+            const Vec3 normal = Vec3(planes[i]);
+            const f32 distance = glm::dot(normal, center) + planes[i].w;
+            const f32 radius = glm::dot(glm::abs(normal), extents);
+            if (distance + radius < 0.f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool castsVisibleShadow(std::span<const ShadowCasterVolume> volumes, const RenderObject& object) {
+        return std::ranges::any_of(volumes, [&](const ShadowCasterVolume& volume) { return volume.intersects(object); });
+    }
+
+    // =========================================================================
+    // Projection Fitting
+    // =========================================================================
+
+    Mat4 fitShadowProjection(const Mat4& lightViewProj, const Mat4& cameraViewProj,
+                             const ShadowCasterVolume& casterVolume, std::span<const RenderObject> objects) {
+        Vec3 casterMin { std::numeric_limits<f32>::max() };
+        Vec3 casterMax { std::numeric_limits<f32>::lowest() };
+        Vec3 receiverMin = casterMin;
+        Vec3 receiverMax = casterMax;
+        bool hasCaster = false;
+        bool hasReceiver = false;
+
+        for (const RenderObject& object : objects) {
+            Vec3 cameraMin, cameraMax;
+            const bool receiver = projectBounds(object, cameraViewProj, cameraMin, cameraMax)
+                                ? overlapsClipVolume(cameraMin, cameraMax)
+                                : true;  // Crosses the camera plane: conservatively visible
+            const bool caster = casterVolume.intersects(object);
+            if (!receiver && !caster) continue;
+
+            Vec3 lightMin, lightMax;
+            if (!projectBounds(object, lightViewProj, lightMin, lightMax)) {
+                // Crosses the light plane, cropping could cut it: keep the full projection
+                return lightViewProj;
+            }
+            if (!overlapsClipVolume(lightMin, lightMax)) continue;
+
+            if (caster) {
+                casterMin = glm::min(casterMin, lightMin);
+                casterMax = glm::max(casterMax, lightMax);
+                hasCaster = true;
+            }
+            if (receiver) {
+                receiverMin = glm::min(receiverMin, lightMin);
+                receiverMax = glm::max(receiverMax, lightMax);
+                hasReceiver = true;
+            }
+        }
+
+        if (!hasCaster || !hasReceiver) {
+            return lightViewProj;
+        }
+
+        // XY: only where shadows are both cast and received. Z: nearest caster to farthest receiver.
+        const f32 minX = std::max({ casterMin.x, receiverMin.x, -1.f });
+        const f32 maxX = std::min({ casterMax.x, receiverMax.x, 1.f });
+        const f32 minY = std::max({ casterMin.y, receiverMin.y, -1.f });
+        const f32 maxY = std::min({ casterMax.y, receiverMax.y, 1.f });
+        const f32 minZ = std::max(casterMin.z, 0.f);
+        const f32 maxZ = std::min(receiverMax.z, 1.f);
+
+        constexpr f32 MIN_EXTENT = 1e-3f;
+        if (maxX - minX < MIN_EXTENT || maxY - minY < MIN_EXTENT || maxZ - minZ < MIN_EXTENT) {
+            return lightViewProj;
+        }
+
+        // Crop matrix: remaps the fitted NDC box to [-1, 1] x [-1, 1] x [0, 1].
+        // Offsets go in the w column so it applies before the perspective divide.
+        Mat4 crop { 1.f };
+        crop[0][0] = 2.f / (maxX - minX);
+        crop[1][1] = 2.f / (maxY - minY);
+        crop[2][2] = 1.f / (maxZ - minZ);
+        crop[3][0] = -(maxX + minX) / (maxX - minX);
+        crop[3][1] = -(maxY + minY) / (maxY - minY);
+        crop[3][2] = -minZ / (maxZ - minZ);
+
+        return crop * lightViewProj;
+    }
+
+} // namespace graphics
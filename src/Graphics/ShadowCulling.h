@@ -0,0 +1,78 @@
+/**
+ * @file ShadowCulling.h
+ * @brief Shadow caster culling and shadow projection fitting.
+ */
+
+#pragma once
+
+#include "Types.h"
+#include "RenderObject.h"
+#include <array>
+#include <span>
+
+namespace graphics {
+
+    /**
+     * @class ShadowCasterVolume
+     * @brief Convex volume containing every object that can cast a visible shadow.
+     *
+     * ## Why not just cull against the light frustum?
+     * The light frustum contains everything the light reaches, including objects
+     * far outside the camera view whose shadows land where nobody looks.
+     * A caster matters only if its shadow can fall on something inside the camera
+     * frustum, i.e. if it lies between the light and the camera frustum.
+     *
+     * ## Building the volume
+     * It is the convex hull of the camera frustum extruded towards the light:
+     * - for a point/spot light, the hull of the 8 frustum corners and the light position
+     * - for a directional light, the frustum swept to infinity against the light direction
+     *
+     * The hull keeps the frustum planes the light does not see (the light is on
+     * their inner side), and adds one plane per silhouette edge, i.e. an edge
+     * between a kept plane and a dropped one, containing the edge and the light.
+     *
+     * Objects are tested with their world-space AABB against at most 6 + 12 planes.
+     */
+    class ShadowCasterVolume {
+    public:
+        static constexpr u32 MAX_PLANES = 6 + 12;  ///< Frustum planes + one per frustum edge
+
+        /// Camera frustum extruded towards a point or spot light
+        static ShadowCasterVolume fromPointLight(const Mat4& cameraViewProj, const Vec3& lightPosition);
+
+        /// Camera frustum extruded against a directional light (direction the light travels)
+        static ShadowCasterVolume fromDirectionalLight(const Mat4& cameraViewProj, const Vec3& lightDirection);
+
+        /// True if the object's bounds may intersect the volume (conservative)
+        bool intersects(const RenderObject& object) const;
+
+        u32 getPlaneCount() const { return planeCount; }
+
+    private:
+        void build(const Mat4& cameraViewProj, const Vec4& light);
+        void addPlane(const Vec3& normal, const Vec3& pointOnPlane, const Vec3& insidePoint);
+
+        std::array<Vec4, MAX_PLANES> planes {};  ///< xyz = inward normal, w = distance (inside when dot >= 0)
+        u32 planeCount { 0 };
+    };
+
+    /// True if the object may cast a shadow into one of the volumes, one per view
+    bool castsVisibleShadow(std::span<const ShadowCasterVolume> volumes, const RenderObject& object);
+
+    /**
+     * @brief Tightens a light view-projection around casters that shadow visible receivers.
+     *
+     * Receivers are the objects inside the camera frustum, casters the objects inside
+     * the caster volume and the light frustum. Their bounds are projected in light
+     * clip space; the light projection is then cropped to the overlap of both boxes
+     * in XY, and from the nearest caster to the farthest receiver in depth.
+     * Shadow map texels end up covering only what is actually seen, which sharpens
+     * shadows when the camera looks at a small part of the light frustum.
+     *
+     * @return The cropped matrix, or lightViewProj unchanged if nothing can be fitted
+     *         (no caster or receiver, or bounds crossing the light plane).
+     */
+    Mat4 fitShadowProjection(const Mat4& lightViewProj, const Mat4& cameraViewProj,
+                             const ShadowCasterVolume& casterVolume, std::span<const RenderObject> objects);
+
+} // namespace graphics
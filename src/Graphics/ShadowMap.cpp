@@ -3,6 +3,18 @@
 
 namespace graphics {
 
+    ShadowFilterSpecialization::ShadowFilterSpecialization(ShadowFilter filter)
+        : value(static_cast<u32>(filter)) {
+        entry.constantID = 0;
+        entry.offset = 0;
+        entry.size = sizeof(u32);
+
+        info.mapEntryCount = 1;
+        info.pMapEntries = &entry;
+        info.dataSize = sizeof(u32);
+        info.pData = &value;
+    }
+
     ShadowMap::ShadowMap(VulkanContext* context, uint32_t resolution)
         : context(context), resolution(resolution) {
 
@@ -11,7 +23,7 @@ namespace graphics {
         vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eDepthStencilAttachment
                                   | vk::ImageUsageFlagBits::eSampled;
 
-        depthImage = Image(context, extent, vk::Format::eD16Unorm, usage, false);
+        depthImage = Image(context, extent, vk::Format::eD16Unorm, usage, false, MemoryCategory::RenderTarget, "Shadow map");
 
         // Create sampler for shadow map
         createSampler();
@@ -31,10 +43,17 @@ namespace graphics {
         samplerInfo.maxLod = 1.0f;
         // Use white border color so areas outside shadow map are lit
         samplerInfo.borderColor = vk::BorderColor::eFloatOpaqueWhite;
-        // Enable depth comparison for shadow mapping
+        // Plain depth reads, used to visualize the shadow map
         samplerInfo.compareEnable = VK_FALSE;
-
         sampler = context->getDevice().createSampler(samplerInfo);
+
+        // Depth comparison for lighting: each fetch compares the 4 nearest texels
+        // against the reference depth and returns the bilinear-filtered result.
+        // Lit when reference <= stored depth, as in the manual comparison it replaces.
+        samplerInfo.compareEnable = VK_TRUE;
+        samplerInfo.compareOp = vk::CompareOp::eLessOrEqual;
+        samplerInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
+        compareSampler = context->getDevice().createSampler(samplerInfo);
     }
 
     void ShadowMap::destroy() {
@@ -43,6 +62,10 @@ namespace graphics {
                 context->getDevice().destroySampler(sampler);
                 sampler = nullptr;
             }
+            if (compareSampler) {
+                context->getDevice().destroySampler(compareSampler);
+                compareSampler = nullptr;
+            }
             depthImage.destroy(context);
         }
     }
@@ -51,12 +74,14 @@ namespace graphics {
         : context(other.context)
         , depthImage(std::move(other.depthImage))
         , sampler(other.sampler)
+        , compareSampler(other.compareSampler)
         , resolution(other.resolution)
         , zNear(other.zNear)
         , zFar(other.zFar)
         , depthBiasConstant(other.depthBiasConstant)
         , depthBiasSlope(other.depthBiasSlope) {
         other.sampler = nullptr;
+        other.compareSampler = nullptr;
         other.context = nullptr;
     }
 
@@ -67,6 +92,7 @@ namespace graphics {
             context = other.context;
             depthImage = std::move(other.depthImage);
             sampler = other.sampler;
+            compareSampler = other.compareSampler;
             resolution = other.resolution;
             zNear = other.zNear;
             zFar = other.zFar;
@@ -74,6 +100,7 @@ namespace graphics {
             depthBiasSlope = other.depthBiasSlope;
 
             other.sampler = nullptr;
+            other.compareSampler = nullptr;
             other.context = nullptr;
         }
         return *this;
@@ -7,6 +7,39 @@ namespace graphics {
 
     class VulkanContext;
 
+    /**
+     * PCF kernel used when sampling the shadow map, baked into the lighting
+     * pipelines through specialization constant 0 (see shadowSampling.glsl).
+     * Every tap goes through a comparison sampler, so the hardware already
+     * filters a 2x2 texel block per texture instruction.
+     */
+    enum class ShadowFilter : u32 {
+        Hardware = 0,   ///< 1 tap: bilinear 2x2 PCF
+        Optimized = 1,  ///< 4 taps: 4x4 texel footprint (16 point compares with manual PCF)
+        Poisson = 2,    ///< 8 taps: per-pixel rotated Poisson disk, softest edges
+        Count
+    };
+
+    /**
+     * Specialization info selecting a ShadowFilter in a fragment shader.
+     * Holds the data the vk::SpecializationInfo points to, so keep it alive
+     * until the pipeline is built.
+     */
+    class ShadowFilterSpecialization {
+    public:
+        explicit ShadowFilterSpecialization(ShadowFilter filter);
+
+        ShadowFilterSpecialization(const ShadowFilterSpecialization&) = delete;
+        ShadowFilterSpecialization& operator=(const ShadowFilterSpecialization&) = delete;
+
+        const vk::SpecializationInfo& get() const { return info; }
+
+    private:
+        u32 value;
+        vk::SpecializationMapEntry entry;
+        vk::SpecializationInfo info;
+    };
+
     class ShadowMap {
     public:
         ShadowMap() = default;
@@ -18,7 +51,8 @@ namespace graphics {
         // Getters
         Image& getImage() { return depthImage; }
         const Image& getImage() const { return depthImage; }
-        vk::Sampler getSampler() const { return sampler; }
+        vk::Sampler getSampler() const { return sampler; }                  ///< Raw depth reads (debug view)
+        vk::Sampler getCompareSampler() const { return compareSampler; }    ///< Depth comparison, for sampler2DShadow
         uint32_t getResolution() const { return resolution; }
 
         // Shadow configuration
@@ -46,6 +80,7 @@ namespace graphics {
         VulkanContext* context { nullptr };
         Image depthImage;
         vk::Sampler sampler { nullptr };
+        vk::Sampler compareSampler { nullptr };
         uint32_t resolution { 2048 };
 
         // Shadow configuration
@@ -0,0 +1,122 @@
+/**
+ * @file SkinningPass.cpp
+ * @brief Implementation of compute pre-skinning.
+ */
+
+#include "SkinningPass.h"
+#include "VulkanContext.h"
+#include "BasicServices/Log.h"
+#include "BasicServices/RenderingStats.h"
+
+using services::Log;
+
+namespace graphics {
+
+    namespace {
+        constexpr u32 SKINNING_GROUP_SIZE = 64;  // Must match local_size_x in skinning.comp
+    }
+
+    void SkinningPass::init(VulkanContext* context) {
+        this->context = context;
+        vk::Device device = context->getDevice();
+
+        // Everything is accessed through buffer device addresses, so no descriptor sets
+        vk::PushConstantRange pushConstant {};
+        pushConstant.offset = 0;
+        pushConstant.size = sizeof(SkinningPushConstants);
+        pushConstant.stageFlags = vk::ShaderStageFlagBits::eCompute;
+
+        vk::PipelineLayoutCreateInfo layoutInfo {};
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges = &pushConstant;
+        pipelineLayout = device.createPipelineLayout(layoutInfo);
+
+        pipeline = std::make_unique<PipelineCompute>(context, "shaders/skinning.comp.spv", pipelineLayout);
+
+        for (auto& jointBuffer : jointBuffers) {
+            jointBuffer = Buffer(context, MAX_JOINT_MATRICES * sizeof(Mat4),
+                vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                VMA_MEMORY_USAGE_CPU_TO_GPU, MemoryCategory::Skinning, "Joint matrices");
+        }
+    }
+
+    void SkinningPass::cleanup(vk::Device device) {
+        for (auto& jointBuffer : jointBuffers) {
+            jointBuffer.destroy();
+        }
+        device.destroyPipelineLayout(pipelineLayout);
+        pipelineLayout = nullptr;
+        reset();
+    }
+
+    // =========================================================================
+    // SkinningBatch
+    // =========================================================================
+
+    bool SkinningBatch::enqueue(vk::DeviceAddress sourceVertices, vk::DeviceAddress skinData, vk::DeviceAddress posedVertices,
+                                u32 vertexCount, std::span<const Mat4> palette) {
+        if (joints.size() + palette.size() > MAX_JOINT_MATRICES) {
+            Log::Warn("Skinning: joint palette full (%u matrices), mesh skipped this frame", MAX_JOINT_MATRICES);
+            return false;
+        }
+
+        SkinningPushConstants job {};
+        job.sourceVertices = sourceVertices;
+        job.skinData = skinData;
+        job.posedVertices = posedVertices;
+        job.vertexCount = vertexCount;
+        job.firstJoint = static_cast<u32>(joints.size());
+        jobs.push_back(job);
+
+        joints.insert(joints.end(), palette.begin(), palette.end());
+        return true;
+    }
+
+    void SkinningBatch::clear() {
+        jobs.clear();
+        joints.clear();
+    }
+
+    // =========================================================================
+    // SkinningPass
+    // =========================================================================
+
+    void SkinningPass::record(vk::CommandBuffer cmd, u32 frameIndex) {
+        record(cmd, frameIndex, queued);
+        reset();
+    }
+
+    void SkinningPass::record(vk::CommandBuffer cmd, u32 frameIndex, const SkinningBatch& batch) {
+        if (batch.empty()) return;
+
+        // The frame fence has been waited on, so this frame's joint buffer is free
+        Buffer& jointBuffer = jointBuffers[frameIndex];
+        memcpy(jointBuffer.info.pMappedData, batch.joints.data(), batch.joints.size() * sizeof(Mat4));
+        const vk::DeviceAddress jointAddress = jointBuffer.getDeviceAddress();
+
+        pipeline->bind(cmd);
+        for (SkinningPushConstants constants : batch.jobs) {
+            constants.jointMatrices = jointAddress;
+            cmd.pushConstants(pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(SkinningPushConstants), &constants);
+            cmd.dispatch((constants.vertexCount + SKINNING_GROUP_SIZE - 1) / SKINNING_GROUP_SIZE, 1, 1);
+        }
+
+        // Posed vertices are read through buffer references by every vertex shader afterwards
+        vk::MemoryBarrier2 barrier {};
+        barrier.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader;
+        barrier.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite;
+        barrier.dstStageMask = vk::PipelineStageFlagBits2::eVertexShader;
+        barrier.dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead;
+
+        vk::DependencyInfo dependencyInfo {};
+        dependencyInfo.memoryBarrierCount = 1;
+        dependencyInfo.pMemoryBarriers = &barrier;
+        cmd.pipelineBarrier2(dependencyInfo);
+        services::RenderingStats::Instance().barrierCount++;
+    }
+
+    void SkinningPass::reset() {
+        queued.clear();
+    }
+
+} // namespace graphics
@@ -0,0 +1,98 @@
+/**
+ * @file SkinningPass.h
+ * @brief Compute pre-skinning of animated meshes.
+ */
+
+#pragma once
+
+#include "Types.h"
+#include "Buffer.h"
+#include "PipelineCompute.h"
+#include <span>
+
+namespace graphics {
+    class VulkanContext;
+
+    /**
+     * @brief Skinning jobs of one frame, with their joint palettes back to back.
+     *
+     * Plain CPU data: the simulation thread fills one per FramePacket, and the
+     * render thread records it with SkinningPass::record.
+     */
+    struct SkinningBatch {
+        /// Capacity of the per-frame joint palette buffer
+        static constexpr u32 MAX_JOINT_MATRICES = 16384;
+
+        /**
+         * @brief Queues a skinned mesh.
+         * @param sourceVertices Bind pose vertex buffer address.
+         * @param skinData SkinVertex buffer address (same vertex count).
+         * @param posedVertices Output vertex buffer address for the frame.
+         * @param vertexCount Number of vertices to skin.
+         * @param palette Joint matrices, copied immediately.
+         * @return false if the joint palette buffer is full and the mesh was not queued.
+         */
+        bool enqueue(vk::DeviceAddress sourceVertices, vk::DeviceAddress skinData, vk::DeviceAddress posedVertices,
+                     u32 vertexCount, std::span<const Mat4> palette);
+
+        void clear();
+        bool empty() const { return jobs.empty(); }
+
+        vector<SkinningPushConstants> jobs;   ///< jointMatrices is filled when recorded
+        vector<Mat4> joints;                  ///< Palettes of all jobs, back to back
+    };
+
+    /**
+     * @class SkinningPass
+     * @brief Deforms skinned meshes on the GPU before any geometry pass runs.
+     *
+     * ## Why pre-skin in compute?
+     * Skinning in the vertex shader means every pass (shadow, G-Buffer, forward...)
+     * redoes the same joint blending, and every pipeline needs a skinned variant.
+     * Instead we run one compute dispatch per skinned mesh that writes the posed
+     * vertices into a plain Vertex buffer. Techniques then draw it like any static
+     * mesh, through the usual vertexBufferAddress push constant.
+     *
+     * ## Data flow each frame
+     * 1. LoadedGLTF::updateAnimation samples clips and builds joint palettes (CPU)
+     * 2. LoadedGLTF::submitSkinning queues one job per skinned mesh in a SkinningBatch,
+     *    either the pass's own (getBatch()) or the one of a FramePacket
+     * 3. Renderer::draw calls record() once the frame fence has been waited on:
+     *    the palettes are copied into this frame's joint buffer and the dispatches
+     *    are recorded, followed by a compute -> vertex shader barrier
+     *
+     * Output buffers are owned by the caller (one per frame in flight), so a
+     * frame still being read by the GPU is never overwritten.
+     */
+    class SkinningPass {
+    public:
+        static constexpr u32 MAX_JOINT_MATRICES = SkinningBatch::MAX_JOINT_MATRICES;
+
+        void init(VulkanContext* context);
+        void cleanup(vk::Device device);
+
+        /// Batch of the single-threaded loops (benchmark, replay)
+        SkinningBatch& getBatch() { return queued; }
+
+        /// Uploads palettes and records all queued dispatches, then clears the queue
+        void record(vk::CommandBuffer cmd, u32 frameIndex);
+        /// Same for a batch owned by someone else, which is left untouched
+        void record(vk::CommandBuffer cmd, u32 frameIndex, const SkinningBatch& batch);
+
+        /// Drops queued jobs (e.g. when a frame is skipped)
+        void reset();
+
+        u32 getQueuedJobCount() const { return static_cast<u32>(queued.jobs.size()); }
+
+    private:
+        VulkanContext* context { nullptr };
+
+        vk::PipelineLayout pipelineLayout { nullptr };
+        uptr<PipelineCompute> pipeline;
+
+        Buffer jointBuffers[FRAME_OVERLAP];   ///< CPU_TO_GPU joint palettes, one per frame in flight
+
+        SkinningBatch queued;
+    };
+
+} // namespace graphics
@@ -1,8 +1,10 @@
 #include "Swapchain.h"
+#include "DeletionQueue.hpp"
 #include <algorithm>
 #include <limits>
 #include "Types.h"
 #include "Defines.h"
+#include "BasicServices/Log.h"
 
 namespace graphics {
 
@@ -29,25 +31,26 @@ void Swapchain::cleanup() {
     }
 }
 
-void Swapchain::recreate(uint32_t newWidth, uint32_t newHeight) {
+void Swapchain::recreate(uint32_t newWidth, uint32_t newHeight, DeletionQueue& retired) {
     width = newWidth;
     height = newHeight;
 
     vk::SwapchainKHR oldSwapchain = swapchain;
-
-    // Destroy old image views
-    for (auto imageView : swapchainImageViews) {
-        device.destroyImageView(imageView);
-    }
+    std::vector<vk::ImageView> oldImageViews = std::move(swapchainImageViews);
     swapchainImageViews.clear();
 
-    // Create new swapchain using old one
+    // Passing the old swapchain lets the driver reuse its resources and hand over
+    // presentation; its images stay valid until it is destroyed
     createSwapchain(newWidth, newHeight, oldSwapchain);
 
-    // Destroy old swapchain
-    if (oldSwapchain) {
-        device.destroySwapchainKHR(oldSwapchain);
-    }
+    retired.pushFunction([device = device, oldSwapchain, oldImageViews]() {
+        for (auto imageView : oldImageViews) {
+            device.destroyImageView(imageView);
+        }
+        if (oldSwapchain) {
+            device.destroySwapchainKHR(oldSwapchain);
+        }
+    }, "Retired swapchain");
 }
 
 void Swapchain::createSwapchain(uint32_t width, uint32_t height, vk::SwapchainKHR oldSwapchain) {
@@ -55,9 +58,17 @@ void Swapchain::createSwapchain(uint32_t width, uint32_t height, vk::SwapchainKH
 
     imageFormat = vk::Format::eB8G8R8A8Unorm;
 
+    // Queried each time: the surface may have moved to another display
+    supportedPresentModes = physicalDevice.getSurfacePresentModesKHR(surface);
+    presentMode = chooseSwapPresentMode(supportedPresentModes);
+    if (presentMode != requestedPresentMode) {
+        services::Log::Warn("Swapchain: %s not supported, using %s", vk::to_string(requestedPresentMode).c_str(),
+                            vk::to_string(presentMode).c_str());
+    }
+
     vkb::Swapchain vkbSwapchain = swapchainBuilder
         .set_desired_format(vk::SurfaceFormatKHR{ imageFormat, vk::ColorSpaceKHR::eSrgbNonlinear })
-        .set_desired_present_mode((VkPresentModeKHR)vk::PresentModeKHR::eFifo)
+        .set_desired_present_mode((VkPresentModeKHR)presentMode)
         .set_desired_extent(width, height)
         .add_image_usage_flags((VkImageUsageFlags)vk::ImageUsageFlagBits::eTransferDst)
         .set_old_swapchain(oldSwapchain)
@@ -101,9 +112,17 @@ vk::SurfaceFormatKHR Swapchain::chooseSwapSurfaceFormat(const std::vector<vk::Su
 }
 
 vk::PresentModeKHR Swapchain::chooseSwapPresentMode(const std::vector<vk::PresentModeKHR>& availablePresentModes) {
-    for (const auto& availablePresentMode : availablePresentModes) {
-        if (availablePresentMode == vk::PresentModeKHR::eMailbox) {
-            return availablePresentMode;
+    // Closest modes first: uncapped ones fall back on each other, FIFO is always supported
+    std::vector<vk::PresentModeKHR> preferences { requestedPresentMode };
+    if (requestedPresentMode == vk::PresentModeKHR::eMailbox) {
+        preferences.push_back(vk::PresentModeKHR::eImmediate);
+    } else if (requestedPresentMode == vk::PresentModeKHR::eImmediate) {
+        preferences.push_back(vk::PresentModeKHR::eMailbox);
+    }
+
+    for (const vk::PresentModeKHR preference : preferences) {
+        if (std::find(availablePresentModes.begin(), availablePresentModes.end(), preference) != availablePresentModes.end()) {
+            return preference;
         }
     }
     return vk::PresentModeKHR::eFifo;
@@ -6,6 +6,8 @@
 
 namespace graphics {
 
+class DeletionQueue;
+
 class Swapchain {
 public:
     Swapchain(vk::Device device, vk::PhysicalDevice physicalDevice, vk::SurfaceKHR surface, uint32_t width, uint32_t height);
@@ -13,7 +15,9 @@ public:
 
     void init();
     void cleanup();
-    void recreate(uint32_t width, uint32_t height);
+    // Builds the new swapchain from the current one, without waiting on the device. The old
+    // swapchain and image views go to retired, to be destroyed once no frame in flight uses them
+    void recreate(uint32_t width, uint32_t height, DeletionQueue& retired);
 
     vk::SwapchainKHR* getSwapchain()  { return &swapchain; }
     vk::Format getImageFormat() const { return imageFormat; }
@@ -21,6 +25,13 @@ public:
     const std::vector<vk::Image>& getImages() const { return swapchainImages; }
     const std::vector<vk::ImageView>& getImageViews() const { return swapchainImageViews; }
 
+    // Present mode wanted for the next (re)creation. Unsupported modes fall back to the closest supported one
+    void setPresentMode(vk::PresentModeKHR mode) { requestedPresentMode = mode; }
+    vk::PresentModeKHR getRequestedPresentMode() const { return requestedPresentMode; }
+    // Mode the current swapchain was created with
+    vk::PresentModeKHR getPresentMode() const { return presentMode; }
+    const std::vector<vk::PresentModeKHR>& getSupportedPresentModes() const { return supportedPresentModes; }
+
 private:
     void createSwapchain(uint32_t width, uint32_t height, vk::SwapchainKHR oldSwapchain = nullptr);
 
@@ -38,6 +49,10 @@ private:
     vk::Format imageFormat;
     vk::Extent2D extent;
 
+    vk::PresentModeKHR requestedPresentMode { vk::PresentModeKHR::eFifo };
+    vk::PresentModeKHR presentMode { vk::PresentModeKHR::eFifo };
+    std::vector<vk::PresentModeKHR> supportedPresentModes;
+
     uint32_t width;
     uint32_t height;
 };
@@ -40,72 +40,11 @@
 #include "../PipelineBuilder.h"
 #include "../Utils.hpp"
 #include "../VulkanInit.hpp"
+#include "BasicServices/Profiler.h"
 #include "BasicServices/RenderingStats.h"
 
 namespace graphics::techniques {
 
-    // =========================================================================
-    // Frustum Culling Helper
-    // =========================================================================
-
-    namespace {
-        /**
-         * @brief Tests if a render object is visible in the camera frustum.
-         *
-         * Frustum culling is a critical optimization that skips objects
-         * outside the camera's view. This saves GPU work by not drawing
-         * invisible geometry.
-         *
-         * How it works:
-         * 1. Transform the object's bounding box corners to clip space
-         * 2. Check if the box is completely outside any frustum plane
-         * 3. If outside, the object is not visible
-         *
-         * @param obj The render object to test.
-         * @param viewProj Combined view-projection matrix.
-         * @return true if the object is potentially visible.
-         */
-        bool isVisible(const RenderObject& obj, const Mat4& viewProj) {
-            // 8 corners of a unit cube
-            std::array<Vec3, 8> corners {
-                Vec3 { 1, 1, 1 },
-                Vec3 { 1, 1, -1 },
-                Vec3 { 1, -1, 1 },
-                Vec3 { 1, -1, -1 },
-                Vec3 { -1, 1, 1 },
-                Vec3 { -1, 1, -1 },
-                Vec3 { -1, -1, 1 },
-                Vec3 { -1, -1, -1 },
-            };
-
-            // Transform from object space to clip space
-            Mat4 matrix = viewProj * obj.transform;
-
-            // Track min/max of transformed corners in clip space
-            Vec3 min = { 1.5f, 1.5f, 1.5f };
-            Vec3 max = { -1.5f, -1.5f, -1.5f };
-
-            for (int c = 0; c < 8; c++) {
-                // Transform corner to clip space
-                Vec4 v = matrix * Vec4(obj.bounds.origin + (corners[c] * obj.bounds.extents), 1.f);
-
-                // Perspective divide (clip space -> normalized device coordinates)
-                v.x = v.x / v.w;
-                v.y = v.y / v.w;
-                v.z = v.z / v.w;
-
-                min = glm::min(Vec3{ v.x, v.y, v.z }, min);
-                max = glm::max(Vec3{ v.x, v.y, v.z }, max);
-            }
-
-            // Check against NDC bounds [-1, 1] for X/Y and [0, 1] for Z
-            if (min.z > 1.f || max.z < 0.f || min.x > 1.f || max.x < -1.f || min.y > 1.f || max.y < -1.f) {
-                return false;
-            }
-            return true;
-        }
-    }
-
     // =========================================================================
     // Initialization
     // =========================================================================
@@ -223,7 +162,8 @@ namespace graphics::techniques {
         auto& stats = services::RenderingStats::Instance();
         stats.drawcallCount = 0;
         stats.triangleCount = 0;
-        auto start = std::chrono::system_clock::now();
+        PROFILE_FUNCTION();
+        const u64 start = services::Profiler::now();
 
         // Get render targets from the renderer
         Image& sceneImage = renderer->getSceneImage();
@@ -248,29 +188,31 @@ namespace graphics::techniques {
         const vk::Rect2D rect{ vk::Offset2D{0, 0}, {imageExtent.width, imageExtent.height} };
         const vk::RenderingInfo renderInfo = graphics::renderingInfo(rect, &colorAttachment, &depthAttachment);
 
+        GpuScope gpuScope(renderer->getGpuProfiler(), cmd, "Geometry");
         cmd.beginRendering(&renderInfo);
 
-        // -----------------------------------------------------------------
-        // Allocate Scene Data Descriptor Set
-        // -----------------------------------------------------------------
-        // Each frame needs a new descriptor set pointing to the scene data buffer.
-        // The per-frame allocator handles this efficiently.
-        vk::DescriptorSet globalDescriptor = frameDescriptors.allocate(renderer->getSceneDataDescriptorLayout());
-        {
-            DescriptorWriter writer;
-            writer.writeBuffer(0, renderer->getSceneDataBuffer().buffer, sizeof(GPUSceneData), 0, vk::DescriptorType::eUniformBuffer);
-            writer.updateSet(renderer->getContext()->getDevice(), globalDescriptor);
-        }
+        // Every view is drawn in this same pass, in its own rectangle of the scene image
+        for (const ViewDraws& view : renderer->getFrameViews().getViews()) {
+            // -----------------------------------------------------------------
+            // Allocate Scene Data Descriptor Set
+            // -----------------------------------------------------------------
+            // Each frame needs a new descriptor set pointing to the view's slot of the
+            // scene data buffer. The per-frame allocator handles this efficiently.
+            vk::DescriptorSet globalDescriptor = frameDescriptors.allocate(renderer->getSceneDataDescriptorLayout());
+            {
+                DescriptorWriter writer;
+                writer.writeBuffer(0, renderer->getSceneDataBuffer().buffer, sizeof(GPUSceneData), view.sceneDataOffset, vk::DescriptorType::eUniformBuffer);
+                writer.updateSet(renderer->getContext()->getDevice(), globalDescriptor);
+            }
 
-        // Draw all geometry
-        renderGeometry(cmd, drawContext, sceneData, globalDescriptor);
+            // Draw the view's geometry
+            renderGeometry(cmd, drawContext, view, globalDescriptor);
+        }
 
         cmd.endRendering();
 
         // Record performance stats
-        auto end = std::chrono::system_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        stats.meshDrawTime = static_cast<float>(elapsed.count()) / 1000.f;
+        stats.meshDrawTime = services::Profiler::toMilliseconds(services::Profiler::now() - start);
     }
 
     // =========================================================================
@@ -280,12 +222,12 @@ namespace graphics::techniques {
     void BasicTechnique::renderGeometry(
         vk::CommandBuffer cmd,
         const DrawContext& drawContext,
-        const GPUSceneData& sceneData,
+        const ViewDraws& view,
         vk::DescriptorSet globalDescriptor
     ) {
         auto& stats = services::RenderingStats::Instance();
 
-        // Reset state cache for this frame
+        // Reset state cache for this view: its scene data set must be bound again
         lastPipeline = nullptr;
         lastMaterial = nullptr;
         lastIndexBuffer = nullptr;
@@ -293,45 +235,19 @@ namespace graphics::techniques {
         // -----------------------------------------------------------------
         // Frustum Culling and Sorting
         // -----------------------------------------------------------------
-        // Build a list of visible opaque objects
-        std::vector<u32> opaqueDraws;
-        opaqueDraws.reserve(drawContext.opaqueSurfaces.size());
-
-        for (uint32_t i = 0; i < drawContext.opaqueSurfaces.size(); i++) {
-            if (isVisible(drawContext.opaqueSurfaces[i], sceneData.viewProj)) {
-                opaqueDraws.push_back(i);
-            }
-        }
-
-        // Sort by material, then by mesh
+        // Already done by the renderer for every view at once (FrameViews):
+        // the view's opaque objects come sorted by material, then by mesh.
         // This minimizes expensive state changes (pipeline binds, descriptor binds)
-        std::ranges::sort(opaqueDraws, [&](const auto& iA, const auto& iB) {
-            const RenderObject& A = drawContext.opaqueSurfaces[iA];
-            const RenderObject& B = drawContext.opaqueSurfaces[iB];
-            if (A.material == B.material) {
-                return A.indexBuffer < B.indexBuffer;  // Same material: sort by mesh
-            }
-            return A.material < B.material;  // Different materials: sort by material
-        });
 
         // -----------------------------------------------------------------
         // Set Dynamic State
         // -----------------------------------------------------------------
-        const auto imageExtent = renderer->getSceneImage().imageExtent;
-
-        // Viewport: Maps [-1,1] to screen coordinates
-        vk::Viewport viewport{};
-        viewport.x = 0;
-        viewport.y = 0;
-        viewport.width = static_cast<float>(imageExtent.width);
-        viewport.height = static_cast<float>(imageExtent.height);
-        viewport.minDepth = 0.f;
-        viewport.maxDepth = 1.f;
+        // Viewport: Maps [-1,1] to the view's rectangle
+        const vk::Viewport viewport = view.getViewport();
         cmd.setViewport(0, 1, &viewport);
 
-        // Scissor: Clips to this rectangle (usually full screen)
-        vk::Rect2D scissor{{0, 0}, {imageExtent.width, imageExtent.height}};
-        cmd.setScissor(0, 1, &scissor);
+        // Scissor: Clips to this rectangle (full screen for a single view)
+        cmd.setScissor(0, 1, &view.rect);
 
         // -----------------------------------------------------------------
         // Draw Lambda
@@ -378,7 +294,7 @@ namespace graphics::techniques {
         // Draw Opaque Objects
         // -----------------------------------------------------------------
         // Draw sorted opaque objects (already sorted for minimal state changes)
-        for (auto& r : opaqueDraws) {
+        for (auto& r : view.opaque) {
             draw(drawContext.opaqueSurfaces[r]);
         }
 
@@ -387,10 +303,8 @@ namespace graphics::techniques {
         // -----------------------------------------------------------------
         // Transparent objects are drawn after opaque (order matters for blending)
         // They use the transparent pipeline (additive blending, no depth write)
-        for (auto& r : drawContext.transparentSurfaces) {
-            if (isVisible(r, sceneData.viewProj)) {
-                draw(r);
-            }
+        for (auto& r : view.transparent) {
+            draw(drawContext.transparentSurfaces[r]);
         }
     }
 
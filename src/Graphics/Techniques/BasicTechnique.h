@@ -8,6 +8,7 @@
 #include "IRenderingTechnique.h"
 #include "../MaterialPipeline.h"
 #include "../DescriptorAllocatorGrowable.h"
+#include "../RenderView.h"
 
 namespace graphics::techniques {
 
@@ -32,16 +33,18 @@ namespace graphics::techniques {
      *    - End rendering
      *
      * ## Optimizations implemented:
-     * - **Frustum culling**: Skip objects outside the camera view
+     * - **Frustum culling**: Skip objects outside the camera view (done by the renderer, see FrameViews)
      * - **State sorting**: Sort by material to reduce pipeline/descriptor changes
      * - **Caching**: Track last pipeline/material/index buffer to avoid redundant binds
      *
+     * - **Views in one pass**: Extra cameras are drawn in their own rectangle of the same pass
+     *
      * ## Rendering steps in detail:
-     * 1. **Cull objects**: Test bounding boxes against view frustum
+     * 1. **Cull objects**: Test bounding boxes against each view frustum
      * 2. **Sort opaque objects**: By material, then by mesh
      * 3. **Begin render pass**: Attach color and depth images
-     * 4. **Set viewport/scissor**: Define rendering area
-     * 5. **For each object**:
+     * 4. **For each view, set viewport/scissor**: Define rendering area
+     * 5. **For each object of the view**:
      *    - Bind pipeline (if changed)
      *    - Bind descriptor sets (scene data, material)
      *    - Bind index buffer (if changed)
@@ -94,16 +97,16 @@ namespace graphics::techniques {
         /**
          * @brief Internal method that performs the actual geometry rendering.
          *
-         * This is where the actual draw calls happen:
-         * - Sets up viewport and scissor
-         * - Iterates through sorted opaque objects
-         * - Iterates through visible transparent objects
+         * This is where the actual draw calls happen, for one view:
+         * - Sets up viewport and scissor to the view's rectangle
+         * - Iterates through its sorted opaque objects
+         * - Iterates through its visible transparent objects
          * - Issues draw calls with proper state management
          */
         void renderGeometry(
             vk::CommandBuffer cmd,
             const DrawContext& drawContext,
-            const GPUSceneData& sceneData,
+            const ViewDraws& view,
             vk::DescriptorSet globalDescriptor
         );
 
@@ -31,7 +31,7 @@ namespace graphics::techniques {
 
         // Create blur params buffer
         blurParamsBuffer = Buffer(context, sizeof(float) * 2,
-            vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU);
+            vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU, MemoryCategory::Uniform, "Bloom blur params");
 
         createImages();
         createDescriptors();
@@ -58,13 +58,15 @@ namespace graphics::techniques {
         device.destroyPipelineLayout(compositeLayout);
     }
 
-    void BloomTechnique::resize(uint32_t newWidth, uint32_t newHeight) {
+    void BloomTechnique::resize(uint32_t newWidth, uint32_t newHeight, DeletionQueue& retired) {
         if (width == newWidth && height == newHeight) return;
 
         width = newWidth;
         height = newHeight;
 
-        destroyImages();
+        brightPassImage.retire(context, retired);
+        blurImageH.retire(context, retired);
+        blurImageV.retire(context, retired);
         createImages();
     }
 
@@ -78,9 +80,9 @@ namespace graphics::techniques {
         vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eColorAttachment |
                                     vk::ImageUsageFlagBits::eSampled;
 
-        brightPassImage = Image(context, extent, format, usage);
-        blurImageH = Image(context, extent, format, usage);
-        blurImageV = Image(context, extent, format, usage);
+        brightPassImage = Image(context, extent, format, usage, false, MemoryCategory::RenderTarget, "Bloom bright pass");
+        blurImageH = Image(context, extent, format, usage, false, MemoryCategory::RenderTarget, "Bloom blur H");
+        blurImageV = Image(context, extent, format, usage, false, MemoryCategory::RenderTarget, "Bloom blur V");
     }
 
     void BloomTechnique::destroyImages() {
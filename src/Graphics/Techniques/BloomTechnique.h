@@ -8,6 +8,7 @@
 namespace graphics {
     class Renderer;
     class VulkanContext;
+    class DeletionQueue;
 }
 
 namespace graphics::techniques {
@@ -26,7 +27,8 @@ namespace graphics::techniques {
     public:
         void init(Renderer* renderer, uint32_t width, uint32_t height);
         void cleanup(vk::Device device);
-        void resize(uint32_t width, uint32_t height);
+        // Old images go to retired: frames in flight may still sample them
+        void resize(uint32_t width, uint32_t height, DeletionQueue& retired);
 
         // Apply bloom to the input image and output to the final image
         void apply(vk::CommandBuffer cmd, Image& inputImage, Image& outputImage,
@@ -6,6 +6,8 @@
 #include "../Utils.hpp"
 #include "../VulkanContext.h"
 #include "BasicServices/Log.h"
+#include "BasicServices/Profiler.h"
+#include "BasicServices/RenderingStats.h"
 #include "../VulkanInit.hpp"
 
 using services::Log;
@@ -19,7 +21,7 @@ namespace graphics::techniques {
 
         // Create lights buffer
         lightsBuffer = Buffer(renderer->getContext(), sizeof(DeferredLightsData),
-            vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU);
+            vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU, MemoryCategory::Uniform, "Deferred lights");
 
         // Initialize lights (like Sascha Willems example, scaled up for the 30x model)
         lightsData.numLights = 6;
@@ -83,16 +85,13 @@ namespace graphics::techniques {
         deferredBuilder.addBinding(2, vk::DescriptorType::eCombinedImageSampler); // Albedo
         deferredBuilder.addBinding(3, vk::DescriptorType::eUniformBuffer);        // Lights
         deferredDescriptorLayout = deferredBuilder.build(device, vk::ShaderStageFlagBits::eFragment);
+    }
 
-        // Allocate and update deferred descriptor set
-        gBufferDescriptorSet = renderer->getContext()->getGlobalDescriptorAllocator()->allocate(deferredDescriptorLayout);
+    void DeferredRenderingTechnique::resize(vk::Extent3D extent, DeletionQueue& retired) {
+        if (gBuffer.extent == extent) return;
 
-        DescriptorWriter writer;
-        writer.writeImage(0, gBuffer.position.imageView, renderer->defaultSamplerLinear, vk::ImageLayout::eShaderReadOnlyOptimal, vk::DescriptorType::eCombinedImageSampler);
-        writer.writeImage(1, gBuffer.normal.imageView, renderer->defaultSamplerLinear, vk::ImageLayout::eShaderReadOnlyOptimal, vk::DescriptorType::eCombinedImageSampler);
-        writer.writeImage(2, gBuffer.albedo.imageView, renderer->defaultSamplerLinear, vk::ImageLayout::eShaderReadOnlyOptimal, vk::DescriptorType::eCombinedImageSampler);
-        writer.writeBuffer(3, lightsBuffer.buffer, sizeof(DeferredLightsData), 0, vk::DescriptorType::eUniformBuffer);
-        writer.updateSet(device, gBufferDescriptorSet);
+        gBuffer.retire(renderer->getContext(), retired);
+        gBuffer.init(renderer->getContext(), extent);
     }
 
     void DeferredRenderingTechnique::createPipelines() {
@@ -153,6 +152,7 @@ namespace graphics::techniques {
         const GPUSceneData& sceneData,
         DescriptorAllocatorGrowable& frameDescriptors
     ) {
+        PROFILE_FUNCTION();
         static bool loggedOnce = false;
         if (!loggedOnce) {
             Log::Debug("Deferred: opaqueSurfaces=%zu, transparentSurfaces=%zu",
@@ -160,7 +160,10 @@ namespace graphics::techniques {
             loggedOnce = true;
         }
 
+        GpuProfiler& profiler = renderer->getGpuProfiler();
+
         // 1. Geometry Pass
+        const u32 geometryScope = profiler.beginScope(cmd, "G-Buffer");
         // Transition G-Buffer images to color attachment
         graphics::transitionImage(cmd, gBuffer.position.image, vk::ImageLayout::eUndefined, vk::ImageLayout::eColorAttachmentOptimal);
         graphics::transitionImage(cmd, gBuffer.normal.image, vk::ImageLayout::eUndefined, vk::ImageLayout::eColorAttachmentOptimal);
@@ -187,44 +190,57 @@ namespace graphics::techniques {
 
         cmd.beginRendering(&renderInfo);
 
-        vk::Viewport viewport(0, 0, (float)gBuffer.extent.width, (float)gBuffer.extent.height, 0, 1);
-        cmd.setViewport(0, 1, &viewport);
-        vk::Rect2D scissor({0, 0}, {gBuffer.extent.width, gBuffer.extent.height});
-        cmd.setScissor(0, 1, &scissor);
-
         // Bind G-Buffer pipeline
         cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, gBufferPipeline->getPipeline());
 
-        // Bind Scene Data
-        vk::DescriptorSet sceneDescriptor = frameDescriptors.allocate(renderer->getSceneDataDescriptorLayout());
-        {
-            DescriptorWriter writer;
-            writer.writeBuffer(0, renderer->getSceneDataBuffer().buffer, sizeof(GPUSceneData), 0, vk::DescriptorType::eUniformBuffer);
-            writer.updateSet(renderer->getContext()->getDevice(), sceneDescriptor);
-        }
-        cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, gBufferLayout, 0, 1, &sceneDescriptor, 0, nullptr);
-
-        // Draw opaque surfaces
-        for (const auto& r : drawContext.opaqueSurfaces) {
-            cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, gBufferLayout, 1, 1, &r.material->materialSet, 0, nullptr);
-            cmd.bindIndexBuffer(r.indexBuffer, 0, vk::IndexType::eUint32);
-
-            GraphicsPushConstants pushConstants;
-            pushConstants.vertexBuffer = r.vertexBufferAddress;
-            pushConstants.worldMatrix = r.transform;
-            cmd.pushConstants(gBufferLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(GraphicsPushConstants), &pushConstants);
-
-            cmd.drawIndexed(r.indexCount, 1, r.firstIndex, 0, 0);
+        // Each view fills its rectangle of the G-Buffer with its visible surfaces.
+        // The G-Buffer holds world positions, so a single lighting pass then shades every view
+        auto& stats = services::RenderingStats::Instance();
+        stats.drawcallCount = 0;
+        stats.triangleCount = 0;
+        vk::DescriptorSet sceneDescriptor { nullptr };
+        for (const ViewDraws& view : renderer->getFrameViews().getViews()) {
+            const vk::Viewport viewport = view.getViewport();
+            cmd.setViewport(0, 1, &viewport);
+            cmd.setScissor(0, 1, &view.rect);
+
+            // Bind Scene Data
+            vk::DescriptorSet viewDescriptor = frameDescriptors.allocate(renderer->getSceneDataDescriptorLayout());
+            {
+                DescriptorWriter writer;
+                writer.writeBuffer(0, renderer->getSceneDataBuffer().buffer, sizeof(GPUSceneData), view.sceneDataOffset, vk::DescriptorType::eUniformBuffer);
+                writer.updateSet(renderer->getContext()->getDevice(), viewDescriptor);
+            }
+            cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, gBufferLayout, 0, 1, &viewDescriptor, 0, nullptr);
+            // The main view's scene data also serves the lighting pass
+            if (!sceneDescriptor) sceneDescriptor = viewDescriptor;
+
+            // Draw opaque surfaces
+            for (const u32 idx : view.opaque) {
+                const RenderObject& r = drawContext.opaqueSurfaces[idx];
+                cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, gBufferLayout, 1, 1, &r.material->materialSet, 0, nullptr);
+                cmd.bindIndexBuffer(r.indexBuffer, 0, vk::IndexType::eUint32);
+
+                GraphicsPushConstants pushConstants;
+                pushConstants.vertexBuffer = r.vertexBufferAddress;
+                pushConstants.worldMatrix = r.transform;
+                cmd.pushConstants(gBufferLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(GraphicsPushConstants), &pushConstants);
+
+                cmd.drawIndexed(r.indexCount, 1, r.firstIndex, 0, 0);
+                stats.drawcallCount++;
+                stats.triangleCount += static_cast<i32>(r.indexCount / 3);
+            }
         }
 
         cmd.endRendering();
+        profiler.endScope(cmd, geometryScope);
 
         // 2. Transition G-Buffer to shader read
         graphics::transitionImage(cmd, gBuffer.position.image, vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
         graphics::transitionImage(cmd, gBuffer.normal.image, vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
         graphics::transitionImage(cmd, gBuffer.albedo.image, vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
 
-        // Update animated lights
+        // Update animated lights. Specular highlights follow the main camera in every view
         updateLights(sceneData);
 
         // 3. Deferred Pass - Render to Renderer's scene image (for post-processing)
@@ -237,13 +253,23 @@ namespace graphics::techniques {
         deferredRenderInfo.colorAttachmentCount = 1;
         deferredRenderInfo.pColorAttachments = &sceneColorAttachment;
 
+        GpuScope lightingScope(profiler, cmd, "Deferred Lighting");
         cmd.beginRendering(&deferredRenderInfo);
 
         cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, deferredPipeline->getPipeline());
 
         // Bind Scene Data at set 0
         cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, deferredLayout, 0, 1, &sceneDescriptor, 0, nullptr);
-        // Bind G-Buffer descriptors at set 2
+        // Bind G-Buffer descriptors at set 2. Written per frame: the G-Buffer is reallocated on resize
+        vk::DescriptorSet gBufferDescriptorSet = frameDescriptors.allocate(deferredDescriptorLayout);
+        {
+            DescriptorWriter writer;
+            writer.writeImage(0, gBuffer.position.imageView, renderer->defaultSamplerLinear, vk::ImageLayout::eShaderReadOnlyOptimal, vk::DescriptorType::eCombinedImageSampler);
+            writer.writeImage(1, gBuffer.normal.imageView, renderer->defaultSamplerLinear, vk::ImageLayout::eShaderReadOnlyOptimal, vk::DescriptorType::eCombinedImageSampler);
+            writer.writeImage(2, gBuffer.albedo.imageView, renderer->defaultSamplerLinear, vk::ImageLayout::eShaderReadOnlyOptimal, vk::DescriptorType::eCombinedImageSampler);
+            writer.writeBuffer(3, lightsBuffer.buffer, sizeof(DeferredLightsData), 0, vk::DescriptorType::eUniformBuffer);
+            writer.updateSet(renderer->getContext()->getDevice(), gBufferDescriptorSet);
+        }
         cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, deferredLayout, 2, 1, &gBufferDescriptorSet, 0, nullptr);
 
         // Pass debug mode via push constants
@@ -24,6 +24,7 @@ namespace graphics::techniques {
         void init(Renderer* renderer) override;
         void cleanup(vk::Device device) override;
         void render(vk::CommandBuffer cmd, const DrawContext& drawContext, const GPUSceneData& sceneData, DescriptorAllocatorGrowable& frameDescriptors) override;
+        void resize(vk::Extent3D extent, DeletionQueue& retired) override;
 
         bool requiresShadowPass() const override { return false; }
         const TechniqueType getTechnique() const override { return TechniqueType::Deferred; }
@@ -54,8 +55,6 @@ namespace graphics::techniques {
         vk::DescriptorSetLayout gBufferDescriptorLayout { nullptr };
         vk::DescriptorSetLayout deferredDescriptorLayout { nullptr };
 
-        vk::DescriptorSet gBufferDescriptorSet; // For the deferred pass to read G-Buffer
-
         // Point lights
         Buffer lightsBuffer;
         DeferredLightsData lightsData;
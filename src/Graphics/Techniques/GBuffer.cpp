@@ -8,13 +8,13 @@ namespace graphics::techniques {
 
         // Position buffer (RGBA32F for world space position)
         vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled;
-        position = Image(context, extent, vk::Format::eR32G32B32A32Sfloat, usage);
+        position = Image(context, extent, vk::Format::eR32G32B32A32Sfloat, usage, false, MemoryCategory::RenderTarget, "G-Buffer position");
 
         // Normal buffer (RGBA16F for world space normals)
-        normal = Image(context, extent, vk::Format::eR16G16B16A16Sfloat, usage);
+        normal = Image(context, extent, vk::Format::eR16G16B16A16Sfloat, usage, false, MemoryCategory::RenderTarget, "G-Buffer normal");
 
         // Albedo buffer (RGBA8 for color)
-        albedo = Image(context, extent, vk::Format::eR8G8B8A8Unorm, usage);
+        albedo = Image(context, extent, vk::Format::eR8G8B8A8Unorm, usage, false, MemoryCategory::RenderTarget, "G-Buffer albedo");
     }
 
     void GBuffer::destroy(VulkanContext* context) {
@@ -23,5 +23,11 @@ namespace graphics::techniques {
         albedo.destroy(context);
     }
 
+    void GBuffer::retire(VulkanContext* context, DeletionQueue& queue) {
+        position.retire(context, queue);
+        normal.retire(context, queue);
+        albedo.retire(context, queue);
+    }
+
 } // namespace graphics::techniques
 
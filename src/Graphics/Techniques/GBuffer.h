@@ -4,6 +4,7 @@
 
 namespace graphics {
     class VulkanContext;
+    class DeletionQueue;
 }
 
 namespace graphics::techniques {
@@ -16,6 +17,8 @@ namespace graphics::techniques {
 
         void init(VulkanContext* context, vk::Extent3D extent);
         void destroy(VulkanContext* context);
+        /// Defers destruction to the queue, for a G-Buffer frames in flight may still use
+        void retire(VulkanContext* context, DeletionQueue& queue);
     };
 
 } // namespace graphics::techniques
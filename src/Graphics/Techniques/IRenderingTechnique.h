@@ -15,6 +15,7 @@
 namespace graphics {
     class Renderer;
     class DescriptorAllocatorGrowable;
+    class DeletionQueue;
     struct FrameData;
 }
 
@@ -116,6 +117,19 @@ namespace graphics::techniques {
             DescriptorAllocatorGrowable& frameDescriptors
         ) = 0;
 
+        /**
+         * @brief Matches the technique's own render targets to the draw image.
+         * @param extent Current extent of the draw image.
+         * @param retired Deletion queue flushed once frames in flight are done.
+         *
+         * Called by the renderer before each render(), so techniques catch up with
+         * window resizes and with changes made while they were not active. Must
+         * do nothing when the extent did not change. Replaced images go to
+         * retired rather than being destroyed, and descriptor sets pointing at
+         * them must not be rewritten while frames in flight may use them.
+         */
+        virtual void resize(vk::Extent3D extent, DeletionQueue& retired) {}
+
         /**
          * @brief Returns whether this technique requires a separate shadow pass.
          *
@@ -0,0 +1,407 @@
+#include "ParticleSystem.h"
+#include "../Renderer.h"
+#include "../VulkanContext.h"
+#include "../PipelineBuilder.h"
+#include "../VulkanInit.hpp"
+#include "BasicServices/Log.h"
+#include "BasicServices/RenderingStats.h"
+
+#include <algorithm>
+
+using services::Log;
+
+namespace graphics::techniques {
+
+    namespace {
+        constexpr u32 PARTICLE_GROUP_SIZE = 64;     // Must match local_size_x in the particle compute shaders
+        constexpr u32 VERTICES_PER_PARTICLE = 6;    // Two triangles per billboard, no index buffer
+        constexpr f32 MAX_DELTA_TIME = 0.1f;        // Avoids an emission burst after a hitch
+
+        // GPU layout of a particle (must match particles.glsl)
+        struct GPUParticle {
+            Vec4 positionLife;      // xyz = position, w = remaining life
+            Vec4 velocityMaxLife;   // xyz = velocity, w = total life
+        };
+
+        // GPU layout of the emitter state buffer (must match particles.glsl)
+        struct GPUParticleState {
+            vk::DrawIndirectCommand draw;   // instanceCount is written by the simulation
+            i32 deadCount;                  // Signed: emission may briefly push it below zero
+            u32 aliveCount[2];
+            u32 padding;
+        };
+        static_assert(sizeof(GPUParticleState) == 32, "Particle state layout must match particles.glsl");
+
+        constexpr vk::DeviceSize INSTANCE_COUNT_OFFSET = offsetof(GPUParticleState, draw) + offsetof(vk::DrawIndirectCommand, instanceCount);
+        constexpr vk::DeviceSize ALIVE_COUNT_OFFSET = offsetof(GPUParticleState, aliveCount);
+
+        struct ParticlePushConstants {
+            vk::DeviceAddress params;
+            u32 aliveIndex;
+            u32 padding;
+        };
+    }
+
+    // =========================================================================
+    // Presets
+    // =========================================================================
+
+    ParticleEmitterSettings ParticleEmitterSettings::dust() {
+        ParticleEmitterSettings settings {};
+        settings.name = "Dust";
+        settings.maxParticles = 65536;
+        settings.emitRate = 8000.0f;
+        settings.position = Vec3(0.0f, 3.0f, 0.0f);
+        settings.extents = Vec3(30.0f, 3.0f, 30.0f);
+        settings.velocityJitter = 0.05f;
+        settings.gravity = Vec3(0.0f, -0.01f, 0.0f);
+        settings.turbulence = 0.1f;
+        settings.lifeMin = 4.0f;
+        settings.lifeMax = 8.0f;
+        settings.size = 0.015f;
+        settings.colorStart = Vec4(0.9f, 0.85f, 0.75f, 0.5f);
+        settings.colorEnd = Vec4(0.9f, 0.85f, 0.75f, 0.0f);
+        return settings;
+    }
+
+    ParticleEmitterSettings ParticleEmitterSettings::pollen() {
+        ParticleEmitterSettings settings {};
+        settings.name = "Pollen";
+        settings.maxParticles = 16384;
+        settings.emitRate = 1500.0f;
+        settings.position = Vec3(0.0f, 1.5f, 0.0f);
+        settings.extents = Vec3(25.0f, 1.5f, 25.0f);
+        settings.velocity = Vec3(0.3f, 0.05f, 0.1f);
+        settings.velocityJitter = 0.2f;
+        settings.gravity = Vec3(0.0f, -0.02f, 0.0f);
+        settings.turbulence = 0.4f;
+        settings.lifeMin = 5.0f;
+        settings.lifeMax = 10.0f;
+        settings.size = 0.03f;
+        settings.colorStart = Vec4(1.0f, 0.9f, 0.4f, 0.8f);
+        settings.colorEnd = Vec4(1.0f, 0.8f, 0.3f, 0.0f);
+        return settings;
+    }
+
+    ParticleEmitterSettings ParticleEmitterSettings::fireflies() {
+        ParticleEmitterSettings settings {};
+        settings.name = "Fireflies";
+        settings.maxParticles = 2048;
+        settings.emitRate = 100.0f;
+        settings.position = Vec3(0.0f, 1.0f, 0.0f);
+        settings.extents = Vec3(15.0f, 1.0f, 15.0f);
+        settings.velocityJitter = 0.3f;
+        settings.turbulence = 1.0f;
+        settings.lifeMin = 6.0f;
+        settings.lifeMax = 12.0f;
+        settings.size = 0.06f;
+        settings.flicker = 0.9f;
+        settings.colorStart = Vec4(0.8f, 1.0f, 0.3f, 1.0f);
+        settings.colorEnd = Vec4(0.5f, 1.0f, 0.2f, 0.0f);
+        return settings;
+    }
+
+    // =========================================================================
+    // Lifecycle
+    // =========================================================================
+
+    void ParticleSystem::init(Renderer* renderer) {
+        this->renderer = renderer;
+        this->context = renderer->getContext();
+
+        emitters.reserve(MAX_EMITTERS);
+
+        for (u32 i = 0; i < FRAME_OVERLAP; i++) {
+            paramsBuffers[i] = Buffer(context, MAX_EMITTERS * sizeof(GPUParticleEmitterParams),
+                vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                VMA_MEMORY_USAGE_CPU_TO_GPU, MemoryCategory::Particles, "Emitter params");
+            paramsAddresses[i] = paramsBuffers[i].getDeviceAddress();
+        }
+
+        createPipelines();
+        lastUpdate = std::chrono::steady_clock::now();
+
+        Log::Info("Particle system initialized");
+    }
+
+    void ParticleSystem::cleanup(vk::Device device) {
+        emitters.clear();
+        for (auto& paramsBuffer : paramsBuffers) {
+            paramsBuffer.destroy();
+        }
+
+        renderPipeline.reset();
+        device.destroyPipelineLayout(computeLayout);
+        device.destroyPipelineLayout(renderLayout);
+        computeLayout = nullptr;
+        renderLayout = nullptr;
+    }
+
+    void ParticleSystem::createPipelines() {
+        vk::Device device = context->getDevice();
+
+        // All particle data is reached through the params buffer address, so no descriptor sets
+        vk::PushConstantRange computePush {};
+        computePush.stageFlags = vk::ShaderStageFlagBits::eCompute;
+        computePush.offset = 0;
+        computePush.size = sizeof(ParticlePushConstants);
+
+        vk::PipelineLayoutCreateInfo computeLayoutInfo {};
+        computeLayoutInfo.pushConstantRangeCount = 1;
+        computeLayoutInfo.pPushConstantRanges = &computePush;
+        computeLayout = device.createPipelineLayout(computeLayoutInfo);
+
+        emitPipeline = std::make_unique<PipelineCompute>(context, "shaders/particle_emit.comp.spv", computeLayout);
+        simulatePipeline = std::make_unique<PipelineCompute>(context, "shaders/particle_simulate.comp.spv", computeLayout);
+
+        vk::PushConstantRange renderPush {};
+        renderPush.stageFlags = vk::ShaderStageFlagBits::eVertex;
+        renderPush.offset = 0;
+        renderPush.size = sizeof(ParticlePushConstants);
+
+        vk::PipelineLayoutCreateInfo renderLayoutInfo {};
+        renderLayoutInfo.pushConstantRangeCount = 1;
+        renderLayoutInfo.pPushConstantRanges = &renderPush;
+        renderLayout = device.createPipelineLayout(renderLayoutInfo);
+
+        // Additive blending is order independent, so particles never need sorting.
+        // Depth is tested against the scene but not written, particles don't occlude each other.
+        PipelineBuilder builder(context, "shaders/particle.vert.spv", "shaders/particle.frag.spv");
+        builder.pipelineLayout = renderLayout;
+        builder.setInputTopology(vk::PrimitiveTopology::eTriangleList);
+        builder.setPolygonMode(vk::PolygonMode::eFill);
+        builder.setCullMode(vk::CullModeFlagBits::eNone, vk::FrontFace::eCounterClockwise);
+        builder.setMultisamplingNone();
+        builder.enableBlendingAdditive();
+        builder.enableDepthTest(false, vk::CompareOp::eLessOrEqual);
+        builder.setColorAttachmentFormat(renderer->getSceneImage().imageFormat);
+        builder.setDepthFormat(context->getDepthImage().imageFormat);
+        renderPipeline = builder.buildPipeline(device);
+    }
+
+    // =========================================================================
+    // Emitters
+    // =========================================================================
+
+    i32 ParticleSystem::addEmitter(const ParticleEmitterSettings& settings) {
+        if (emitters.size() >= MAX_EMITTERS) {
+            Log::Warn("Particles: cannot add emitter '%s', limit of %u reached", settings.name.c_str(), MAX_EMITTERS);
+            return -1;
+        }
+
+        const u32 capacity = std::max(settings.maxParticles, 1u);
+        const vk::BufferUsageFlags storageUsage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress;
+        const size_t indexListSize = capacity * sizeof(u32);
+
+        Emitter emitter {};
+        emitter.settings = settings;
+        emitter.settings.maxParticles = capacity;
+        const char* name = settings.name.c_str();
+        emitter.particles = Buffer(context, capacity * sizeof(GPUParticle), storageUsage, VMA_MEMORY_USAGE_GPU_ONLY, MemoryCategory::Particles, name);
+        emitter.deadList = Buffer(context, indexListSize, storageUsage | vk::BufferUsageFlagBits::eTransferDst, VMA_MEMORY_USAGE_GPU_ONLY, MemoryCategory::Particles, name);
+        emitter.aliveLists[0] = Buffer(context, indexListSize, storageUsage, VMA_MEMORY_USAGE_GPU_ONLY, MemoryCategory::Particles, name);
+        emitter.aliveLists[1] = Buffer(context, indexListSize, storageUsage, VMA_MEMORY_USAGE_GPU_ONLY, MemoryCategory::Particles, name);
+        emitter.drawList = Buffer(context, indexListSize, storageUsage, VMA_MEMORY_USAGE_GPU_ONLY, MemoryCategory::Particles, name);
+        emitter.state = Buffer(context, sizeof(GPUParticleState),
+            storageUsage | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst,
+            VMA_MEMORY_USAGE_GPU_ONLY, MemoryCategory::Particles, name);
+
+        // Every slot starts dead: the dead list holds all indices, nothing is alive
+        const size_t stagingSize = indexListSize + sizeof(GPUParticleState);
+        const Buffer staging { context, stagingSize, vk::BufferUsageFlagBits::eTransferSrc, VMA_MEMORY_USAGE_CPU_ONLY,
+            MemoryCategory::Staging, "Particle upload" };
+        auto* deadIndices = static_cast<u32*>(staging.info.pMappedData);
+        for (u32 i = 0; i < capacity; i++) {
+            deadIndices[i] = i;
+        }
+
+        GPUParticleState initialState {};
+        initialState.draw = vk::DrawIndirectCommand { VERTICES_PER_PARTICLE, 0, 0, 0 };
+        initialState.deadCount = static_cast<i32>(capacity);
+        memcpy(static_cast<u8*>(staging.info.pMappedData) + indexListSize, &initialState, sizeof(GPUParticleState));
+
+        renderer->getImmediateSubmitter()->immediateSubmit(context, [&](vk::CommandBuffer cmd) {
+            vk::BufferCopy deadCopy { 0, 0, indexListSize };
+            cmd.copyBuffer(staging.buffer, emitter.deadList.buffer, 1, &deadCopy);
+
+            vk::BufferCopy stateCopy { indexListSize, 0, sizeof(GPUParticleState) };
+            cmd.copyBuffer(staging.buffer, emitter.state.buffer, 1, &stateCopy);
+        });
+
+        emitters.push_back(std::move(emitter));
+        Log::Info("Particles: added emitter '%s' (%u particles)", settings.name.c_str(), capacity);
+        return static_cast<i32>(emitters.size()) - 1;
+    }
+
+    vk::DeviceAddress ParticleSystem::getParamsAddress(u32 frameIndex, u32 emitterIndex) const {
+        return paramsAddresses[frameIndex] + emitterIndex * sizeof(GPUParticleEmitterParams);
+    }
+
+    void ParticleSystem::fillParams(const GPUSceneData& sceneData, u32 frameIndex, f32 deltaTime) {
+        auto* params = static_cast<GPUParticleEmitterParams*>(paramsBuffers[frameIndex].info.pMappedData);
+
+        // Camera basis vectors are the rows of the view rotation
+        const Vec4 cameraRight { sceneData.view[0][0], sceneData.view[1][0], sceneData.view[2][0], 0.0f };
+        const Vec4 cameraUp { sceneData.view[0][1], sceneData.view[1][1], sceneData.view[2][1], 0.0f };
+
+        for (u32 i = 0; i < emitters.size(); i++) {
+            Emitter& emitter = emitters[i];
+            const ParticleEmitterSettings& s = emitter.settings;
+
+            // Carry the fractional part so low rates still emit at the right average
+            emitter.emitAccumulator += s.enabled ? s.emitRate * deltaTime : 0.0f;
+            emitter.emitCount = std::min(static_cast<u32>(emitter.emitAccumulator), s.maxParticles);
+            emitter.emitAccumulator -= static_cast<f32>(emitter.emitCount);
+            emitter.emitAccumulator = std::min(emitter.emitAccumulator, 1.0f);
+
+            GPUParticleEmitterParams& p = params[i];
+            p.viewProj = sceneData.viewProj;
+            p.cameraRight = cameraRight;
+            p.cameraUp = cameraUp;
+            p.positionSize = Vec4(s.position, s.size);
+            p.extentsJitter = Vec4(s.extents, s.velocityJitter);
+            p.velocityLifeMin = Vec4(s.velocity, s.lifeMin);
+            p.gravityLifeMax = Vec4(s.gravity, std::max(s.lifeMax, s.lifeMin));
+            p.colorStart = s.colorStart;
+            p.colorEnd = s.colorEnd;
+            p.emitCount = emitter.emitCount;
+            p.maxParticles = s.maxParticles;
+            p.randomSeed = frameCounter * 747796405u + i * 2891336453u;
+            p.deltaTime = deltaTime;
+            p.turbulence = s.turbulence;
+            p.flicker = s.flicker;
+            p.particles = emitter.particles.getDeviceAddress();
+            p.deadList = emitter.deadList.getDeviceAddress();
+            p.aliveList0 = emitter.aliveLists[0].getDeviceAddress();
+            p.aliveList1 = emitter.aliveLists[1].getDeviceAddress();
+            p.drawList = emitter.drawList.getDeviceAddress();
+            p.state = emitter.state.getDeviceAddress();
+        }
+    }
+
+    // =========================================================================
+    // Simulation
+    // =========================================================================
+
+    void ParticleSystem::update(vk::CommandBuffer cmd, const GPUSceneData& sceneData, u32 frameIndex) {
+        const auto now = std::chrono::steady_clock::now();
+        const f32 deltaTime = std::min(std::chrono::duration<f32>(now - lastUpdate).count(), MAX_DELTA_TIME);
+        lastUpdate = now;
+
+        if (!enabled || emitters.empty()) return;
+
+        frameCounter++;
+        fillParams(sceneData, frameIndex, deltaTime);
+
+        auto& stats = services::RenderingStats::Instance();
+
+        // The previous frame may still be drawing from (or simulating into) these buffers
+        vk::MemoryBarrier2 previousFrameBarrier {};
+        previousFrameBarrier.srcStageMask = vk::PipelineStageFlagBits2::eDrawIndirect | vk::PipelineStageFlagBits2::eVertexShader |
+                                            vk::PipelineStageFlagBits2::eComputeShader;
+        previousFrameBarrier.srcAccessMask = vk::AccessFlagBits2::eIndirectCommandRead | vk::AccessFlagBits2::eShaderStorageRead |
+                                             vk::AccessFlagBits2::eShaderStorageWrite;
+        previousFrameBarrier.dstStageMask = vk::PipelineStageFlagBits2::eTransfer | vk::PipelineStageFlagBits2::eComputeShader;
+        previousFrameBarrier.dstAccessMask = vk::AccessFlagBits2::eTransferWrite | vk::AccessFlagBits2::eShaderStorageRead |
+                                             vk::AccessFlagBits2::eShaderStorageWrite;
+
+        vk::DependencyInfo dependencyInfo {};
+        dependencyInfo.memoryBarrierCount = 1;
+        dependencyInfo.pMemoryBarriers = &previousFrameBarrier;
+        cmd.pipelineBarrier2(dependencyInfo);
+        stats.barrierCount++;
+
+        // 1. Reset the counters written this frame: draw instances and the output alive list
+        for (Emitter& emitter : emitters) {
+            const u32 outIndex = 1 - emitter.aliveIndex;
+            cmd.fillBuffer(emitter.state.buffer, INSTANCE_COUNT_OFFSET, sizeof(u32), 0);
+            cmd.fillBuffer(emitter.state.buffer, ALIVE_COUNT_OFFSET + outIndex * sizeof(u32), sizeof(u32), 0);
+        }
+
+        vk::MemoryBarrier2 computeBarrier {};
+        computeBarrier.srcStageMask = vk::PipelineStageFlagBits2::eTransfer;
+        computeBarrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+        computeBarrier.dstStageMask = vk::PipelineStageFlagBits2::eComputeShader;
+        computeBarrier.dstAccessMask = vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite;
+        dependencyInfo.pMemoryBarriers = &computeBarrier;
+        cmd.pipelineBarrier2(dependencyInfo);
+        stats.barrierCount++;
+
+        // 2. Emit: new particles are appended to the input alive list
+        emitPipeline->bind(cmd);
+        for (u32 i = 0; i < emitters.size(); i++) {
+            Emitter& emitter = emitters[i];
+            if (emitter.emitCount == 0) continue;
+
+            ParticlePushConstants push { getParamsAddress(frameIndex, i), emitter.aliveIndex, 0 };
+            cmd.pushConstants(computeLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(ParticlePushConstants), &push);
+            cmd.dispatch((emitter.emitCount + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE, 1, 1);
+        }
+
+        computeBarrier.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader;
+        computeBarrier.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite;
+        cmd.pipelineBarrier2(dependencyInfo);
+        stats.barrierCount++;
+
+        // 3. Simulate: the alive count is only known on the GPU, so dispatch for the whole
+        //    capacity and let invocations past the count exit early
+        simulatePipeline->bind(cmd);
+        for (u32 i = 0; i < emitters.size(); i++) {
+            Emitter& emitter = emitters[i];
+
+            ParticlePushConstants push { getParamsAddress(frameIndex, i), emitter.aliveIndex, 0 };
+            cmd.pushConstants(computeLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(ParticlePushConstants), &push);
+            cmd.dispatch((emitter.settings.maxParticles + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE, 1, 1);
+
+            // Survivors now live in the other list
+            emitter.aliveIndex = 1 - emitter.aliveIndex;
+        }
+
+        // Draw list and instance count are consumed by the indirect draw
+        vk::MemoryBarrier2 drawBarrier {};
+        drawBarrier.srcStageMask = vk::PipelineStageFlagBits2::eComputeShader;
+        drawBarrier.srcAccessMask = vk::AccessFlagBits2::eShaderStorageWrite;
+        drawBarrier.dstStageMask = vk::PipelineStageFlagBits2::eDrawIndirect | vk::PipelineStageFlagBits2::eVertexShader;
+        drawBarrier.dstAccessMask = vk::AccessFlagBits2::eIndirectCommandRead | vk::AccessFlagBits2::eShaderStorageRead;
+        dependencyInfo.pMemoryBarriers = &drawBarrier;
+        cmd.pipelineBarrier2(dependencyInfo);
+        stats.barrierCount++;
+    }
+
+    // =========================================================================
+    // Rendering
+    // =========================================================================
+
+    void ParticleSystem::render(vk::CommandBuffer cmd, Image& colorTarget, Image& depthTarget, u32 frameIndex) {
+        if (!enabled || emitters.empty()) return;
+
+        vk::RenderingAttachmentInfo colorAttachment = graphics::attachmentInfo(colorTarget.imageView, nullptr,
+                                                                               vk::ImageLayout::eColorAttachmentOptimal);
+        // Keep the scene depth: particles are tested against it
+        vk::RenderingAttachmentInfo depthAttachment = graphics::depthAttachmentInfo(depthTarget.imageView,
+                                                                                    vk::ImageLayout::eDepthAttachmentOptimal);
+        depthAttachment.loadOp = vk::AttachmentLoadOp::eLoad;
+
+        const vk::Extent2D extent { colorTarget.imageExtent.width, colorTarget.imageExtent.height };
+        vk::RenderingInfo renderInfo = graphics::renderingInfo(vk::Rect2D { {0, 0}, extent }, &colorAttachment, &depthAttachment);
+        cmd.beginRendering(&renderInfo);
+
+        cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, renderPipeline->getPipeline());
+
+        vk::Viewport viewport { 0.0f, 0.0f, static_cast<f32>(extent.width), static_cast<f32>(extent.height), 0.0f, 1.0f };
+        cmd.setViewport(0, 1, &viewport);
+        vk::Rect2D scissor { {0, 0}, extent };
+        cmd.setScissor(0, 1, &scissor);
+
+        for (u32 i = 0; i < emitters.size(); i++) {
+            const Emitter& emitter = emitters[i];
+
+            ParticlePushConstants push { getParamsAddress(frameIndex, i), emitter.aliveIndex, 0 };
+            cmd.pushConstants(renderLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(ParticlePushConstants), &push);
+            cmd.drawIndirect(emitter.state.buffer, offsetof(GPUParticleState, draw), 1, sizeof(vk::DrawIndirectCommand));
+        }
+
+        cmd.endRendering();
+    }
+
+} // namespace graphics::techniques
@@ -0,0 +1,167 @@
+/**
+ * @file ParticleSystem.h
+ * @brief GPU-driven particle system (compute simulation + indirect draws).
+ */
+
+#pragma once
+
+#include "../Image.h"
+#include "../Buffer.h"
+#include "../MaterialPipeline.h"
+#include "../PipelineCompute.h"
+#include <chrono>
+
+namespace graphics {
+    class Renderer;
+    class VulkanContext;
+}
+
+namespace graphics::techniques {
+
+    /**
+     * @struct ParticleEmitterSettings
+     * @brief CPU-side description of one emitter type (dust, pollen, fireflies...).
+     *
+     * Everything here is sent to the GPU each frame, so it can be tweaked live.
+     * Only maxParticles is fixed at creation (it sizes the GPU buffers).
+     */
+    struct ParticleEmitterSettings {
+        str name { "Emitter" };
+        u32 maxParticles { 65536 };
+        f32 emitRate { 1000.0f };        ///< Particles spawned per second
+        Vec3 position { 0.0f };          ///< Center of the spawn box
+        Vec3 extents { 10.0f };          ///< Half size of the spawn box
+        Vec3 velocity { 0.0f };          ///< Initial velocity
+        f32 velocityJitter { 0.5f };     ///< Random velocity added on each axis
+        Vec3 gravity { 0.0f };           ///< Constant acceleration
+        f32 turbulence { 0.0f };         ///< Strength of the cheap swirl noise
+        f32 lifeMin { 2.0f };
+        f32 lifeMax { 5.0f };
+        f32 size { 0.1f };               ///< Billboard half size in world units
+        f32 flicker { 0.0f };            ///< 0 = steady, 1 = fully blinking (fireflies)
+        Vec4 colorStart { 1.0f };
+        Vec4 colorEnd { 1.0f, 1.0f, 1.0f, 0.0f };
+        bool enabled { true };
+
+        static ParticleEmitterSettings dust();
+        static ParticleEmitterSettings pollen();
+        static ParticleEmitterSettings fireflies();
+    };
+
+    /**
+     * @struct GPUParticleEmitterParams
+     * @brief Per-emitter, per-frame data read by the particle shaders (must match particles.glsl).
+     *
+     * Read through a buffer device address, like vertex buffers, so the particle
+     * pipelines don't need any descriptor set.
+     */
+    struct GPUParticleEmitterParams {
+        Mat4 viewProj;
+        Vec4 cameraRight;
+        Vec4 cameraUp;
+        Vec4 positionSize;       // xyz = spawn center, w = size
+        Vec4 extentsJitter;      // xyz = spawn half extents, w = velocity jitter
+        Vec4 velocityLifeMin;    // xyz = velocity, w = min life
+        Vec4 gravityLifeMax;     // xyz = gravity, w = max life
+        Vec4 colorStart;
+        Vec4 colorEnd;
+        u32 emitCount;
+        u32 maxParticles;
+        u32 randomSeed;
+        f32 deltaTime;
+        f32 turbulence;
+        f32 flicker;
+        u32 padding[2];
+        vk::DeviceAddress particles;
+        vk::DeviceAddress deadList;
+        vk::DeviceAddress aliveList0;
+        vk::DeviceAddress aliveList1;
+        vk::DeviceAddress drawList;
+        vk::DeviceAddress state;
+    };
+    static_assert(sizeof(GPUParticleEmitterParams) % 16 == 0, "Emitter params are addressed with a 16 bytes stride");
+
+    /**
+     * @class ParticleSystem
+     * @brief Simulates and draws particles entirely on the GPU.
+     *
+     * ## Why on the GPU?
+     * Pushing every particle through the DrawContext as a RenderObject would cost one
+     * draw call and CPU work per particle. Here the CPU only uploads a few hundred bytes
+     * per emitter; compute shaders do the rest and the draw count comes from the GPU.
+     *
+     * ## Persistent buffers per emitter
+     * - **particles**: position/life and velocity/max life of every slot
+     * - **dead list**: indices of free slots (a stack)
+     * - **alive lists**: two lists used in ping-pong, last frame's survivors -> this frame's
+     * - **draw list**: alive AND inside the camera frustum, read by the vertex shader
+     * - **state**: counters + VkDrawIndirectCommand (instanceCount written by the GPU)
+     *
+     * ## Each frame
+     * 1. **Reset**: clear the output alive counter and the indirect instance count
+     * 2. **Emit**: pop slots from the dead list, initialize them, append to the alive list
+     * 3. **Simulate**: integrate, push dead particles back to the dead list, compact
+     *    survivors into the other alive list, frustum cull them into the draw list
+     * 4. **Draw**: one vkCmdDrawIndirect per emitter, 6 vertices per instance (a billboard)
+     *
+     * ## Blending
+     * Particles use additive blending. Addition is commutative, so the result is
+     * order-independent and no sorting pass is needed.
+     */
+    class ParticleSystem {
+    public:
+        static constexpr u32 MAX_EMITTERS = 8;
+
+        void init(Renderer* renderer);
+        void cleanup(vk::Device device);
+
+        /// Creates the GPU buffers of a new emitter. Returns its index, or -1 when full
+        i32 addEmitter(const ParticleEmitterSettings& settings);
+        ParticleEmitterSettings& getEmitterSettings(u32 index) { return emitters[index].settings; }
+        u32 getEmitterCount() const { return static_cast<u32>(emitters.size()); }
+
+        /// Records emit + simulate compute dispatches. Call before the scene is rendered.
+        void update(vk::CommandBuffer cmd, const GPUSceneData& sceneData, u32 frameIndex);
+
+        /// Draws the particles on top of the scene, depth tested against the scene depth
+        void render(vk::CommandBuffer cmd, Image& colorTarget, Image& depthTarget, u32 frameIndex);
+
+        bool isEnabled() const { return enabled; }
+        void setEnabled(bool enable) { enabled = enable; }
+
+    private:
+        struct Emitter {
+            ParticleEmitterSettings settings;
+            Buffer particles;
+            Buffer deadList;
+            Buffer aliveLists[2];
+            Buffer drawList;
+            Buffer state;
+            f32 emitAccumulator { 0.0f };   ///< Fractional particles carried to the next frame
+            u32 emitCount { 0 };            ///< Particles requested this frame
+            u32 aliveIndex { 0 };           ///< Which alive list holds last frame's survivors
+        };
+
+        void createPipelines();
+        void fillParams(const GPUSceneData& sceneData, u32 frameIndex, f32 deltaTime);
+        vk::DeviceAddress getParamsAddress(u32 frameIndex, u32 emitterIndex) const;
+
+        Renderer* renderer { nullptr };
+        VulkanContext* context { nullptr };
+        bool enabled { false };
+
+        vector<Emitter> emitters;
+        Buffer paramsBuffers[FRAME_OVERLAP];   ///< MAX_EMITTERS params slots, one buffer per frame in flight
+        vk::DeviceAddress paramsAddresses[FRAME_OVERLAP] {};
+
+        vk::PipelineLayout computeLayout { nullptr };
+        vk::PipelineLayout renderLayout { nullptr };
+        uptr<PipelineCompute> emitPipeline;
+        uptr<PipelineCompute> simulatePipeline;
+        uptr<MaterialPipeline> renderPipeline;
+
+        u32 frameCounter { 0 };
+        std::chrono::steady_clock::time_point lastUpdate;
+    };
+
+} // namespace graphics::techniques
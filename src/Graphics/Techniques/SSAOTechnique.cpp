@@ -54,7 +54,7 @@ namespace graphics::techniques {
 
         // Create SSAO params buffer
         ssaoParamsBuffer = Buffer(context, sizeof(SSAOParamsUBO),
-            vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU);
+            vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU, MemoryCategory::Uniform, "SSAO params");
 
         createImages();
         createNoiseTexture();
@@ -89,13 +89,14 @@ namespace graphics::techniques {
         device.destroyPipelineLayout(compositeLayout);
     }
 
-    void SSAOTechnique::resize(uint32_t newWidth, uint32_t newHeight) {
+    void SSAOTechnique::resize(uint32_t newWidth, uint32_t newHeight, DeletionQueue& retired) {
         if (width == newWidth && height == newHeight) return;
 
         width = newWidth;
         height = newHeight;
 
-        destroyImages();
+        ssaoImage.retire(context, retired);
+        ssaoBlurImage.retire(context, retired);
         createImages();
     }
 
@@ -107,8 +108,8 @@ namespace graphics::techniques {
         vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eColorAttachment |
                                     vk::ImageUsageFlagBits::eSampled;
 
-        ssaoImage = Image(context, extent, format, usage);
-        ssaoBlurImage = Image(context, extent, format, usage);
+        ssaoImage = Image(context, extent, format, usage, false, MemoryCategory::RenderTarget, "SSAO");
+        ssaoBlurImage = Image(context, extent, format, usage, false, MemoryCategory::RenderTarget, "SSAO blur");
     }
 
     void SSAOTechnique::destroyImages() {
@@ -139,7 +140,7 @@ namespace graphics::techniques {
                                     vk::ImageUsageFlagBits::eTransferDst;
 
         noiseImage = Image(context, *renderer->getImmediateSubmitter(),
-                          noiseData.data(), noiseExtent, format, usage, false);
+                          noiseData.data(), noiseExtent, format, usage, false, MemoryCategory::Texture, "SSAO noise");
     }
 
     void SSAOTechnique::createKernel() {
@@ -169,7 +170,7 @@ namespace graphics::techniques {
 
         // Create kernel buffer
         kernelBuffer = Buffer(context, kernel.size() * sizeof(glm::vec4),
-            vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU);
+            vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU, MemoryCategory::Uniform, "SSAO kernel");
 
         // Upload kernel data
         void* data;
@@ -8,6 +8,7 @@
 namespace graphics {
     class Renderer;
     class VulkanContext;
+    class DeletionQueue;
 }
 
 namespace graphics::techniques {
@@ -29,7 +30,8 @@ namespace graphics::techniques {
     public:
         void init(Renderer* renderer, uint32_t width, uint32_t height);
         void cleanup(vk::Device device);
-        void resize(uint32_t width, uint32_t height);
+        // Old images go to retired: frames in flight may still sample them
+        void resize(uint32_t width, uint32_t height, DeletionQueue& retired);
 
         // Apply SSAO to input image using G-Buffer data
         // Reads from inputImage (scene color), positionImage, normalImage
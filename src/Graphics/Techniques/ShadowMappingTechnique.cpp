@@ -1,52 +1,18 @@
 #include "ShadowMappingTechnique.h"
 
 #include "../Renderer.h"
+#include "../Culling.h"
 #include "../DescriptorLayoutBuilder.hpp"
 #include "../DescriptorWriter.h"
 #include "../PipelineBuilder.h"
 #include "../Utils.hpp"
 #include "../VulkanInit.hpp"
 #include "BasicServices/File.h"
+#include "BasicServices/Profiler.h"
 #include "BasicServices/RenderingStats.h"
 
 namespace graphics::techniques {
 
-    namespace {
-        bool isVisible(const RenderObject& obj, const Mat4& viewProj) {
-            std::array<Vec3, 8> corners {
-                Vec3 { 1, 1, 1 },
-                Vec3 { 1, 1, -1 },
-                Vec3 { 1, -1, 1 },
-                Vec3 { 1, -1, -1 },
-                Vec3 { -1, 1, 1 },
-                Vec3 { -1, 1, -1 },
-                Vec3 { -1, -1, 1 },
-                Vec3 { -1, -1, -1 },
-            };
-
-            Mat4 matrix = viewProj * obj.transform;
-
-            Vec3 min = { 1.5f, 1.5f, 1.5f };
-            Vec3 max = { -1.5f, -1.5f, -1.5f };
-
-            for (int c = 0; c < 8; c++) {
-                Vec4 v = matrix * Vec4(obj.bounds.origin + (corners[c] * obj.bounds.extents), 1.f);
-
-                v.x = v.x / v.w;
-                v.y = v.y / v.w;
-                v.z = v.z / v.w;
-
-                min = glm::min(Vec3{ v.x, v.y, v.z }, min);
-                max = glm::max(Vec3{ v.x, v.y, v.z }, max);
-            }
-
-            if (min.z > 1.f || max.z < 0.f || min.x > 1.f || max.x < -1.f || min.y > 1.f || max.y < -1.f) {
-                return false;
-            }
-            return true;
-        }
-    }
-
     void ShadowMappingTechnique::init(Renderer* renderer) {
         this->renderer = renderer;
         vk::Device device = renderer->getContext()->getDevice();
@@ -102,7 +68,9 @@ namespace graphics::techniques {
         }
 
         depthPipeline.reset();
-        shadowMeshPipeline.reset();
+        for (auto& pipeline : shadowMeshPipelines) {
+            pipeline.reset();
+        }
         gBufferPipeline.reset();
         debugPipeline.reset();
     }
@@ -110,7 +78,7 @@ namespace graphics::techniques {
     void ShadowMappingTechnique::buildDepthPipeline(vk::Device device) {
         vk::PushConstantRange matrixRange{};
         matrixRange.offset = 0;
-        matrixRange.size = sizeof(GraphicsPushConstants);
+        matrixRange.size = sizeof(DepthPushConstants);
         matrixRange.stageFlags = vk::ShaderStageFlagBits::eVertex;
 
         const vk::DescriptorSetLayout layouts[] = { renderer->getSceneDataDescriptorLayout() };
@@ -191,7 +159,12 @@ namespace graphics::techniques {
 
         builder.pipelineLayout = shadowMeshPipelineLayout;
 
-        shadowMeshPipeline = builder.buildPipeline(device);
+        // One variant per PCF kernel so the filter can be switched without rebuilding
+        for (u32 i = 0; i < static_cast<u32>(ShadowFilter::Count); i++) {
+            const ShadowFilterSpecialization specialization { static_cast<ShadowFilter>(i) };
+            builder.setFragmentSpecialization(specialization.get());
+            shadowMeshPipelines[i] = builder.buildPipeline(device);
+        }
 
         builder.destroyShaderModules(device);
     }
@@ -238,12 +211,21 @@ namespace graphics::techniques {
         stats.drawcallCount = 0;
         stats.triangleCount = 0;
 
-        auto start = std::chrono::system_clock::now();
+        PROFILE_FUNCTION();
+        const u64 start = services::Profiler::now();
 
-        renderShadowPass(cmd, drawContext, sceneData, frameDescriptors);
+        GpuProfiler& profiler = renderer->getGpuProfiler();
+        {
+            const u64 shadowPixels = static_cast<u64>(shadowMap->getResolution()) * shadowMap->getResolution();
+            GpuScope scope(profiler, cmd, "Shadow", shadowPixels);
+            renderShadowPass(cmd, drawContext, sceneData, frameDescriptors);
+        }
 
         // Render G-Buffer pass for SSAO support
-        renderGBufferPass(cmd, drawContext, sceneData, frameDescriptors);
+        {
+            GpuScope scope(profiler, cmd, "G-Buffer");
+            renderGBufferPass(cmd, drawContext, sceneData, frameDescriptors);
+        }
 
         // Render to Renderer's sceneImage for post-processing
         Image& sceneImage = renderer->getSceneImage();
@@ -257,32 +239,38 @@ namespace graphics::techniques {
         const auto imageExtent = sceneImage.imageExtent;
         const vk::Rect2D rect{ vk::Offset2D{0, 0}, {imageExtent.width, imageExtent.height} };
         const vk::RenderingInfo renderInfo = graphics::renderingInfo(rect, &colorAttachment, &depthAttachment);
+        const u32 lightingScope = profiler.beginScope(cmd, "Lighting");
         cmd.beginRendering(&renderInfo);
 
-        vk::DescriptorSet shadowSceneDescriptor = frameDescriptors.allocate(shadowSceneDataLayout);
-        {
-            DescriptorWriter writer;
-            writer.writeBuffer(0, renderer->getSceneDataBuffer().buffer, sizeof(GPUSceneData), 0, vk::DescriptorType::eUniformBuffer);
-            writer.writeImage(1, shadowMap->getImage().imageView, shadowMap->getSampler(),
-                vk::ImageLayout::eShaderReadOnlyOptimal, vk::DescriptorType::eCombinedImageSampler);
-            writer.updateSet(renderer->getContext()->getDevice(), shadowSceneDescriptor);
-        }
+        // The shadow map is shared, each view lights its own rectangle with its own scene data slot
+        for (const ViewDraws& view : renderer->getFrameViews().getViews()) {
+            vk::DescriptorSet shadowSceneDescriptor = frameDescriptors.allocate(shadowSceneDataLayout);
+            {
+                DescriptorWriter writer;
+                writer.writeBuffer(0, renderer->getSceneDataBuffer().buffer, sizeof(GPUSceneData), view.sceneDataOffset, vk::DescriptorType::eUniformBuffer);
+                // The debug view reads raw depth, lighting goes through the comparison sampler
+                const vk::Sampler shadowSampler = displayShadowMap ? shadowMap->getSampler() : shadowMap->getCompareSampler();
+                writer.writeImage(1, shadowMap->getImage().imageView, shadowSampler,
+                    vk::ImageLayout::eShaderReadOnlyOptimal, vk::DescriptorType::eCombinedImageSampler);
+                writer.updateSet(renderer->getContext()->getDevice(), shadowSceneDescriptor);
+            }
 
-        if (displayShadowMap) {
-            renderDebugView(cmd, shadowSceneDescriptor);
-        } else {
-            renderShadowGeometry(cmd, drawContext, sceneData, shadowSceneDescriptor);
+            // The debug view covers the whole image: main view only
+            if (displayShadowMap) {
+                renderDebugView(cmd, shadowSceneDescriptor);
+                break;
+            }
+            renderShadowGeometry(cmd, drawContext, view, shadowSceneDescriptor);
         }
 
         cmd.endRendering();
+        profiler.endScope(cmd, lightingScope);
 
         // Transition G-Buffer to shader read for SSAO
         graphics::transitionImage(cmd, gBuffer.position.image, vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
         graphics::transitionImage(cmd, gBuffer.normal.image, vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
 
-        auto end = std::chrono::system_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        stats.meshDrawTime = elapsed.count() / 1000.f;
+        stats.meshDrawTime = services::Profiler::toMilliseconds(services::Profiler::now() - start);
     }
 
     void ShadowMappingTechnique::renderShadowPass(
@@ -338,18 +326,34 @@ namespace graphics::techniques {
         cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
             depthPipelineLayout, 0, 1, &sceneDescriptor, 0, nullptr);
 
-        for (auto& r : drawContext.opaqueSurfaces) {
-            if (isVisible(r, sceneData.lightSpaceMatrix)) {
-                GraphicsPushConstants pushConstants{};
-                pushConstants.vertexBuffer = r.vertexBufferAddress;
-                pushConstants.worldMatrix = r.transform;
+        auto& stats = services::RenderingStats::Instance();
+        stats.shadowDrawcallCount = 0;
+        stats.shadowCasterCulledCount = 0;
 
-                cmd.pushConstants(depthPipelineLayout,
-                    vk::ShaderStageFlagBits::eVertex, 0, sizeof(GraphicsPushConstants), &pushConstants);
+        const bool casterCulling = renderer->isShadowCasterCullingEnabled();
+        const std::span<const ShadowCasterVolume> casterVolumes = renderer->getShadowCasterVolumes();
 
-                cmd.bindIndexBuffer(r.indexBuffer, 0, vk::IndexType::eUint32);
-                cmd.drawIndexed(r.indexCount, 1, r.firstIndex, 0, 0);
+        for (auto& r : drawContext.opaqueSurfaces) {
+            if (!isVisible(r, sceneData.lightSpaceMatrix)) continue;
+
+            // Inside the light frustum, but its shadow may still fall outside every view
+            if (casterCulling && !castsVisibleShadow(casterVolumes, r)) {
+                stats.shadowCasterCulledCount++;
+                continue;
             }
+
+            // Depth only needs positions: use the packed stream when the mesh has one
+            DepthPushConstants pushConstants{};
+            pushConstants.worldMatrix = r.transform;
+            pushConstants.positionBuffer = r.positionBufferAddress ? r.positionBufferAddress : r.vertexBufferAddress;
+            pushConstants.positionStride = r.positionBufferAddress ? PACKED_POSITION_STRIDE : VERTEX_POSITION_STRIDE;
+
+            cmd.pushConstants(depthPipelineLayout,
+                vk::ShaderStageFlagBits::eVertex, 0, sizeof(DepthPushConstants), &pushConstants);
+
+            cmd.bindIndexBuffer(r.indexBuffer, 0, vk::IndexType::eUint32);
+            cmd.drawIndexed(r.indexCount, 1, r.firstIndex, 0, 0);
+            stats.shadowDrawcallCount++;
         }
 
         cmd.endRendering();
@@ -361,7 +365,7 @@ namespace graphics::techniques {
     void ShadowMappingTechnique::renderShadowGeometry(
         vk::CommandBuffer cmd,
         const DrawContext& drawContext,
-        const GPUSceneData& sceneData,
+        const ViewDraws& view,
         vk::DescriptorSet sceneDescriptor
     ) {
         auto& stats = services::RenderingStats::Instance();
@@ -369,39 +373,14 @@ namespace graphics::techniques {
         lastMaterial = nullptr;
         lastIndexBuffer = nullptr;
 
-        std::vector<u32> opaqueDraws;
-        opaqueDraws.reserve(drawContext.opaqueSurfaces.size());
-        for (uint32_t i = 0; i < drawContext.opaqueSurfaces.size(); i++) {
-            if (isVisible(drawContext.opaqueSurfaces[i], sceneData.viewProj)) {
-                opaqueDraws.push_back(i);
-            }
-        }
+        // Culled and sorted by material for every view at once, see FrameViews
+        shadowMeshPipelines[static_cast<u32>(shadowFilter)]->bind(cmd);
 
-        std::ranges::sort(opaqueDraws, [&](const auto& iA, const auto& iB) {
-            const RenderObject& A = drawContext.opaqueSurfaces[iA];
-            const RenderObject& B = drawContext.opaqueSurfaces[iB];
-            if (A.material == B.material) {
-                return A.indexBuffer < B.indexBuffer;
-            }
-            return A.material < B.material;
-        });
-
-        shadowMeshPipeline->bind(cmd);
-
-        const auto imageExtent = renderer->getSceneImage().imageExtent;
-        vk::Viewport viewport{};
-        viewport.x = 0;
-        viewport.y = 0;
-        viewport.width = static_cast<float>(imageExtent.width);
-        viewport.height = static_cast<float>(imageExtent.height);
-        viewport.minDepth = 0.f;
-        viewport.maxDepth = 1.f;
+        const vk::Viewport viewport = view.getViewport();
         cmd.setViewport(0, 1, &viewport);
+        cmd.setScissor(0, 1, &view.rect);
 
-        vk::Rect2D scissor{{0, 0}, {imageExtent.width, imageExtent.height}};
-        cmd.setScissor(0, 1, &scissor);
-
-        for (auto& idx : opaqueDraws) {
+        for (auto& idx : view.opaque) {
             const RenderObject& r = drawContext.opaqueSurfaces[idx];
 
             if (r.material != lastMaterial) {
@@ -452,6 +431,13 @@ namespace graphics::techniques {
         cmd.draw(3, 1, 0, 0);
     }
 
+    void ShadowMappingTechnique::resize(vk::Extent3D extent, DeletionQueue& retired) {
+        if (gBuffer.extent == extent) return;
+
+        gBuffer.retire(renderer->getContext(), retired);
+        gBuffer.init(renderer->getContext(), extent);
+    }
+
     void ShadowMappingTechnique::createGBuffer() {
         auto extent = renderer->getContext()->getDrawImage().imageExtent;
         gBuffer.init(renderer->getContext(), extent);
@@ -517,34 +503,37 @@ namespace graphics::techniques {
 
         cmd.beginRendering(&renderInfo);
 
-        vk::Viewport viewport(0, 0, (float)gBuffer.extent.width, (float)gBuffer.extent.height, 0, 1);
-        cmd.setViewport(0, 1, &viewport);
-        vk::Rect2D scissor({0, 0}, {gBuffer.extent.width, gBuffer.extent.height});
-        cmd.setScissor(0, 1, &scissor);
-
         // Bind G-Buffer pipeline
         cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, gBufferPipeline->getPipeline());
 
-        // Bind Scene Data
-        vk::DescriptorSet sceneDescriptor = frameDescriptors.allocate(renderer->getSceneDataDescriptorLayout());
-        {
-            DescriptorWriter writer;
-            writer.writeBuffer(0, renderer->getSceneDataBuffer().buffer, sizeof(GPUSceneData), 0, vk::DescriptorType::eUniformBuffer);
-            writer.updateSet(renderer->getContext()->getDevice(), sceneDescriptor);
-        }
-        cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, gBufferPipelineLayout, 0, 1, &sceneDescriptor, 0, nullptr);
+        // Each view fills its rectangle with its visible surfaces. SSAO samples them with the main projection
+        for (const ViewDraws& view : renderer->getFrameViews().getViews()) {
+            const vk::Viewport viewport = view.getViewport();
+            cmd.setViewport(0, 1, &viewport);
+            cmd.setScissor(0, 1, &view.rect);
+
+            // Bind Scene Data
+            vk::DescriptorSet sceneDescriptor = frameDescriptors.allocate(renderer->getSceneDataDescriptorLayout());
+            {
+                DescriptorWriter writer;
+                writer.writeBuffer(0, renderer->getSceneDataBuffer().buffer, sizeof(GPUSceneData), view.sceneDataOffset, vk::DescriptorType::eUniformBuffer);
+                writer.updateSet(renderer->getContext()->getDevice(), sceneDescriptor);
+            }
+            cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, gBufferPipelineLayout, 0, 1, &sceneDescriptor, 0, nullptr);
 
-        // Draw opaque surfaces
-        for (const auto& r : drawContext.opaqueSurfaces) {
-            cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, gBufferPipelineLayout, 1, 1, &r.material->materialSet, 0, nullptr);
-            cmd.bindIndexBuffer(r.indexBuffer, 0, vk::IndexType::eUint32);
+            // Draw opaque surfaces
+            for (const u32 idx : view.opaque) {
+                const RenderObject& r = drawContext.opaqueSurfaces[idx];
+                cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, gBufferPipelineLayout, 1, 1, &r.material->materialSet, 0, nullptr);
+                cmd.bindIndexBuffer(r.indexBuffer, 0, vk::IndexType::eUint32);
 
-            GraphicsPushConstants pushConstants;
-            pushConstants.vertexBuffer = r.vertexBufferAddress;
-            pushConstants.worldMatrix = r.transform;
-            cmd.pushConstants(gBufferPipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(GraphicsPushConstants), &pushConstants);
+                GraphicsPushConstants pushConstants;
+                pushConstants.vertexBuffer = r.vertexBufferAddress;
+                pushConstants.worldMatrix = r.transform;
+                cmd.pushConstants(gBufferPipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(GraphicsPushConstants), &pushConstants);
 
-            cmd.drawIndexed(r.indexCount, 1, r.firstIndex, 0, 0);
+                cmd.drawIndexed(r.indexCount, 1, r.firstIndex, 0, 0);
+            }
         }
 
         cmd.endRendering();
@@ -4,6 +4,7 @@
 #include "GBuffer.h"
 #include "../MaterialPipeline.h"
 #include "../DescriptorAllocatorGrowable.h"
+#include "../RenderView.h"
 #include "../ShadowMap.h"
 
 namespace graphics::techniques {
@@ -19,6 +20,7 @@ namespace graphics::techniques {
             const GPUSceneData& sceneData,
             DescriptorAllocatorGrowable& frameDescriptors
         ) override;
+        void resize(vk::Extent3D extent, DeletionQueue& retired) override;
 
         bool requiresShadowPass() const override { return true; }
         const TechniqueType getTechnique() const override { return TechniqueType::ShadowMapping; }
@@ -33,6 +35,9 @@ namespace graphics::techniques {
         void setEnablePCF(bool enable) { enablePCF = enable; }
         bool isPCFEnabled() const { return enablePCF; }
 
+        void setShadowFilter(ShadowFilter filter) { shadowFilter = filter; }
+        ShadowFilter getShadowFilter() const { return shadowFilter; }
+
         // G-Buffer access for SSAO
         GBuffer& getGBuffer() { return gBuffer; }
         const GBuffer& getGBuffer() const { return gBuffer; }
@@ -46,7 +51,7 @@ namespace graphics::techniques {
 
         void renderShadowPass(vk::CommandBuffer cmd, const DrawContext& drawContext, const GPUSceneData& sceneData, DescriptorAllocatorGrowable& frameDescriptors);
         void renderGBufferPass(vk::CommandBuffer cmd, const DrawContext& drawContext, const GPUSceneData& sceneData, DescriptorAllocatorGrowable& frameDescriptors);
-        void renderShadowGeometry(vk::CommandBuffer cmd, const DrawContext& drawContext, const GPUSceneData& sceneData, vk::DescriptorSet sceneDescriptor);
+        void renderShadowGeometry(vk::CommandBuffer cmd, const DrawContext& drawContext, const ViewDraws& view, vk::DescriptorSet sceneDescriptor);
         void renderDebugView(vk::CommandBuffer cmd, vk::DescriptorSet sceneDescriptor);
 
         Renderer* renderer { nullptr };
@@ -55,7 +60,7 @@ namespace graphics::techniques {
         GBuffer gBuffer;  // For SSAO support
 
         uptr<MaterialPipeline> depthPipeline;
-        uptr<MaterialPipeline> shadowMeshPipeline;
+        uptr<MaterialPipeline> shadowMeshPipelines[static_cast<u32>(ShadowFilter::Count)];  // One per PCF kernel
         uptr<MaterialPipeline> gBufferPipeline;  // G-Buffer generation pipeline
         uptr<MaterialPipeline> debugPipeline;
 
@@ -68,6 +73,7 @@ namespace graphics::techniques {
 
         bool displayShadowMap { false };
         bool enablePCF { true };
+        ShadowFilter shadowFilter { ShadowFilter::Optimized };
 
         MaterialInstance* lastMaterial { nullptr };
         vk::Buffer lastIndexBuffer { nullptr };
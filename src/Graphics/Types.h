@@ -56,6 +56,44 @@ namespace graphics
         vk::DeviceAddress vertexBuffer;
     };
 
+    /// Floats between two positions in a mesh's packed position stream
+    static constexpr u32 PACKED_POSITION_STRIDE = 3;
+    /// Floats between two positions read straight from a Vertex buffer (position is its first member)
+    static constexpr u32 VERTEX_POSITION_STRIDE = sizeof(Vertex) / sizeof(f32);
+
+    /**
+     * Push constants of depth-only passes (shadow map), which only need positions.
+     * positionBuffer is the mesh's packed position stream when it has one, otherwise
+     * its Vertex buffer read with VERTEX_POSITION_STRIDE (e.g. skinned, posed meshes).
+     */
+    struct DepthPushConstants
+    {
+        Mat4 worldMatrix;
+        vk::DeviceAddress positionBuffer;
+        u32 positionStride;
+        u32 padding;
+    };
+
+    /**
+     * Per-vertex skinning influences, stored in a buffer parallel to the vertex buffer.
+     * Kept separate from Vertex so static meshes don't pay for it.
+     */
+    struct SkinVertex
+    {
+        glm::uvec4 joints;   // Indices into the skin's joint palette
+        glm::vec4 weights;   // Matching weights, sum to 1 (all 0 = not skinned)
+    };
+
+    struct SkinningPushConstants
+    {
+        vk::DeviceAddress sourceVertices;  // Bind pose Vertex[]
+        vk::DeviceAddress skinData;        // SkinVertex[]
+        vk::DeviceAddress jointMatrices;   // Mat4[] palette for this frame
+        vk::DeviceAddress posedVertices;   // Output Vertex[]
+        u32 vertexCount;
+        u32 firstJoint;                    // Offset of this mesh's palette in jointMatrices
+    };
+
     struct GPUSceneData {
         Mat4 view;
         Mat4 proj;
@@ -67,6 +105,13 @@ namespace graphics
         Vec4 shadowParams;      // x=zNear, y=zFar, z=enablePCF, w=shadowBias
     };
 
+    /**
+     * FRAME_OVERLAP determines how many frames can be "in flight" simultaneously.
+     * With 2, CPU can prepare frame N+1 while GPU renders frame N.
+     * Anything written by the CPU or GPU every frame needs this many copies.
+     */
+    static constexpr int FRAME_OVERLAP = 2;
+
     // Point light for deferred rendering
     struct PointLight {
         Vec4 position;   // xyz = position, w = unused
@@ -0,0 +1,190 @@
+/**
+ * @file UploadBatch.cpp
+ * @brief Implementation of the batched CPU to GPU uploads.
+ */
+
+#include "UploadBatch.h"
+
+#include "Image.h"
+#include "Utils.hpp"
+#include "VulkanContext.h"
+#include "VulkanInit.hpp"
+#include "../BasicServices/Profiler.h"
+#include <algorithm>
+
+namespace graphics {
+
+    namespace {
+        // Buffer to image copies need offsets multiple of the texel size and of 4
+        constexpr vk::DeviceSize COPY_ALIGNMENT = 16;
+
+        vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    UploadBatch::UploadBatch(VulkanContext* context, ImmediateSubmitter& submitter, vk::DeviceSize budget)
+        : context(context), submitter(submitter), budget(std::max(budget, CHUNK_SIZE)) {
+    }
+
+    UploadBatch::~UploadBatch() {
+        flush();
+    }
+
+    void* UploadBatch::addBufferCopy(vk::Buffer dst, vk::DeviceSize size, vk::DeviceSize dstOffset) {
+        BufferCopy copy;
+        vk::DeviceSize srcOffset = 0;
+        void* data = allocate(size, copy.chunk, srcOffset);
+        copy.dst = dst;
+        copy.region.srcOffset = srcOffset;
+        copy.region.dstOffset = dstOffset;
+        copy.region.size = size;
+        bufferCopies.push_back(copy);
+        stats.bufferCopies++;
+        return data;
+    }
+
+    void* UploadBatch::addImageCopy(const Image& image, vk::DeviceSize size, bool generateMipmaps) {
+        ImageCopy copy;
+        void* data = allocate(size, copy.chunk, copy.srcOffset);
+        copy.image = image.image;
+        copy.extent = image.imageExtent;
+        copy.generateMipmaps = generateMipmaps;
+        imageCopies.push_back(std::move(copy));
+        stats.imageCopies++;
+        return data;
+    }
+
+    void* UploadBatch::addImageCopy(const Image& image, vk::DeviceSize size, std::span<const size_t> mipOffsets) {
+        ImageCopy copy;
+        void* data = allocate(size, copy.chunk, copy.srcOffset);
+        copy.image = image.image;
+        copy.extent = image.imageExtent;
+        copy.mipOffsets.assign(mipOffsets.begin(), mipOffsets.end());
+        imageCopies.push_back(std::move(copy));
+        stats.imageCopies++;
+        return data;
+    }
+
+    void* UploadBatch::allocate(vk::DeviceSize size, u32& chunk, vk::DeviceSize& offset) {
+        if (stagedBytes > 0 && stagedBytes + size > budget) {
+            flush();
+        }
+
+        offset = alignUp(chunkUsed, COPY_ALIGNMENT);
+        if (chunks.empty() || offset + size > chunks.back().size) {
+            // Larger copies get a chunk of their own
+            chunks.emplace_back(context, std::max(size, CHUNK_SIZE), vk::BufferUsageFlagBits::eTransferSrc,
+                VMA_MEMORY_USAGE_CPU_ONLY, MemoryCategory::Staging, "Upload batch");
+            offset = 0;
+        }
+
+        chunk = static_cast<u32>(chunks.size() - 1);
+        chunkUsed = offset + size;
+        stagedBytes += size;
+        stats.bytes += size;
+        return static_cast<u8*>(chunks.back().info.pMappedData) + offset;
+    }
+
+    void UploadBatch::flush() {
+        if (isEmpty()) {
+            chunks.clear();
+            chunkUsed = 0;
+            stagedBytes = 0;
+            return;
+        }
+
+        PROFILE_FUNCTION();
+        const u64 start = services::Profiler::now();
+
+        submitter.immediateSubmit(context, [this](vk::CommandBuffer cmd) {
+            // Every image to transfer in one barrier: their previous content is discarded
+            vector<vk::ImageMemoryBarrier2> imageBarriers;
+            imageBarriers.reserve(imageCopies.size());
+            for (const ImageCopy& copy : imageCopies) {
+                vk::ImageMemoryBarrier2& barrier = imageBarriers.emplace_back();
+                barrier.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+                barrier.srcAccessMask = vk::AccessFlagBits2::eNone;
+                barrier.dstStageMask = vk::PipelineStageFlagBits2::eCopy;
+                barrier.dstAccessMask = vk::AccessFlagBits2::eTransferWrite;
+                barrier.oldLayout = vk::ImageLayout::eUndefined;
+                barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+                barrier.subresourceRange = imageSubresourceRange(vk::ImageAspectFlagBits::eColor);
+                barrier.image = copy.image;
+            }
+            if (!imageBarriers.empty()) {
+                vk::DependencyInfo dependencyInfo {};
+                dependencyInfo.imageMemoryBarrierCount = static_cast<u32>(imageBarriers.size());
+                dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+                cmd.pipelineBarrier2(dependencyInfo);
+            }
+
+            for (const BufferCopy& copy : bufferCopies) {
+                cmd.copyBuffer(chunks[copy.chunk].buffer, copy.dst, 1, &copy.region);
+            }
+
+            vector<vk::BufferImageCopy> regions;
+            for (const ImageCopy& copy : imageCopies) {
+                regions.clear();
+                const u32 levels = copy.mipOffsets.empty() ? 1 : static_cast<u32>(copy.mipOffsets.size());
+                for (u32 mip = 0; mip < levels; mip++) {
+                    vk::BufferImageCopy& region = regions.emplace_back();
+                    region.bufferOffset = copy.srcOffset + (copy.mipOffsets.empty() ? 0 : copy.mipOffsets[mip]);
+                    region.bufferRowLength = 0;     // Tightly packed
+                    region.bufferImageHeight = 0;
+                    region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+                    region.imageSubresource.mipLevel = mip;
+                    region.imageSubresource.baseArrayLayer = 0;
+                    region.imageSubresource.layerCount = 1;
+                    region.imageExtent = vk::Extent3D { std::max(1u, copy.extent.width >> mip), std::max(1u, copy.extent.height >> mip), 1 };
+                }
+                cmd.copyBufferToImage(chunks[copy.chunk].buffer, copy.image, vk::ImageLayout::eTransferDstOptimal,
+                    static_cast<u32>(regions.size()), regions.data());
+            }
+
+            // Then to shader reads, blitting the mip chain first where asked
+            imageBarriers.clear();
+            for (const ImageCopy& copy : imageCopies) {
+                if (copy.generateMipmaps) {
+                    generateMipmaps(cmd, copy.image, vk::Extent2D { copy.extent.width, copy.extent.height });
+                    continue;
+                }
+                vk::ImageMemoryBarrier2& barrier = imageBarriers.emplace_back();
+                barrier.srcStageMask = vk::PipelineStageFlagBits2::eCopy;
+                barrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+                barrier.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+                barrier.dstAccessMask = vk::AccessFlagBits2::eMemoryRead;
+                barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+                barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+                barrier.subresourceRange = imageSubresourceRange(vk::ImageAspectFlagBits::eColor);
+                barrier.image = copy.image;
+            }
+
+            // Buffers are read through device addresses, index and vertex fetches: no narrower stage
+            vk::MemoryBarrier2 bufferBarrier {};
+            bufferBarrier.srcStageMask = vk::PipelineStageFlagBits2::eCopy;
+            bufferBarrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+            bufferBarrier.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+            bufferBarrier.dstAccessMask = vk::AccessFlagBits2::eMemoryRead;
+
+            vk::DependencyInfo dependencyInfo {};
+            dependencyInfo.memoryBarrierCount = bufferCopies.empty() ? 0 : 1;
+            dependencyInfo.pMemoryBarriers = &bufferBarrier;
+            dependencyInfo.imageMemoryBarrierCount = static_cast<u32>(imageBarriers.size());
+            dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+            if (dependencyInfo.memoryBarrierCount > 0 || dependencyInfo.imageMemoryBarrierCount > 0) {
+                cmd.pipelineBarrier2(dependencyInfo);
+            }
+        });
+
+        // The GPU is done with the staging memory
+        bufferCopies.clear();
+        imageCopies.clear();
+        chunks.clear();
+        chunkUsed = 0;
+        stagedBytes = 0;
+        stats.submits++;
+        stats.submitMs += services::Profiler::toMilliseconds(services::Profiler::now() - start);
+    }
+
+} // namespace graphics
@@ -0,0 +1,109 @@
+/**
+ * @file UploadBatch.h
+ * @brief Many CPU to GPU copies sent in a single immediate submit.
+ */
+
+#pragma once
+
+#include "Buffer.h"
+#include "Types.h"
+#include <span>
+
+namespace graphics {
+    class VulkanContext;
+    class ImmediateSubmitter;
+    class Image;
+
+    /**
+     * @class UploadBatch
+     * @brief Stages buffer and image uploads, and records them all in one command buffer.
+     *
+     * ## Why?
+     * Renderer::uploadMesh() or the upload constructor of Image each fill a staging
+     * buffer, submit and wait for the GPU. Loading a scene does that a few hundred
+     * times: a queue submit, a fence wait and a staging allocation per mesh and
+     * per texture, with the GPU idle between them.
+     *
+     * ## How it works
+     * add*Copy() hand out room in large staging chunks (CPU_ONLY, persistently
+     * mapped) and remember where the bytes go. The caller writes the bytes there.
+     * flush() records every copy in one immediate submit: a single barrier moves
+     * all images to transfer, the buffer and image copies follow, then images get
+     * their mipmaps or move to shader reads. Once the GPU is done the chunks are freed.
+     *
+     * Staging more than the budget flushes first, so loading a large scene never
+     * holds more than about budget bytes of staging memory.
+     *
+     * Destination buffers need eTransferDst, images eTransferDst (and eTransferSrc
+     * to generate mipmaps). Nothing may read them before flush() returns.
+     *
+     * ## Threading
+     * Not thread safe: the thread that owns the ImmediateSubmitter.
+     */
+    class UploadBatch {
+    public:
+        static constexpr vk::DeviceSize CHUNK_SIZE = 32ull << 20;
+        static constexpr vk::DeviceSize DEFAULT_BUDGET = 256ull << 20;
+
+        /// Totals since construction
+        struct Stats {
+            u32 bufferCopies { 0 };
+            u32 imageCopies { 0 };
+            u64 bytes { 0 };
+            u32 submits { 0 };
+            f32 submitMs { 0.f };       ///< Recording, submitting and waiting for the GPU
+        };
+
+        UploadBatch(VulkanContext* context, ImmediateSubmitter& submitter, vk::DeviceSize budget = DEFAULT_BUDGET);
+        ~UploadBatch();
+
+        UploadBatch(const UploadBatch&) = delete;
+        UploadBatch& operator=(const UploadBatch&) = delete;
+
+        /// Copy of size bytes to dst at dstOffset. Returns where to write them, valid until the next flush
+        void* addBufferCopy(vk::Buffer dst, vk::DeviceSize size, vk::DeviceSize dstOffset = 0);
+
+        /// Tightly packed pixels of mip 0. With generateMipmaps, the other levels are blitted from it
+        void* addImageCopy(const Image& image, vk::DeviceSize size, bool generateMipmaps);
+
+        /// Every mip level, at mipOffsets in the size bytes, as in KTX files
+        void* addImageCopy(const Image& image, vk::DeviceSize size, std::span<const size_t> mipOffsets);
+
+        /// Records, submits and waits for every staged copy, then frees the staging memory
+        void flush();
+
+        bool isEmpty() const { return bufferCopies.empty() && imageCopies.empty(); }
+        const Stats& getStats() const { return stats; }
+
+    private:
+        struct BufferCopy {
+            u32 chunk { 0 };
+            vk::Buffer dst { nullptr };
+            vk::BufferCopy region {};
+        };
+
+        struct ImageCopy {
+            u32 chunk { 0 };
+            vk::Image image { nullptr };
+            vk::Extent3D extent {};
+            vk::DeviceSize srcOffset { 0 };
+            bool generateMipmaps { false };
+            vector<size_t> mipOffsets;          ///< Empty: mip 0 only
+        };
+
+        /// size bytes of staging, in a new chunk if needed. Flushes first when over budget
+        void* allocate(vk::DeviceSize size, u32& chunk, vk::DeviceSize& offset);
+
+        VulkanContext* context { nullptr };
+        ImmediateSubmitter& submitter;
+        vk::DeviceSize budget { DEFAULT_BUDGET };
+
+        vector<Buffer> chunks;
+        vk::DeviceSize chunkUsed { 0 };         ///< In the last chunk
+        vk::DeviceSize stagedBytes { 0 };       ///< Since the last flush
+        vector<BufferCopy> bufferCopies;
+        vector<ImageCopy> imageCopies;
+        Stats stats;
+    };
+
+} // namespace graphics
@@ -5,6 +5,9 @@
 
 #include "VulkanContext.h"
 #include "VulkanInit.hpp"
+#include "../BasicServices/FrameHistory.h"
+#include "../BasicServices/Profiler.h"
+#include "../BasicServices/RenderingStats.h"
 
 namespace graphics
 {
@@ -62,6 +65,7 @@ namespace graphics
         dependencyInfo.pImageMemoryBarriers = &imageBarrier;
 
         command.pipelineBarrier2(dependencyInfo);
+        services::RenderingStats::Instance().barrierCount++;
     }
 
     void copyImageToImage(vk::CommandBuffer command, vk::Image srcImage, vk::Image dstImage, vk::Extent2D srcSize,
@@ -178,6 +182,9 @@ namespace graphics
     }
 
     void ImmediateSubmitter::immediateSubmit(VulkanContext* context, std::function<void(vk::CommandBuffer cmd)> &&function) {
+        PROFILE_ZONE("Immediate Submit");
+        // Blocks until the GPU is done: a stall when it happens mid-frame
+        services::ScopedFrameEvent frameEvent(services::FrameEvent::AssetUpload);
         context->getDevice().resetFences(immFence);
         immCommandBuffer.reset();
 
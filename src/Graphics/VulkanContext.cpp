@@ -8,6 +8,7 @@
 
 // VMA Implementation
 #include "DescriptorAllocatorGrowable.h"
+#include "BasicServices/FrameHistory.h"
 #include "Image.h"
 #include "VulkanInit.hpp"
 
@@ -17,15 +18,29 @@ namespace graphics {
     VulkanContext::VulkanContext(SDL_Window *window) : window(window) {
     }
 
+    VulkanContext::VulkanContext(vk::Extent2D offscreenExtent) : offscreenExtent(offscreenExtent) {
+    }
+
     VulkanContext::~VulkanContext() { cleanup(); }
 
     void VulkanContext::init() {
         const vkb::Instance vkbInstance = createInstance();
-        createSurface();
+        if (!isHeadless()) {
+            createSurface();
+        }
         const vkb::PhysicalDevice vkbPhysicalDevice = pickPhysicalDevice(vkbInstance);
         createLogicalDevice(vkbPhysicalDevice);
         createAllocator();
-        createSwapchain();
+        if (isHeadless()) {
+            createRenderTargets({ offscreenExtent.width, offscreenExtent.height, 1 });
+        } else {
+            createSwapchain();
+        }
+        // Reads the members at shutdown: destroys the targets of the last resize
+        mainDeletionQueue.pushFunction([this]() {
+            drawImage.destroy(this);
+            depthImage.destroy(this);
+        }, "Swapchain's render and depth image and view");
         createDescriptorAllocator();
     }
 
@@ -38,7 +53,9 @@ namespace graphics {
             allocator = nullptr;
         }
 
-        instance.destroySurfaceKHR(surface);
+        if (surface) {
+            instance.destroySurfaceKHR(surface);
+        }
         vkb::destroy_debug_utils_messenger(instance, debugMessenger);
         // VkBootstrap handles destruction of instance and device
     }
@@ -68,11 +85,16 @@ namespace graphics {
             builder.set_debug_callback(debugCallback);
         }
 
-        // Get required extensions from SDL
-        uint32_t count = 0;
-        const char *const *sdlExtensions = SDL_Vulkan_GetInstanceExtensions(&count);
-        for (uint32_t i = 0; i < count; ++i) {
-            builder.enable_extension(sdlExtensions[i]);
+        if (isHeadless()) {
+            // No surface extensions: the instance works without a display (e.g. lavapipe on CI)
+            builder.set_headless(true);
+        } else {
+            // Get required extensions from SDL
+            uint32_t count = 0;
+            const char *const *sdlExtensions = SDL_Vulkan_GetInstanceExtensions(&count);
+            for (uint32_t i = 0; i < count; ++i) {
+                builder.enable_extension(sdlExtensions[i]);
+            }
         }
 
         auto instRet = builder.build();
@@ -111,13 +133,15 @@ namespace graphics {
 
         // Use VkBootstrap to select a GPU
         // We want a GPU that can write to the SDL surface and supports Vulkan 1.3 with the correct features
+        // Headless: no surface to present to, any device type is fine (including CPU implementations)
         vkb::PhysicalDeviceSelector selector{vkbInstance};
-        auto physRet = selector
-                .set_minimum_version(1, 3)
+        selector.set_minimum_version(1, 3)
                 .set_required_features_13(features13)
-                .set_required_features_12(features12)
-                .set_surface(surface)
-                .select();
+                .set_required_features_12(features12);
+        if (!isHeadless()) {
+            selector.set_surface(surface);
+        }
+        auto physRet = selector.select();
 
         if (!physRet) {
             Log::Error("Failed to select physical device: %s", physRet.error().message().c_str());
@@ -126,6 +150,11 @@ namespace graphics {
 
         auto vkbPhysicalDevice = physRet.value();
         physicalDevice = vkbPhysicalDevice.physical_device;
+
+        // Optional: pipeline statistics queries for the GPU profiler
+        vk::PhysicalDeviceFeatures optionalFeatures{};
+        optionalFeatures.pipelineStatisticsQuery = true;
+        pipelineStatisticsSupported = vkbPhysicalDevice.enable_features_if_present(optionalFeatures);
         return vkbPhysicalDevice;
     }
 
@@ -146,7 +175,8 @@ namespace graphics {
 
         // Get queues
         graphicsQueue = vkbDevice.get_queue(vkb::QueueType::graphics).value();
-        presentQueue = vkbDevice.get_queue(vkb::QueueType::present).value();
+        presentQueue = isHeadless() ? graphicsQueue : vkbDevice.get_queue(vkb::QueueType::present).value();
+        graphicsQueueFamily = vkbDevice.get_queue_index(vkb::QueueType::graphics).value();
     }
 
     void VulkanContext::createAllocator() {
@@ -158,22 +188,24 @@ namespace graphics {
         allocatorInfo.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
 
         vmaCreateAllocator(&allocatorInfo, &allocator);
+        memoryTracker->init(allocator);
     }
 
     void VulkanContext::createSwapchain() {
         int w, h;
-        SDL_GetWindowSize(window, &w, &h);
+        SDL_GetWindowSizeInPixels(window, &w, &h);
         swapchain = std::make_unique<Swapchain>(device, physicalDevice, surface, w, h);
         swapchain->init();
 
-
-        // Image size will match the window
-        VkExtent3D drawImageExtent = {
+        // Image size will match the window, once the renderer resizes the targets for its render scale
+        createRenderTargets({
             3440, //static_cast<u32>(w),
             1440, //static_cast<u32>(h),
             1
-        };
+        });
+    }
 
+    void VulkanContext::createRenderTargets(vk::Extent3D drawImageExtent) {
         // DRAW IMAGE
 
         // Hardcoding the draw format to 32 bit float
@@ -198,6 +230,7 @@ namespace graphics {
         // Allocate and create the image
         vmaCreateImage(allocator, reinterpret_cast<const VkImageCreateInfo *>(&renderImageInfo),
                        &renderImgAllocInfo, reinterpret_cast<VkImage *>(&drawImage.image), &drawImage.allocation, nullptr);
+        memoryTracker->track(drawImage.allocation, MemoryCategory::RenderTarget, "Draw image");
 
         // Build a image-view for the draw image to use for rendering
         vk::ImageViewCreateInfo renderViewInfo = graphics::imageViewCreateInfo(
@@ -214,27 +247,34 @@ namespace graphics {
         vk::ImageCreateInfo depthImgInfo = graphics::imageCreateInfo(depthImage.imageFormat, depthImageUsages, drawImageExtent);
         vmaCreateImage(allocator, reinterpret_cast<const VkImageCreateInfo *>(&depthImgInfo),
                         &renderImgAllocInfo, reinterpret_cast<VkImage *>(&depthImage.image), &depthImage.allocation, nullptr);
+        memoryTracker->track(depthImage.allocation, MemoryCategory::RenderTarget, "Depth image");
 
         vk::ImageViewCreateInfo depthViewInfo = graphics::imageViewCreateInfo(depthImage.imageFormat, depthImage.image, vk::ImageAspectFlagBits::eDepth);
         auto resDepth = device.createImageView(&depthViewInfo, nullptr, &depthImage.imageView);
+    }
 
+    bool VulkanContext::resizeSwapchain(vk::Extent2D windowExtent, DeletionQueue& retired) {
+        if (isHeadless()) return false;
 
-        mainDeletionQueue.pushFunction([this]() {
-            device.destroyImageView(drawImage.imageView, nullptr);
-            vmaDestroyImage(allocator, drawImage.image, drawImage.allocation);
-            device.destroyImageView(depthImage.imageView, nullptr);
-            vmaDestroyImage(allocator, depthImage.image, depthImage.allocation);
-        }, "Swapchain's render and depth image and view");
+        // A minimized window has no valid extent, wait for it to come back
+        if (windowExtent.width == 0 || windowExtent.height == 0) return false;
 
+        services::ScopedFrameEvent frameEvent(services::FrameEvent::SwapchainRecreation,
+            std::to_string(windowExtent.width) + "x" + std::to_string(windowExtent.height));
+        swapchain->recreate(windowExtent.width, windowExtent.height, retired);
+        return true;
+    }
 
+    void VulkanContext::resizeRenderTargets(vk::Extent3D extent, DeletionQueue& retired) {
+        if (drawImage.imageExtent == extent) return;
 
+        drawImage.retire(this, retired);
+        depthImage.retire(this, retired);
+        createRenderTargets(extent);
     }
 
-    void VulkanContext::resizeSwapchain() {
-        device.waitIdle();
-        int w, h;
-        SDL_GetWindowSize(window, &w, &h);
-        swapchain->recreate(w, h);
+    vk::Extent2D VulkanContext::getOutputExtent() const {
+        return isHeadless() ? offscreenExtent : swapchain->getExtent();
     }
 
     Image & VulkanContext::getDrawImage() {
@@ -7,6 +7,7 @@
 
 #include "DeletionQueue.hpp"
 #include "Image.h"
+#include "MemoryTracker.h"
 
 namespace graphics {
     class DescriptorAllocatorGrowable;
@@ -16,6 +17,9 @@ namespace graphics {
     public:
         VulkanContext(SDL_Window *window);
 
+        /// Headless context: no window, surface nor swapchain, rendering goes to an offscreen target of this size
+        explicit VulkanContext(vk::Extent2D offscreenExtent);
+
         ~VulkanContext();
 
         void init();
@@ -27,10 +31,16 @@ namespace graphics {
         vk::Device getDevice() const { return device; }
         vk::Queue getGraphicsQueue() const { return graphicsQueue; }
         vk::Queue getPresentQueue() const { return presentQueue; }
+        u32 getGraphicsQueueFamily() const { return graphicsQueueFamily; }
         vk::SurfaceKHR getSurface() const { return surface; }
         VmaAllocator getAllocator() const { return allocator; }
+        MemoryTracker& getMemoryTracker() const { return *memoryTracker; }
         Swapchain *getSwapchain() const { return swapchain.get(); }
         SDL_Window *getWindow() const { return window; }
+        bool isHeadless() const { return window == nullptr; }
+        bool supportsPipelineStatistics() const { return pipelineStatisticsSupported; }
+        /// Size of the final image: the swapchain extent, or the offscreen extent when headless
+        vk::Extent2D getOutputExtent() const;
         DescriptorAllocatorGrowable* getGlobalDescriptorAllocator() const { return globalDescriptorAllocator.get(); }
 
         Image& getDrawImage();
@@ -43,7 +53,16 @@ namespace graphics {
         }
         void flushMainDeletionQueue() { mainDeletionQueue.flush(); }
 
-        void resizeSwapchain();
+        /**
+         * Recreates the swapchain for a window size in pixels, without waiting on the device.
+         * The size is sampled by the main thread, the only one SDL lets query the window.
+         * What frames in flight may still use (old swapchain, image views) goes to retired.
+         * Returns false when there is nothing to present to: headless, or minimized window.
+         */
+        bool resizeSwapchain(vk::Extent2D windowExtent, DeletionQueue& retired);
+
+        /// Reallocates the draw and depth images when extent differs, the old ones go to retired
+        void resizeRenderTargets(vk::Extent3D extent, DeletionQueue& retired);
 
     private:
         vkb::Instance createInstance();
@@ -58,13 +77,16 @@ namespace graphics {
 
         void createSwapchain();
 
+        void createRenderTargets(vk::Extent3D extent);
+
         bool checkDeviceExtensionSupport(vk::PhysicalDevice device);
 
         SwapChainSupportDetails querySwapChainSupport(vk::PhysicalDevice device);
 
         void createDescriptorAllocator();
 
-        SDL_Window *window;
+        SDL_Window *window { nullptr };
+        vk::Extent2D offscreenExtent {};
 
         vk::Instance instance;
         vk::DebugUtilsMessengerEXT debugMessenger;
@@ -73,9 +95,12 @@ namespace graphics {
         vk::Device device;
         vk::Queue graphicsQueue;
         vk::Queue presentQueue;
+        u32 graphicsQueueFamily { 0 };
+        bool pipelineStatisticsSupported { false };
         DeletionQueue mainDeletionQueue;
 
         VmaAllocator allocator;
+        uptr<MemoryTracker> memoryTracker { std::make_unique<MemoryTracker>() };
         uptr<Swapchain> swapchain{nullptr};
         uptr<DescriptorAllocatorGrowable> globalDescriptorAllocator {nullptr};
 
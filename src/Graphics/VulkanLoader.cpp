@@ -3,12 +3,18 @@
 #include "VulkanLoader.h"
 
 #include <iostream>
+#include <algorithm>
+#include <future>
+#include <thread>
 
 #include "Renderer.h"
+#include "UploadBatch.h"
 #include "VulkanInit.hpp"
 #include "Types.h"
 #include <glm/gtx/quaternion.hpp>
 #include  "../BasicServices/Log.h"
+#include "../BasicServices/Platform.h"
+#include "../BasicServices/Profiler.h"
 
 #include <fastgltf/glm_element_traits.hpp>
 #include <fastgltf/tools.hpp>
@@ -135,7 +141,7 @@ namespace graphics {
                 vtx.color = glm::vec4(vtx.normal, 1.f);
             }
         }
-        newmesh.meshBuffers = engine->uploadMesh(indices, vertices);
+        newmesh.meshBuffers = engine->uploadMesh(indices, vertices, true, newmesh.name.c_str());
 
         meshes.emplace_back(std::make_shared<MeshAsset>(std::move(newmesh)));
     }
@@ -173,95 +179,219 @@ namespace graphics {
         }
     }
 
-    std::optional<Image> loadImage(Renderer* engine, fastgltf::Asset& asset, fastgltf::Image& image) {
-        std::optional<Image> newImage;
+    void DecodedImage::Free::operator()(u8* pixels) const {
+        stbi_image_free(pixels);
+    }
+
+    DecodedImage decodeImage(const fastgltf::Asset& asset, const fastgltf::Image& image) {
+        PROFILE_FUNCTION();
+        DecodedImage decoded;
+        decoded.name = image.name.c_str();
 
         int width, height, nrChannels;
+        const auto decodeBytes = [&](const void* bytes, size_t size) {
+            decoded.pixels.reset(stbi_load_from_memory(static_cast<const stbi_uc*>(bytes), static_cast<int>(size), &width, &height, &nrChannels, 4));
+        };
 
         std::visit(fastgltf::visitor {
             [](auto& arg) {},
-            [&](fastgltf::sources::URI& filePath) {
+            [&](const fastgltf::sources::URI& filePath) {
                 assert(filePath.fileByteOffset == 0); // We don't support offsets with stbi
                 assert(filePath.uri.isLocalPath()); // We're only testing local files
 
                 const std::string path(filePath.uri.path().begin(), filePath.uri.path().end());
-                unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 4);
-                if (data) {
-                    vk::Extent3D imagesize;
-                    imagesize.width = width;
-                    imagesize.height = height;
-                    imagesize.depth = 1;
-
-                    newImage = Image(engine->getContext(), *engine->getImmediateSubmitter(), data, imagesize, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled, true);
-
-                    stbi_image_free(data);
-                }
+                decoded.pixels.reset(stbi_load(path.c_str(), &width, &height, &nrChannels, 4));
             },
-            [&](fastgltf::sources::Vector& vector) {
-                unsigned char* data = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(vector.bytes.data()), static_cast<int>(vector.bytes.size()), &width, &height, &nrChannels, 4);
-                if (data) {
-                    vk::Extent3D imagesize;
-                    imagesize.width = width;
-                    imagesize.height = height;
-                    imagesize.depth = 1;
-
-                    newImage = Image(engine->getContext(), *engine->getImmediateSubmitter(), data, imagesize, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled, true);
-
-                    stbi_image_free(data);
-                }
+            [&](const fastgltf::sources::Vector& vector) {
+                decodeBytes(vector.bytes.data(), vector.bytes.size());
             },
-            [&](fastgltf::sources::BufferView& view) {
-                auto& bufferView = asset.bufferViews[view.bufferViewIndex];
-                auto& buffer = asset.buffers[bufferView.bufferIndex];
+            [&](const fastgltf::sources::BufferView& view) {
+                const auto& bufferView = asset.bufferViews[view.bufferViewIndex];
+                const auto& buffer = asset.buffers[bufferView.bufferIndex];
 
                 std::visit(fastgltf::visitor {
                     [](auto& arg) {},
-                    [&](fastgltf::sources::Array& array) {
-                        unsigned char* data = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(array.bytes.data() + bufferView.byteOffset), static_cast<int>(bufferView.byteLength), &width, &height, &nrChannels, 4);
-                        if (data) {
-                            vk::Extent3D imagesize;
-                            imagesize.width = width;
-                            imagesize.height = height;
-                            imagesize.depth = 1;
-
-                            newImage = Image(engine->getContext(), *engine->getImmediateSubmitter(), data, imagesize, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled, true);
-
-                            stbi_image_free(data);
-                        }
+                    [&](const fastgltf::sources::Array& array) {
+                        decodeBytes(array.bytes.data() + bufferView.byteOffset, bufferView.byteLength);
                     },
-                    [&](fastgltf::sources::Vector& vector) {
-                        unsigned char* data = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(vector.bytes.data() + bufferView.byteOffset), static_cast<int>(bufferView.byteLength), &width, &height, &nrChannels, 4);
-                        if (data) {
-                            vk::Extent3D imagesize;
-                            imagesize.width = width;
-                            imagesize.height = height;
-                            imagesize.depth = 1;
-
-                            newImage = Image(engine->getContext(), *engine->getImmediateSubmitter(), data, imagesize, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled, true);
-
-                            stbi_image_free(data);
-                        }
+                    [&](const fastgltf::sources::Vector& vector) {
+                        decodeBytes(vector.bytes.data() + bufferView.byteOffset, bufferView.byteLength);
                     }
                 }, buffer.data);
             },
         }, image.data);
 
+        if (decoded.pixels) {
+            decoded.width = static_cast<u32>(width);
+            decoded.height = static_cast<u32>(height);
+        }
+        return decoded;
+    }
+
+    std::optional<Image> loadImage(Renderer* engine, fastgltf::Asset& asset, fastgltf::Image& image) {
+        PROFILE_FUNCTION();
+        const DecodedImage decoded = decodeImage(asset, image);
+
         // If loading failed, return empty optional
-        if (!newImage.has_value()) {
+        if (!decoded.pixels) {
             Log::Error("Failed to load texture for glTF");
-             return {};
+            return {};
+        }
+
+        return Image(engine->getContext(), *engine->getImmediateSubmitter(), decoded.pixels.get(), vk::Extent3D { decoded.width, decoded.height, 1 },
+            vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eSampled, true, MemoryCategory::Texture, image.name.c_str());
+    }
+
+    bool appendPrimitiveGeometry(const fastgltf::Asset& gltf, const fastgltf::Primitive& p, vector<u32>& indices,
+                                 vector<Vertex>& vertices, vector<SkinVertex>& skinVertices, GeoSurface& surface) {
+        surface.startIndex = static_cast<u32>(indices.size());
+        surface.count = static_cast<u32>(gltf.accessors[p.indicesAccessor.value()].count);
+
+        const size_t initialVtx = vertices.size();
+        bool skinned = false;
+
+        // Load indices
+        {
+            const fastgltf::Accessor& indexAccessor = gltf.accessors[p.indicesAccessor.value()];
+            indices.reserve(indices.size() + indexAccessor.count);
+            fastgltf::iterateAccessor<std::uint32_t>(gltf, indexAccessor, [&](std::uint32_t idx) {
+                indices.push_back(idx + static_cast<u32>(initialVtx));
+            });
+        }
+
+        // Load vertex positions
+        {
+            const fastgltf::Accessor& posAccessor = gltf.accessors[p.findAttribute("POSITION")->accessorIndex];
+            vertices.resize(vertices.size() + posAccessor.count);
+            fastgltf::iterateAccessorWithIndex<glm::vec3>(gltf, posAccessor, [&](glm::vec3 v, size_t index) {
+                Vertex newvtx;
+                newvtx.position = v;
+                newvtx.normal = { 1, 0, 0 };
+                newvtx.color = glm::vec4 { 1.f };
+                newvtx.uvX = 0;
+                newvtx.uvY = 0;
+                vertices[initialVtx + index] = newvtx;
+            });
+        }
+
+        // Load normals
+        auto normals = p.findAttribute("NORMAL");
+        if (normals != p.attributes.end()) {
+            fastgltf::iterateAccessorWithIndex<glm::vec3>(gltf, gltf.accessors[normals->accessorIndex], [&](glm::vec3 v, size_t index) {
+                vertices[initialVtx + index].normal = v;
+            });
+        }
+
+        // Load UVs
+        auto uv = p.findAttribute("TEXCOORD_0");
+        if (uv != p.attributes.end()) {
+            fastgltf::iterateAccessorWithIndex<glm::vec2>(gltf, gltf.accessors[uv->accessorIndex], [&](glm::vec2 v, size_t index) {
+                vertices[initialVtx + index].uvX = v.x;
+                vertices[initialVtx + index].uvY = v.y;
+            });
+        }
+
+        // Load Colors
+        auto colors = p.findAttribute("COLOR_0");
+        if (colors != p.attributes.end()) {
+            fastgltf::iterateAccessorWithIndex<glm::vec4>(gltf, gltf.accessors[colors->accessorIndex], [&](glm::vec4 v, size_t index) {
+                vertices[initialVtx + index].color = v;
+            });
+        }
+
+        // Load skinning influences (primitives without them get zero weights = bind pose)
+        skinVertices.resize(vertices.size(), SkinVertex { glm::uvec4 { 0 }, glm::vec4 { 0.f } });
+        auto joints = p.findAttribute("JOINTS_0");
+        auto weights = p.findAttribute("WEIGHTS_0");
+        if (joints != p.attributes.end() && weights != p.attributes.end()) {
+            skinned = true;
+            fastgltf::iterateAccessorWithIndex<glm::uvec4>(gltf, gltf.accessors[joints->accessorIndex], [&](glm::uvec4 v, size_t index) {
+                skinVertices[initialVtx + index].joints = v;
+            });
+            fastgltf::iterateAccessorWithIndex<glm::vec4>(gltf, gltf.accessors[weights->accessorIndex], [&](glm::vec4 v, size_t index) {
+                skinVertices[initialVtx + index].weights = v;
+            });
+        }
+
+        // Calculate bounds from vertex positions
+        glm::vec3 minPos = vertices[initialVtx].position;
+        glm::vec3 maxPos = vertices[initialVtx].position;
+        for (size_t i = initialVtx; i < vertices.size(); i++) {
+            minPos = glm::min(minPos, vertices[i].position);
+            maxPos = glm::max(maxPos, vertices[i].position);
+        }
+        surface.bounds.origin = (maxPos + minPos) / 2.f;
+        surface.bounds.extents = (maxPos - minPos) / 2.f;
+        surface.bounds.sphereRadius = glm::length(surface.bounds.extents);
+
+        return skinned;
+    }
+
+    void SkinBounds::build(std::span<const Vertex> vertices, std::span<const SkinVertex> skinVertices) {
+        for (size_t i = 0; i < vertices.size(); i++) {
+            const Vec3& position = vertices[i].position;
+            const SkinVertex& skin = skinVertices[i];
+            if (skin.weights == glm::vec4 { 0.f }) {
+                staticMin = glm::min(staticMin, position);
+                staticMax = glm::max(staticMax, position);
+                continue;
+            }
+
+            for (u32 k = 0; k < 4; k++) {
+                if (skin.weights[k] <= 0.f) continue;
+                const u32 joint = skin.joints[k];
+                if (joint >= jointMin.size()) {
+                    jointMin.resize(joint + 1, Vec3 { std::numeric_limits<f32>::max() });
+                    jointMax.resize(joint + 1, Vec3 { std::numeric_limits<f32>::lowest() });
+                }
+                jointMin[joint] = glm::min(jointMin[joint], position);
+                jointMax[joint] = glm::max(jointMax[joint], position);
+            }
         }
+    }
 
-        return newImage;
+    Bounds SkinBounds::pose(std::span<const Mat4> palette) const {
+        Vec3 minPos = staticMin;
+        Vec3 maxPos = staticMax;
+        const size_t joints = std::min(jointMin.size(), palette.size());
+        for (size_t j = 0; j < joints; j++) {
+            if (jointMin[j].x > jointMax[j].x) continue;
+            for (u32 c = 0; c < 8; c++) {
+                const Vec3 corner { c & 1 ? jointMax[j].x : jointMin[j].x, c & 2 ? jointMax[j].y : jointMin[j].y,
+                                    c & 4 ? jointMax[j].z : jointMin[j].z };
+                const Vec3 moved = Vec3(palette[j] * Vec4(corner, 1.f));
+                minPos = glm::min(minPos, moved);
+                maxPos = glm::max(maxPos, moved);
+            }
+        }
+
+        Bounds bounds;
+        bounds.origin = (maxPos + minPos) / 2.f;
+        bounds.extents = (maxPos - minPos) / 2.f;
+        bounds.sphereRadius = glm::length(bounds.extents);
+        return bounds;
     }
 
     std::optional<sptr<LoadedGLTF>> loadGltf(Renderer* engine, const str& filePath) {
-        Log::Debug("Loading glTF scene: %s", filePath.c_str());
+        PROFILE_FUNCTION();
+        std::optional<GltfData> data = parseGltf(filePath);
+        if (!data.has_value()) {
+            return {};
+        }
 
-        sptr<LoadedGLTF> scene = std::make_shared<LoadedGLTF>();
-        scene->creator = engine;
-        LoadedGLTF& file = *scene;
+        UploadBatch batch { engine->getContext(), *engine->getImmediateSubmitter() };
+        sptr<LoadedGLTF> scene = createGltf(engine, *data, batch);
+        batch.flush();
+        return scene;
+    }
+
+    std::optional<GltfData> parseGltf(const str& filePath, bool parallelDecode) {
+        PROFILE_FUNCTION();
+        Log::Debug("Loading glTF scene: %s", filePath.c_str());
+        u64 start = services::Profiler::now();
 
+        GltfData data;
+        data.path = filePath;
         std::filesystem::path path = services::File::getFileSystemPath(filePath);
 
         auto dataResult = fastgltf::GltfDataBuffer::FromPath(path);
@@ -272,7 +402,7 @@ namespace graphics {
 
         constexpr auto gltfOptions = fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble | fastgltf::Options::LoadGLBBuffers | fastgltf::Options::LoadExternalBuffers;
 
-        fastgltf::Asset gltf;
+        fastgltf::Asset& gltf = data.asset;
         fastgltf::Parser parser {};
 
         auto type = fastgltf::determineGltfFileType(dataResult.get());
@@ -296,6 +426,66 @@ namespace graphics {
             Log::Error("Failed to determine glTF container");
             return {};
         }
+        data.parseMs = services::Profiler::toMilliseconds(services::Profiler::now() - start);
+
+        // Decode images on workers, in contiguous chunks, while this thread builds the meshes.
+        // They only read the asset, and each writes its own images
+        data.images.resize(gltf.images.size());
+        const auto decodeChunk = [&data](size_t begin, size_t end) {
+            const u64 chunkStart = services::Profiler::now();
+            for (size_t i = begin; i < end; i++) {
+                data.images[i] = decodeImage(data.asset, data.asset.images[i]);
+            }
+            return services::Profiler::toMilliseconds(services::Profiler::now() - chunkStart);
+        };
+        const auto decodeWorkerChunk = [&decodeChunk](size_t begin, size_t end) {
+            services::Platform::pinToWorkerCpus();
+            return decodeChunk(begin, end);
+        };
+
+        vector<std::future<f32>> decodeJobs;
+        if (parallelDecode && !gltf.images.empty()) {
+            const size_t workerCount = std::max(1u, std::min(std::thread::hardware_concurrency(), static_cast<u32>(gltf.images.size())));
+            const size_t chunkSize = (gltf.images.size() + workerCount - 1) / workerCount;
+            for (size_t begin = 0; begin < gltf.images.size(); begin += chunkSize) {
+                decodeJobs.push_back(std::async(std::launch::async, decodeWorkerChunk, begin, std::min(begin + chunkSize, gltf.images.size())));
+            }
+        } else {
+            data.decodeMs = decodeChunk(0, gltf.images.size());
+        }
+
+        // Build meshes
+        start = services::Profiler::now();
+        data.meshes.resize(gltf.meshes.size());
+        for (size_t m = 0; m < gltf.meshes.size(); m++) {
+            MeshGeometry& geometry = data.meshes[m];
+            for (auto&& p : gltf.meshes[m].primitives) {
+                GeoSurface& newSurface = geometry.surfaces.emplace_back();
+                if (appendPrimitiveGeometry(gltf, p, geometry.indices, geometry.vertices, geometry.skinVertices, newSurface)) {
+                    geometry.skinned = true;
+                }
+            }
+            if (geometry.skinned) {
+                geometry.skinBounds.build(geometry.vertices, geometry.skinVertices);
+            } else {
+                geometry.skinVertices = {};
+            }
+        }
+        data.geometryMs = services::Profiler::toMilliseconds(services::Profiler::now() - start);
+
+        for (auto& job : decodeJobs) {
+            data.decodeMs += job.get();
+        }
+
+        return data;
+    }
+
+    sptr<LoadedGLTF> createGltf(Renderer* engine, GltfData& data, UploadBatch& batch) {
+        PROFILE_FUNCTION();
+        sptr<LoadedGLTF> scene = std::make_shared<LoadedGLTF>();
+        scene->creator = engine;
+        LoadedGLTF& file = *scene;
+        fastgltf::Asset& gltf = data.asset;
 
         // Initialize descriptor pool
         vector<DescriptorAllocatorGrowable::PoolSizeRatio> sizes = {
@@ -327,21 +517,26 @@ namespace graphics {
         vector<sptr<GLTFMaterial>> materials;
 
         // Load Images
-        for (fastgltf::Image& image : gltf.images) {
-            std::optional<Image> img = loadImage(engine, gltf, image);
-
-            if (img.has_value()) {
-                images.push_back(*img);
-                file.images[image.name.c_str()] = *img; 
+        for (DecodedImage& decoded : data.images) {
+            if (decoded.pixels) {
+                const Image img { engine->getContext(), vk::Extent3D { decoded.width, decoded.height, 1 }, vk::Format::eR8G8B8A8Unorm,
+                    vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc, true,
+                    MemoryCategory::Texture, decoded.name.c_str() };
+                const size_t size = static_cast<size_t>(decoded.width) * decoded.height * 4;
+                memcpy(batch.addImageCopy(img, size, true), decoded.pixels.get(), size);
+                decoded.pixels.reset();     // Staged
+
+                images.push_back(img);
+                file.images[decoded.name] = img;
             } else {
                 // we failed to load, so let's give the slot a default white image to not crash
                 images.push_back(engine->errorCheckerboardImage);
-                Log::Error("gltf failed to load texture: %s", image.name.c_str());
+                Log::Error("gltf failed to load texture: %s", decoded.name.c_str());
             }
         }
         
         file.materialDataBuffer = Buffer(engine->getContext(), sizeof(pipelines::GLTFMetallicRoughness::MaterialConstants) * gltf.materials.size(),
-            vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU);
+            vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_CPU_TO_GPU, MemoryCategory::Uniform, "glTF material constants");
 
         int dataIndex = 0;
         auto* sceneMaterialConstants = static_cast<pipelines::GLTFMetallicRoughness::MaterialConstants*>(file.materialDataBuffer.info.pMappedData);
@@ -389,95 +584,53 @@ namespace graphics {
         }
 
         // Load Meshes
-        vector<uint32_t> indices;
-        vector<Vertex> vertices;
-
-        for (fastgltf::Mesh& mesh : gltf.meshes) {
+        for (size_t m = 0; m < gltf.meshes.size(); m++) {
+            fastgltf::Mesh& mesh = gltf.meshes[m];
+            MeshGeometry& geometry = data.meshes[m];
             sptr<MeshAsset> newMesh = std::make_shared<MeshAsset>();
             meshes.push_back(newMesh);
             file.meshes[mesh.name.c_str()] = newMesh;
             newMesh->name = mesh.name;
 
-            indices.clear();
-            vertices.clear();
-
-            for (auto&& p : mesh.primitives) {
-                GeoSurface newSurface;
-                newSurface.startIndex = static_cast<u32>(indices.size());
-                newSurface.count = static_cast<u32>(gltf.accessors[p.indicesAccessor.value()].count);
-
-                size_t initialVtx = vertices.size();
-
-                // Load indices
-                {
-                    fastgltf::Accessor& indexAccessor = gltf.accessors[p.indicesAccessor.value()];
-                    indices.reserve(indices.size() + indexAccessor.count);
-                    fastgltf::iterateAccessor<std::uint32_t>(gltf, indexAccessor, [&](std::uint32_t idx) {
-                        indices.push_back(idx + static_cast<u32>(initialVtx));
-                    });
-                }
-
-                // Load vertex positions
-                {
-                    fastgltf::Accessor& posAccessor = gltf.accessors[p.findAttribute("POSITION")->accessorIndex];
-                    vertices.resize(vertices.size() + posAccessor.count);
-                    fastgltf::iterateAccessorWithIndex<glm::vec3>(gltf, posAccessor, [&](glm::vec3 v, size_t index) {
-                        Vertex newvtx;
-                        newvtx.position = v;
-                        newvtx.normal = { 1, 0, 0 };
-                        newvtx.color = glm::vec4 { 1.f };
-                        newvtx.uvX = 0;
-                        newvtx.uvY = 0;
-                        vertices[initialVtx + index] = newvtx;
-                    });
-                }
-
-                // Load normals
-                auto normals = p.findAttribute("NORMAL");
-                if (normals != p.attributes.end()) {
-                    fastgltf::iterateAccessorWithIndex<glm::vec3>(gltf, gltf.accessors[normals->accessorIndex], [&](glm::vec3 v, size_t index) {
-                        vertices[initialVtx + index].normal = v;
-                    });
-                }
-
-                // Load UVs
-                auto uv = p.findAttribute("TEXCOORD_0");
-                if (uv != p.attributes.end()) {
-                    fastgltf::iterateAccessorWithIndex<glm::vec2>(gltf, gltf.accessors[uv->accessorIndex], [&](glm::vec2 v, size_t index) {
-                        vertices[initialVtx + index].uvX = v.x;
-                        vertices[initialVtx + index].uvY = v.y;
-                    });
-                }
-
-                // Load Colors
-                auto colors = p.findAttribute("COLOR_0");
-                if (colors != p.attributes.end()) {
-                    fastgltf::iterateAccessorWithIndex<glm::vec4>(gltf, gltf.accessors[colors->accessorIndex], [&](glm::vec4 v, size_t index) {
-                        vertices[initialVtx + index].color = v;
-                    });
-                }
-
-                if (p.materialIndex.has_value()) {
-                    newSurface.material = materials[p.materialIndex.value()];
+            for (size_t p = 0; p < mesh.primitives.size(); p++) {
+                GeoSurface newSurface = geometry.surfaces[p];
+                if (mesh.primitives[p].materialIndex.has_value()) {
+                    newSurface.material = materials[mesh.primitives[p].materialIndex.value()];
                 } else {
                     newSurface.material = materials[0];
                 }
+                newMesh->surfaces.push_back(newSurface);
+            }
 
-                // Calculate bounds from vertex positions
-                glm::vec3 minPos = vertices[initialVtx].position;
-                glm::vec3 maxPos = vertices[initialVtx].position;
-                for (size_t i = initialVtx; i < vertices.size(); i++) {
-                    minPos = glm::min(minPos, vertices[i].position);
-                    maxPos = glm::max(maxPos, vertices[i].position);
-                }
-                newSurface.bounds.origin = (maxPos + minPos) / 2.f;
-                newSurface.bounds.extents = (maxPos - minPos) / 2.f;
-                newSurface.bounds.sphereRadius = glm::length(newSurface.bounds.extents);
+            newMesh->meshBuffers = engine->uploadMesh(batch, geometry.indices, geometry.vertices, true, newMesh->name.c_str());
+            newMesh->vertexCount = static_cast<u32>(geometry.vertices.size());
 
-                newMesh->surfaces.push_back(newSurface);
+            if (geometry.skinned) {
+                newMesh->skinBuffer = engine->uploadSkinData(batch, geometry.skinVertices, newMesh->name.c_str());
+                newMesh->skinBufferAddress = newMesh->skinBuffer.getDeviceAddress();
+                newMesh->skinBounds = std::move(geometry.skinBounds);
+            }
+        }
+
+        // Load Skins
+        for (fastgltf::Skin& skin : gltf.skins) {
+            Skin newSkin;
+            newSkin.name = skin.name;
+            newSkin.joints.reserve(skin.joints.size());
+            for (size_t joint : skin.joints) {
+                newSkin.joints.push_back(static_cast<u32>(joint));
             }
 
-            newMesh->meshBuffers = engine->uploadMesh(indices, vertices);
+            newSkin.inverseBindMatrices.assign(newSkin.joints.size(), Mat4 { 1.f });
+            if (skin.inverseBindMatrices.has_value()) {
+                fastgltf::iterateAccessorWithIndex<glm::mat4>(gltf, gltf.accessors[skin.inverseBindMatrices.value()], [&](glm::mat4 m, size_t index) {
+                    if (index < newSkin.inverseBindMatrices.size()) {
+                        newSkin.inverseBindMatrices[index] = m;
+                    }
+                });
+            }
+
+            file.skins.push_back(std::move(newSkin));
         }
 
         // Load Nodes
@@ -494,6 +647,12 @@ namespace graphics {
             nodes.push_back(newNode);
             file.nodes[node.name.c_str()] = newNode;
 
+            if (node.meshIndex.has_value() && node.skinIndex.has_value()) {
+                static_cast<MeshNode*>(newNode.get())->skin = static_cast<i32>(node.skinIndex.value());
+            }
+
+            NodeTRS& rest = file.restPose.emplace_back();
+
             std::visit([&](auto&& arg) {
                 // Use C++20 concepts to detect type features instead of names
                 if constexpr (requires { arg.translation; }) {
@@ -507,6 +666,11 @@ namespace graphics {
                     glm::mat4 sm = glm::scale(glm::mat4(1.f), sc);
 
                     newNode->localTransform = tm * rm * sm;
+
+                    // Kept separately so animation channels can override a single component
+                    rest.translation = tl;
+                    rest.rotation = rot;
+                    rest.scale = sc;
                 } else {
                      // It's Matrix (std::array or similar)
                     memcpy(&newNode->localTransform, arg.data(), sizeof(arg));
@@ -533,6 +697,114 @@ namespace graphics {
             }
         }
 
+        file.nodeList = nodes;
+
+        // Skinned mesh instances: each one gets its own posed vertex buffers, since two nodes
+        // can share a mesh but not a pose
+        for (auto& node : nodes) {
+            auto meshNode = std::dynamic_pointer_cast<MeshNode>(node);
+            if (!meshNode || meshNode->skin < 0 || !meshNode->mesh->isSkinned()) continue;
+            if (meshNode->skin >= static_cast<i32>(file.skins.size())) {
+                Log::Warn("glTF node references missing skin %d", meshNode->skin);
+                continue;
+            }
+
+            SkinnedMeshInstance& instance = file.skinnedMeshes.emplace_back();
+            instance.node = meshNode;
+            instance.skin = static_cast<u32>(meshNode->skin);
+            for (int i = 0; i < FRAME_OVERLAP; i++) {
+                instance.posedVertices[i] = Buffer(engine->getContext(), meshNode->mesh->vertexCount * sizeof(Vertex),
+                    vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                    VMA_MEMORY_USAGE_GPU_ONLY, MemoryCategory::Skinning, meshNode->mesh->name.c_str());
+                instance.posedAddresses[i] = instance.posedVertices[i].getDeviceAddress();
+            }
+        }
+
+        // Load Animations
+        for (fastgltf::Animation& animation : gltf.animations) {
+            AnimationClip clip;
+            clip.name = animation.name;
+
+            for (fastgltf::AnimationSampler& sampler : animation.samplers) {
+                AnimationSampler& newSampler = clip.samplers.emplace_back();
+
+                switch (sampler.interpolation) {
+                case fastgltf::AnimationInterpolation::Step:
+                    newSampler.interpolation = AnimationInterpolation::Step;
+                    break;
+                case fastgltf::AnimationInterpolation::CubicSpline:
+                    newSampler.interpolation = AnimationInterpolation::CubicSpline;
+                    break;
+                default:
+                    newSampler.interpolation = AnimationInterpolation::Linear;
+                    break;
+                }
+
+                fastgltf::Accessor& input = gltf.accessors[sampler.inputAccessor];
+                newSampler.times.resize(input.count);
+                fastgltf::iterateAccessorWithIndex<float>(gltf, input, [&](float t, size_t index) {
+                    newSampler.times[index] = t;
+                });
+                if (!newSampler.times.empty()) {
+                    clip.duration = std::max(clip.duration, newSampler.times.back());
+                }
+
+                // Translation/scale are vec3, rotation is vec4. Morph target weights are not supported.
+                fastgltf::Accessor& output = gltf.accessors[sampler.outputAccessor];
+                newSampler.values.resize(output.count);
+                if (output.type == fastgltf::AccessorType::Vec3) {
+                    fastgltf::iterateAccessorWithIndex<glm::vec3>(gltf, output, [&](glm::vec3 v, size_t index) {
+                        newSampler.values[index] = Vec4(v, 0.f);
+                    });
+                } else if (output.type == fastgltf::AccessorType::Vec4) {
+                    fastgltf::iterateAccessorWithIndex<glm::vec4>(gltf, output, [&](glm::vec4 v, size_t index) {
+                        newSampler.values[index] = v;
+                    });
+                } else {
+                    newSampler.times.clear();
+                    newSampler.values.clear();
+                }
+            }
+
+            for (fastgltf::AnimationChannel& channel : animation.channels) {
+                if (!channel.nodeIndex.has_value()) continue;
+
+                AnimationChannel newChannel;
+                newChannel.sampler = static_cast<u32>(channel.samplerIndex);
+                newChannel.node = static_cast<u32>(channel.nodeIndex.value());
+
+                switch (channel.path) {
+                case fastgltf::AnimationPath::Translation:
+                    newChannel.path = AnimationPath::Translation;
+                    break;
+                case fastgltf::AnimationPath::Rotation:
+                    newChannel.path = AnimationPath::Rotation;
+                    break;
+                case fastgltf::AnimationPath::Scale:
+                    newChannel.path = AnimationPath::Scale;
+                    break;
+                default:
+                    continue;
+                }
+
+                clip.channels.push_back(newChannel);
+                if (std::find(clip.animatedNodes.begin(), clip.animatedNodes.end(), newChannel.node) == clip.animatedNodes.end()) {
+                    clip.animatedNodes.push_back(newChannel.node);
+                }
+            }
+
+            file.animations.push_back(std::move(clip));
+        }
+
+        if (!file.animations.empty()) {
+            file.playAnimation(0);
+        }
+
+        if (!file.animations.empty() || !file.skins.empty()) {
+            Log::Debug("glTF %s: %zu skins, %zu skinned meshes, %zu animations", data.path.c_str(),
+                file.skins.size(), file.skinnedMeshes.size(), file.animations.size());
+        }
+
         return scene;
     }
 }
@@ -1,5 +1,7 @@
 ﻿#pragma once
 #include <filesystem>
+#include <limits>
+#include <span>
 
 #include "Buffer.h"
 #include "Types.h"
@@ -24,17 +26,91 @@ namespace graphics {
         sptr<GLTFMaterial> material;
     };
 
+    /**
+     * Bounds of a skinned mesh in any pose. A skinned vertex is a weighted average of the
+     * vertex moved by each of its joints, so it stays in the box of the bind pose vertices
+     * of those joints, each moved by its joint matrix: the posed box is the union of them.
+     * Conservative, in the mesh node's space like the joint palette.
+     */
+    struct SkinBounds {
+        vector<Vec3> jointMin;     // Indexed like SkinVertex::joints. Above jointMax: the joint moves no vertex
+        vector<Vec3> jointMax;
+        Vec3 staticMin { std::numeric_limits<f32>::max() };    // Vertices without weights stay in the bind pose
+        Vec3 staticMax { std::numeric_limits<f32>::lowest() };
+
+        void build(std::span<const Vertex> vertices, std::span<const SkinVertex> skinVertices);
+        Bounds pose(std::span<const Mat4> palette) const;
+        bool isEmpty() const { return jointMin.empty(); }
+    };
+
     struct MeshAsset {
         str name;
 
         vector<GeoSurface> surfaces;
         GPUMeshBuffers meshBuffers;
+
+        // Skinning (only filled when a primitive has JOINTS_0/WEIGHTS_0)
+        u32 vertexCount { 0 };
+        Buffer skinBuffer;                        ///< SkinVertex per vertex, read by the skinning compute pass
+        vk::DeviceAddress skinBufferAddress { 0 };
+        SkinBounds skinBounds;
+
+        bool isSkinned() const { return skinBufferAddress != 0; }
     };
 
     class Renderer;
     class LoadedGLTF;
+    class UploadBatch;
+
+    // Pixels of a glTF image, decoded to RGBA8
+    struct DecodedImage {
+        struct Free { void operator()(u8* pixels) const; };
+
+        str name;
+        std::unique_ptr<u8, Free> pixels;   // Null when decoding failed
+        u32 width { 0 };
+        u32 height { 0 };
+    };
+
+    // One glTF mesh, ready to upload. Surfaces have no material yet
+    struct MeshGeometry {
+        vector<u32> indices;
+        vector<Vertex> vertices;
+        vector<SkinVertex> skinVertices;
+        vector<GeoSurface> surfaces;
+        bool skinned { false };
+        SkinBounds skinBounds;              // Skinned meshes only
+    };
+
+    // CPU side of a glTF file: everything that can be done without the GPU, on any thread
+    struct GltfData {
+        str path;
+        fastgltf::Asset asset;
+        vector<DecodedImage> images;        // One per asset.images
+        vector<MeshGeometry> meshes;        // One per asset.meshes
+
+        // Time spent in each step, in milliseconds
+        f32 parseMs { 0.f };
+        f32 decodeMs { 0.f };               // Summed over the decoding threads
+        f32 geometryMs { 0.f };
+    };
 
     std::optional<vector<sptr<MeshAsset>>> loadGltfMeshes(Renderer* engine, const str& filePath);
+    // parseGltf() then createGltf(), uploads waited for
     std::optional<sptr<LoadedGLTF>> loadGltf(Renderer* engine, const str& filePath);
     std::optional<Image> loadImage(Renderer* engine, fastgltf::Asset& asset, fastgltf::Image& image);
+
+    // Reads and parses a glTF file, decodes its images and builds its meshes. Thread safe.
+    // With parallelDecode, images are decoded on worker threads while the meshes are built.
+    std::optional<GltfData> parseGltf(const str& filePath, bool parallelDecode = true);
+    // Creates the GPU resources, materials and scene graph of a parsed file. Buffers and images
+    // are filled when batch flushes. Thread that owns the renderer's immediate submitter.
+    sptr<LoadedGLTF> createGltf(Renderer* engine, GltfData& data, UploadBatch& batch);
+    // Thread safe
+    DecodedImage decodeImage(const fastgltf::Asset& asset, const fastgltf::Image& image);
+
+    // CPU side of mesh loading: appends one primitive's indices, vertices and skin influences,
+    // fills the surface range and bounds. Returns true if the primitive has JOINTS_0/WEIGHTS_0.
+    bool appendPrimitiveGeometry(const fastgltf::Asset& gltf, const fastgltf::Primitive& primitive, vector<u32>& indices,
+                                 vector<Vertex>& vertices, vector<SkinVertex>& skinVertices, GeoSurface& surface);
 }
\ No newline at end of file
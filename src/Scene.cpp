@@ -8,6 +8,8 @@
 #include "Graphics/Pipelines/GLTFMetallicRoughness.h"
 #include "Graphics/Techniques/IRenderingTechnique.h"
 #include <imgui.h>
+#include "BasicServices/Profiler.h"
+#include "BasicServices/RenderingStats.h"
 
 #include "Graphics/Techniques/ShadowMappingTechnique.h"
 #include "Graphics/Techniques/DeferredRenderingTechnique.h"
@@ -44,7 +46,9 @@ void Scene::initializeDefaultMaterial() {
         renderer->getContext(),
         sizeof(GLTFMetallicRoughness::MaterialConstants),
         vk::BufferUsageFlagBits::eUniformBuffer,
-        VMA_MEMORY_USAGE_CPU_TO_GPU
+        VMA_MEMORY_USAGE_CPU_TO_GPU,
+        graphics::MemoryCategory::Uniform,
+        "Scene material constants"
     );
 
     // Write default constants (white, slightly rough non-metal)
@@ -197,8 +201,10 @@ void Scene::drawImGui() {
     // Default ImGui for base Scene - can be overridden by derived classes
     if (ImGui::Begin("Scene Info")) {
         ImGui::Text("Nodes: %zu", nodes.size());
-        ImGui::Text("Opaque surfaces: %zu", drawContext.opaqueSurfaces.size());
-        ImGui::Text("Transparent surfaces: %zu", drawContext.transparentSurfaces.size());
+        // What the renderer draws: in the interactive app, the draw lists of the frame packet
+        const graphics::DrawContext& renderedContext = *renderer->getDrawContext();
+        ImGui::Text("Opaque surfaces: %zu", renderedContext.opaqueSurfaces.size());
+        ImGui::Text("Transparent surfaces: %zu", renderedContext.transparentSurfaces.size());
 
         if (renderingTechnique) {
             ImGui::Text("Technique: %s", renderingTechnique->getName().c_str());
@@ -215,6 +221,25 @@ void Scene::drawImGui() {
             if (ImGui::Checkbox("Enable PCF", &enablePCF)) {
                 static_cast<graphics::techniques::ShadowMappingTechnique*>(renderingTechnique)->setEnablePCF(enablePCF);
             }
+
+            if (enablePCF) {
+                const char* filterModes[] = { "Hardware (1 tap)", "Optimized (4 taps)", "Poisson (8 taps)" };
+                int currentFilter = static_cast<int>(static_cast<graphics::techniques::ShadowMappingTechnique*>(renderingTechnique)->getShadowFilter());
+                if (ImGui::Combo("PCF Kernel", &currentFilter, filterModes, IM_ARRAYSIZE(filterModes))) {
+                    static_cast<graphics::techniques::ShadowMappingTechnique*>(renderingTechnique)->setShadowFilter(static_cast<graphics::ShadowFilter>(currentFilter));
+                }
+            }
+
+            bool casterCulling = renderer->isShadowCasterCullingEnabled();
+            if (ImGui::Checkbox("Shadow Caster Culling", &casterCulling)) {
+                renderer->setShadowCasterCulling(casterCulling);
+            }
+            bool projectionFitting = renderer->isShadowProjectionFittingEnabled();
+            if (ImGui::Checkbox("Fit Shadow Projection", &projectionFitting)) {
+                renderer->setShadowProjectionFitting(projectionFitting);
+            }
+            const auto& stats = services::RenderingStats::Instance();
+            ImGui::Text("Shadow casters: %d drawn, %d culled", stats.shadowDrawcallCount, stats.shadowCasterCulledCount);
         }
 
         // Debug for deferred technique
@@ -256,6 +281,39 @@ void Scene::drawImGui() {
                 ImGui::Checkbox("SSAO Only (Debug)", &ssaoParams.ssaoOnly);
             }
         }
+
+        // GPU particles (drawn by the external techniques, before post-processing)
+        ImGui::Separator();
+        ImGui::Text("Particles");
+        auto& particles = renderer->getParticleSystem();
+        bool particlesEnabled = particles.isEnabled();
+        if (ImGui::Checkbox("Enable Particles", &particlesEnabled)) {
+            particles.setEnabled(particlesEnabled);
+        }
+        if (particlesEnabled) {
+            for (u32 i = 0; i < particles.getEmitterCount(); i++) {
+                auto& emitter = particles.getEmitterSettings(i);
+                ImGui::PushID(static_cast<int>(i));
+                ImGui::Checkbox(emitter.name.c_str(), &emitter.enabled);
+                ImGui::SameLine();
+                ImGui::SliderFloat("Rate", &emitter.emitRate, 0.0f, 20000.0f, "%.0f/s");
+                ImGui::PopID();
+            }
+        }
+
+        // CPU zones, opened in chrome://tracing or ui.perfetto.dev
+        ImGui::Separator();
+        ImGui::Text("Profiling");
+#ifdef MEADOWS_PROFILING
+        auto& profiler = services::Profiler::Instance();
+        if (profiler.isCapturing()) {
+            ImGui::Text("Capturing CPU trace...");
+        } else if (ImGui::Button("Capture CPU Trace (120 frames)")) {
+            profiler.captureFrames(120, "cpu_trace.json");
+        }
+#else
+        ImGui::Text("CPU zones disabled (MEADOWS_PROFILING=OFF)");
+#endif
     }
     ImGui::End();
 }
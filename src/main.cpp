@@ -3,6 +3,18 @@
 int main(int argc, char* argv[]) {
     Engine engine;
 
+    // meadows --bench [--scene basic|shadow|deferred] [--technique basic|shadow|deferred]
+    //                 [--width W] [--height H] [--warmup N] [--frames N] [--views N] [--output report.json]
+    //                 [--replay capture.mcap [--repeat N]]
+    //                 [--batch jobs.txt|orbit [--images directory] [--format png|exr]]
+    // --batch alone also runs headless: one image per job, or --frames views of --scene for orbit
+    if (const auto benchmarkSettings = BenchmarkSettings::fromArguments(argc, argv)) {
+        engine.initBenchmark(*benchmarkSettings);
+        const int result = engine.runBenchmark();
+        engine.cleanup();
+        return result;
+    }
+
     engine.init();
     engine.run();
     engine.cleanup();